@@ -0,0 +1,62 @@
+#include "ads1115_current.h"
+
+#include <Arduino.h>
+#include <Wire.h>
+
+#define ADS1115_REG_CONVERSION 0x00
+#define ADS1115_REG_CONFIG 0x01
+
+bool Ads1115CurrentSource::begin() {
+  Wire.begin(CURRENT_SDA_PIN, CURRENT_SCL_PIN, 400000);
+
+  Wire.beginTransmission(ADS1115_ADDRESS);
+  found = Wire.endTransmission() == 0;
+  if (!found) return false;
+
+  channel = 0;
+  return startConversion(channel);
+}
+
+bool Ads1115CurrentSource::startConversion(uint8_t ch) {
+  // OS=1 (старт), MUX=1xx (AINx относительно GND), PGA=±4.096 В, MODE=одиночное,
+  // DR=860 SPS, компаратор выключен
+  uint8_t hi = 0x80 | ((4 + ch) << 4) | (0x01 << 1) | 0x01;
+  uint8_t lo = 0xE3;
+
+  Wire.beginTransmission(ADS1115_ADDRESS);
+  Wire.write(ADS1115_REG_CONFIG);
+  Wire.write(hi);
+  Wire.write(lo);
+  return Wire.endTransmission() == 0;
+}
+
+bool Ads1115CurrentSource::readConversion(int16_t &raw) {
+  Wire.beginTransmission(ADS1115_ADDRESS);
+  Wire.write(ADS1115_REG_CONVERSION);
+  if (Wire.endTransmission() != 0) return false;
+
+  if (Wire.requestFrom((uint8_t)ADS1115_ADDRESS, (uint8_t)2) != 2) return false;
+  raw = (int16_t)((Wire.read() << 8) | Wire.read());
+  return true;
+}
+
+void Ads1115CurrentSource::poll() {
+  if (!found) return;
+
+  int16_t raw;
+  if (readConversion(raw)) {
+    // 1 LSB = 125 мкВ при PGA ±4.096 В
+    int32_t microvolts = raw > 0 ? (int32_t)raw * 125 : 0;
+    current[channel] = (uint16_t)(microvolts / CURRENT_SENSE_MV_PER_A);
+    validMask |= 1 << channel;
+  }
+
+  channel = (channel + 1) & 3;
+  startConversion(channel);
+}
+
+bool Ads1115CurrentSource::sample(uint16_t milliamps[4]) {
+  if (!found || validMask != 0x0F) return false;
+  for (int i = 0; i < 4; i++) milliamps[i] = current[i];
+  return true;
+}
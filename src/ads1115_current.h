@@ -0,0 +1,42 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "board.h"
+#include "power_guard.h"
+
+// ==================== ДАТЧИКИ ТОКА НА ADS1115 ====================
+// Четыре шунта с усилителями рядом с драйверами TA6586 заведены на
+// внешний 16-битный АЦП ADS1115 (I2C). Свободных пинов ADC1 на плате
+// только три, а ADC2 не работает вместе с WiFi.
+// Опрос без ожидания: за один такт управления читается результат
+// предыдущего канала и запускается преобразование следующего
+// (860 выборок/с, ~1.2 мс < периода такта). Каждый канал обновляется
+// раз в 4 такта.
+
+#define ADS1115_ADDRESS 0x48
+#define CURRENT_SDA_PIN (kBoard.i2cSda)
+#define CURRENT_SCL_PIN (kBoard.i2cScl)
+#define CURRENT_SENSE_MV_PER_A 1000   // Шунт 0.05 Ом x усиление 20
+
+class Ads1115CurrentSource : public CurrentSource {
+public:
+  // false = АЦП не отвечает (датчики не установлены)
+  bool begin();
+
+  // Прочитать готовый канал и запустить следующий (из задачи управления)
+  void poll();
+
+  bool sample(uint16_t milliamps[4]) override;
+
+  bool present() const { return found; }
+
+private:
+  bool startConversion(uint8_t channel);
+  bool readConversion(int16_t &raw);
+
+  bool found = false;
+  uint8_t channel = 0;
+  uint16_t current[4] = {0, 0, 0, 0};
+  uint8_t validMask = 0;
+};
@@ -0,0 +1,72 @@
+#include "battery.h"
+
+#include "fixed.h"
+
+// ==================== СИНТЕТИЧЕСКИЙ ИСТОЧНИК ====================
+
+bool SyntheticVoltageSource::sample(uint32_t &millivolts) {
+  int32_t v = (int32_t)voltage - (int32_t)sag;
+  if (noise > 0) {
+    lcg = lcg * 1103515245u + 12345u;
+    v += (int32_t)((lcg >> 16) % (2 * noise + 1)) - (int32_t)noise;
+  }
+  millivolts = v > 0 ? (uint32_t)v : 0;
+  return true;
+}
+
+// ==================== МОНИТОР БАТАРЕИ ====================
+
+void BatteryMonitor::update() {
+  uint32_t mv;
+  if (source == nullptr || !source->sample(mv)) return;
+
+  // Первый отсчёт инициализирует фильтр, чтобы не стартовать с нуля
+  if (filteredQ8 == 0) {
+    filteredQ8 = mv << 8;
+  } else {
+    int32_t diff = (int32_t)(mv << 8) - (int32_t)filteredQ8;
+    filteredQ8 += diff >> BATTERY_FILTER_SHIFT;
+  }
+
+  uint32_t filtered = filteredQ8 >> 8;
+  filteredMv.store(filtered, std::memory_order_relaxed);
+
+  // Отсечка с гистерезисом
+  if (filtered < BATTERY_CUTOFF_MV) {
+    low.store(true, std::memory_order_relaxed);
+  } else if (filtered > BATTERY_RECOVER_MV) {
+    low.store(false, std::memory_order_relaxed);
+  }
+
+  // Коэффициент компенсации: Vnominal / Vbattery в Q8
+  uint32_t s = filtered > 0 ? (BATTERY_NOMINAL_MV << 8) / filtered : 256;
+  if (s > BATTERY_MAX_SCALE_Q8) s = BATTERY_MAX_SCALE_Q8;
+  scale.store((uint16_t)s, std::memory_order_relaxed);
+}
+
+int BatteryMonitor::compensate(int speed) const {
+  return fxClamp(fxScaleQ8(speed, scale.load(std::memory_order_relaxed)), -255, 255);
+}
+
+// Кривая разряда одной Li-ion ячейки: мВ -> %
+static const uint16_t socTable[][2] = {
+  {3300, 0}, {3500, 5}, {3600, 12}, {3700, 30}, {3750, 45},
+  {3800, 55}, {3900, 70}, {4000, 82}, {4100, 92}, {4200, 100},
+};
+
+uint8_t BatteryMonitor::stateOfCharge() const {
+  uint32_t cellMv = millivolts() / BATTERY_CELLS;
+  const int n = sizeof(socTable) / sizeof(socTable[0]);
+
+  if (cellMv <= socTable[0][0]) return 0;
+  if (cellMv >= socTable[n - 1][0]) return 100;
+
+  for (int i = 1; i < n; i++) {
+    if (cellMv < socTable[i][0]) {
+      uint32_t v0 = socTable[i - 1][0], v1 = socTable[i][0];
+      uint32_t p0 = socTable[i - 1][1], p1 = socTable[i][1];
+      return (uint8_t)(p0 + (cellMv - v0) * (p1 - p0) / (v1 - v0));
+    }
+  }
+  return 100;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+
+// ==================== НАПРЯЖЕНИЕ БАТАРЕИ ====================
+// Напряжение читается каждый такт управления, фильтруется IIR-фильтром
+// в фиксированной точке и используется для:
+//   - компенсации PWM: скважность масштабируется так, чтобы мотор получал
+//     одинаковое эффективное напряжение на полной и просевшей батарее
+//   - отсечки по низкому напряжению (с гистерезисом)
+//   - оценки заряда (SoC) для телеметрии
+// Источник напряжения — интерфейс: на ESP32 это АЦП, на хосте — синтетика.
+
+#define BATTERY_CELLS 2               // Li-ion 2S
+#define BATTERY_NOMINAL_MV 7000       // Напряжение, к которому приводится PWM
+#define BATTERY_CUTOFF_MV 6400        // Ниже — моторы отключаются
+#define BATTERY_RECOVER_MV 6800       // Выше — моторы снова разрешены
+#define BATTERY_FILTER_SHIFT 5        // IIR: alpha = 1/32 (~0.3 с при 100 Гц)
+#define BATTERY_MAX_SCALE_Q8 512      // Компенсация не больше чем x2
+
+// Источник мгновенного напряжения батареи (мВ на батарее, не на пине АЦП)
+class VoltageSource {
+public:
+  virtual ~VoltageSource() {}
+  virtual bool sample(uint32_t &millivolts) = 0;
+};
+
+// Синтетический источник для хоста: заданное напряжение, просадка под
+// нагрузкой и детерминированный шум
+class SyntheticVoltageSource : public VoltageSource {
+public:
+  explicit SyntheticVoltageSource(uint32_t millivolts) : voltage(millivolts) {}
+
+  void setVoltage(uint32_t millivolts) { voltage = millivolts; }
+  void setSag(uint32_t millivolts) { sag = millivolts; }
+  void setNoise(uint32_t amplitudeMv) { noise = amplitudeMv; }
+
+  bool sample(uint32_t &millivolts) override;
+
+private:
+  uint32_t voltage;
+  uint32_t sag = 0;
+  uint32_t noise = 0;
+  uint32_t lcg = 12345;
+};
+
+class BatteryMonitor {
+public:
+  explicit BatteryMonitor(VoltageSource *source) : source(source) {}
+
+  void setSource(VoltageSource *s) { source = s; }
+
+  // Один отсчёт + фильтр + отсечка (вызывается из задачи управления)
+  void update();
+
+  // Скорость колеса -255..255 с учётом текущего напряжения
+  int compensate(int speed) const;
+
+  uint32_t millivolts() const { return filteredMv.load(std::memory_order_relaxed); }
+  uint8_t stateOfCharge() const;
+  bool isLow() const { return low.load(std::memory_order_relaxed); }
+  bool hasReading() const { return filteredQ8 != 0; }
+  uint16_t scaleQ8() const { return scale.load(std::memory_order_relaxed); }
+
+private:
+  VoltageSource *source;
+  uint32_t filteredQ8 = 0;                     // мВ << 8
+  std::atomic<uint32_t> filteredMv{0};
+  std::atomic<uint16_t> scale{256};            // Q8: 256 = 1.0
+  std::atomic<bool> low{false};
+};
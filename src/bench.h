@@ -0,0 +1,58 @@
+#pragma once
+
+#include <stdint.h>
+
+// ==================== МИКРОБЕНЧМАРКИ ====================
+// Замер горячих путей на самом ESP32 в тактах процессора: min/mean/max
+// по n повторам. Из каждого замера вычитается стоимость чтения счётчика
+// (минимум пустого замера). max включает прерывания WiFi и вытеснение
+// другими задачами — это часть картины на реальном железе.
+
+struct BenchStats {
+  const char *name;
+  uint32_t n;
+  uint32_t min;
+  uint32_t max;
+  uint64_t total;
+
+  void reset(const char *benchName) {
+    name = benchName;
+    n = 0;
+    min = UINT32_MAX;
+    max = 0;
+    total = 0;
+  }
+
+  void add(uint32_t cycles) {
+    n++;
+    total += cycles;
+    if (cycles < min) min = cycles;
+    if (cycles > max) max = cycles;
+  }
+
+  uint32_t mean() const { return n > 0 ? (uint32_t)(total / n) : 0; }
+};
+
+// now() — счётчик тактов (ESP.getCycleCount на ESP32)
+template <typename Now>
+uint32_t benchOverhead(Now now) {
+  uint32_t best = UINT32_MAX;
+  for (int i = 0; i < 16; i++) {
+    uint32_t t0 = now();
+    uint32_t t1 = now();
+    if (t1 - t0 < best) best = t1 - t0;
+  }
+  return best;
+}
+
+template <typename Now, typename F>
+void benchRun(BenchStats &s, const char *name, uint32_t n, Now now, F fn) {
+  uint32_t overhead = benchOverhead(now);
+  s.reset(name);
+  for (uint32_t i = 0; i < n; i++) {
+    uint32_t t0 = now();
+    fn(i);
+    uint32_t dt = now() - t0;
+    s.add(dt > overhead ? dt - overhead : 0);
+  }
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <stdint.h>
+
+// ==================== ПЛАТА ====================
+// Распиновка — одна константа kBoard в заголовке варианта платы. Вариант
+// выбирается флагом сборки -DBOARD_HEADER=\"board_xxx.h\" (по умолчанию
+// board_esp32dev.h: ESP32 DevKit и два драйвера TA6586). Всё, что ниже
+// проверяется static_assert, сборка с ошибочной распиновкой не пропустит:
+// пины существуют и могут быть выходами, не заняты дважды, у каждого
+// мотора свой таймер LEDC.
+
+#define BOARD_RANGES_MAX 8        // Датчиков расстояния в кольце
+
+struct BoardMotor {
+  uint8_t pinD0;          // PWM (LEDC)
+  uint8_t pinD1;          // Направление (LOW/HIGH)
+  uint8_t pwmChannel;     // Канал LEDC
+};
+
+// Датчик расстояния (HC-SR04): пины и установка на корпусе
+struct BoardRange {
+  uint8_t trigPin;
+  uint8_t echoPin;        // Эхо 5 В — через делитель
+  int16_t xMm, yMm;       // От центра: x — вперёд, y — влево
+  int16_t directionDeg;   // Куда смотрит: 0 — вперёд, против часовой
+};
+
+struct BoardDefinition {
+  const char *name;
+  BoardMotor motors[4];   // ФИЗИЧЕСКИЕ моторы M1..M4
+  uint8_t batteryAdcPin;  // Делитель батареи (только ADC1: ADC2 занят WiFi)
+  uint16_t batteryDividerNum;   // (R1 + R2)
+  uint16_t batteryDividerDen;   // R2
+  uint8_t i2cSda;         // Шина датчиков тока и гироскопа
+  uint8_t i2cScl;
+  uint8_t gyroIntPin;     // Прерывание MPU6050 (готовность данных)
+  uint8_t rangeCount;     // Кольцо датчиков расстояния (0 = нет)
+  BoardRange ranges[BOARD_RANGES_MAX];
+};
+
+#ifndef BOARD_HEADER
+#define BOARD_HEADER "board_esp32dev.h"
+#endif
+#include BOARD_HEADER
+
+// ==================== ПРОВЕРКИ РАСПИНОВКИ ====================
+
+// GPIO ESP32: 0..39 без 20, 24, 28..31; 6..11 — SPI-флеш
+constexpr bool boardPinExists(uint8_t pin) {
+  return pin <= 39 && pin != 20 && pin != 24 && !(pin >= 28 && pin <= 31) && !(pin >= 6 && pin <= 11);
+}
+
+// 34..39 — только входы
+constexpr bool boardPinOutput(uint8_t pin) {
+  return boardPinExists(pin) && pin < 34;
+}
+
+constexpr bool boardPinAdc1(uint8_t pin) {
+  return pin >= 32 && pin <= 39;
+}
+
+// Все пины платы: моторы (D0, D1), батарея, I2C, прерывание гироскопа,
+// датчики расстояния (trig, echo)
+constexpr int boardPinCount(const BoardDefinition &b) {
+  return 12 + 2 * b.rangeCount;
+}
+
+constexpr uint8_t boardPin(const BoardDefinition &b, int i) {
+  return i < 8 ? (i & 1 ? b.motors[i / 2].pinD1 : b.motors[i / 2].pinD0)
+       : i < 12 ? (i == 8 ? b.batteryAdcPin : (i == 9 ? b.i2cSda : (i == 10 ? b.i2cScl : b.gyroIntPin)))
+       : ((i - 12) & 1 ? b.ranges[(i - 12) / 2].echoPin : b.ranges[(i - 12) / 2].trigPin);
+}
+
+constexpr bool boardPinsUnique(const BoardDefinition &b) {
+  for (int i = 0; i < boardPinCount(b); i++) {
+    for (int j = i + 1; j < boardPinCount(b); j++) {
+      if (boardPin(b, i) == boardPin(b, j)) return false;
+    }
+  }
+  return true;
+}
+
+constexpr bool boardMotorPinsValid(const BoardDefinition &b) {
+  for (int m = 0; m < 4; m++) {
+    if (!boardPinOutput(b.motors[m].pinD0) || !boardPinOutput(b.motors[m].pinD1)) return false;
+  }
+  return true;
+}
+
+constexpr bool boardRangePinsValid(const BoardDefinition &b) {
+  if (b.rangeCount > BOARD_RANGES_MAX) return false;
+  for (int i = 0; i < b.rangeCount; i++) {
+    if (!boardPinOutput(b.ranges[i].trigPin) || !boardPinExists(b.ranges[i].echoPin)) return false;
+  }
+  return true;
+}
+
+// Таймер LEDC общий у пары каналов (0/1, 2/3 ...): у каждого мотора свой
+// профиль PWM, только если моторы на разных парах
+constexpr bool boardPwmTimersSeparate(const BoardDefinition &b) {
+  for (int m = 0; m < 4; m++) {
+    if (b.motors[m].pwmChannel >= 16) return false;
+    for (int n = m + 1; n < 4; n++) {
+      if (b.motors[m].pwmChannel / 2 == b.motors[n].pwmChannel / 2) return false;
+    }
+  }
+  return true;
+}
+
+static_assert(boardMotorPinsValid(kBoard), "Пин мотора не существует или не может быть выходом");
+static_assert(boardRangePinsValid(kBoard), "Датчик расстояния: trig — выход, echo — существующий пин");
+static_assert(boardPinsUnique(kBoard), "Пин платы занят дважды");
+static_assert(boardPwmTimersSeparate(kBoard), "Моторы делят таймер LEDC (каналы одной пары)");
+static_assert(boardPinAdc1(kBoard.batteryAdcPin), "Батарея — только на ADC1 (GPIO 32..39)");
+static_assert(boardPinOutput(kBoard.i2cSda) && boardPinOutput(kBoard.i2cScl), "I2C — на пинах-выходах");
+static_assert(boardPinExists(kBoard.gyroIntPin), "Нет такого пина прерывания гироскопа");
+static_assert(kBoard.batteryDividerDen > 0 && kBoard.batteryDividerNum >= kBoard.batteryDividerDen,
+              "Делитель батареи: (R1 + R2) / R2 >= 1");
@@ -0,0 +1,27 @@
+#pragma once
+
+// ESP32 DevKit, два драйвера TA6586 (по два мотора), ADS1115 и MPU6050
+// на общей шине I2C, кольцо из четырёх HC-SR04 (необязательное: не
+// ответивший датчик считается неустановленным). Подключается из board.h.
+
+inline constexpr BoardDefinition kBoard = {
+  "esp32dev",
+  {
+    // D0 (PWM), D1 (направление), канал LEDC — через один: свой таймер
+    {32, 33, 0},    // M1, драйвер 1
+    {25, 26, 2},    // M2, драйвер 1
+    {19, 18, 4},    // M3, драйвер 2
+    {17, 16, 6},    // M4, драйвер 2
+  },
+  34,               // Батарея: делитель 100k/33k
+  133, 33,
+  21, 22,           // I2C: SDA, SCL
+  27,               // Прерывание MPU6050
+  4,                // Датчики расстояния: trig, echo, установка, направление
+  {
+    { 4, 35,  110,    0,    0},   // Спереди
+    { 5, 36,    0,  110,   90},   // Слева
+    {13, 39, -110,    0,  180},   // Сзади
+    {23, 14,    0, -110,  -90},   // Справа
+  },
+};
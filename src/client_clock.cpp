@@ -0,0 +1,97 @@
+#include "client_clock.h"
+
+#include <string.h>
+
+const uint32_t ClientClocks::bucketLimitsMs[CLOCK_AGE_BUCKETS - 1] = {50, 100, 200, 500};
+
+ClientClock *ClientClocks::find(uint32_t clientId) {
+  for (ClientClock &c : clocks) {
+    if (c.clientId == clientId) return &c;
+  }
+  return nullptr;
+}
+
+const ClientClock *ClientClocks::find(uint32_t clientId) const {
+  for (const ClientClock &c : clocks) {
+    if (c.clientId == clientId) return &c;
+  }
+  return nullptr;
+}
+
+bool ClientClocks::sync(uint32_t clientId, uint32_t offsetMs, uint16_t rttMs) {
+  ClientClock *c = find(clientId);
+  if (c == nullptr) {
+    c = find(0);
+    if (c == nullptr) return false;
+    memset(c, 0, sizeof(*c));
+    c->clientId = clientId;
+  }
+  c->offsetMs = offsetMs % CLOCK_STAMP_MODULO;
+  c->rttMs = rttMs;
+  c->syncs++;
+  return true;
+}
+
+void ClientClocks::remove(uint32_t clientId) {
+  ClientClock *c = find(clientId);
+  if (c != nullptr) c->clientId = 0;
+}
+
+bool ClientClocks::age(uint32_t clientId, uint32_t stampMs, uint32_t nowMs, uint32_t &ageMs) const {
+  const ClientClock *c = find(clientId);
+  if (c == nullptr || clientId == 0) return false;
+
+  // Метка клиента в часах робота и текущее время, по модулю
+  uint32_t sent = (stampMs % CLOCK_STAMP_MODULO + c->offsetMs) % CLOCK_STAMP_MODULO;
+  uint32_t now = nowMs % CLOCK_STAMP_MODULO;
+  uint32_t diff = (now + CLOCK_STAMP_MODULO - sent) % CLOCK_STAMP_MODULO;
+
+  // Вторая половина оборота — метка чуть впереди часов робота
+  ageMs = diff < CLOCK_STAMP_MODULO / 2 ? diff : 0;
+  return true;
+}
+
+void ClientClocks::record(ClientClock &c, uint32_t ageMs, AgeVerdict verdict) {
+  c.frames++;
+  c.ageSumMs += ageMs;
+  if (ageMs > c.ageMaxMs) c.ageMaxMs = ageMs;
+  c.lastAgeMs = ageMs;
+
+  int b = 0;
+  while (b < CLOCK_AGE_BUCKETS - 1 && ageMs >= bucketLimitsMs[b]) b++;
+  c.buckets[b]++;
+
+  if (verdict == AGE_DECAYED) c.decayed++;
+  if (verdict == AGE_STALE) c.stale++;
+}
+
+AgeVerdict ClientClocks::check(uint32_t clientId, uint32_t stampMs, uint32_t nowMs, RobotState &st) {
+  uint32_t ageMs;
+  if (!age(clientId, stampMs, nowMs, ageMs)) return AGE_FRESH;
+
+  uint16_t scale = commandAgeScaleQ8(ageMs, st.config.cmdMaxAgeMs, st.config.cmdAgeDecay);
+  if (st.drive.kind == DRIVE_STOP) {
+    scale = 256;  // Остановка не бывает запоздалой
+  } else if (scale < 256 && st.drive.kind != DRIVE_JOY && st.drive.kind != DRIVE_AXES) {
+    scale = 0;    // Ослабить можно только джойстик и геймпад
+  }
+
+  AgeVerdict verdict = scale == 256 ? AGE_FRESH : (scale == 0 ? AGE_STALE : AGE_DECAYED);
+  record(*find(clientId), ageMs, verdict);
+
+  if (verdict == AGE_STALE) {
+    st.drive.kind = DRIVE_STOP;
+    st.drive.stopProfile = st.config.stopProfile;
+  } else if (verdict == AGE_DECAYED) {
+    st.drive.joyX = (int16_t)(st.drive.joyX * scale / 256);
+    st.drive.joyY = (int16_t)(st.drive.joyY * scale / 256);
+    st.drive.joyW = (int16_t)(st.drive.joyW * scale / 256);
+  }
+  return verdict;
+}
+
+uint16_t commandAgeScaleQ8(uint32_t ageMs, uint16_t maxAgeMs, bool decay) {
+  if (maxAgeMs == 0 || ageMs <= maxAgeMs) return 256;
+  if (!decay || ageMs >= 2u * maxAgeMs) return 0;
+  return (uint16_t)((2u * maxAgeMs - ageMs) * 256 / maxAgeMs);
+}
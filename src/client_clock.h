@@ -0,0 +1,78 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "robot_state.h"
+#include "ws_broadcast.h"
+
+// ==================== ЧАСЫ КЛИЕНТОВ И ВОЗРАСТ КОМАНД ====================
+// Кадр джойстика, пролежавший в очереди TCP, не должен выполняться как
+// свежий. Клиент сверяет часы с роботом, как NTP: "sync:t1" -> ответ с
+// t2 (время робота); по t4 (приход ответа) клиент считает задержку
+// t4 - t1 и смещение t2 - (t1 + t4) / 2, берёт замер с наименьшей
+// задержкой и сообщает смещение командой "clock:смещение:задержка".
+// Дальше каждый кадр управления начинается меткой "at:t;joy:...", и
+// робот знает, сколько кадр шёл. Запоздавшая уставка движения
+// заменяется остановкой или ослабляется к нулю (настройки max_age и
+// age_decay): что оператор хочет сейчас, по такому кадру не понять.
+//
+// Разбор целых в командах ограничен 999999, поэтому все метки берутся
+// по модулю CLOCK_STAMP_MODULO (~16 минут); возраст считается по тому
+// же модулю и до полуоборота в обе стороны.
+
+#define CLOCK_STAMP_MODULO 1000000
+#define CLOCK_AGE_BUCKETS 5           // <50, <100, <200, <500, >=500 мс
+
+enum AgeVerdict : uint8_t {
+  AGE_FRESH,      // Выполнена как есть (или часы клиента не сверены)
+  AGE_DECAYED,    // Уставка джойстика ослаблена
+  AGE_STALE       // Уставка движения заменена остановкой
+};
+
+struct ClientClock {
+  uint32_t clientId;            // 0 = слот свободен
+  uint32_t offsetMs;            // Время робота минус время клиента, по модулю
+  uint16_t rttMs;               // Задержка лучшего замера при синхронизации
+  uint32_t syncs;
+  // Статистика возраста кадров с меткой
+  uint32_t frames;
+  uint32_t ageSumMs;
+  uint32_t ageMaxMs;
+  uint32_t lastAgeMs;
+  uint32_t buckets[CLOCK_AGE_BUCKETS];
+  uint32_t decayed;
+  uint32_t stale;
+};
+
+class ClientClocks {
+public:
+  // false = таблица заполнена
+  bool sync(uint32_t clientId, uint32_t offsetMs, uint16_t rttMs);
+  void remove(uint32_t clientId);
+
+  // Возраст кадра с меткой клиента stampMs к моменту nowMs (часы робота).
+  // false = клиент ещё не сверял часы. Метка из будущего (погрешность
+  // синхронизации) даёт возраст 0.
+  bool age(uint32_t clientId, uint32_t stampMs, uint32_t nowMs, uint32_t &ageMs) const;
+
+  // Проверить кадр с меткой перед публикацией: st — снимок после всех
+  // команд кадра, запоздавшая уставка правится в нём. Возраст попадает
+  // в статистику клиента.
+  AgeVerdict check(uint32_t clientId, uint32_t stampMs, uint32_t nowMs, RobotState &st);
+
+  // Для отчёта: слоты по индексу, свободные пропускать
+  const ClientClock &slot(int i) const { return clocks[i]; }
+  static const uint32_t bucketLimitsMs[CLOCK_AGE_BUCKETS - 1];
+
+private:
+  void record(ClientClock &c, uint32_t ageMs, AgeVerdict verdict);
+  ClientClock *find(uint32_t clientId);
+  const ClientClock *find(uint32_t clientId) const;
+
+  ClientClock clocks[WS_MAX_CLIENTS + 1] = {};    // + проводной клиент
+};
+
+// Множитель уставки по возрасту, Q8: 256 = выполнить как есть, 0 = стоять.
+// Без ослабления всё старше maxAgeMs запоздало; с ослаблением
+// множитель падает линейно от 1 при maxAgeMs до 0 при 2 * maxAgeMs.
+uint16_t commandAgeScaleQ8(uint32_t ageMs, uint16_t maxAgeMs, bool decay);
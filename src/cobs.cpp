@@ -0,0 +1,52 @@
+#include "cobs.h"
+
+size_t cobsEncode(const uint8_t *in, size_t len, uint8_t *out) {
+  size_t codeAt = 0;   // Куда записать длину текущего блока
+  size_t o = 1;
+  uint8_t code = 1;
+
+  for (size_t i = 0; i < len; i++) {
+    if (in[i] == 0) {
+      out[codeAt] = code;
+      codeAt = o++;
+      code = 1;
+      continue;
+    }
+    out[o++] = in[i];
+    if (++code == 0xFF) {
+      out[codeAt] = code;
+      codeAt = o++;
+      code = 1;
+    }
+  }
+  out[codeAt] = code;
+  return o;
+}
+
+bool cobsDecode(const uint8_t *in, size_t len, uint8_t *out, size_t &outLen) {
+  size_t i = 0;
+  outLen = 0;
+
+  while (i < len) {
+    uint8_t code = in[i++];
+    if (code == 0 || i + code - 1 > len) return false;
+
+    for (uint8_t k = 1; k < code; k++) {
+      if (in[i] == 0) return false;
+      out[outLen++] = in[i++];
+    }
+    // Блок короче 254 байт заканчивается нулём, кроме последнего
+    if (code < 0xFF && i < len) out[outLen++] = 0;
+  }
+  return true;
+}
+
+uint16_t crc16Ccitt(const uint8_t *data, size_t len, uint16_t crc) {
+  for (size_t i = 0; i < len; i++) {
+    crc ^= (uint16_t)data[i] << 8;
+    for (int b = 0; b < 8; b++) {
+      crc = crc & 0x8000 ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+    }
+  }
+  return crc;
+}
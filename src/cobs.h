@@ -0,0 +1,22 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ==================== COBS И CRC ====================
+// Consistent Overhead Byte Stuffing: кадр без нулевых байт, поэтому 0x00
+// однозначно разделяет кадры в потоке байт (последовательный порт).
+// Накладные расходы — 1 байт на каждые 254 байта данных.
+
+#define COBS_MAX_ENCODED(n) ((n) + (n) / 254 + 1)
+
+// Закодировать len байт в out (не меньше COBS_MAX_ENCODED(len)), без
+// завершающего нуля. Возвращает длину кода.
+size_t cobsEncode(const uint8_t *in, size_t len, uint8_t *out);
+
+// Раскодировать кадр (без разделителя) в out (не меньше len).
+// false = в коде ошибка (ноль внутри или блок за концом кадра).
+bool cobsDecode(const uint8_t *in, size_t len, uint8_t *out, size_t &outLen);
+
+// CRC-16/CCITT-FALSE (полином 0x1021, начальное 0xFFFF)
+uint16_t crc16Ccitt(const uint8_t *data, size_t len, uint16_t crc = 0xFFFF);
@@ -0,0 +1,44 @@
+#include "command_core.h"
+
+#include <string.h>
+
+MessageResult processCommandMessage(uint32_t clientId, const char *text, size_t len, uint32_t nowMs,
+                                    SeqLock<RobotState> &state, ClientClocks &clocks,
+                                    CommandEffects &fx) {
+  MessageResult r = {false, false, 0, AGE_FRESH};
+
+  // Метка времени "at:t;" впереди не делает из одиночной команды пакет
+  const char *body = text;
+  size_t bodyLen = len;
+  if (len > 3 && memcmp(text, "at:", 3) == 0) {
+    const char *sep = (const char*)memchr(text, ';', len);
+    if (sep != nullptr) {
+      bodyLen = len - (sep + 1 - text);
+      body = sep + 1;
+    }
+  }
+  r.batch = memchr(body, ';', bodyLen) != nullptr;
+
+  state.update([&](RobotState &st) {
+    size_t start = 0;
+    while (start <= len) {
+      const char *sep = (const char*)memchr(text + start, ';', len - start);
+      size_t end = sep ? (size_t)(sep - text) : len;
+
+      if (end > start) {
+        commandLog("Команда: %.*s\n", (int)(end - start), text + start);
+
+        if (r.count >= MAX_BATCH_COMMANDS || !dispatchCommand(text + start, end - start, st, fx)) {
+          r.failed = true;
+          return false;
+        }
+        r.count++;
+      }
+      start = end + 1;
+    }
+    if (r.count > 0 && fx.stamped) r.age = clocks.check(clientId, fx.stampMs, nowMs, st);
+    return r.count > 0;
+  });
+
+  return r;
+}
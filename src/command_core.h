@@ -0,0 +1,30 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "client_clock.h"
+#include "commands.h"
+#include "robot_state.h"
+
+// ==================== ЯДРО КОМАНД ====================
+// Сообщение клиента — одна команда или пакет "cmd1;cmd2;...". Пакет
+// разбирается по копии снимка и публикуется, только если корректны все
+// команды, поэтому задача управления применяет его целиком за один такт.
+// Ядро не знает ни транспорта, ни платформы: ответы и побочные действия
+// (CommandEffects) выполняет вызывающий — прошивка (main.cpp) или
+// заменитель робота на ПК (src/host/standin.cpp).
+
+#define MAX_BATCH_COMMANDS 16     // Команд в одном пакете "cmd1;cmd2;..."
+
+struct MessageResult {
+  bool batch;         // Несколько команд: ответ одним подтверждением
+  bool failed;        // Ничего не опубликовано
+  int count;          // Выполнено команд; при ошибке — номер неверной
+  AgeVerdict age;     // Для кадра с меткой "at:t"
+};
+
+// Вызовы должны быть сериализованы (часы клиентов меняются без блокировки)
+MessageResult processCommandMessage(uint32_t clientId, const char *text, size_t len, uint32_t nowMs,
+                                    SeqLock<RobotState> &state, ClientClocks &clocks,
+                                    CommandEffects &fx);
@@ -0,0 +1,551 @@
+#include "commands.h"
+
+#include <string.h>
+
+#include "fixed.h"
+#include "odometry.h"
+
+// ==================== ОБРАБОТЧИКИ ====================
+
+static bool wordIs(const CommandArgs &args, const char *s) {
+  size_t n = strlen(s);
+  return args.wordLen == n && memcmp(args.word, s, n) == 0;
+}
+
+static bool cmdPreset(const CommandArgs &args, RobotState &st, CommandEffects &fx) {
+  st.drive.kind = DRIVE_PRESET;
+  st.drive.preset = (DrivePreset)args.param;
+  return true;
+}
+
+// "stop" — профиль из настроек, "estop" — торможение до следующей команды
+static bool cmdStop(const CommandArgs &args, RobotState &st, CommandEffects &fx) {
+  st.drive.kind = DRIVE_STOP;
+  st.drive.stopProfile = args.param ? STOP_BRAKE : st.config.stopProfile;
+  fx.estop = args.param != 0;
+  return true;
+}
+
+// Профиль обычной остановки: "stop_profile:0" (coast/brake/brake_coast)
+static bool cmdStopProfile(const CommandArgs &args, RobotState &st, CommandEffects &fx) {
+  if (args.ints[0] < 0 || args.ints[0] >= STOP_PROFILE_COUNT) return false;
+  st.config.stopProfile = (StopProfile)args.ints[0];
+  commandLog("Профиль остановки: %d\n", args.ints[0]);
+  return true;
+}
+
+// Замер времени до остановки: "stop_test:1"
+static bool cmdStopTest(const CommandArgs &args, RobotState &st, CommandEffects &fx) {
+  if (args.ints[0] < 0 || args.ints[0] >= STOP_PROFILE_COUNT) return false;
+  st.drive.kind = DRIVE_STOP_TEST;
+  st.drive.stopProfile = (StopProfile)args.ints[0];
+  return true;
+}
+
+// Автоматическая характеризация моторов: "characterize"
+static bool cmdCharacterize(const CommandArgs &args, RobotState &st, CommandEffects &fx) {
+  st.drive.kind = DRIVE_CHARACTERIZE;
+  return true;
+}
+
+// Линеаризация по таблице: "lin:1" — включить, "lin:0" — выключить
+static bool cmdLinearize(const CommandArgs &args, RobotState &st, CommandEffects &fx) {
+  if (args.ints[0] != 0 && args.ints[0] != 1) return false;
+  st.config.linearize = args.ints[0] == 1;
+  commandLog("Линеаризация: %s\n", st.config.linearize ? "вкл" : "выкл");
+  return true;
+}
+
+static bool cmdLinReset(const CommandArgs &args, RobotState &st, CommandEffects &fx) {
+  st.config.linearize = false;
+  fx.linReset = true;
+  return true;
+}
+
+// PWM профиль всех моторов: "pwm:1"
+static bool cmdPwm(const CommandArgs &args, RobotState &st, CommandEffects &fx) {
+  if (args.ints[0] < 0 || args.ints[0] >= PWM_PROFILE_COUNT) return false;
+  for (int i = 0; i < 4; i++) {
+    st.config.pwmProfile[i] = (uint8_t)args.ints[0];
+  }
+  commandLog("PWM профиль: %s\n", pwmProfile(args.ints[0]).name);
+  return true;
+}
+
+// PWM профиль одного ФИЗИЧЕСКОГО мотора: "pwm_motor:3:2"
+static bool cmdPwmMotor(const CommandArgs &args, RobotState &st, CommandEffects &fx) {
+  int motor = args.ints[0];
+  if (motor < 1 || motor > 4) return false;
+  if (args.ints[1] < 0 || args.ints[1] >= PWM_PROFILE_COUNT) return false;
+  st.config.pwmProfile[motor - 1] = (uint8_t)args.ints[1];
+  commandLog("PWM профиль мотора %d: %s\n", motor, pwmProfile(args.ints[1]).name);
+  return true;
+}
+
+static bool cmdPwmBench(const CommandArgs &args, RobotState &st, CommandEffects &fx) {
+  fx.pwmBench = true;
+  return true;
+}
+
+// Поток позы для этого клиента: "pose:50" (Гц, 0 = выключить)
+static bool cmdPose(const CommandArgs &args, RobotState &st, CommandEffects &fx) {
+  if (args.ints[0] < 0 || args.ints[0] > POSE_MAX_RATE_HZ) return false;
+  fx.poseRateSet = true;
+  fx.poseRate = (uint8_t)args.ints[0];
+  return true;
+}
+
+static bool cmdOdomReset(const CommandArgs &args, RobotState &st, CommandEffects &fx) {
+  fx.odomReset = true;
+  return true;
+}
+
+// ---------- Маршрут ----------
+// "path_clear;wp:500:0:0;wp:500:500:90;path_go" — точки в мм и градусах
+// в системе одометрии; пакет загружает маршрут и запускает его целиком.
+
+static bool cmdPathClear(const CommandArgs &args, RobotState &st, CommandEffects &fx) {
+  st.path.count = 0;
+  if (st.drive.kind == DRIVE_PATH) {
+    st.drive.kind = DRIVE_STOP;
+    st.drive.stopProfile = st.config.stopProfile;
+  }
+  return true;
+}
+
+static bool cmdWaypoint(const CommandArgs &args, RobotState &st, CommandEffects &fx) {
+  if (st.path.count >= PATH_MAX_WAYPOINTS) return false;
+  Waypoint &wp = st.path.points[st.path.count++];
+  wp.xMm = args.ints[0];
+  wp.yMm = args.ints[1];
+  wp.heading = degreesToAngle(args.ints[2]);
+  return true;
+}
+
+// Крейсерская скорость маршрута: "path_speed:300" (мм/с)
+static bool cmdPathSpeed(const CommandArgs &args, RobotState &st, CommandEffects &fx) {
+  if (args.ints[0] < PATH_SPEED_MIN_MMPS || args.ints[0] > PATH_SPEED_MAX_MMPS) return false;
+  st.path.speedMmps = args.ints[0];
+  return true;
+}
+
+static bool cmdPathGo(const CommandArgs &args, RobotState &st, CommandEffects &fx) {
+  if (st.path.count == 0) return false;
+  st.drive.kind = DRIVE_PATH;
+  st.path.seq++;
+  commandLog("Маршрут: %u точек, %u мм/с\n", st.path.count, st.path.speedMmps);
+  return true;
+}
+
+// Удержание курса по гироскопу: "heading:1" — включить, "heading:0" — выключить
+static bool cmdHeading(const CommandArgs &args, RobotState &st, CommandEffects &fx) {
+  if (args.ints[0] != 0 && args.ints[0] != 1) return false;
+  st.config.headingHold = args.ints[0] == 1;
+  commandLog("Удержание курса: %s\n", st.config.headingHold ? "вкл" : "выкл");
+  return true;
+}
+
+// Ограничение скорости к препятствиям: "obstacle:1" — включить, "obstacle:0" — выключить
+static bool cmdObstacle(const CommandArgs &args, RobotState &st, CommandEffects &fx) {
+  if (args.ints[0] != 0 && args.ints[0] != 1) return false;
+  st.config.obstacleGuard = args.ints[0] == 1;
+  commandLog("Ограничение у препятствий: %s\n", st.config.obstacleGuard ? "вкл" : "выкл");
+  return true;
+}
+
+// Самописец: "rec_freeze" — стоп-кадр сейчас, "rec_arm" — очистить и писать заново
+static bool cmdRecFreeze(const CommandArgs &args, RobotState &st, CommandEffects &fx) {
+  fx.recFreeze = true;
+  return true;
+}
+
+static bool cmdRecArm(const CommandArgs &args, RobotState &st, CommandEffects &fx) {
+  fx.recArm = true;
+  return true;
+}
+
+// Микробенчмарки горячих путей (робот должен стоять): "bench"
+static bool cmdBench(const CommandArgs &args, RobotState &st, CommandEffects &fx) {
+  fx.bench = true;
+  return true;
+}
+
+// Профиль кучи: "heap" — состояние и счётчики по меткам,
+// "heap_reset" — обнулить счётчики перед замером
+static bool cmdHeap(const CommandArgs &args, RobotState &st, CommandEffects &fx) {
+  fx.heapStats = true;
+  fx.heapReset = args.param != 0;
+  return true;
+}
+
+// Проверка связи: "ping" -> {"pong":мс}. Проводной клиент шлёт его,
+// когда команд нет, чтобы не считаться отключённым.
+static bool cmdPing(const CommandArgs &args, RobotState &st, CommandEffects &fx) {
+  fx.pong = true;
+  return true;
+}
+
+static bool cmdLinkStats(const CommandArgs &args, RobotState &st, CommandEffects &fx) {
+  fx.linkStats = true;
+  return true;
+}
+
+// Часы клиента (client_clock.h). "at:t" — метка времени кадра,
+// ставится первой в пакете: "at:123456;joy:0:200".
+static bool cmdAt(const CommandArgs &args, RobotState &st, CommandEffects &fx) {
+  if (args.ints[0] < 0 || fx.stamped) return false;
+  fx.stamped = true;
+  fx.stampMs = (uint32_t)args.ints[0];
+  return true;
+}
+
+static bool cmdSync(const CommandArgs &args, RobotState &st, CommandEffects &fx) {
+  if (args.ints[0] < 0) return false;
+  fx.sync = true;
+  fx.syncT1 = (uint32_t)args.ints[0];
+  return true;
+}
+
+static bool cmdClock(const CommandArgs &args, RobotState &st, CommandEffects &fx) {
+  if (args.ints[0] < 0 || args.ints[1] < 0 || args.ints[1] > 65535) return false;
+  fx.clockSet = true;
+  fx.clockOffsetMs = (uint32_t)args.ints[0];
+  fx.clockRttMs = (uint16_t)args.ints[1];
+  return true;
+}
+
+static bool cmdClockStats(const CommandArgs &args, RobotState &st, CommandEffects &fx) {
+  fx.clockStats = true;
+  return true;
+}
+
+// Предельный возраст кадра управления: "max_age:250" (мс, 0 = не проверять)
+static bool cmdMaxAge(const CommandArgs &args, RobotState &st, CommandEffects &fx) {
+  if (args.ints[0] < 0 || args.ints[0] > CMD_AGE_MAX_MS) return false;
+  st.config.cmdMaxAgeMs = (uint16_t)args.ints[0];
+  commandLog("Предельный возраст команды: %d мс\n", args.ints[0]);
+  return true;
+}
+
+// Запоздавшая уставка: "age_decay:1" — ослаблять, "age_decay:0" — отбрасывать
+static bool cmdAgeDecay(const CommandArgs &args, RobotState &st, CommandEffects &fx) {
+  if (args.ints[0] != 0 && args.ints[0] != 1) return false;
+  st.config.cmdAgeDecay = args.ints[0] == 1;
+  commandLog("Запоздавшие команды: %s\n", st.config.cmdAgeDecay ? "ослаблять" : "отбрасывать");
+  return true;
+}
+
+static bool cmdMode(const CommandArgs &args, RobotState &st, CommandEffects &fx) {
+  st.config.omniMode = args.param != 0;
+  commandLog(st.config.omniMode ? "✓ Режим: Omni (strafe)\n" : "✓ Режим: Tank (rotation)\n");
+  return true;
+}
+
+// Тест по ЛОГИЧЕСКОЙ позиции (с учетом маппинга): "test_0_fwd"
+static bool cmdTest(const CommandArgs &args, RobotState &st, CommandEffects &fx) {
+  int pos = args.ints[0];
+  if (pos < 0 || pos >= 4) return false;
+
+  int8_t dir;
+  if (wordIs(args, "fwd")) dir = 1;
+  else if (wordIs(args, "bwd")) dir = -1;
+  else if (wordIs(args, "stop")) dir = 0;
+  else return false;
+
+  if (st.drive.kind != DRIVE_TEST) {
+    st.drive.kind = DRIVE_TEST;
+    memset(st.drive.test, 0, sizeof(st.drive.test));
+  }
+  st.drive.test[pos] = dir;
+  return true;
+}
+
+static bool cmdSpeed(const CommandArgs &args, RobotState &st, CommandEffects &fx) {
+  int newSpeed = args.ints[0];
+  if (newSpeed < 0 || newSpeed > 255) return false;
+  st.config.speed = newSpeed;
+  commandLog("Скорость изменена на: %d\n", newSpeed);
+  return true;
+}
+
+// Управление джойстиком: "joy:x:y" где x,y от -255 до 255
+static bool cmdJoy(const CommandArgs &args, RobotState &st, CommandEffects &fx) {
+  st.drive.kind = DRIVE_JOY;
+  st.drive.joyX = args.ints[0] < -255 ? -255 : (args.ints[0] > 255 ? 255 : args.ints[0]);
+  st.drive.joyY = args.ints[1] < -255 ? -255 : (args.ints[1] > 255 ? 255 : args.ints[1]);
+  return true;
+}
+
+// Три оси разом: "drive:vx:vy:w", каждая -255..255 (vx — вправо,
+// vy — вперёд, w — поворот против часовой). Смешивается в колёса за один
+// проход, без omni/tank: стрейф и поворот одновременно.
+static bool cmdAxes(const CommandArgs &args, RobotState &st, CommandEffects &fx) {
+  st.drive.kind = DRIVE_AXES;
+  st.drive.joyX = (int16_t)fxClamp(args.ints[0], -255, 255);
+  st.drive.joyY = (int16_t)fxClamp(args.ints[1], -255, 255);
+  st.drive.joyW = (int16_t)fxClamp(args.ints[2], -255, 255);
+  return true;
+}
+
+static bool cmdGetConfig(const CommandArgs &args, RobotState &st, CommandEffects &fx) {
+  fx.sendConfig = true;
+  return true;
+}
+
+static bool cmdSaveConfig(const CommandArgs &args, RobotState &st, CommandEffects &fx) {
+  fx.saved = true;
+  return true;
+}
+
+static bool cmdResetConfig(const CommandArgs &args, RobotState &st, CommandEffects &fx) {
+  for (int i = 0; i < 4; i++) {
+    st.config.motorMapping[i] = i + 1;
+    st.config.motorInvert[i] = false;
+  }
+  commandLog("✓ Конфигурация сброшена к дефолту\n");
+  fx.sendConfig = true;
+  return true;
+}
+
+static bool cmdWsStats(const CommandArgs &args, RobotState &st, CommandEffects &fx) {
+  fx.wsStats = true;
+  return true;
+}
+
+// Установка маппинга: "set_map:0:2" = логическая_позиция:физический_мотор
+static bool cmdSetMap(const CommandArgs &args, RobotState &st, CommandEffects &fx) {
+  int logicalPos = args.ints[0];
+  int physicalMotor = args.ints[1];
+  if (logicalPos < 0 || logicalPos >= 4 || physicalMotor < 1 || physicalMotor > 4) return false;
+
+  st.config.motorMapping[logicalPos] = physicalMotor;
+  commandLog("Маппинг установлен: позиция %d -> мотор %d\n", logicalPos, physicalMotor);
+  return true;
+}
+
+// Установка инверсии: "set_inv:0:true"
+static bool cmdSetInv(const CommandArgs &args, RobotState &st, CommandEffects &fx) {
+  int logicalPos = args.ints[0];
+  if (logicalPos < 0 || logicalPos >= 4) return false;
+
+  st.config.motorInvert[logicalPos] = wordIs(args, "true");
+  commandLog("Инверсия установлена: позиция %d = %s\n", logicalPos,
+             st.config.motorInvert[logicalPos] ? "true" : "false");
+  return true;
+}
+
+// ==================== ТАБЛИЦА КОМАНД ====================
+
+static constexpr CommandEntry kCommands[] = {
+  // Команды управления
+  {"forward",      "",   cmdPreset, PRESET_FORWARD},
+  {"backward",     "",   cmdPreset, PRESET_BACKWARD},
+  {"left",         "",   cmdPreset, PRESET_LEFT},
+  {"right",        "",   cmdPreset, PRESET_RIGHT},
+  {"rotate_left",  "",   cmdPreset, PRESET_ROTATE_LEFT},
+  {"rotate_right", "",   cmdPreset, PRESET_ROTATE_RIGHT},
+  {"diag_fl",      "",   cmdPreset, PRESET_DIAG_FL},
+  {"diag_fr",      "",   cmdPreset, PRESET_DIAG_FR},
+  {"diag_bl",      "",   cmdPreset, PRESET_DIAG_BL},
+  {"diag_br",      "",   cmdPreset, PRESET_DIAG_BR},
+  {"stop",         "",   cmdStop,   0},
+  {"estop",        "",   cmdStop,   1},
+  {"mode_omni",    "",   cmdMode,   1},
+  {"mode_tank",    "",   cmdMode,   0},
+  {"joy",          "ii", cmdJoy,    0},
+  {"drive",        "iii", cmdAxes,  0},
+  {"speed",        "i",  cmdSpeed,  0},
+  // Калибровка
+  {"test",         "iw", cmdTest,   0},
+  {"set_map",      "ii", cmdSetMap, 0},
+  {"set_inv",      "iw", cmdSetInv, 0},
+  {"stop_profile", "i",  cmdStopProfile, 0},
+  {"stop_test",    "i",  cmdStopTest,    0},
+  {"characterize", "",   cmdCharacterize, 0},
+  {"lin",          "i",  cmdLinearize,   0},
+  {"lin_reset",    "",   cmdLinReset,    0},
+  {"pwm",          "i",  cmdPwm,         0},
+  {"pwm_motor",    "ii", cmdPwmMotor,    0},
+  {"pwm_bench",    "",   cmdPwmBench,    0},
+  {"pose",         "i",  cmdPose,        0},
+  {"odom_reset",   "",   cmdOdomReset,   0},
+  {"heading",      "i",  cmdHeading,     0},
+  {"obstacle",     "i",  cmdObstacle,    0},
+  {"path_clear",   "",   cmdPathClear,   0},
+  {"wp",           "iii", cmdWaypoint,   0},
+  {"path_speed",   "i",  cmdPathSpeed,   0},
+  {"path_go",      "",   cmdPathGo,      0},
+  // Настройки
+  {"get_config",   "",   cmdGetConfig,   0},
+  {"save_config",  "",   cmdSaveConfig,  0},
+  {"reset_config", "",   cmdResetConfig, 0},
+  {"ws_stats",     "",   cmdWsStats,     0},
+  {"link_stats",   "",   cmdLinkStats,   0},
+  {"ping",         "",   cmdPing,        0},
+  {"at",           "i",  cmdAt,          0},
+  {"sync",         "i",  cmdSync,        0},
+  {"clock",        "ii", cmdClock,       0},
+  {"clock_stats",  "",   cmdClockStats,  0},
+  {"max_age",      "i",  cmdMaxAge,      0},
+  {"age_decay",    "i",  cmdAgeDecay,    0},
+  {"rec_freeze",   "",   cmdRecFreeze,   0},
+  {"rec_arm",      "",   cmdRecArm,      0},
+  {"bench",        "",   cmdBench,       0},
+  {"heap",         "",   cmdHeap,        0},
+  {"heap_reset",   "",   cmdHeap,        1},
+};
+
+static constexpr size_t kCommandCount = sizeof(kCommands) / sizeof(kCommands[0]);
+
+// ==================== СОВЕРШЕННЫЙ ХЭШ ====================
+// FNV-1a с подбираемым seed. Seed ищется при компиляции так, чтобы все
+// глаголы попали в разные ячейки; при добавлении команды он пересчитается
+// сам, а если подобрать не удастся — сборка упадёт на static_assert.
+
+#define COMMAND_HASH_SLOTS 256  // Степень двойки, с запасом > 4 * kCommandCount
+
+static_assert(kCommandCount < 128, "int8_t slot index");
+static_assert(COMMAND_HASH_SLOTS >= 4 * kCommandCount, "increase COMMAND_HASH_SLOTS");
+
+static constexpr uint32_t verbHash(const char *s, size_t n, uint32_t seed) {
+  uint32_t h = 2166136261u ^ seed;
+  for (size_t i = 0; i < n; i++) {
+    h ^= (uint8_t)s[i];
+    h *= 16777619u;
+  }
+  return h ^ (h >> 15);
+}
+
+static constexpr size_t constLen(const char *s) {
+  size_t n = 0;
+  while (s[n]) n++;
+  return n;
+}
+
+static constexpr bool seedWorks(uint32_t seed) {
+  bool used[COMMAND_HASH_SLOTS] = {};
+  for (size_t i = 0; i < kCommandCount; i++) {
+    uint32_t slot = verbHash(kCommands[i].verb, constLen(kCommands[i].verb), seed) & (COMMAND_HASH_SLOTS - 1);
+    if (used[slot]) return false;
+    used[slot] = true;
+  }
+  return true;
+}
+
+static constexpr uint32_t findSeed() {
+  for (uint32_t seed = 0; seed < 4096; seed++) {
+    if (seedWorks(seed)) return seed;
+  }
+  return UINT32_MAX;
+}
+
+static constexpr uint32_t kHashSeed = findSeed();
+static_assert(kHashSeed != UINT32_MAX, "no perfect hash seed for command verbs");
+
+struct SlotTable {
+  int8_t index[COMMAND_HASH_SLOTS];
+  uint8_t verbLen[kCommandCount];
+};
+
+static constexpr SlotTable buildSlots() {
+  SlotTable t = {};
+  for (size_t i = 0; i < COMMAND_HASH_SLOTS; i++) t.index[i] = -1;
+  for (size_t i = 0; i < kCommandCount; i++) {
+    size_t n = constLen(kCommands[i].verb);
+    t.index[verbHash(kCommands[i].verb, n, kHashSeed) & (COMMAND_HASH_SLOTS - 1)] = (int8_t)i;
+    t.verbLen[i] = (uint8_t)n;
+  }
+  return t;
+}
+
+static constexpr SlotTable kSlots = buildSlots();
+
+static const CommandEntry *findCommand(const char *verb, size_t len) {
+  int8_t i = kSlots.index[verbHash(verb, len, kHashSeed) & (COMMAND_HASH_SLOTS - 1)];
+  if (i < 0) return nullptr;
+  if (kSlots.verbLen[i] != len || memcmp(kCommands[i].verb, verb, len) != 0) return nullptr;
+  return &kCommands[i];
+}
+
+// ==================== РАЗБОР АРГУМЕНТОВ ====================
+
+static inline bool isSeparator(char c) {
+  return c == ':' || c == '_';
+}
+
+// Целое со знаком; значения за пределами ±999999 насыщаются
+static bool parseInt(const char *&p, const char *end, int &out) {
+  bool neg = false;
+  if (p < end && (*p == '-' || *p == '+')) {
+    neg = *p == '-';
+    p++;
+  }
+
+  const char *digits = p;
+  int value = 0;
+  while (p < end && *p >= '0' && *p <= '9') {
+    if (value < 1000000) value = value * 10 + (*p - '0');
+    p++;
+  }
+  if (p == digits) return false;
+
+  if (value > 999999) value = 999999;
+  out = neg ? -value : value;
+  return true;
+}
+
+static bool parseArgs(const char *p, const char *end, const char *schema, CommandArgs &args) {
+  for (size_t k = 0; schema[k]; k++) {
+    if (k > 0) {
+      if (p >= end || !isSeparator(*p)) return false;
+      p++;
+    }
+
+    if (schema[k] == 'i') {
+      if (args.intCount >= MAX_COMMAND_ARGS) return false;
+      if (!parseInt(p, end, args.ints[args.intCount++])) return false;
+    } else {
+      args.word = p;
+      while (p < end && !isSeparator(*p)) p++;
+      args.wordLen = p - args.word;
+    }
+  }
+  return p == end;
+}
+
+// ==================== ДИСПЕТЧЕР ====================
+
+bool dispatchCommand(const char *cmd, size_t len, RobotState &st, CommandEffects &fx) {
+  const char *end = cmd + len;
+
+  // Глагол: [a-z_]+ до ':' или до числа ("test_0_fwd" -> "test")
+  size_t v = 0;
+  while (v < len && ((cmd[v] >= 'a' && cmd[v] <= 'z') || cmd[v] == '_')) v++;
+
+  size_t verbLen = v;
+  const char *argsStart = cmd + v;
+  if (v > 0 && v < len && cmd[v] >= '0' && cmd[v] <= '9' && cmd[v - 1] == '_') {
+    verbLen = v - 1;
+  } else if (v < len) {
+    if (cmd[v] != ':') return false;
+    argsStart++;
+  }
+
+  const CommandEntry *entry = findCommand(cmd, verbLen);
+  if (entry == nullptr) return false;
+
+  CommandArgs args;
+  args.intCount = 0;
+  args.word = nullptr;
+  args.wordLen = 0;
+  args.param = entry->param;
+
+  // Команда без аргументов не должна иметь хвоста
+  if (entry->schema[0] == 0) {
+    if (argsStart != end || v != len) return false;
+  } else if (!parseArgs(argsStart, end, entry->schema, args)) {
+    return false;
+  }
+
+  return entry->handler(args, st, fx);
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "robot_state.h"
+
+// ==================== ТЕКСТОВЫЙ ПРОТОКОЛ КОМАНД ====================
+// Команда = глагол + аргументы: "forward", "speed:180", "joy:-40:255",
+// "set_map:0:2", "test_0_fwd". Глагол ищется в таблице через совершенный
+// хэш, построенный при компиляции, поэтому стоимость разбора не зависит
+// от числа команд. Аргументы разбираются по схеме записи таблицы без
+// выделения памяти.
+
+#define MAX_COMMAND_ARGS 3
+#define POSE_MAX_RATE_HZ 100    // Предел частоты потока позы ("pose:N")
+
+// Действия после публикации снимка (ответы, запись в EEPROM)
+struct CommandEffects {
+  bool sendConfig;
+  bool saved;
+  bool wsStats;
+  bool linReset;        // Сбросить таблицу линеаризации
+  bool pwmBench;        // Сравнение PWM профилей на малых скоростях
+  bool odomReset;       // Обнулить позу
+  bool poseRateSet;     // Подписка клиента на позу изменена
+  uint8_t poseRate;     // Гц, 0 = отписаться
+  bool estop;           // Аварийный стоп: заморозить самописец
+  bool recFreeze;       // Заморозить самописец вручную
+  bool recArm;          // Очистить самописец и писать заново
+  bool bench;           // Микробенчмарки на железе
+  bool pong;            // Ответ на "ping" (поддержание проводной связи)
+  bool linkStats;       // Счётчики проводной связи
+  bool stamped;         // Кадр начинается меткой времени клиента "at:t"
+  uint32_t stampMs;
+  bool sync;            // Замер часов "sync:t1": ответить временем робота
+  uint32_t syncT1;
+  bool clockSet;        // Итог синхронизации "clock:смещение:задержка"
+  uint32_t clockOffsetMs;
+  uint16_t clockRttMs;
+  bool clockStats;      // Статистика возраста кадров по клиентам
+  bool heapStats;       // Состояние кучи и выделения по меткам
+  bool heapReset;       // Обнулить счётчики выделений
+};
+
+// Разобранные аргументы. Схема записи: 'i' = целое, 'w' = слово.
+struct CommandArgs {
+  int ints[MAX_COMMAND_ARGS];
+  uint8_t intCount;
+  const char *word;     // Последний аргумент-слово (не завершён нулём)
+  size_t wordLen;
+  uint8_t param;        // Константа из записи таблицы (например, пресет)
+};
+
+typedef bool (*CommandHandler)(const CommandArgs &args, RobotState &st, CommandEffects &fx);
+
+struct CommandEntry {
+  const char *verb;
+  const char *schema;
+  CommandHandler handler;
+  uint8_t param;
+};
+
+// Разобрать одну команду (без завершающего нуля) и применить к копии снимка.
+// false = неизвестный глагол, аргументы не по схеме или вне диапазона.
+bool dispatchCommand(const char *cmd, size_t len, RobotState &st, CommandEffects &fx);
+
+// Журнал команд; реализуется платформой (Serial на ESP32)
+void commandLog(const char *fmt, ...);
@@ -0,0 +1,80 @@
+#include "drive_mix.h"
+
+// Знаки колёс M1..M4 для кнопочных команд (умножаются на текущую скорость)
+const int8_t presetPattern[PRESET_COUNT][4] = {
+  { 1,  1,  1,  1},  // forward
+  {-1, -1, -1, -1},  // backward
+  {-1,  1,  1, -1},  // left
+  { 1, -1, -1,  1},  // right
+  {-1,  1, -1,  1},  // rotate_left
+  { 1, -1,  1, -1},  // rotate_right
+  { 0,  1,  1,  0},  // diag_fl
+  { 1,  0,  0,  1},  // diag_fr
+  {-1,  0,  0, -1},  // diag_bl
+  { 0, -1, -1,  0},  // diag_br
+};
+
+// Джойстик — частный случай трёх осей, чтобы кнопки, джойстик, геймпад,
+// одометрия и модель шасси понимали знаки колёс одинаково:
+//   OMNI: X — стрейф вправо (как "right"),  M1=Y+X, M2=Y-X, M3=Y-X, M4=Y+X
+//   TANK: X — разворот вправо (как "rotate_right"), M1=Y+X, M2=Y-X, M3=Y+X, M4=Y-X
+void computeJoystick(bool omniMode, int joyX, int joyY, int wheels[4]) {
+  if (omniMode) {
+    computeAxes(joyX, joyY, 0, wheels);
+  } else {
+    computeAxes(0, joyY, -joyX, wheels);  // w — против часовой
+  }
+}
+
+// Три оси за один проход (vx — вправо, vy — вперёд, w — против часовой):
+//   M1 = vy + vx - w    M2 = vy - vx + w
+//   M3 = vy - vx - w    M4 = vy + vx + w
+// Если колесо выходит за 255, все четыре уменьшаются одним множителем —
+// направление движения и доля поворота сохраняются.
+void computeAxes(int vx, int vy, int w, int wheels[4]) {
+  int32_t s[4] = {vy + vx - w, vy - vx + w, vy - vx - w, vy + vx + w};
+  fxLimitPeak4(s, SPEED_MAX);
+  for (int i = 0; i < 4; i++) wheels[i] = s[i];
+}
+
+bool translationOnly(const RobotState &st) {
+  switch (st.drive.kind) {
+    case DRIVE_PRESET:
+      return st.drive.preset != PRESET_ROTATE_LEFT && st.drive.preset != PRESET_ROTATE_RIGHT;
+    case DRIVE_JOY:
+      // В omni-режиме X джойстика — стрейф, в tank — поворот
+      return st.config.omniMode || st.drive.joyX == 0;
+    case DRIVE_AXES:
+      return st.drive.joyW == 0;
+    default:
+      return false;
+  }
+}
+
+// Скорости логических колёс M1..M4 для текущего намерения движения
+void computeWheels(const RobotState &st, int wheels[4]) {
+  const DriveIntent &drive = st.drive;
+
+  switch (drive.kind) {
+    case DRIVE_PRESET:
+      for (int i = 0; i < 4; i++) {
+        wheels[i] = presetPattern[drive.preset][i] * st.config.speed;
+      }
+      break;
+    case DRIVE_JOY:
+      computeJoystick(st.config.omniMode, drive.joyX, drive.joyY, wheels);
+      break;
+    case DRIVE_AXES:
+      computeAxes(drive.joyX, drive.joyY, drive.joyW, wheels);
+      break;
+    case DRIVE_TEST:
+      for (int i = 0; i < 4; i++) {
+        wheels[i] = drive.test[i] * st.config.speed;
+      }
+      break;
+    case DRIVE_STOP:
+    default:
+      for (int i = 0; i < 4; i++) wheels[i] = 0;
+      break;
+  }
+}
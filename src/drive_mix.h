@@ -0,0 +1,30 @@
+#pragma once
+
+#include "robot_state.h"
+
+// ==================== ФУНКЦИИ ДВИЖЕНИЯ OMNI-РОБОТА ====================
+// Намерение движения -> скорости ЛОГИЧЕСКИХ колёс M1..M4 (-255..255).
+// Без платформы: тот же расчёт в прошивке (main.cpp) и в заменителе
+// робота на ПК (src/host/standin.cpp).
+// Предполагается X-конфигурация колес (смотря сверху):
+//     M1 ↗  ↖ M2
+//         ╲╱
+//         ╱╲
+//     M3 ↙  ↘ M4
+
+// Знаки колёс M1..M4 для кнопочных команд (умножаются на текущую скорость)
+extern const int8_t presetPattern[PRESET_COUNT][4];
+
+// Джойстик "joy:x:y" (X — вправо, Y — вперёд): в omni X — стрейф, в
+// танке X — разворот; смешивается через computeAxes
+void computeJoystick(bool omniMode, int joyX, int joyY, int wheels[4]);
+
+// Три оси "drive:vx:vy:w" с общим ограничением пика
+void computeAxes(int vx, int vy, int w, int wheels[4]);
+
+// Намерение без команды поворота: курс можно держать (heading_hold.h)
+bool translationOnly(const RobotState &st);
+
+// Скорости колёс для текущего намерения движения (PRESET, JOY, AXES,
+// TEST; остальные виды считает задача управления — здесь нули)
+void computeWheels(const RobotState &st, int wheels[4]);
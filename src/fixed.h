@@ -0,0 +1,231 @@
+#pragma once
+
+#include <stdint.h>
+
+// ==================== ФИКСИРОВАННАЯ ТОЧКА ====================
+// Общая целочисленная математика для пути моторов, регуляторов и
+// кинематики. Без float: на ESP32 задача, тронувшая FPU, сохраняет его
+// контекст при каждом переключении, а в прерываниях FPU нельзя вовсе.
+// Всё здесь — inline, таблицы константные (во флеше), результат не
+// зависит от платформы: ПК и ESP32 считают бит в бит одинаково.
+//
+// Форматы — обычные целые, формат указан в имени переменной:
+//   Q8    — 256 = 1.0 (коэффициенты масштаба: батарея, бюджет тока, буксование)
+//   Q15   — 32767 ≈ 1.0 (sin/cos, доли скважности в самописце)
+//   Q16   — 65536 = 1.0 (Q16.16: скважность, константы кинематики)
+//   угол  — двоичный: uint32_t, 2^32 = оборот, переполнение = переход через 0
+//
+// Умножения округляют к ближайшему; fxScaleQ8 округляет к нулю, как
+// прежнее v * s / 256 — знак и ноль команды колеса не меняются.
+
+#define FX_Q8_ONE 256
+#define FX_Q15_ONE 32767
+#define FX_Q16_ONE 65536
+#define FX_ANGLE_QUARTER 0x40000000u
+#define FX_ANGLE_HALF 0x80000000u
+#define FX_ANGLE_PER_RAD 683565276LL      // 2^32 / 2π
+#define FX_URAD_PER_TURN 6283185LL        // 2π * 10^6
+
+// ==================== НАСЫЩЕНИЕ ====================
+
+inline int32_t fxClamp(int32_t v, int32_t lo, int32_t hi) {
+  return v < lo ? lo : (v > hi ? hi : v);
+}
+
+inline int32_t fxSat32(int64_t v) {
+  return v > INT32_MAX ? INT32_MAX : (v < INT32_MIN ? INT32_MIN : (int32_t)v);
+}
+
+inline int16_t fxSat16(int32_t v) {
+  return (int16_t)fxClamp(v, INT16_MIN, INT16_MAX);
+}
+
+inline int32_t fxAddSat(int32_t a, int32_t b) { return fxSat32((int64_t)a + b); }
+inline int32_t fxSubSat(int32_t a, int32_t b) { return fxSat32((int64_t)a - b); }
+
+inline int32_t fxAbs(int32_t v) {
+  return v < 0 ? (v == INT32_MIN ? INT32_MAX : -v) : v;
+}
+
+// ==================== УМНОЖЕНИЕ ====================
+
+inline int32_t fxMulQ15(int32_t a, int32_t b) {
+  return fxSat32(((int64_t)a * b + (1 << 14)) >> 15);
+}
+
+inline int32_t fxMulQ16(int32_t a, int32_t b) {
+  return fxSat32(((int64_t)a * b + (1 << 15)) >> 16);
+}
+
+inline int32_t fxDivQ16(int32_t a, int32_t b) {
+  if (b == 0) return a >= 0 ? INT32_MAX : INT32_MIN;
+  return fxSat32(((int64_t)a << 16) / b);
+}
+
+// v * scaleQ8 / 256 с округлением к нулю
+inline int32_t fxScaleQ8(int32_t v, int32_t scaleQ8) {
+  return fxSat32((int64_t)v * scaleQ8 / FX_Q8_ONE);
+}
+
+// ==================== КОРЕНЬ ====================
+
+// Целый квадратный корень (вниз), поразрядно, без деления
+inline uint32_t fxIsqrt64(uint64_t v) {
+  uint64_t root = 0;
+  uint64_t bit = (uint64_t)1 << 62;
+  while (bit > v) bit >>= 2;
+  while (bit != 0) {
+    if (v >= root + bit) {
+      v -= root + bit;
+      root = (root >> 1) + bit;
+    } else {
+      root >>= 1;
+    }
+    bit >>= 2;
+  }
+  return (uint32_t)root;
+}
+
+inline int32_t fxHypot(int32_t dx, int32_t dy) {
+  return (int32_t)fxIsqrt64((uint64_t)((int64_t)dx * dx + (int64_t)dy * dy));
+}
+
+// ==================== УГЛЫ ====================
+
+// Четверть синуса, Q15, 64 шага на 90°
+inline constexpr int16_t kFxSinQuarter[65] = {
+      0,   804,  1608,  2410,  3212,  4011,  4808,  5602,  6393,
+   7179,  7962,  8739,  9512, 10278, 11039, 11793, 12539, 13279,
+  14010, 14732, 15446, 16151, 16846, 17530, 18204, 18868, 19519,
+  20159, 20787, 21403, 22005, 22594, 23170, 23731, 24279, 24811,
+  25329, 25832, 26319, 26790, 27245, 27683, 28105, 28510, 28898,
+  29268, 29621, 29956, 30273, 30571, 30852, 31113, 31356, 31580,
+  31785, 31971, 32137, 32285, 32412, 32521, 32609, 32678, 32728,
+  32757, 32767,
+};
+
+// atan(i/64) в двоичном угле, i = 0..64 (0..45°)
+inline constexpr uint32_t kFxAtanOctant[65] = {
+          0,  10679838,  21354465,  32018685,  42667331,
+   53295284,  63897482,  74468939,  85004756,  95500135,
+  105950391, 116350962, 126697423, 136985493, 147211045,
+  157370116, 167458907, 177473799, 187411349, 197268300,
+  207041579, 216728303, 226325781, 235831508, 245243172,
+  254558647, 263775993, 272893455, 281909457, 290822599,
+  299631651, 308335554, 316933406, 325424463, 333808132,
+  342083962, 350251643, 358310992, 366261957, 374104599,
+  381839095, 389465727, 396984877, 404397019, 411702716,
+  418902610, 425997422, 432987938, 439875013, 446659557,
+  453342536, 459924966, 466407904, 472792449, 479079736,
+  485270931, 491367227, 497369841, 503280012, 509098996,
+  514828063, 520468494, 526021581, 531488619, 536870912,
+};
+
+// sin двоичного угла, Q15; линейная интерполяция, ошибка < 1.5e-4
+inline int32_t fxSinQ15(uint32_t angle) {
+  // Квадрант — старшие 2 бита, позиция в квадранте — 6 бит + 16 бит дроби
+  uint32_t quadrant = angle >> 30;
+  uint32_t pos = (angle >> 8) & 0x3FFFFF;   // 22 бита на 90°
+  if (quadrant & 1) pos = 0x400000 - pos;
+
+  uint32_t idx = pos >> 16;
+  uint32_t frac = pos & 0xFFFF;
+  int32_t a = kFxSinQuarter[idx];
+  int32_t b = kFxSinQuarter[idx < 64 ? idx + 1 : 64];
+  int32_t v = a + (int32_t)(((int64_t)(b - a) * frac) >> 16);
+
+  return quadrant & 2 ? -v : v;
+}
+
+inline int32_t fxCosQ15(uint32_t angle) { return fxSinQ15(angle + FX_ANGLE_QUARTER); }
+
+// Направление вектора (x, y) двоичным углом против часовой от +x;
+// (0, 0) -> 0. Ошибка < 5e-5 рад (~0.003°).
+inline uint32_t fxAtan2(int32_t y, int32_t x) {
+  if (x == 0 && y == 0) return 0;
+  uint64_t ax = x < 0 ? (uint64_t)(-(int64_t)x) : (uint64_t)x;
+  uint64_t ay = y < 0 ? (uint64_t)(-(int64_t)y) : (uint64_t)y;
+
+  // Октант: отношение меньшего катета к большему, Q16 (0..65536)
+  bool steep = ay > ax;
+  uint32_t t = (uint32_t)(((steep ? ax : ay) << 16) / (steep ? ay : ax));
+  uint32_t idx = t >> 10;
+  uint32_t frac = t & 0x3FF;
+  uint32_t a = kFxAtanOctant[idx];
+  uint32_t b = kFxAtanOctant[idx < 64 ? idx + 1 : 64];
+  uint32_t angle = a + (uint32_t)(((uint64_t)(b - a) * frac) >> 10);
+
+  if (steep) angle = FX_ANGLE_QUARTER - angle;
+  if (x < 0) angle = FX_ANGLE_HALF - angle;
+  return y < 0 ? 0u - angle : angle;
+}
+
+// Двоичный угол -> миллирадианы в диапазоне -π..π
+inline int32_t angleToMrad(uint32_t angle) {
+  int64_t urad = ((int64_t)(int32_t)angle * FX_URAD_PER_TURN) >> 32;
+  return (int32_t)(urad / 1000);
+}
+
+// Двоичный угол -> миллиградусы в диапазоне -180000..180000
+inline int32_t angleToMdeg(uint32_t angle) {
+  return (int32_t)(((int64_t)(int32_t)angle * 360000) >> 32);
+}
+
+// Микрорадианы (со знаком, до ±3 млн) -> двоичный угол
+inline uint32_t uradToAngle(int64_t urad) {
+  return (uint32_t)(int32_t)(urad * FX_ANGLE_PER_RAD / 1000000);
+}
+
+// Целые градусы (любые, в том числе отрицательные) -> двоичный угол
+inline uint32_t degreesToAngle(int32_t degrees) {
+  int64_t d = degrees % 360;
+  if (d < 0) d += 360;
+  return (uint32_t)((d << 32) / 360);
+}
+
+// ==================== ВЕКТОРЫ ====================
+
+struct FxVec2 {
+  int32_t x;
+  int32_t y;
+};
+
+// Поворот на угол против часовой (sin/cos Q15, с округлением)
+inline FxVec2 fxRotate(FxVec2 v, uint32_t angle) {
+  int64_t c = fxCosQ15(angle);
+  int64_t s = fxSinQ15(angle);
+  return {fxSat32((v.x * c - v.y * s + (1 << 14)) >> 15),
+          fxSat32((v.x * s + v.y * c + (1 << 14)) >> 15)};
+}
+
+inline int64_t fxDot(FxVec2 a, FxVec2 b) {
+  return (int64_t)a.x * b.x + (int64_t)a.y * b.y;
+}
+
+// Векторное произведение (z): > 0, если b левее a
+inline int64_t fxCross(FxVec2 a, FxVec2 b) {
+  return (int64_t)a.x * b.y - (int64_t)a.y * b.x;
+}
+
+inline int32_t fxLength(FxVec2 v) { return fxHypot(v.x, v.y); }
+
+// То же направление, длина length; нулевой вектор остаётся нулевым
+inline FxVec2 fxScaleTo(FxVec2 v, int32_t length) {
+  int32_t len = fxLength(v);
+  if (len == 0) return {0, 0};
+  return {(int32_t)((int64_t)v.x * length / len), (int32_t)((int64_t)v.y * length / len)};
+}
+
+// Ограничить четыре значения по модулю limit одним общим множителем
+// (направление набора сохраняется); false — ограничивать не пришлось
+template <typename T>
+inline bool fxLimitPeak4(T v[4], int32_t limit) {
+  int32_t peak = 0;
+  for (int i = 0; i < 4; i++) {
+    int32_t m = fxAbs((int32_t)v[i]);
+    if (m > peak) peak = m;
+  }
+  if (peak <= limit) return false;
+  for (int i = 0; i < 4; i++) v[i] = (T)((int64_t)v[i] * limit / peak);
+  return true;
+}
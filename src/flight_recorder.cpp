@@ -0,0 +1,143 @@
+#include "flight_recorder.h"
+
+#include <string.h>
+
+static const char *const reasonNames[FREEZE_REASON_COUNT] = {
+  "none", "manual", "estop", "watchdog", "low_battery", "reboot",
+};
+
+const char *freezeReasonName(uint8_t reason) {
+  return reason < FREEZE_REASON_COUNT ? reasonNames[reason] : "unknown";
+}
+
+void FlightRecorder::begin(FlightLog *storage, uint8_t resetReason, bool crashed) {
+  log = storage;
+  bootReset = resetReason;
+
+  bool valid = log->magic == FREC_MAGIC && log->magicEnd == ~FREC_MAGIC && log->state <= REC_FROZEN &&
+               log->reason < FREEZE_REASON_COUNT && log->postLeft <= FREC_POST_TRIGGER_TICKS;
+
+  if (valid && log->state == REC_FROZEN) {
+    // Не выгруженный дамп прошлой работы сохраняется
+    frozenFlag.store(true, std::memory_order_release);
+  } else if (valid && crashed && log->head > 0) {
+    // Запись оборвалась сбросом: заморозить с причиной перезагрузки
+    if (log->state == REC_RECORDING) {
+      log->reason = FREEZE_REBOOT;
+      log->postTicks = 0;
+      log->freezeMs = log->records[(log->head - 1) % FREC_RECORDS].timeMs;
+    }
+    log->resetReason = resetReason;
+    freeze();
+  } else {
+    clear();
+  }
+}
+
+void FlightRecorder::clear() {
+  memset(log, 0, sizeof(FlightLog));
+  log->magic = FREC_MAGIC;
+  log->magicEnd = ~FREC_MAGIC;
+  log->state = REC_RECORDING;
+  log->resetReason = bootReset;
+  pendingReason.store(FREEZE_NONE, std::memory_order_relaxed);
+  frozenFlag.store(false, std::memory_order_release);
+}
+
+void FlightRecorder::freeze() {
+  log->state = REC_FROZEN;
+  log->postLeft = 0;
+  frozenFlag.store(true, std::memory_order_release);
+}
+
+void FlightRecorder::trigger(FreezeReason reason, uint32_t now) {
+  uint8_t expected = FREEZE_NONE;
+  if (pendingReason.compare_exchange_strong(expected, reason, std::memory_order_relaxed)) {
+    pendingMs.store(now, std::memory_order_relaxed);
+  }
+}
+
+void FlightRecorder::record(const FlightRecord &r) {
+  if (log == nullptr) return;
+
+  if (rearmPending.exchange(false, std::memory_order_relaxed)) clear();
+  if (log->state == REC_FROZEN) return;
+
+  FlightRecord &slot = log->records[log->head % FREC_RECORDS];
+  slot = r;
+  log->head++;
+
+  if (log->state == REC_TRIGGERED) {
+    log->postTicks++;
+    if (--log->postLeft == 0) freeze();
+    return;
+  }
+
+  uint8_t reason = pendingReason.load(std::memory_order_relaxed);
+  if (reason != FREEZE_NONE) {
+    slot.flags |= FREC_FLAG_TRIGGER;
+    log->reason = reason;
+    log->freezeMs = pendingMs.load(std::memory_order_relaxed);
+    log->postTicks = 0;
+    if (reason == FREEZE_MANUAL) {
+      freeze();  // Ручной стоп-кадр — сразу
+    } else {
+      log->state = REC_TRIGGERED;
+      log->postLeft = FREC_POST_TRIGGER_TICKS;
+    }
+  }
+}
+
+uint8_t FlightRecorder::reason() const {
+  return log != nullptr && frozen() ? log->reason : (uint8_t)FREEZE_NONE;
+}
+
+uint16_t FlightRecorder::count() const {
+  return (uint16_t)(log->head < FREC_RECORDS ? log->head : FREC_RECORDS);
+}
+
+void FlightRecorder::header(FlightDumpHeader &h) const {
+  h.magic = FREC_MAGIC;
+  h.version = FREC_VERSION;
+  h.recordSize = sizeof(FlightRecord);
+  h.reason = log->reason;
+  h.resetReason = log->resetReason;
+  h.count = count();
+  h.postTicks = log->postTicks;
+  h.freezeMs = log->freezeMs;
+}
+
+size_t FlightRecorder::dumpSize() const {
+  if (log == nullptr || !frozen()) return 0;
+  return sizeof(FlightDumpHeader) + (size_t)count() * sizeof(FlightRecord);
+}
+
+size_t FlightRecorder::readDump(uint8_t *buf, size_t maxLen, size_t index) const {
+  size_t total = dumpSize();
+  if (index >= total) return 0;
+  size_t written = 0;
+
+  // Заголовок
+  if (index < sizeof(FlightDumpHeader) && maxLen > 0) {
+    FlightDumpHeader h;
+    header(h);
+    size_t n = sizeof(h) - index;
+    if (n > maxLen) n = maxLen;
+    memcpy(buf, (const uint8_t *)&h + index, n);
+    written = n;
+  }
+
+  // Записи от самой старой: кольцо разворачивается на лету
+  uint32_t first = log->head - count();
+  while (written < maxLen && index + written < total) {
+    size_t offset = index + written - sizeof(FlightDumpHeader);
+    size_t rec = offset / sizeof(FlightRecord);
+    size_t within = offset % sizeof(FlightRecord);
+    const uint8_t *src = (const uint8_t *)&log->records[(first + rec) % FREC_RECORDS] + within;
+    size_t n = sizeof(FlightRecord) - within;
+    if (n > maxLen - written) n = maxLen - written;
+    memcpy(buf + written, src, n);
+    written += n;
+  }
+  return written;
+}
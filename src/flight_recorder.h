@@ -0,0 +1,137 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+// ==================== БОРТОВОЙ САМОПИСЕЦ ====================
+// Кольцевой буфер в RAM: задача управления пишет одну запись на такт
+// (намерение, команды колёс, выход на моторы, датчики, время такта).
+// По триггеру (аварийный стоп, зависание цикла управления, низкое
+// напряжение, ручной) пишется ещё FREC_POST_TRIGGER_TICKS тактов, затем
+// буфер замораживается до выгрузки и повторного взвода.
+// Буфер лежит в неинициализируемой памяти: после сброса по watchdog,
+// panic или brownout он проверяется по сигнатуре и остаётся замороженным
+// с причиной "reboot" — последние секунды перед сбросом не теряются.
+//
+// Файл дампа: FlightDumpHeader + count записей FlightRecord от старой к
+// новой, little-endian (как в памяти ESP32). Декодер в CSV: src/host/frec_decode.cpp.
+
+#define FREC_RECORDS 512              // 5.12 с при 100 Гц, 26 КБ
+#define FREC_POST_TRIGGER_TICKS 50    // Записей после триггера
+#define FREC_MAGIC 0x43455246u        // "FREC"
+#define FREC_VERSION 2                // 2: joyW (поворот DRIVE_AXES)
+
+enum FreezeReason : uint8_t {
+  FREEZE_NONE,
+  FREEZE_MANUAL,         // Команда rec_freeze или запрос дампа
+  FREEZE_ESTOP,          // Аварийный стоп
+  FREEZE_WATCHDOG,       // Такт управления не выполнялся дольше допустимого
+  FREEZE_LOW_BATTERY,    // Отсечка по низкому напряжению
+  FREEZE_REBOOT,         // Аварийная перезагрузка (причина в resetReason)
+  FREEZE_REASON_COUNT
+};
+
+const char *freezeReasonName(uint8_t reason);
+
+// Биты FlightRecord::flags
+#define FREC_FLAG_DRIVING 0x01      // Колёса крутятся по намерению движения
+#define FREC_FLAG_LOW_CUTOFF 0x02   // Моторы отключены по напряжению
+#define FREC_FLAG_HOLDING 0x04      // Удержание курса активно
+#define FREC_FLAG_GYRO 0x08         // yawCdeg действителен
+#define FREC_FLAG_CURRENT 0x10      // currentMa действителен
+#define FREC_FLAG_OBSTACLE 0x20     // Скорость ограничена препятствием
+#define FREC_FLAG_TRIGGER 0x80      // Такт, в котором сработал триггер
+
+// Одна запись на такт, 52 байта
+struct FlightRecord {
+  uint32_t timeMs;
+  uint16_t loopUs;          // Длительность такта, мкс (насыщается)
+  uint8_t driveKind;        // DriveKind
+  uint8_t flags;            // FREC_FLAG_*
+  int16_t joyX;             // Намерение: джойстик (DRIVE_AXES — и поворот),
+  int16_t joyY;
+  int16_t joyW;
+  uint8_t preset;           // ...пресет
+  uint8_t speed;            // ...и скорость из настроек
+  int16_t shaped[4];        // ЛОГИЧЕСКИЕ колёса после курса/антибукса/компенсации
+  int16_t dutyQ15[4];       // ФИЗИЧЕСКИЕ моторы после маппинга и инверсии, Q15 со знаком
+  uint16_t batteryMv;
+  uint16_t currentMa[4];    // По физическим каналам
+  int16_t yawCdeg;          // Курс, сотые градуса
+  int16_t omega;            // Поправка удержания курса
+  int16_t residualMmps;     // Рассогласование скоростей колёс (traction.h)
+  uint8_t slipMask;
+  uint8_t brakeMask;        // Физические моторы в торможении
+  uint16_t reserved;
+};
+
+static_assert(sizeof(FlightRecord) == 52, "FlightRecord layout is part of the dump format");
+
+// Заголовок файла дампа, 16 байт
+struct FlightDumpHeader {
+  uint32_t magic;           // FREC_MAGIC
+  uint8_t version;          // FREC_VERSION
+  uint8_t recordSize;       // sizeof(FlightRecord)
+  uint8_t reason;           // FreezeReason
+  uint8_t resetReason;      // esp_reset_reason() загрузки, на которой записан буфер
+  uint16_t count;           // Записей после заголовка
+  uint16_t postTicks;       // Из них после триггера
+  uint32_t freezeMs;        // millis() в момент триггера
+};
+
+static_assert(sizeof(FlightDumpHeader) == 16, "FlightDumpHeader layout is part of the dump format");
+
+// Хранилище самописца. Должно переживать программный сброс, поэтому без
+// конструкторов: содержимое проверяется сигнатурами в begin().
+struct FlightLog {
+  uint32_t magic;
+  uint32_t head;            // Всего записано (следующая ячейка = head % FREC_RECORDS)
+  uint8_t state;
+  uint8_t reason;
+  uint8_t resetReason;
+  uint8_t reserved;
+  uint16_t postLeft;
+  uint16_t postTicks;
+  uint32_t freezeMs;
+  FlightRecord records[FREC_RECORDS];
+  uint32_t magicEnd;        // ~FREC_MAGIC
+};
+
+class FlightRecorder {
+public:
+  // log — хранилище в неинициализируемой памяти; resetReason — причина
+  // текущей загрузки; crashed — загрузка после аварийного сброса.
+  void begin(FlightLog *log, uint8_t resetReason, bool crashed);
+
+  // Из задачи управления, раз в такт. Здесь же применяются триггер и взвод.
+  void record(const FlightRecord &r);
+
+  // Из любой задачи. Первый триггер выигрывает до повторного взвода.
+  void trigger(FreezeReason reason, uint32_t now);
+  // Очистить и снова писать (применяется в следующем такте)
+  void rearm() { rearmPending.store(true, std::memory_order_relaxed); }
+
+  bool frozen() const { return frozenFlag.load(std::memory_order_acquire); }
+  uint8_t reason() const;
+
+  // Дамп читается только из замороженного буфера: писатель стоит
+  size_t dumpSize() const;
+  // Кусок дампа со смещения index (для потоковой отдачи по HTTP)
+  size_t readDump(uint8_t *buf, size_t maxLen, size_t index) const;
+
+private:
+  enum State : uint8_t { REC_RECORDING, REC_TRIGGERED, REC_FROZEN };
+
+  void clear();
+  void freeze();
+  uint16_t count() const;
+  void header(FlightDumpHeader &h) const;
+
+  FlightLog *log = nullptr;
+  uint8_t bootReset = 0;
+  std::atomic<uint8_t> pendingReason{FREEZE_NONE};
+  std::atomic<uint32_t> pendingMs{0};
+  std::atomic<bool> rearmPending{false};
+  std::atomic<bool> frozenFlag{false};
+};
@@ -0,0 +1,28 @@
+#include "gyro.h"
+
+// Двоичный угол на 1 мград·мкс, Q32: 2^64 / (360000 * 10^6)
+#define ANGLE_PER_MDEG_US_Q32 51240956LL
+
+void SimulatedGyro::advance(int32_t trueRateMdps, uint32_t dtMs) {
+  uint32_t periodUs = 1000000 / odrHz;
+  pendingUs += dtMs * 1000;
+
+  while (pendingUs >= periodUs) {
+    pendingUs -= periodUs;
+
+    int32_t sample = trueRateMdps + bias;
+    if (noise > 0) {
+      lcg = lcg * 1103515245u + 12345u;
+      sample += (int32_t)((lcg >> 16) % (2 * noise + 1)) - noise;
+    }
+    rate = sample;
+    // мград/с * мкс -> двоичный угол
+    angle += (uint32_t)(((int64_t)sample * periodUs * ANGLE_PER_MDEG_US_Q32) >> 32);
+  }
+}
+
+bool SimulatedGyro::read(uint32_t &yaw, int32_t &rateMdps) {
+  yaw = angle;
+  rateMdps = rate;
+  return true;
+}
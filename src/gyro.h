@@ -0,0 +1,48 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+
+#include "fixed.h"
+
+// ==================== ГИРОСКОП (РЫСКАНИЕ) ====================
+// Источник угла рыскания для удержания курса. Датчик опрашивается сам
+// на своей частоте (ODR) и интегрирует угол; задача управления только
+// читает готовые значения и никогда не ждёт шину.
+// Угол — двоичный, как в fixed.h: 2^32 = оборот, против часовой.
+
+class GyroSource {
+public:
+  virtual ~GyroSource() {}
+
+  // Накопленный угол и угловая скорость, мград/с.
+  // false = данных нет (датчик молчит дольше допустимого)
+  virtual bool read(uint32_t &yaw, int32_t &rateMdps) = 0;
+
+  // Робот стоит: датчик может уточнить смещение нуля
+  virtual void setStationary(bool stationary) {}
+};
+
+// Модель гироскопа для хоста: истинная угловая скорость плюс остаточное
+// смещение нуля и шум, интегрирование шагами ODR, как у настоящего датчика
+class SimulatedGyro : public GyroSource {
+public:
+  explicit SimulatedGyro(uint32_t odrHz = 200) : odrHz(odrHz) {}
+
+  void setBias(int32_t mdps) { bias = mdps; }
+  void setNoise(int32_t mdps) { noise = mdps; }
+
+  // Прошло dtMs при истинной угловой скорости trueRateMdps
+  void advance(int32_t trueRateMdps, uint32_t dtMs);
+
+  bool read(uint32_t &yaw, int32_t &rateMdps) override;
+
+private:
+  uint32_t odrHz;
+  int32_t bias = 0;
+  int32_t noise = 0;
+  uint32_t lcg = 12345;
+  uint32_t pendingUs = 0;     // Время до следующего отсчёта ODR
+  uint32_t angle = 0;
+  int32_t rate = 0;
+};
@@ -0,0 +1,59 @@
+#include "hcsr04_range.h"
+
+bool Hcsr04Ranges::begin() {
+  for (uint8_t i = 0; i < kBoard.rangeCount; i++) {
+    const BoardRange &r = kBoard.ranges[i];
+    pinMode(r.trigPin, OUTPUT);
+    digitalWrite(r.trigPin, LOW);
+    pinMode(r.echoPin, INPUT);
+    echoArgs[i] = {this, i};
+    attachInterruptArg(r.echoPin, onEcho, &echoArgs[i], CHANGE);
+  }
+  return kBoard.rangeCount > 0;
+}
+
+void IRAM_ATTR Hcsr04Ranges::onEcho(void *arg) {
+  Echo *e = (Echo *)arg;
+  Hcsr04Ranges *self = e->owner;
+  if (e->sensor != self->active) return;   // Чужое (запоздавшее) эхо
+
+  uint32_t t = micros();
+  if (digitalRead(kBoard.ranges[e->sensor].echoPin)) {
+    self->riseUs = t;
+    self->rose = true;
+  } else if (self->rose) {
+    self->fallUs = t;
+    self->fell = true;
+  }
+}
+
+void Hcsr04Ranges::trigger(uint8_t sensor, uint32_t now) {
+  rose = false;
+  fell = false;
+  active = sensor;
+  digitalWrite(kBoard.ranges[sensor].trigPin, HIGH);
+  triggerHigh = true;
+}
+
+RangeStatus Hcsr04Ranges::poll(uint8_t sensor, uint32_t now, uint16_t &mm) {
+  if (triggerHigh) {
+    // Такт спустя: спад trig запускает измерение
+    digitalWrite(kBoard.ranges[sensor].trigPin, LOW);
+    triggerHigh = false;
+    return RANGE_PENDING;
+  }
+  if (!fell) {
+    // Эхо без препятствия тянется ~38 мс: хватит и половины
+    if (rose && micros() - riseUs > HCSR04_NO_ECHO_US) {
+      active = 0xFF;
+      mm = RANGE_MAX_MM;
+      return RANGE_READY;
+    }
+    return RANGE_PENDING;
+  }
+
+  active = 0xFF;
+  uint32_t us = fallUs - riseUs;
+  mm = us >= HCSR04_NO_ECHO_US ? RANGE_MAX_MM : (uint16_t)(us * HCSR04_UM_PER_US / 1000);
+  return RANGE_READY;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <Arduino.h>
+
+#include "board.h"
+#include "range.h"
+
+// ==================== ДАТЧИКИ HC-SR04 ====================
+// Кольцо из kBoard.ranges. Измерение без ожидания:
+//   trigger() — trig = HIGH;
+//   первый poll() (следующий такт, >= 10 мкс спустя) — trig = LOW, по
+//     спаду датчик посылает пачку;
+//   фронт и спад эха ловит прерывание (micros()), poll() только читает.
+// Эхо без препятствия — импульс ~38 мс: это "путь свободен"
+// (RANGE_MAX_MM). Не поднявшееся эхо — датчика нет или он неисправен,
+// такое измерение снимает по таймауту планировщик.
+
+#define HCSR04_UM_PER_US 172              // Звук туда и обратно: 343 м/с / 2
+#define HCSR04_NO_ECHO_US 30000           // Эхо длиннее — препятствий в пределах дальности нет
+
+class Hcsr04Ranges : public RangeSource {
+public:
+  // Настроить пины и прерывания эха; false — на плате нет датчиков
+  bool begin();
+
+  uint8_t count() const override { return kBoard.rangeCount; }
+  void trigger(uint8_t sensor, uint32_t now) override;
+  RangeStatus poll(uint8_t sensor, uint32_t now, uint16_t &mm) override;
+
+private:
+  static void IRAM_ATTR onEcho(void *arg);
+
+  struct Echo {
+    Hcsr04Ranges *owner;
+    uint8_t sensor;
+  };
+
+  Echo echoArgs[BOARD_RANGES_MAX];
+  bool triggerHigh = false;
+  volatile uint8_t active = 0xFF;       // Датчик, чьё эхо ждём
+  volatile uint32_t riseUs = 0;
+  volatile uint32_t fallUs = 0;
+  volatile bool rose = false;
+  volatile bool fell = false;
+};
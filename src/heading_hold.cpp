@@ -0,0 +1,68 @@
+#include "heading_hold.h"
+
+#include <stdlib.h>
+
+#include "fixed.h"
+#include "gyro.h"
+
+static const int8_t rotateLeftPattern[4] = {-1, 1, -1, 1};
+
+void HeadingHold::reset() {
+  phase = PHASE_IDLE;
+  integralQ8 = 0;
+  held.store(false, std::memory_order_relaxed);
+  error.store(0, std::memory_order_relaxed);
+  output.store(0, std::memory_order_relaxed);
+}
+
+int HeadingHold::update(bool hold, uint32_t yaw, int32_t rateMdps, uint32_t now) {
+  uint32_t dt = now - lastUpdate;
+  lastUpdate = now;
+
+  if (!hold) {
+    reset();
+    return 0;
+  }
+
+  if (phase == PHASE_IDLE) {
+    phase = PHASE_CAPTURE;
+    captureStart = now;
+  }
+
+  // Курс запоминается после того, как робот перестал поворачивать,
+  // иначе регулятор вернул бы его к углу, с которого начался выбег
+  if (phase == PHASE_CAPTURE) {
+    if (abs(rateMdps) > HEADING_CAPTURE_RATE_MDPS && now - captureStart < HEADING_CAPTURE_TIMEOUT_MS) {
+      return 0;
+    }
+    phase = PHASE_HOLD;
+    target = yaw;
+    integralQ8 = 0;
+    held.store(true, std::memory_order_relaxed);
+    return 0;
+  }
+
+  int32_t err = angleToMdeg(target - yaw);
+  error.store(err, std::memory_order_relaxed);
+
+  int32_t p = (int32_t)(((int64_t)HEADING_KP_Q8 * err / 1000) >> 8);
+  int32_t d = -(int32_t)(((int64_t)HEADING_KD_Q8 * rateMdps / 1000) >> 8);
+
+  // Интеграл в Q8 единиц колеса, с ограничением от насыщения
+  if (dt > 0 && dt < 1000) {
+    integralQ8 += (int32_t)((int64_t)HEADING_KI_Q8 * err * (int32_t)dt / 1000000);
+    const int32_t limit = HEADING_MAX_CORRECTION << 8;
+    integralQ8 = fxClamp(integralQ8, -limit, limit);
+  }
+
+  int32_t omega = fxClamp(p + (integralQ8 >> 8) + d, -HEADING_MAX_CORRECTION, HEADING_MAX_CORRECTION);
+  output.store((int)omega, std::memory_order_relaxed);
+  return (int)omega;
+}
+
+void applyHeadingCorrection(int wheels[4], int omega) {
+  if (omega == 0) return;
+
+  for (int i = 0; i < 4; i++) wheels[i] += omega * rotateLeftPattern[i];
+  fxLimitPeak4(wheels, 255);
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+
+// ==================== УДЕРЖАНИЕ КУРСА ====================
+// Моторы никогда не совпадают точно, поэтому при движении без команды
+// поворота (стрейф в omni, вперёд/назад) робот уводит по рысканию.
+// Регулятор запоминает курс, когда оператор перестаёт поворачивать,
+// и добавляет в смешивание колёс поправку omega (ПИД по ошибке курса,
+// Д — по угловой скорости гироскопа).
+// Поправка в единицах команды колеса: omega > 0 = против часовой,
+// колёса получают её по шаблону rotate_left {-1, +1, -1, +1}.
+
+#define HEADING_KP_Q8 (10 * 256)         // Единиц колеса на градус ошибки
+#define HEADING_KI_Q8 (16 * 256)         // Единиц колеса на градус·секунду
+#define HEADING_KD_Q8 80                 // Единиц колеса на градус/с (демпфирование)
+#define HEADING_MAX_CORRECTION 80        // Предел |omega|
+#define HEADING_CAPTURE_RATE_MDPS 5000   // Курс запоминается, когда поворот затих
+#define HEADING_CAPTURE_TIMEOUT_MS 400   // ...или по истечении этого времени
+
+class HeadingHold {
+public:
+  // hold: едем без команды поворота — держать курс; false = отпустить.
+  // Возвращает поправку omega для applyHeadingCorrection().
+  int update(bool hold, uint32_t yaw, int32_t rateMdps, uint32_t now);
+
+  void reset();
+
+  // Для телеметрии (читаются из другой задачи)
+  bool holding() const { return held.load(std::memory_order_relaxed); }
+  int32_t errorMdeg() const { return error.load(std::memory_order_relaxed); }
+  int correction() const { return output.load(std::memory_order_relaxed); }
+
+private:
+  enum Phase : uint8_t { PHASE_IDLE, PHASE_CAPTURE, PHASE_HOLD };
+
+  Phase phase = PHASE_IDLE;
+  uint32_t target = 0;
+  uint32_t captureStart = 0;
+  uint32_t lastUpdate = 0;
+  int32_t integralQ8 = 0;
+  std::atomic<bool> held{false};
+  std::atomic<int32_t> error{0};
+  std::atomic<int> output{0};
+};
+
+// Добавить omega к скоростям колёс M1..M4. Если колесо выходит за 255,
+// все четыре масштабируются одним коэффициентом — направление сохраняется.
+void applyHeadingCorrection(int wheels[4], int omega);
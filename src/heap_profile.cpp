@@ -0,0 +1,167 @@
+#include "heap_profile.h"
+
+#include <stdlib.h>
+
+#ifdef ARDUINO
+#include <esp_attr.h>
+#endif
+#ifndef IRAM_ATTR
+#define IRAM_ATTR
+#endif
+
+HeapProfile heapProfile;
+
+static const char *const kTagNames[HEAP_TAG_COUNT] = {
+  "other", "command", "reply", "send", "telemetry", "nvs", "http", "ws", "link", "log",
+};
+
+const char *heapTagName(uint8_t tag) {
+  return tag < HEAP_TAG_COUNT ? kTagNames[tag] : "?";
+}
+
+// Метка текущей задачи (TLS FreeRTOS на ESP32, поток на ПК)
+static thread_local uint8_t currentTag = HEAP_TAG_OTHER;
+
+HeapScope::HeapScope(HeapTag tag) : previous(currentTag) {
+  currentTag = tag;
+  heapProfile.noteCall(tag);
+}
+
+HeapScope::~HeapScope() {
+  currentTag = previous;
+}
+
+// ==================== СЧЁТЧИКИ ====================
+
+void IRAM_ATTR HeapProfile::noteAlloc(size_t size, uintptr_t pc) {
+  uint8_t tag = currentTag;
+  tags[tag].allocs.fetch_add(1, std::memory_order_relaxed);
+  tags[tag].bytes.fetch_add((uint32_t)size, std::memory_order_relaxed);
+
+#ifdef HEAP_TRACE_SITES
+  // Открытая адресация без блокировок: ячейку занимает первый CAS
+  size_t i = (pc >> 2) & (HEAP_SITES - 1);
+  for (size_t probe = 0; probe < HEAP_SITES; probe++, i = (i + 1) & (HEAP_SITES - 1)) {
+    uintptr_t owner = sites[i].pc.load(std::memory_order_relaxed);
+    if (owner == 0) {
+      uintptr_t expected = 0;
+      if (!sites[i].pc.compare_exchange_strong(expected, pc, std::memory_order_relaxed) && expected != pc) {
+        continue;
+      }
+      sites[i].tag.store(tag, std::memory_order_relaxed);
+    } else if (owner != pc) {
+      continue;
+    }
+    sites[i].count.fetch_add(1, std::memory_order_relaxed);
+    sites[i].bytes.fetch_add((uint32_t)size, std::memory_order_relaxed);
+    return;
+  }
+  siteOverflow.fetch_add(1, std::memory_order_relaxed);
+#else
+  (void)pc;
+#endif
+}
+
+HeapTagCounters HeapProfile::tagCounters(uint8_t tag) const {
+  HeapTagCounters c;
+  c.allocs = tags[tag].allocs.load(std::memory_order_relaxed);
+  c.bytes = tags[tag].bytes.load(std::memory_order_relaxed);
+  c.calls = tags[tag].calls.load(std::memory_order_relaxed);
+  return c;
+}
+
+uint32_t HeapProfile::totalAllocs() const {
+  uint32_t total = 0;
+  for (int t = 0; t < HEAP_TAG_COUNT; t++) total += tags[t].allocs.load(std::memory_order_relaxed);
+  return total;
+}
+
+bool HeapProfile::site(size_t i, HeapSite &out) const {
+  out.pc = sites[i].pc.load(std::memory_order_relaxed);
+  if (out.pc == 0) return false;
+  out.tag = sites[i].tag.load(std::memory_order_relaxed);
+  out.count = sites[i].count.load(std::memory_order_relaxed);
+  out.bytes = sites[i].bytes.load(std::memory_order_relaxed);
+  return true;
+}
+
+// ==================== ИСТОРИЯ ====================
+
+void HeapProfile::record(const HeapSample &sample) {
+  HeapHistoryEntry &e = ring[(historyHead + historyLen) % HEAP_HISTORY];
+  if (historyLen < HEAP_HISTORY) {
+    historyLen++;
+  } else {
+    historyHead = (historyHead + 1) % HEAP_HISTORY;
+  }
+
+  e.sample = sample;
+  for (int t = 0; t < HEAP_TAG_COUNT; t++) {
+    uint32_t now = tags[t].allocs.load(std::memory_order_relaxed);
+    uint32_t delta = now - lastAllocs[t];
+    e.allocs[t] = delta > UINT16_MAX ? UINT16_MAX : (uint16_t)delta;
+    lastAllocs[t] = now;
+  }
+}
+
+const HeapHistoryEntry &HeapProfile::history(size_t i) const {
+  return ring[(historyHead + i) % HEAP_HISTORY];
+}
+
+// Обнулить счётчики и места (история остаётся: это замеры кучи)
+void HeapProfile::reset() {
+  for (int t = 0; t < HEAP_TAG_COUNT; t++) {
+    tags[t].allocs.store(0, std::memory_order_relaxed);
+    tags[t].bytes.store(0, std::memory_order_relaxed);
+    tags[t].calls.store(0, std::memory_order_relaxed);
+    lastAllocs[t] = 0;
+  }
+  frees.store(0, std::memory_order_relaxed);
+  for (size_t i = 0; i < HEAP_SITES; i++) {
+    sites[i].count.store(0, std::memory_order_relaxed);
+    sites[i].bytes.store(0, std::memory_order_relaxed);
+    sites[i].pc.store(0, std::memory_order_relaxed);
+  }
+  siteOverflow.store(0, std::memory_order_relaxed);
+}
+
+// ==================== ОБЁРТКИ MALLOC ====================
+// -Wl,--wrap=malloc направляет все вызовы malloc в __wrap_malloc, а
+// настоящий остаётся доступен как __real_malloc. Это касается и
+// библиотек (String, operator new, AsyncTCP), собранных в прошивку.
+// Обёртки в IRAM, как сам malloc в ESP-IDF.
+
+#ifdef HEAP_PROFILE_WRAP
+extern "C" {
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t n, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void __real_free(void *ptr);
+
+void *IRAM_ATTR __wrap_malloc(size_t size) {
+  heapProfile.noteAlloc(size, (uintptr_t)__builtin_return_address(0));
+  return __real_malloc(size);
+}
+
+void *IRAM_ATTR __wrap_calloc(size_t n, size_t size) {
+  heapProfile.noteAlloc(n * size, (uintptr_t)__builtin_return_address(0));
+  return __real_calloc(n, size);
+}
+
+// realloc(nullptr) — выделение, realloc(p, 0) — освобождение; рост String
+// (realloc существующего буфера) тоже считается выделением
+void *IRAM_ATTR __wrap_realloc(void *ptr, size_t size) {
+  if (size == 0) {
+    if (ptr != nullptr) heapProfile.noteFree();
+  } else {
+    heapProfile.noteAlloc(size, (uintptr_t)__builtin_return_address(0));
+  }
+  return __real_realloc(ptr, size);
+}
+
+void IRAM_ATTR __wrap_free(void *ptr) {
+  if (ptr != nullptr) heapProfile.noteFree();
+  __real_free(ptr);
+}
+}
+#endif
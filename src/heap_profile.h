@@ -0,0 +1,134 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+// ==================== ПРОФИЛЬ КУЧИ ====================
+// Долгие сессии упираются не в объём свободной памяти, а во фрагментацию:
+// String на каждую команду, JSON, ключи NVS и строки журнала режут кучу
+// на мелкие куски. Здесь три вещи:
+//   - счётчики выделений по подсистемам: код помечает участок HeapScope,
+//     и каждое malloc/realloc внутри (в этой задаче) засчитывается его
+//     метке. Выделения других задач (WiFi, lwIP) идут в "other";
+//   - история: раз в HEAP_SAMPLE_PERIOD_MS свободная память, наибольший
+//     блок, минимум и выделения по меткам за период;
+//   - места выделений (только с HEAP_TRACE_SITES): адрес возврата
+//     malloc, число и байты — адреса переводятся в строки addr2line.
+// Счётчики ведут обёртки malloc/calloc/realloc/free (ключи компоновщика
+// --wrap, см. platformio.ini). Без HEAP_PROFILE_WRAP обёрток нет, метки
+// ничего не считают, а свободная память и история работают.
+
+#define HEAP_SAMPLE_PERIOD_MS 10000
+#define HEAP_HISTORY 30               // 5 минут по 10 с
+#define HEAP_SITES 64                 // Мест выделения в таблице (степень двойки)
+
+enum HeapTag : uint8_t {
+  HEAP_TAG_OTHER,       // Вне меток и чужие задачи
+  HEAP_TAG_COMMAND,     // Разбор и применение команды
+  HEAP_TAG_REPLY,       // Ответы на команды (JSON)
+  HEAP_TAG_SEND,        // Отправка из очередей в транспорты
+  HEAP_TAG_TELEMETRY,   // Телеметрия и поток позы
+  HEAP_TAG_NVS,         // Загрузка и запись настроек
+  HEAP_TAG_HTTP,        // Обработчики GET
+  HEAP_TAG_WS,          // События WebSocket, сборка сообщений
+  HEAP_TAG_LINK,        // Проводная связь
+  HEAP_TAG_LOG,         // Журнал команд
+  HEAP_TAG_COUNT
+};
+
+const char *heapTagName(uint8_t tag);
+
+// Участок кода с меткой; вложенные участки восстанавливают внешнюю метку
+class HeapScope {
+public:
+  explicit HeapScope(HeapTag tag);
+  ~HeapScope();
+
+  HeapScope(const HeapScope &) = delete;
+  HeapScope &operator=(const HeapScope &) = delete;
+
+private:
+  uint8_t previous;
+};
+
+// Состояние кучи в момент замера (заполняет платформа)
+struct HeapSample {
+  uint32_t ms;
+  uint32_t freeBytes;
+  uint32_t largestBlock;
+  uint32_t minFree;             // Минимум с момента загрузки
+};
+
+struct HeapTagCounters {
+  uint32_t allocs;
+  uint32_t bytes;
+  uint32_t calls;               // Сколько раз входили в участок с меткой
+};
+
+struct HeapHistoryEntry {
+  HeapSample sample;
+  uint16_t allocs[HEAP_TAG_COUNT];  // Выделений по меткам за период (насыщается)
+};
+
+struct HeapSite {
+  uintptr_t pc;                 // Адрес возврата из malloc
+  uint8_t tag;
+  uint32_t count;
+  uint32_t bytes;
+};
+
+class HeapProfile {
+public:
+  // Из обёрток malloc: не выделяет и не блокирует
+  void noteAlloc(size_t size, uintptr_t pc);
+  void noteFree() { frees.fetch_add(1, std::memory_order_relaxed); }
+  void noteCall(uint8_t tag) { tags[tag].calls.fetch_add(1, std::memory_order_relaxed); }
+
+  // Замер раз в период (из loop())
+  void record(const HeapSample &sample);
+  void reset();
+
+  HeapTagCounters tagCounters(uint8_t tag) const;
+  uint32_t totalAllocs() const;
+  uint32_t totalFrees() const { return frees.load(std::memory_order_relaxed); }
+
+  // От старого к новому, i < historyCount()
+  size_t historyCount() const { return historyLen; }
+  const HeapHistoryEntry &history(size_t i) const;
+
+  // Места выделения, занятые ячейки; false — ячейка пуста
+  bool site(size_t i, HeapSite &out) const;
+  uint32_t sitesDropped() const { return siteOverflow.load(std::memory_order_relaxed); }
+
+  // Процент фрагментации: доля свободной памяти вне наибольшего блока
+  static uint8_t fragmentation(const HeapSample &s) {
+    return s.freeBytes > 0 ? (uint8_t)(100 - (uint64_t)s.largestBlock * 100 / s.freeBytes) : 0;
+  }
+
+private:
+  struct AtomicCounters {
+    std::atomic<uint32_t> allocs{0};
+    std::atomic<uint32_t> bytes{0};
+    std::atomic<uint32_t> calls{0};
+  };
+  struct SiteSlot {
+    std::atomic<uintptr_t> pc{0};
+    std::atomic<uint8_t> tag{0};
+    std::atomic<uint32_t> count{0};
+    std::atomic<uint32_t> bytes{0};
+  };
+
+  AtomicCounters tags[HEAP_TAG_COUNT];
+  std::atomic<uint32_t> frees{0};
+  SiteSlot sites[HEAP_SITES];
+  std::atomic<uint32_t> siteOverflow{0};
+
+  // Только из loop()
+  HeapHistoryEntry ring[HEAP_HISTORY] = {};
+  size_t historyHead = 0;
+  size_t historyLen = 0;
+  uint32_t lastAllocs[HEAP_TAG_COUNT] = {};
+};
+
+extern HeapProfile heapProfile;
@@ -0,0 +1,80 @@
+// Декодер дампа самописца в CSV:
+//   pio run -e frec  &&  .pio/build/frec/program flight.frec > flight.csv
+// Дамп: curl -o flight.frec http://<ip>/flight_recorder
+
+#include <stdio.h>
+#include <string.h>
+
+#include "../flight_recorder.h"
+#include "../robot_state.h"
+
+// По порядку DriveKind
+static const char *const driveNames[] = {
+  "stop", "preset", "joy", "test", "stop_test", "characterize", "path", "axes",
+};
+static_assert(sizeof(driveNames) / sizeof(driveNames[0]) == DRIVE_KIND_COUNT, "driveNames must follow DriveKind");
+
+static const char *driveName(uint8_t kind) {
+  return kind < sizeof(driveNames) / sizeof(driveNames[0]) ? driveNames[kind] : "?";
+}
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    fprintf(stderr, "Использование: %s flight.frec > flight.csv\n", argv[0]);
+    return 2;
+  }
+
+  FILE *f = fopen(argv[1], "rb");
+  if (f == nullptr) {
+    fprintf(stderr, "✗ Не открыть %s\n", argv[1]);
+    return 1;
+  }
+
+  FlightDumpHeader h;
+  if (fread(&h, sizeof(h), 1, f) != 1 || h.magic != FREC_MAGIC) {
+    fprintf(stderr, "✗ Не дамп самописца\n");
+    fclose(f);
+    return 1;
+  }
+  if (h.version != FREC_VERSION || h.recordSize != sizeof(FlightRecord)) {
+    fprintf(stderr, "✗ Версия %u, запись %u байт; декодер понимает версию %u, %u байт\n",
+            h.version, h.recordSize, FREC_VERSION, (unsigned)sizeof(FlightRecord));
+    fclose(f);
+    return 1;
+  }
+
+  fprintf(stderr, "Причина: %s, сброс %u, триггер в %u мс, записей %u (после триггера %u)\n",
+          freezeReasonName(h.reason), h.resetReason, h.freezeMs, h.count, h.postTicks);
+
+  printf("time_ms,loop_us,drive,driving,low_cutoff,holding,trigger,joy_x,joy_y,joy_w,preset,speed,"
+         "w1,w2,w3,w4,duty1,duty2,duty3,duty4,brake,battery_mv,i1_ma,i2_ma,i3_ma,i4_ma,"
+         "yaw_deg,omega,residual_mmps,slip,obstacle\n");
+
+  FlightRecord r;
+  uint16_t read = 0;
+  while (read < h.count && fread(&r, sizeof(r), 1, f) == 1) {
+    read++;
+    printf("%u,%u,%s,%d,%d,%d,%d,%d,%d,%d,%u,%u,", r.timeMs, r.loopUs, driveName(r.driveKind),
+           !!(r.flags & FREC_FLAG_DRIVING), !!(r.flags & FREC_FLAG_LOW_CUTOFF),
+           !!(r.flags & FREC_FLAG_HOLDING), !!(r.flags & FREC_FLAG_TRIGGER),
+           r.joyX, r.joyY, r.joyW, r.preset, r.speed);
+    printf("%d,%d,%d,%d,", r.shaped[0], r.shaped[1], r.shaped[2], r.shaped[3]);
+    // Скважность в процентах со знаком
+    for (int i = 0; i < 4; i++) printf("%.2f,", r.dutyQ15[i] * 100.0 / 32767);
+    printf("%u,%u,", r.brakeMask, r.batteryMv);
+    for (int i = 0; i < 4; i++) {
+      if (r.flags & FREC_FLAG_CURRENT) printf("%u,", r.currentMa[i]);
+      else printf(",");
+    }
+    if (r.flags & FREC_FLAG_GYRO) printf("%.2f,", r.yawCdeg / 100.0);
+    else printf(",");
+    printf("%d,%d,%u,%d\n", r.omega, r.residualMmps, r.slipMask, !!(r.flags & FREC_FLAG_OBSTACLE));
+  }
+  fclose(f);
+
+  if (read != h.count) {
+    fprintf(stderr, "✗ Дамп обрезан: %u из %u записей\n", read, h.count);
+    return 1;
+  }
+  return 0;
+}
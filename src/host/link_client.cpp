@@ -0,0 +1,103 @@
+// Проводной клиент: команды по USB-UART вместо Wi-Fi.
+//   pio run -e link  &&  .pio/build/link/program /dev/ttyUSB0
+// Строки stdin уходят кадрами (та же команда, что по WebSocket:
+// "forward", "joy:0:200", "get_config"), ответы робота печатаются в
+// stdout, текст журнала Serial между кадрами — в stderr. Пока команд нет,
+// клиент шлёт "ping", чтобы робот не посчитал связь потерянной.
+
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "link_fd.h"
+
+#define LINK_BAUD 921600              // Как SERIAL_BAUD в main.cpp
+#define LINK_KEEPALIVE_MS 300         // Меньше LINK_TIMEOUT_MS робота
+
+static uint64_t nowMs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static void printFrame(void *ctx, const uint8_t *data, size_t len) {
+  // Ответы на собственный ping не интересны
+  if (len >= 8 && memcmp(data, "{\"pong\":", 8) == 0) return;
+  fwrite(data, 1, len, stdout);
+  fputc('\n', stdout);
+  fflush(stdout);
+}
+
+static void printNoise(void *ctx, const uint8_t *data, size_t len) {
+  fwrite(data, 1, len, stderr);
+}
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    fprintf(stderr, "Использование: %s /dev/ttyUSB0\n", argv[0]);
+    return 2;
+  }
+
+  int fd = open(argv[1], O_RDWR | O_NOCTTY);
+  if (fd < 0) {
+    fprintf(stderr, "✗ Не открыть %s\n", argv[1]);
+    return 1;
+  }
+  if (!linkSetRaw(fd, LINK_BAUD)) {
+    fprintf(stderr, "✗ Не настроить порт на %d бод\n", LINK_BAUD);
+    close(fd);
+    return 1;
+  }
+
+  FdStream stream(fd);
+  SerialLink link(stream);
+  fprintf(stderr, "✓ %s, %d бод\n", argv[1], LINK_BAUD);
+
+  char line[LINK_MAX_PAYLOAD + 2];
+  size_t lineLen = 0;
+  bool stdinOpen = true;
+  uint64_t lastSent = 0;
+
+  for (;;) {
+    struct pollfd p[2] = {{fd, POLLIN, 0}, {STDIN_FILENO, POLLIN, 0}};
+    int n = poll(p, stdinOpen ? 2 : 1, LINK_KEEPALIVE_MS / 3);
+    if (n < 0) break;
+
+    if (p[0].revents & (POLLERR | POLLHUP)) {
+      fprintf(stderr, "✗ Порт закрыт\n");
+      break;
+    }
+    link.poll(printFrame, printNoise, nullptr);
+
+    if (stdinOpen && (p[1].revents & (POLLIN | POLLHUP))) {
+      char buf[256];
+      ssize_t got = read(STDIN_FILENO, buf, sizeof(buf));
+      if (got <= 0) stdinOpen = false;
+
+      for (ssize_t i = 0; i < got; i++) {
+        if (buf[i] == '\n' || buf[i] == '\r') {
+          if (lineLen > 0 && !link.send((const uint8_t *)line, lineLen)) {
+            fprintf(stderr, "✗ Не отправлено: %.*s\n", (int)lineLen, line);
+          }
+          if (lineLen > 0) lastSent = nowMs();
+          lineLen = 0;
+        } else if (lineLen < LINK_MAX_PAYLOAD) {
+          line[lineLen++] = buf[i];
+        }
+      }
+    }
+
+    if (nowMs() - lastSent >= LINK_KEEPALIVE_MS) {
+      link.send((const uint8_t *)"ping", 4);
+      lastSent = nowMs();
+    }
+  }
+
+  const LinkStats &st = link.stats();
+  fprintf(stderr, "Кадры: принято %u, отправлено %u, шум %u\n", st.rxFrames, st.txFrames, st.badFrames);
+  close(fd);
+  return 0;
+}
@@ -0,0 +1,65 @@
+#include "link_fd.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+FdStream::FdStream(int fd) : handle(fd) {
+  int flags = fcntl(fd, F_GETFL, 0);
+  if (flags >= 0) fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+}
+
+size_t FdStream::read(uint8_t *buf, size_t maxLen) {
+  ssize_t n = ::read(handle, buf, maxLen);
+  return n > 0 ? (size_t)n : 0;
+}
+
+size_t FdStream::write(const uint8_t *data, size_t len) {
+  size_t done = 0;
+  while (done < len) {
+    ssize_t n = ::write(handle, data + done, len - done);
+    if (n > 0) {
+      done += (size_t)n;
+      continue;
+    }
+    if (n < 0 && errno != EAGAIN && errno != EINTR) break;
+
+    struct pollfd p = {handle, POLLOUT, 0};
+    if (poll(&p, 1, LINK_FD_WRITE_TIMEOUT_MS) <= 0) break;
+  }
+  return done;
+}
+
+static speed_t baudConstant(unsigned baud) {
+  switch (baud) {
+    case 115200: return B115200;
+    case 230400: return B230400;
+#ifdef B460800
+    case 460800: return B460800;
+#endif
+#ifdef B921600
+    case 921600: return B921600;
+#endif
+    default: return B0;
+  }
+}
+
+bool linkSetRaw(int fd, unsigned baud) {
+  struct termios t;
+  if (tcgetattr(fd, &t) != 0) return false;
+  cfmakeraw(&t);
+  t.c_cflag |= CLOCAL | CREAD;
+  t.c_cflag &= ~(CSTOPB | CRTSCTS);
+  t.c_cc[VMIN] = 0;
+  t.c_cc[VTIME] = 0;
+
+  if (baud != 0) {
+    speed_t s = baudConstant(baud);
+    if (s == B0) return false;
+    cfsetispeed(&t, s);
+    cfsetospeed(&t, s);
+  }
+  return tcsetattr(fd, TCSANOW, &t) == 0;
+}
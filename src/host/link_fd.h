@@ -0,0 +1,27 @@
+#pragma once
+
+#include "../serial_link.h"
+
+// ByteStream поверх файлового дескриптора ПК (tty, псевдотерминал).
+// Чтение не блокирует. Запись ждёт, пока ядро не примет кадр целиком
+// (не дольше LINK_FD_WRITE_TIMEOUT_MS), поэтому кадры не рвутся.
+
+#define LINK_FD_WRITE_TIMEOUT_MS 500
+
+class FdStream : public ByteStream {
+public:
+  explicit FdStream(int fd);
+
+  size_t read(uint8_t *buf, size_t maxLen) override;
+  size_t write(const uint8_t *data, size_t len) override;
+  size_t writable() override { return LINK_MAX_FRAME + 2; }
+
+  int fd() const { return handle; }
+
+private:
+  int handle;
+};
+
+// Перевести терминал в сырой режим (8N1, без эха и преобразований).
+// baud = 0 — скорость не менять (псевдотерминал). false = ошибка termios.
+bool linkSetRaw(int fd, unsigned baud);
@@ -0,0 +1,85 @@
+#include "sha1.h"
+
+#include <string.h>
+
+static uint32_t rol(uint32_t v, int n) {
+  return (v << n) | (v >> (32 - n));
+}
+
+static void sha1Block(uint32_t h[5], const uint8_t *block) {
+  uint32_t w[80];
+  for (int i = 0; i < 16; i++) {
+    w[i] = (uint32_t)block[4 * i] << 24 | (uint32_t)block[4 * i + 1] << 16 |
+           (uint32_t)block[4 * i + 2] << 8 | block[4 * i + 3];
+  }
+  for (int i = 16; i < 80; i++) w[i] = rol(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+
+  uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+  for (int i = 0; i < 80; i++) {
+    uint32_t f, k;
+    if (i < 20) {
+      f = (b & c) | (~b & d);
+      k = 0x5A827999;
+    } else if (i < 40) {
+      f = b ^ c ^ d;
+      k = 0x6ED9EBA1;
+    } else if (i < 60) {
+      f = (b & c) | (b & d) | (c & d);
+      k = 0x8F1BBCDC;
+    } else {
+      f = b ^ c ^ d;
+      k = 0xCA62C1D6;
+    }
+    uint32_t t = rol(a, 5) + f + e + k + w[i];
+    e = d;
+    d = c;
+    c = rol(b, 30);
+    b = a;
+    a = t;
+  }
+  h[0] += a;
+  h[1] += b;
+  h[2] += c;
+  h[3] += d;
+  h[4] += e;
+}
+
+void sha1(const uint8_t *data, size_t len, uint8_t digest[20]) {
+  uint32_t h[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+
+  size_t full = len / 64 * 64;
+  for (size_t i = 0; i < full; i += 64) sha1Block(h, data + i);
+
+  // Хвост: 0x80, нули, длина в битах big-endian
+  uint8_t tail[128] = {};
+  size_t rest = len - full;
+  memcpy(tail, data + full, rest);
+  tail[rest] = 0x80;
+  size_t tailLen = rest + 9 <= 64 ? 64 : 128;
+  uint64_t bits = (uint64_t)len * 8;
+  for (int i = 0; i < 8; i++) tail[tailLen - 1 - i] = (uint8_t)(bits >> (8 * i));
+
+  for (size_t i = 0; i < tailLen; i += 64) sha1Block(h, tail + i);
+
+  for (int i = 0; i < 5; i++) {
+    digest[4 * i] = (uint8_t)(h[i] >> 24);
+    digest[4 * i + 1] = (uint8_t)(h[i] >> 16);
+    digest[4 * i + 2] = (uint8_t)(h[i] >> 8);
+    digest[4 * i + 3] = (uint8_t)h[i];
+  }
+}
+
+void base64Encode(const uint8_t *data, size_t len, char *out) {
+  static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  size_t o = 0;
+  for (size_t i = 0; i < len; i += 3) {
+    uint32_t v = (uint32_t)data[i] << 16;
+    if (i + 1 < len) v |= (uint32_t)data[i + 1] << 8;
+    if (i + 2 < len) v |= data[i + 2];
+    out[o++] = alphabet[(v >> 18) & 63];
+    out[o++] = alphabet[(v >> 12) & 63];
+    out[o++] = i + 1 < len ? alphabet[(v >> 6) & 63] : '=';
+    out[o++] = i + 2 < len ? alphabet[v & 63] : '=';
+  }
+  out[o] = 0;
+}
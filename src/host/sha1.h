@@ -0,0 +1,11 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// SHA-1 и base64 — только для рукопожатия WebSocket (Sec-WebSocket-Accept)
+
+void sha1(const uint8_t *data, size_t len, uint8_t digest[20]);
+
+// out: не меньше 4 * ((len + 2) / 3) + 1 байт, завершается нулём
+void base64Encode(const uint8_t *data, size_t len, char *out);
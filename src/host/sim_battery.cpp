@@ -0,0 +1,126 @@
+// Монитор батареи (battery.cpp) на синтетическом источнике: тот же путь
+// отсчёт -> IIR-фильтр -> отсечка -> компенсация PWM, что в такте
+// управления на роботе. Проверяется: шум АЦП сглаживается, короткая
+// просадка под нагрузкой не отключает моторы, разряд отключает, а
+// включение возвращается только выше порога восстановления; коэффициент
+// компенсации Q8 при нескольких напряжениях.
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../battery.h"
+#include "sim_scenarios.h"
+
+#define SIM_TICK_MS 10
+#define MAX_RIPPLE_MV 60              // Остаток шума после фильтра (~4 сигмы)
+#define SETTLE_MS 2000                // ~6 постоянных времени фильтра
+#define MAX_CUTOFF_LAG_MV 60          // Фильтр запаздывает на медленном разряде
+
+struct BatteryTrace {
+  uint32_t minMv, maxMv;
+  bool wentLow;
+};
+
+// Прогон ms миллисекунд с текущими настройками источника
+static BatteryTrace runFor(BatteryMonitor &monitor, uint32_t ms) {
+  BatteryTrace tr = {0xFFFFFFFF, 0, false};
+  for (uint32_t t = 0; t < ms; t += SIM_TICK_MS) {
+    monitor.update();
+    uint32_t mv = monitor.millivolts();
+    if (mv < tr.minMv) tr.minMv = mv;
+    if (mv > tr.maxMv) tr.maxMv = mv;
+    if (monitor.isLow()) tr.wentLow = true;
+  }
+  return tr;
+}
+
+int runBatteryScenario() {
+  int failed = 0;
+
+  printf("Отсечка %d мВ, восстановление %d мВ, номинал %d мВ, фильтр 1/%d за такт\n", BATTERY_CUTOFF_MV,
+         BATTERY_RECOVER_MV, BATTERY_NOMINAL_MV, 1 << BATTERY_FILTER_SHIFT);
+
+  // 1. Шум АЦП ±200 мВ на 7.4 В: после установления — узкая полоса
+  SyntheticVoltageSource source(7400);
+  source.setNoise(200);
+  BatteryMonitor monitor(&source);
+  runFor(monitor, SETTLE_MS);
+  BatteryTrace noisy = runFor(monitor, 5000);
+  bool ok = !noisy.wentLow && noisy.minMv + MAX_RIPPLE_MV >= 7400 && noisy.maxMv <= 7400 + MAX_RIPPLE_MV;
+  printf("%s Шум ±200 мВ: после фильтра %u..%u мВ (допуск ±%d)\n", ok ? "✓" : "✗", noisy.minMv, noisy.maxMv,
+         MAX_RIPPLE_MV);
+  if (!ok) failed++;
+
+  // 2. Разгон: провал на 1.2 В (до 6.2 В, ниже отсечки) на 50 мс
+  source.setVoltage(7200);
+  runFor(monitor, SETTLE_MS);
+  source.setSag(1200);
+  BatteryTrace spike = runFor(monitor, 50);
+  source.setSag(0);
+  runFor(monitor, SETTLE_MS);
+  ok = !spike.wentLow && !monitor.isLow();
+  printf("%s Провал до %d мВ на 50 мс: фильтр опустился до %u мВ, моторы не отключены\n", ok ? "✓" : "✗",
+         7200 - 1200, spike.minMv);
+  if (!ok) failed++;
+
+  // 3. Длительная нагрузка: просадка 500 мВ устанавливается
+  source.setSag(500);
+  runFor(monitor, SETTLE_MS);
+  uint32_t sagged = monitor.millivolts();
+  source.setSag(0);
+  runFor(monitor, SETTLE_MS);
+  ok = abs((int)sagged - 6700) <= MAX_RIPPLE_MV && !monitor.isLow();
+  printf("%s Нагрузка -500 мВ: фильтр %u мВ (ожидалось 6700), выше отсечки\n", ok ? "✓" : "✗", sagged);
+  if (!ok) failed++;
+
+  // 4. Разряд 7.0 -> 6.2 В по 1 мВ за такт: отсечка у BATTERY_CUTOFF_MV
+  uint32_t cutAtMv = 0;
+  for (uint32_t v = 7000; v >= 6200 && cutAtMv == 0; v--) {
+    source.setVoltage(v);
+    monitor.update();
+    if (monitor.isLow()) cutAtMv = v;
+  }
+  uint32_t lag = cutAtMv != 0 ? BATTERY_CUTOFF_MV - cutAtMv : 0;
+  ok = cutAtMv != 0 && lag <= MAX_CUTOFF_LAG_MV;
+  printf("%s Разряд: отсечка при %u мВ на батарее (фильтр запаздывает на %u мВ)\n", ok ? "✓" : "✗", cutAtMv, lag);
+  if (!ok) failed++;
+
+  // 5. Гистерезис: отдых до 6.6 В — ещё выключено, 7.0 В — включено
+  source.setVoltage(6600);
+  BatteryTrace rest = runFor(monitor, SETTLE_MS);
+  bool lowBetween = monitor.isLow();
+  source.setVoltage(7000);
+  runFor(monitor, SETTLE_MS);
+  ok = lowBetween && rest.maxMv < BATTERY_RECOVER_MV && !monitor.isLow();
+  printf("%s Гистерезис: при %u мВ моторы выключены, при %u мВ снова включены\n", ok ? "✓" : "✗", rest.maxMv,
+         monitor.millivolts());
+  if (!ok) failed++;
+
+  // 6. Компенсация: Q8 = номинал / напряжение, не больше BATTERY_MAX_SCALE_Q8
+  struct ScaleCase {
+    uint32_t mv;
+    uint16_t scaleQ8;
+    int speed200;
+  };
+  static const ScaleCase cases[] = {
+    {8400, 213, 166},     // Полный заряд: скважность уменьшается
+    {7000, 256, 200},     // Номинал: без изменений
+    {6000, 298, 232},
+    {5000, 358, 255},     // Насыщение команды
+    {3000, 512, 255},     // Предел x2
+  };
+  ok = true;
+  for (const ScaleCase &c : cases) {
+    SyntheticVoltageSource fixedSource(c.mv);
+    BatteryMonitor m(&fixedSource);
+    m.update();
+    bool caseOk = m.scaleQ8() == c.scaleQ8 && m.compensate(200) == c.speed200 && m.compensate(-200) == -c.speed200;
+    printf("  %s %u мВ: scale %u/256 (ожидалось %u), 200 -> %d\n", caseOk ? "✓" : "✗", c.mv, m.scaleQ8(),
+           c.scaleQ8, m.compensate(200));
+    if (!caseOk) ok = false;
+  }
+  printf("%s Компенсация PWM\n", ok ? "✓" : "✗");
+  if (!ok) failed++;
+
+  return failed;
+}
@@ -0,0 +1,106 @@
+#include "sim_chassis.h"
+
+#include <math.h>
+
+// Вклад корпуса в скорость колеса: s_i = A + sx_i*B + sw_i*C, где
+// A = вперёд/√2, B = вправо/√2, C = ω*R (против часовой)
+static const double sx[4] = {1, -1, -1, 1};
+static const double sw[4] = {-1, 1, -1, 1};
+
+#define SLIP_WEIGHT 0.1   // Вклад буксующего колеса в движение корпуса
+
+SimChassisParams defaultSimChassisParams() {
+  SimChassisParams p;
+  p.maxWheelMmps = 600;
+  p.motorTauS = 0.08;
+  p.bodyTauS = 0.12;
+  p.trackRadiusMm = 100;
+  p.wheelDiameterMm = 60;
+  p.countsPerRev = 360;
+  for (int i = 0; i < 4; i++) {
+    p.wheelGain[i] = 1.0;
+    p.gripMmps[i] = 1e9;   // По умолчанию колёса не срываются
+  }
+  return p;
+}
+
+SimChassis::SimChassis(const SimChassisParams &params) : p(params) {}
+
+// Взвешенные наименьшие квадраты: (A, B, C) по скоростям моторов
+static void fitBody(const double s[4], const double w[4], double &a, double &b, double &c) {
+  double m[3][4] = {};  // Нормальные уравнения [M | v]
+  for (int i = 0; i < 4; i++) {
+    double row[3] = {1, sx[i], sw[i]};
+    for (int r = 0; r < 3; r++) {
+      for (int k = 0; k < 3; k++) m[r][k] += w[i] * row[r] * row[k];
+      m[r][3] += w[i] * row[r] * s[i];
+    }
+  }
+
+  // Гаусс без выбора ведущего: матрица симметричная положительно определённая
+  for (int r = 0; r < 3; r++) {
+    for (int q = r + 1; q < 3; q++) {
+      double f = m[q][r] / m[r][r];
+      for (int k = r; k < 4; k++) m[q][k] -= f * m[r][k];
+    }
+  }
+  double x[3];
+  for (int r = 2; r >= 0; r--) {
+    double v = m[r][3];
+    for (int k = r + 1; k < 3; k++) v -= m[r][k] * x[k];
+    x[r] = v / m[r][r];
+  }
+  a = x[0];
+  b = x[1];
+  c = x[2];
+}
+
+void SimChassis::step(const int commands[4], double dtS) {
+  const double sub = 0.001;
+  for (double t = 0; t < dtS - 1e-9; t += sub) {
+    double h = dtS - t < sub ? dtS - t : sub;
+
+    double weight[4];
+    for (int i = 0; i < 4; i++) {
+      double target = p.wheelGain[i] * commands[i] / 255.0 * p.maxWheelMmps;
+      motor[i] += (target - motor[i]) * h / (p.motorTauS + h);
+      weight[i] = slip[i] ? SLIP_WEIGHT : 1.0;
+    }
+
+    double a, b, c;
+    fitBody(motor, weight, a, b, c);
+    double k = h / (p.bodyTauS + h);
+    bodyA += (a - bodyA) * k;
+    bodyB += (b - bodyB) * k;
+    bodyC += (c - bodyC) * k;
+
+    for (int i = 0; i < 4; i++) {
+      double ground = bodyA + sx[i] * bodyB + sw[i] * bodyC;
+      double diff = fabs(motor[i] - ground);
+      if (!slip[i] && diff > p.gripMmps[i]) slip[i] = true;
+      else if (slip[i] && diff < p.gripMmps[i] / 2) slip[i] = false;
+
+      wheel[i] = slip[i] ? motor[i] : ground;
+      travel[i] += wheel[i] * h;
+    }
+
+    double forward = M_SQRT2 * bodyA;
+    double left = -M_SQRT2 * bodyB;
+    double w = bodyC / p.trackRadiusMm;
+
+    px += (forward * cos(pth) - left * sin(pth)) * h;
+    py += (forward * sin(pth) + left * cos(pth)) * h;
+    pth += w * h;
+  }
+}
+
+double SimChassis::omega() const {
+  return bodyC / p.trackRadiusMm;
+}
+
+void SimChassis::readCounts(int32_t counts[4]) const {
+  double perCount = M_PI * p.wheelDiameterMm / p.countsPerRev;
+  for (int i = 0; i < 4; i++) {
+    counts[i] = (int32_t)floor(travel[i] / perCount);
+  }
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <stdint.h>
+
+// ==================== МОДЕЛЬ ШАССИ (ХОСТ) ====================
+// Упрощённая модель робота для проверки алгоритмов на ПК:
+//   - мотор разгоняется к скорости команды с постоянной времени мотора,
+//     у каждого свой коэффициент (моторы не одинаковые);
+//   - корпус тянется к движению, которое "хотят" моторы (наименьшие
+//     квадраты по четырём колёсам, буксующее колесо почти не тянет),
+//     с постоянной времени корпуса (инерция);
+//   - колесо со сцеплением крутится со скоростью, которую задаёт корпус;
+//     если мотор хочет больше, чем позволяет сцепление колеса, колесо
+//     срывается и буксует со скоростью мотора, пока разница не упадёт
+//     вдвое ниже предела;
+//   - энкодеры считают целые отсчёты пути каждого колеса.
+// Все величины — по ЛОГИЧЕСКИМ колёсам M1..M4.
+
+struct SimChassisParams {
+  double maxWheelMmps;      // Скорость колеса при команде 255
+  double motorTauS;         // Постоянная времени мотора
+  double bodyTauS;          // Постоянная времени корпуса
+  double trackRadiusMm;     // От центра до колеса
+  double wheelDiameterMm;
+  int countsPerRev;
+  double wheelGain[4];      // Разброс моторов (1.0 = номинал)
+  double gripMmps[4];       // Предел сцепления: разница мотор/корпус до срыва
+};
+
+SimChassisParams defaultSimChassisParams();
+
+class SimChassis {
+public:
+  explicit SimChassis(const SimChassisParams &params);
+
+  // Команды колёс -255..255 на время dtS
+  void step(const int commands[4], double dtS);
+
+  // Истинная поза: мм, мм, рад (x — вперёд, y — влево, θ — против часовой)
+  double x() const { return px; }
+  double y() const { return py; }
+  double theta() const { return pth; }
+
+  // Скорость поверхности колеса (то, что видит энкодер), мм/с
+  double wheelSpeed(int i) const { return wheel[i]; }
+  bool slipping(int i) const { return slip[i]; }
+
+  // Истинная угловая скорость корпуса, рад/с (против часовой)
+  double omega() const;
+
+  // Накопленные отсчёты энкодеров
+  void readCounts(int32_t counts[4]) const;
+
+private:
+  SimChassisParams p;
+  double px = 0, py = 0, pth = 0;
+  double bodyA = 0, bodyB = 0, bodyC = 0;   // s_i = A + sx_i*B + sw_i*C
+  double motor[4] = {0, 0, 0, 0};
+  double wheel[4] = {0, 0, 0, 0};
+  bool slip[4] = {false, false, false, false};
+  double travel[4] = {0, 0, 0, 0};          // Путь колеса, мм
+};
@@ -0,0 +1,19 @@
+// Команды в сценариях идут через ядро команд прошивки (command_core.cpp):
+// тот же разбор пакета, метки "at:" и публикация снимка, что в handleCommand.
+
+#include <string.h>
+
+#include "../command_core.h"
+#include "sim_scenarios.h"
+
+#define SIM_COMMAND_CLIENT 1
+
+bool simApplyCommands(RobotState &st, const char *batch) {
+  SeqLock<RobotState> state(st);
+  ClientClocks clocks;
+  CommandEffects fx = {};
+  MessageResult r = processCommandMessage(SIM_COMMAND_CLIENT, batch, strlen(batch), 0, state, clocks, fx);
+  if (r.failed || r.count == 0) return false;
+  state.read(st);
+  return true;
+}
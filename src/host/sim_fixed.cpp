@@ -0,0 +1,147 @@
+// Фиксированная точка (fixed.h) против libm: точность таблиц sin/cos и
+// atan2, поворот вектора, корень, насыщение на краях диапазона. Затем
+// время тех же операций против float/double на ПК — для сравнения с
+// замером на роботе ("bench": fx_* и float_*). Время не проверяется:
+// на ПК с FPU float обычно не медленнее, выигрыш fixed.h — на ESP32.
+
+#include <chrono>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "../fixed.h"
+#include "sim_scenarios.h"
+
+#define MAX_SIN_ERROR 1.5e-4          // Доля от 1.0: ~5 единиц Q15
+#define MAX_ATAN2_ERROR_RAD 5e-5
+#define MAX_ROTATE_ERROR 1.0          // Единиц вектора (округление)
+#define TIMING_ITERATIONS 2000000
+
+static const double kRadPerAngle = 2 * M_PI / 4294967296.0;
+
+static volatile int64_t sink = 0;     // Не даёт компилятору выбросить замеряемый код
+
+static int check(const char *name, double worst, double limit, const char *unit) {
+  bool ok = worst <= limit;
+  printf("  %-22s %s наибольшая ошибка %.2e %s (допуск %.1e)\n", name, ok ? "✓" : "✗", worst, unit, limit);
+  return ok ? 0 : 1;
+}
+
+static int checkAccuracy() {
+  int failures = 0;
+
+  double sinError = 0;
+  for (uint64_t a = 0; a < (1ull << 32); a += 65537) {
+    double rad = (double)a * kRadPerAngle;
+    double es = fabs(fxSinQ15((uint32_t)a) / 32767.0 - sin(rad));
+    double ec = fabs(fxCosQ15((uint32_t)a) / 32767.0 - cos(rad));
+    if (es > sinError) sinError = es;
+    if (ec > sinError) sinError = ec;
+  }
+  failures += check("sin/cos Q15", sinError, MAX_SIN_ERROR, "");
+
+  double atanError = 0;
+  for (int32_t y = -1000; y <= 1000; y += 7) {
+    for (int32_t x = -1000; x <= 1000; x += 11) {
+      if (x == 0 && y == 0) continue;
+      double got = (double)(int32_t)fxAtan2(y, x) * kRadPerAngle;
+      double e = fabs(remainder(got - atan2(y, x), 2 * M_PI));
+      if (e > atanError) atanError = e;
+    }
+  }
+  // Края диапазона: большие катеты и оси
+  const int32_t edges[][2] = {{INT32_MAX, 1}, {INT32_MIN, -1}, {1, INT32_MIN}, {0, -5}, {-5, 0}, {7, 7}};
+  for (const auto &p : edges) {
+    double got = (double)(int32_t)fxAtan2(p[0], p[1]) * kRadPerAngle;
+    double e = fabs(remainder(got - atan2(p[0], p[1]), 2 * M_PI));
+    if (e > atanError) atanError = e;
+  }
+  failures += check("atan2", atanError, MAX_ATAN2_ERROR_RAD, "рад");
+
+  double rotError = 0;
+  for (uint32_t i = 0; i < 100000; i++) {
+    uint32_t a = i * 0x9E3779B9u;
+    FxVec2 v = {(int32_t)(i % 2001) - 1000, (int32_t)(i * 13 % 2001) - 1000};
+    FxVec2 r = fxRotate(v, a);
+    double rad = (double)a * kRadPerAngle;
+    double ex = fabs(r.x - (v.x * cos(rad) - v.y * sin(rad)));
+    double ey = fabs(r.y - (v.x * sin(rad) + v.y * cos(rad)));
+    if (ex > rotError) rotError = ex;
+    if (ey > rotError) rotError = ey;
+  }
+  failures += check("поворот ±1000", rotError, MAX_ROTATE_ERROR, "ед.");
+
+  // Корень и угол — точно на любых входах
+  int exact = 0;
+  for (uint64_t v = 0; v < 2000000; v += 3) {
+    uint64_t r = fxIsqrt64(v * v + v % 7);
+    exact += r == v;
+  }
+  exact += fxIsqrt64(UINT64_MAX) == UINT32_MAX;
+  exact += fxHypot(3000, -4000) == 5000;
+  exact += degreesToAngle(-90) == 0xC0000000u;
+  exact += angleToMrad(uradToAngle(-1570796)) == -1570;
+  int exactTotal = (2000000 + 2) / 3 + 4;
+  printf("  %-22s %s %d из %d\n", "isqrt/hypot/углы", exact == exactTotal ? "✓" : "✗", exact, exactTotal);
+  failures += exact == exactTotal ? 0 : 1;
+
+  // Насыщение вместо переполнения
+  bool sat = fxAddSat(INT32_MAX, 1) == INT32_MAX && fxSubSat(INT32_MIN, 1) == INT32_MIN &&
+             fxMulQ16(INT32_MAX, 2 * FX_Q16_ONE) == INT32_MAX && fxMulQ15(-FX_Q15_ONE, FX_Q15_ONE) == -32766 &&
+             fxSat16(40000) == INT16_MAX && fxDivQ16(1, 0) == INT32_MAX && fxScaleQ8(-255, 200) == -199 &&
+             fxAbs(INT32_MIN) == INT32_MAX;
+  int32_t wheels[4] = {300, -600, 150, 0};
+  sat = sat && fxLimitPeak4(wheels, 255) && wheels[0] == 127 && wheels[1] == -255 && wheels[2] == 63 &&
+        wheels[3] == 0;
+  printf("  %-22s %s\n", "насыщение", sat ? "✓" : "✗");
+  failures += sat ? 0 : 1;
+
+  return failures;
+}
+
+template <typename F>
+static double nsPerOp(F fn) {
+  auto t0 = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < TIMING_ITERATIONS; i++) fn(i);
+  auto t1 = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(t1 - t0).count() / TIMING_ITERATIONS;
+}
+
+static void printTiming(const char *name, double fixedNs, double floatNs) {
+  printf("  %-10s fixed %6.2f нс   float %6.2f нс\n", name, fixedNs, floatNs);
+}
+
+static void timing() {
+  printf("\nВремя на ПК (%d повторов):\n", TIMING_ITERATIONS);
+  printTiming("sin",
+              nsPerOp([](uint32_t i) { sink += fxSinQ15(i * 0x9E3779B9u); }),
+              nsPerOp([](uint32_t i) { sink += (int32_t)(sinf((float)(i * 0x9E3779B9u) * 1.4629181e-9f) * 32767.0f); }));
+  printTiming("atan2",
+              nsPerOp([](uint32_t i) {
+                sink += (int32_t)fxAtan2((int32_t)((i * 37) % 511) - 255, (int32_t)((i * 91) % 511) - 255);
+              }),
+              nsPerOp([](uint32_t i) {
+                sink += (int32_t)(atan2f((float)((int32_t)((i * 37) % 511) - 255),
+                                         (float)((int32_t)((i * 91) % 511) - 255)) * 1000.0f);
+              }));
+  printTiming("rotate",
+              nsPerOp([](uint32_t i) {
+                FxVec2 v = fxRotate({(int32_t)(i & 2047) - 1024, 300}, i * 0x9E3779B9u);
+                sink += v.x + v.y;
+              }),
+              nsPerOp([](uint32_t i) {
+                float a = (float)(i * 0x9E3779B9u) * 1.4629181e-9f;
+                float c = cosf(a), s = sinf(a);
+                float x = (float)((int32_t)(i & 2047) - 1024), y = 300.0f;
+                sink += (int32_t)(x * c - y * s) + (int32_t)(x * s + y * c);
+              }));
+  printTiming("mul_q16",
+              nsPerOp([](uint32_t i) { sink += fxMulQ16((int32_t)i, 46341); }),
+              nsPerOp([](uint32_t i) { sink += (int32_t)((float)i * 0.70711f); }));
+}
+
+int runFixedScenario() {
+  int failures = checkAccuracy();
+  timing();
+  return failures;
+}
@@ -0,0 +1,195 @@
+// Удержание курса (heading_hold.cpp) на модели шасси с разбросом моторов:
+// без регулятора стрейф уводит по рысканию, с регулятором курс держится.
+// Второй маршрут идёт командами "joy:" через разбор, смешивание колёс и
+// translationOnly(), как в такте управления: регулятор не должен
+// бороться с джойстиком, а X джойстика — двигать робот как кнопки.
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "../commands.h"
+#include "../drive_mix.h"
+#include "../gyro.h"
+#include "../heading_hold.h"
+#include "sim_chassis.h"
+#include "sim_scenarios.h"
+
+#define SIM_TICK_MS 10
+#define MAX_HOLD_DRIFT_DEG 3.0
+#define MIN_DIRECTION_COS 0.95        // Смещение "joy:" по направлению кнопки (до ~18°)
+
+struct HeadingSegment {
+  const char *name;
+  int wheels[4];
+  bool rotating;     // Оператор командует поворот — курс не держится
+  double seconds;
+};
+
+static const HeadingSegment route[] = {
+  {"вправо",      { 200, -200, -200,  200}, false, 4.0},
+  {"вперёд",      { 220,  220,  220,  220}, false, 3.0},
+  {"разворот",    {-120,  120, -120,  120}, true,  1.5},
+  {"влево",       {-200,  200,  200, -200}, false, 4.0},
+  {"диагональ",   {   0,  200,  200,    0}, false, 3.0},
+};
+
+// Прогон маршрута; возвращает наибольший уход курса на участках удержания
+static double runRoute(bool holdEnabled, bool verbose) {
+  SimChassisParams params = defaultSimChassisParams();
+  const double gains[4] = {1.0, 0.90, 1.06, 0.95};
+  for (int i = 0; i < 4; i++) params.wheelGain[i] = gains[i];
+
+  SimChassis chassis(params);
+  SimulatedGyro gyro(200);
+  gyro.setBias(150);     // Остаток после калибровки нуля
+  gyro.setNoise(300);
+  HeadingHold hold;
+
+  uint32_t now = 0;
+  double worst = 0;
+  double reference = 0;     // Курс, от которого считается уход
+  bool wasHolding = false;
+
+  for (const HeadingSegment &seg : route) {
+    double segWorst = 0;
+    int ticks = (int)(seg.seconds * 1000 / SIM_TICK_MS);
+
+    for (int t = 0; t < ticks; t++) {
+      uint32_t yaw;
+      int32_t rate;
+      gyro.read(yaw, rate);
+
+      int wheels[4] = {seg.wheels[0], seg.wheels[1], seg.wheels[2], seg.wheels[3]};
+      int omega = hold.update(holdEnabled && !seg.rotating, yaw, rate, now);
+      applyHeadingCorrection(wheels, omega);
+
+      chassis.step(wheels, SIM_TICK_MS / 1000.0);
+      gyro.advance((int32_t)lround(chassis.omega() * 180 / M_PI * 1000), SIM_TICK_MS);
+      now += SIM_TICK_MS;
+
+      // Опорный курс: момент захвата цели регулятором, а без регулятора —
+      // 0.5 с от начала участка (выбег после поворота)
+      bool capture = holdEnabled ? (hold.holding() && !wasHolding) : t * SIM_TICK_MS == 500;
+      wasHolding = hold.holding();
+      if (capture) reference = chassis.theta();
+
+      bool measured = holdEnabled ? hold.holding() : (!seg.rotating && t * SIM_TICK_MS > 500);
+      if (measured) {
+        double drift = fabs(remainder(chassis.theta() - reference, 2 * M_PI)) * 180 / M_PI;
+        if (drift > segWorst) segWorst = drift;
+      }
+    }
+
+    if (verbose) {
+      printf("  %-12s курс %8.2f°, уход %6.2f°%s\n", seg.name, chassis.theta() * 180 / M_PI,
+             segWorst, seg.rotating ? " (поворот)" : "");
+    }
+    if (segWorst > worst) worst = segWorst;
+  }
+  return worst;
+}
+
+// ---------- Маршрут джойстиком ----------
+
+struct JoySegment {
+  const char *name;
+  const char *commands;
+  double forward, right;    // Ожидаемое направление смещения в системе робота (0, 0 — поворот)
+  double turn;              // Знак поворота: +1 против часовой, -1 по часовой, 0 — курс держится
+  double seconds;
+};
+
+static const JoySegment joyRoute[] = {
+  {"omni вправо",       "heading:1;mode_omni;joy:200:0", 0,  1,  0, 4.0},
+  {"omni вперёд",       "joy:0:220",                     1,  0,  0, 3.0},
+  {"omni влево-вперёд", "joy:-150:150",                  1, -1,  0, 3.0},
+  {"tank вправо",       "mode_tank;joy:150:0",           0,  0, -1, 1.0},
+  {"tank вперёд",       "joy:0:220",                     1,  0,  0, 3.0},
+};
+
+static int runJoystickRoute() {
+  SimChassisParams params = defaultSimChassisParams();
+  const double gains[4] = {1.0, 0.90, 1.06, 0.95};
+  for (int i = 0; i < 4; i++) params.wheelGain[i] = gains[i];
+
+  SimChassis chassis(params);
+  SimulatedGyro gyro(200);
+  gyro.setBias(150);
+  gyro.setNoise(300);
+  HeadingHold hold;
+  RobotState st = defaultRobotState();
+
+  int failed = 0;
+  uint32_t now = 0;
+  for (const JoySegment &seg : joyRoute) {
+    if (!simApplyCommands(st, seg.commands)) {
+      printf("  ✗ %-18s команды не приняты\n", seg.name);
+      failed++;
+      continue;
+    }
+    // Смещение и поворот за участок в системе робота (x вперёд, y влево)
+    double fwd = 0, left = 0, turned = 0;
+    double reference = 0, drift = 0;
+    bool wasHolding = false;
+    int ticks = (int)(seg.seconds * 1000 / SIM_TICK_MS);
+
+    for (int t = 0; t < ticks; t++) {
+      uint32_t yaw;
+      int32_t rate;
+      gyro.read(yaw, rate);
+
+      int wheels[4];
+      computeWheels(st, wheels);
+      int omega = hold.update(st.config.headingHold && translationOnly(st), yaw, rate, now);
+      applyHeadingCorrection(wheels, omega);
+
+      double x0 = chassis.x(), y0 = chassis.y(), th0 = chassis.theta();
+      chassis.step(wheels, SIM_TICK_MS / 1000.0);
+      gyro.advance((int32_t)lround(chassis.omega() * 180 / M_PI * 1000), SIM_TICK_MS);
+      now += SIM_TICK_MS;
+      double dx = chassis.x() - x0, dy = chassis.y() - y0;
+      fwd += dx * cos(th0) + dy * sin(th0);
+      left += -dx * sin(th0) + dy * cos(th0);
+      turned += remainder(chassis.theta() - th0, 2 * M_PI) * 180 / M_PI;
+
+      if (hold.holding() && !wasHolding) reference = chassis.theta();
+      wasHolding = hold.holding();
+      if (hold.holding()) {
+        double d = fabs(remainder(chassis.theta() - reference, 2 * M_PI)) * 180 / M_PI;
+        if (d > drift) drift = d;
+      }
+    }
+
+    bool ok;
+    if (seg.turn != 0) {
+      ok = turned * seg.turn > 30 && !hold.holding();
+      printf("  %s %-18s поворот %+7.1f°, регулятор %s\n", ok ? "✓" : "✗", seg.name, turned,
+             hold.holding() ? "мешает" : "выключен");
+    } else {
+      double len = hypot(fwd, left);
+      double want = hypot(seg.forward, seg.right);
+      double cosine = len > 0 ? (fwd * seg.forward - left * seg.right) / (len * want) : 0;
+      ok = cosine >= MIN_DIRECTION_COS && drift <= MAX_HOLD_DRIFT_DEG && wasHolding;
+      printf("  %s %-18s вперёд %+6.0f мм, вправо %+6.0f мм, уход курса %.2f°\n", ok ? "✓" : "✗", seg.name, fwd,
+             -left, drift);
+    }
+    if (!ok) failed++;
+  }
+  return failed;
+}
+
+int runHeadingScenario() {
+  printf("Без удержания курса:\n");
+  double open = runRoute(false, true);
+  printf("С удержанием курса:\n");
+  double held = runRoute(true, true);
+
+  printf("\nНаибольший уход: %.2f° без регулятора, %.2f° с регулятором (допуск %.1f°)\n",
+         open, held, MAX_HOLD_DRIFT_DEG);
+  int failed = held <= MAX_HOLD_DRIFT_DEG ? 0 : 1;
+
+  printf("\nДжойстик \"joy:\" с удержанием курса:\n");
+  failed += runJoystickRoute();
+  return failed;
+}
@@ -0,0 +1,255 @@
+// Запоздавшие команды (client_clock.cpp) в сети с заторами. Клиент
+// сверяет часы с роботом, как страница управления (серия "sync", затем
+// "clock"), и шлёт кадры джойстика "at:t;joy:x:y" 50 раз в секунду.
+// Часы робота смещены и уходят на 40 ppm, задержка в сети несимметрична.
+// Иногда канал к роботу встаёт на 500 мс (повтор TCP) как раз тогда,
+// когда оператор отпускает джойстик; накопленные кадры потом приходят
+// пачкой, по одному в DRAIN_MS. Без проверки возраста робот после
+// затора заново проигрывает старое движение; с проверкой — стоит.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../command_core.h"
+#include "sim_scenarios.h"
+
+#define SIM_DURATION_MS 30000
+#define JOY_PERIOD_MS 20              // 50 Гц, как handleMove на странице
+#define PUSH_MS 1500                  // Оператор держит джойстик...
+#define RELEASE_MS 1000               // ...и отпускает (одна команда "stop")
+#define STALL_MS 500                  // Затор канала к роботу
+#define STALL_LEAD_MS 250             // Затор начинается до отпускания
+#define DRAIN_MS 6                    // Пачка после затора: кадр на 6 мс
+#define SYNC_SAMPLES 8
+#define SYNC_GAP_MS 50
+#define SYNC_PERIOD_MS 10000
+#define DEVICE_OFFSET_MS 777777       // Часы робота от часов клиента
+#define DEVICE_DRIFT_PPM 40
+#define MAX_SYNC_ERROR_MS 5
+#define SIM_CLIENT_ID 1
+
+struct SimMessage {
+  uint32_t deliverMs;
+  char text[40];
+};
+
+// Затор у каждого второго отпускания джойстика
+static uint32_t stallEnd(uint32_t at) {
+  const uint32_t cycle = PUSH_MS + RELEASE_MS;
+  for (uint32_t release = PUSH_MS; release < SIM_DURATION_MS; release += 2 * cycle) {
+    uint32_t start = release - STALL_LEAD_MS;
+    if (at >= start && at < start + STALL_MS) return start + STALL_MS;
+  }
+  return at;
+}
+
+// Затор прошёл, а оператор всё ещё не трогает джойстик
+static bool afterStall(uint32_t t) {
+  const uint32_t cycle = PUSH_MS + RELEASE_MS;
+  for (uint32_t release = PUSH_MS; release < SIM_DURATION_MS; release += 2 * cycle) {
+    uint32_t end = release - STALL_LEAD_MS + STALL_MS;
+    if (t >= end && t < release + RELEASE_MS) return true;
+  }
+  return false;
+}
+
+// Канал с сохранением порядка (как TCP): кадр не обгоняет предыдущий
+struct SimChannel {
+  SimMessage queue[256];
+  int head;
+  int count;
+  uint32_t lastDeliverMs;
+  uint32_t minDelayMs;
+  uint32_t jitterMs;
+  bool stalls;
+
+  void send(uint32_t now, const char *text) {
+    uint32_t at = now + minDelayMs + (uint32_t)(rand() % (jitterMs + 1));
+    if (stalls) at = stallEnd(at);
+    uint32_t gap = at <= lastDeliverMs + DRAIN_MS ? DRAIN_MS : 0;
+    if (at < lastDeliverMs + gap) at = lastDeliverMs + gap;
+    lastDeliverMs = at;
+
+    SimMessage &m = queue[(head + count++) % 256];
+    m.deliverMs = at;
+    snprintf(m.text, sizeof(m.text), "%s", text);
+  }
+
+  bool receive(uint32_t now, SimMessage &out) {
+    if (count == 0 || queue[head].deliverMs > now) return false;
+    out = queue[head];
+    head = (head + 1) % 256;
+    count--;
+    return true;
+  }
+};
+
+static uint32_t deviceClock(uint32_t t) {
+  return DEVICE_OFFSET_MS + t + (uint32_t)((uint64_t)t * DEVICE_DRIFT_PPM / 1000000);
+}
+
+// Езда считается в мс на полном ходу: ослабленная уставка весит меньше
+struct LatencyRun {
+  double lurchMs;           // Робот едет, хотя оператор уже отпустил джойстик
+  double replayMs;          // ...из них после того, как затор прошёл
+  uint32_t stale;
+  uint32_t decayed;
+  uint32_t frames;
+  uint32_t ageMaxMs;
+  int syncErrorMaxMs;       // Ошибка смещения часов по итогам сверок
+};
+
+static LatencyRun runNetwork(bool stalls, uint16_t maxAgeMs, bool decay) {
+  srand(42);
+  SimChannel up = {}, down = {};
+  up.minDelayMs = 4;
+  up.jitterMs = 8;
+  up.stalls = stalls;
+  down.minDelayMs = 2;
+  down.jitterMs = 3;
+
+  RobotState initial = defaultRobotState();
+  initial.config.cmdMaxAgeMs = maxAgeMs;
+  initial.config.cmdAgeDecay = decay;
+  SeqLock<RobotState> state(initial);
+  ClientClocks clocks;
+  LatencyRun run = {};
+
+  // Сверка часов на стороне клиента
+  int syncLeft = 0;
+  uint32_t syncNextMs = 0;
+  uint32_t bestRtt = 0, bestOffset = 0;
+  bool haveBest = false;
+  bool waitingSync = false;
+
+  for (uint32_t t = 0; t < SIM_DURATION_MS; t++) {
+    // ---------- Клиент ----------
+    if (t % SYNC_PERIOD_MS == 0) {
+      syncLeft = SYNC_SAMPLES;
+      haveBest = false;
+      syncNextMs = t;
+    }
+    if (syncLeft > 0 && !waitingSync && t >= syncNextMs) {
+      char cmd[24];
+      snprintf(cmd, sizeof(cmd), "sync:%u", t % CLOCK_STAMP_MODULO);
+      up.send(t, cmd);
+      waitingSync = true;
+    }
+
+    uint32_t phase = t % (PUSH_MS + RELEASE_MS);
+    bool pushing = phase < PUSH_MS;
+    if (pushing && phase % JOY_PERIOD_MS == 0) {
+      // Оператор ведёт джойстик по кругу на полном отклонении
+      int x = (int)((phase * 510 / PUSH_MS) % 511) - 255;
+      char cmd[40];
+      snprintf(cmd, sizeof(cmd), "at:%u;joy:%d:%d", t % CLOCK_STAMP_MODULO, x, 200);
+      up.send(t, cmd);
+    }
+    if (phase == PUSH_MS) up.send(t, "stop");
+
+    SimMessage m;
+    while (down.receive(t, m)) {
+      // Ответ {"sync":t1,t2}: смещение по замеру с наименьшей задержкой
+      unsigned t1, t2;
+      sscanf(m.text, "%u:%u", &t1, &t2);
+      uint32_t rtt = (t % CLOCK_STAMP_MODULO + CLOCK_STAMP_MODULO - t1) % CLOCK_STAMP_MODULO;
+      uint32_t mid = (t1 + rtt / 2) % CLOCK_STAMP_MODULO;
+      uint32_t offset = (t2 + CLOCK_STAMP_MODULO - mid) % CLOCK_STAMP_MODULO;
+      if (!haveBest || rtt < bestRtt) {
+        bestRtt = rtt;
+        bestOffset = offset;
+        haveBest = true;
+      }
+      waitingSync = false;
+      syncNextMs = t + SYNC_GAP_MS;
+      if (--syncLeft == 0) {
+        char cmd[32];
+        snprintf(cmd, sizeof(cmd), "clock:%u:%u", bestOffset, bestRtt);
+        up.send(t, cmd);
+
+        int truth = (int)((deviceClock(t) - t) % CLOCK_STAMP_MODULO);
+        int err = abs(truth - (int)bestOffset);
+        if (err > run.syncErrorMaxMs) run.syncErrorMaxMs = err;
+      }
+    }
+
+    // ---------- Робот: как handleCommand ----------
+    uint32_t now = deviceClock(t);
+    while (up.receive(t, m)) {
+      CommandEffects fx = {};
+      MessageResult r = processCommandMessage(SIM_CLIENT_ID, m.text, strlen(m.text), now, state, clocks, fx);
+      if (r.failed) continue;
+
+      if (fx.sync) {
+        char reply[32];
+        snprintf(reply, sizeof(reply), "%u:%u", fx.syncT1, now % CLOCK_STAMP_MODULO);
+        down.send(t, reply);
+      }
+      if (fx.clockSet) clocks.sync(SIM_CLIENT_ID, fx.clockOffsetMs, fx.clockRttMs);
+    }
+
+    // ---------- Итог такта ----------
+    DriveIntent drive = state.read().drive;
+    if (drive.kind == DRIVE_JOY && !pushing) {
+      int deflection = abs(drive.joyX) > abs(drive.joyY) ? abs(drive.joyX) : abs(drive.joyY);
+      run.lurchMs += deflection / 255.0;
+      if (stalls && afterStall(t)) run.replayMs += deflection / 255.0;
+    }
+  }
+
+  for (int i = 0; i < WS_MAX_CLIENTS + 1; i++) {
+    const ClientClock &c = clocks.slot(i);
+    if (c.clientId != SIM_CLIENT_ID) continue;
+    run.stale = c.stale;
+    run.decayed = c.decayed;
+    run.frames = c.frames;
+    run.ageMaxMs = c.ageMaxMs;
+  }
+  return run;
+}
+
+static void printRun(const char *name, const LatencyRun &run) {
+  printf("  %-26s езда после отпускания %4.0f мс (после затора %3.0f мс), кадров %u, "
+         "возраст до %3u мс, запоздало %u, ослаблено %u\n",
+         name, run.lurchMs, run.replayMs, run.frames, run.ageMaxMs, run.stale, run.decayed);
+}
+
+int runLatencyScenario() {
+  LatencyRun clean = runNetwork(false, CMD_AGE_DEFAULT_MS, false);
+  LatencyRun off = runNetwork(true, 0, false);
+  LatencyRun discard = runNetwork(true, CMD_AGE_DEFAULT_MS, false);
+  LatencyRun decay = runNetwork(true, CMD_AGE_DEFAULT_MS, true);
+
+  printRun("без заторов:", clean);
+  printRun("заторы, без проверки:", off);
+  printRun("заторы, остановка:", discard);
+  printRun("заторы, ослабление:", decay);
+  printf("\nОшибка сверки часов: до %d мс (дрейф %d ppm, период %d с)\n",
+         clean.syncErrorMaxMs, DEVICE_DRIFT_PPM, SYNC_PERIOD_MS / 1000);
+
+  int failures = 0;
+  if (clean.syncErrorMaxMs > MAX_SYNC_ERROR_MS) {
+    printf("✗ Часы сверены хуже %d мс\n", MAX_SYNC_ERROR_MS);
+    failures++;
+  }
+  // Без заторов робот едет после отпускания только пока "stop" в пути
+  int releases = SIM_DURATION_MS / (PUSH_MS + RELEASE_MS);
+  if (clean.stale != 0 || clean.decayed != 0 || clean.lurchMs > releases * JOY_PERIOD_MS) {
+    printf("✗ Без заторов кадры не должны считаться запоздавшими\n");
+    failures++;
+  }
+  if (off.replayMs == 0) {
+    printf("✗ Модель сети не воспроизводит проигрывание старых кадров\n");
+    failures++;
+  }
+  if (discard.replayMs > 0 || discard.stale == 0) {
+    printf("✗ Запоздавшие кадры выполнены\n");
+    failures++;
+  }
+  if (decay.replayMs > off.replayMs / 2) {
+    printf("✗ Ослабление не сократило проигрывание вдвое\n");
+    failures++;
+  }
+  return failures;
+}
@@ -0,0 +1,230 @@
+// Проводная связь (serial_link.cpp) через псевдотерминал: "робот" и
+// "клиент" — два SerialLink на концах одного pty, команды разбираются
+// ядром команд прошивки (processCommandMessage). Между кадрами робот пишет в тот же поток
+// текст журнала, как Serial на ESP32. Проверяется, что команды доходят,
+// журнал отсекается как шум, испорченный кадр отвергается, а длинный
+// ответ (как JSON настроек) приходит целиком.
+
+#include <pty.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../command_core.h"
+#include "link_fd.h"
+#include "sim_scenarios.h"
+
+#define LINK_ROUND_TRIPS 200
+#define LINK_BIG_PAYLOAD 1900         // Около размера JSON настроек
+#define LINK_WAIT_MS 1000
+#define LINK_MAX_RTT_US 20000         // Псевдотерминал: с запасом
+#define SIM_LINK_CLIENT 1
+
+// Журнал команд на ПК не нужен; ядро команд пишет сюда
+void commandLog(const char *fmt, ...) {}
+
+static uint64_t nowUs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+// ---------- Сторона робота ----------
+
+struct SimDevice {
+  FdStream stream;
+  SerialLink link;
+  SeqLock<RobotState> state;
+  ClientClocks clocks;
+  uint32_t commands;
+  uint32_t rejected;
+
+  explicit SimDevice(int fd) : stream(fd), link(stream), state(defaultRobotState()),
+                               commands(0), rejected(0) {}
+};
+
+static void deviceFrame(void *ctx, const uint8_t *data, size_t len) {
+  SimDevice &dev = *(SimDevice *)ctx;
+
+  // Как handleCommand: ядро команд публикует снимок, только если кадр верен
+  CommandEffects fx = {};
+  MessageResult r = processCommandMessage(SIM_LINK_CLIENT, (const char *)data, len, 0, dev.state, dev.clocks, fx);
+  if (r.failed || r.count == 0) {
+    dev.rejected++;
+    return;
+  }
+  dev.commands++;
+
+  // Журнал в тот же порт — между кадрами, как Serial.printf на роботе
+  char log[64];
+  int n = snprintf(log, sizeof(log), "Команда: %.*s\r\n", (int)(len < 32 ? len : 32), (const char *)data);
+  dev.stream.write((const uint8_t *)log, (size_t)n);
+
+  if (fx.pong) {
+    char reply[32];
+    int r = snprintf(reply, sizeof(reply), "{\"pong\":%u}", dev.commands);
+    dev.link.send((const uint8_t *)reply, (size_t)r);
+  }
+  if (fx.sendConfig) {
+    // Длинный ответ: кадр почти предельного размера
+    static char big[LINK_BIG_PAYLOAD + 1];
+    memset(big, 'x', LINK_BIG_PAYLOAD);
+    memcpy(big, "{\"config\":\"", 11);
+    memcpy(big + LINK_BIG_PAYLOAD - 2, "\"}", 2);
+    dev.link.send((const uint8_t *)big, LINK_BIG_PAYLOAD);
+  }
+}
+
+// ---------- Сторона клиента ----------
+
+struct SimClient {
+  FdStream stream;
+  SerialLink link;
+  char last[LINK_MAX_PAYLOAD + 1];
+  size_t lastLen;
+  uint32_t replies;
+  uint32_t noise;
+
+  explicit SimClient(int fd) : stream(fd), link(stream), lastLen(0), replies(0), noise(0) {}
+};
+
+static void clientFrame(void *ctx, const uint8_t *data, size_t len) {
+  SimClient &cl = *(SimClient *)ctx;
+  memcpy(cl.last, data, len);
+  cl.last[len] = 0;
+  cl.lastLen = len;
+  cl.replies++;
+}
+
+static void clientNoise(void *ctx, const uint8_t *data, size_t len) {
+  ((SimClient *)ctx)->noise++;
+}
+
+static bool sendText(SimClient &cl, const char *text) {
+  return cl.link.send((const uint8_t *)text, strlen(text));
+}
+
+// Крутить обе стороны, пока клиент не получит ответ
+static bool waitReply(SimDevice &dev, SimClient &cl, uint32_t before) {
+  uint64_t deadline = nowUs() + (uint64_t)LINK_WAIT_MS * 1000;
+  while (nowUs() < deadline) {
+    dev.link.poll(deviceFrame, nullptr, &dev);
+    cl.link.poll(clientFrame, clientNoise, &cl);
+    if (cl.replies != before) return true;
+  }
+  return false;
+}
+
+// Крутить обе стороны 50 мс (ответа не ждём)
+static void settle(SimDevice &dev, SimClient &cl) {
+  uint64_t deadline = nowUs() + 50000;
+  while (nowUs() < deadline) {
+    dev.link.poll(deviceFrame, nullptr, &dev);
+    cl.link.poll(clientFrame, clientNoise, &cl);
+  }
+}
+
+int runLinkScenario() {
+  int master, slave;
+  if (openpty(&master, &slave, nullptr, nullptr, nullptr) != 0) {
+    printf("✗ openpty не удался\n");
+    return 1;
+  }
+  linkSetRaw(master, 0);
+  linkSetRaw(slave, 0);
+
+  static SimDevice dev(slave);
+  static SimClient cl(master);
+  int failures = 0;
+
+  // 1. Поток команд джойстика с ping: задержка туда-обратно
+  uint64_t rttSum = 0, rttMax = 0;
+  int lost = 0;
+  for (int i = 0; i < LINK_ROUND_TRIPS; i++) {
+    char cmd[24];
+    snprintf(cmd, sizeof(cmd), "joy:%d:%d", (i % 511) - 255, 100);
+    sendText(cl, cmd);
+
+    uint32_t before = cl.replies;
+    uint64_t t0 = nowUs();
+    sendText(cl, "ping");
+    if (!waitReply(dev, cl, before) || strncmp(cl.last, "{\"pong\":", 8) != 0) {
+      lost++;
+      continue;
+    }
+    uint64_t rtt = nowUs() - t0;
+    rttSum += rtt;
+    if (rtt > rttMax) rttMax = rtt;
+  }
+  int answered = LINK_ROUND_TRIPS - lost;
+  printf("Туда-обратно: %d из %d, средняя %.0f мкс, худшая %llu мкс\n", answered, LINK_ROUND_TRIPS,
+         answered > 0 ? (double)rttSum / answered : 0.0, (unsigned long long)rttMax);
+  printf("Робот: команд %u, отвергнуто %u; клиент: шум (журнал) %u отрезков\n",
+         dev.commands, dev.rejected, cl.noise);
+
+  if (lost > 0) {
+    printf("✗ Потеряно ответов: %d\n", lost);
+    failures++;
+  }
+  if (answered > 0 && rttMax > LINK_MAX_RTT_US) {
+    printf("✗ Худшая задержка больше %d мкс\n", LINK_MAX_RTT_US);
+    failures++;
+  }
+  if (dev.commands != 2 * LINK_ROUND_TRIPS || dev.state.read().drive.kind != DRIVE_JOY) {
+    printf("✗ Робот принял не все команды\n");
+    failures++;
+  }
+  // Строки журнала между двумя кадрами сливаются в один отрезок шума
+  if (cl.noise == 0) {
+    printf("✗ Журнал робота не дошёл до клиента как шум\n");
+    failures++;
+  }
+
+  // 2. Испорченный кадр: CRC не сходится, команда не выполняется
+  uint8_t frame[32];
+  const char *stop = "stop";
+  uint8_t plain[8];
+  memcpy(plain, stop, 4);
+  uint16_t crc = crc16Ccitt(plain, 4);
+  plain[4] = (uint8_t)crc;
+  plain[5] = (uint8_t)(crc >> 8);
+  frame[0] = 0;
+  size_t n = cobsEncode(plain, 6, frame + 1) + 1;
+  frame[n++] = 0;
+  frame[2] ^= 0x20;   // "stop" -> "Stop"
+
+  uint32_t bad = dev.link.stats().badFrames;
+  uint32_t commands = dev.commands;
+  cl.stream.write(frame, n);
+  settle(dev, cl);
+  bool rejectedBad = dev.link.stats().badFrames == bad + 1 && dev.commands == commands &&
+                     dev.state.read().drive.kind == DRIVE_JOY;
+  printf("Испорченный кадр: %s\n", rejectedBad ? "отвергнут" : "ПРИНЯТ");
+  if (!rejectedBad) failures++;
+
+  // 3. Длинный ответ целиком одним кадром
+  uint32_t before = cl.replies;
+  sendText(cl, "get_config");
+  bool big = waitReply(dev, cl, before) && cl.lastLen == LINK_BIG_PAYLOAD &&
+             strncmp(cl.last, "{\"config\":\"", 11) == 0 && cl.last[LINK_BIG_PAYLOAD - 1] == '}';
+  printf("Ответ %d байт: %s\n", LINK_BIG_PAYLOAD, big ? "получен целиком" : "НЕ получен");
+  if (!big) failures++;
+
+  // 4. После испорченного кадра связь продолжает работать
+  before = cl.replies;
+  sendText(cl, "stop");
+  sendText(cl, "ping");
+  bool alive = waitReply(dev, cl, before) && dev.state.read().drive.kind == DRIVE_STOP;
+  printf("Связь после ошибки: %s\n", alive ? "работает" : "НЕ работает");
+  if (!alive) failures++;
+
+  const LinkStats &ds = dev.link.stats();
+  printf("Кадры робота: принято %u, отправлено %u, битых %u, переполнений %u\n",
+         ds.rxFrames, ds.txFrames, ds.badFrames, ds.overflows);
+
+  close(master);
+  close(slave);
+  return failures;
+}
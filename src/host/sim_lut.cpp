@@ -0,0 +1,122 @@
+// Характеризация моторов (motor_lut.cpp) на синтетических кривых
+// "скважность -> скорость": свои мёртвая зона, наклон и излом у каждого
+// мотора и направления. Прогон идёт тем же пошаговым интерфейсом
+// step()/addSample(), что в такте управления. Проверяется: таблица
+// строится и монотонна, скорость 1 уже выводит колесо из мёртвой зоны,
+// одинаковая команда даёт одинаковую скорость всем моторам.
+
+#include <math.h>
+#include <stdio.h>
+
+#include "../motor_lut.h"
+#include "sim_scenarios.h"
+
+#define SIM_TICK_MS 10
+#define MAX_SPREAD_PCT 8.0            // Разброс скоростей моторов после коррекции
+
+// Отклик мотора: ноль до мёртвой зоны, затем линейно, выше излома — положе
+struct MotorCurve {
+  double deadDuty;
+  double mmpsPerDuty;
+  double kneeDuty;        // Выше — наклон x0.6 (насыщение драйвера)
+};
+
+static const MotorCurve curves[4][2] = {
+  {{37, 4.0, 150}, {52, 3.6, 140}},
+  {{21, 4.4, 170}, {29, 4.1, 160}},
+  {{45, 3.8, 130}, {61, 3.5, 120}},
+  {{30, 4.2, 160}, {34, 3.9, 150}},
+};
+
+static double response(const MotorCurve &c, double duty) {
+  double x = duty - c.deadDuty;
+  if (x <= 0) return 0;
+  double knee = c.kneeDuty - c.deadDuty;
+  return c.mmpsPerDuty * (x < knee ? x : knee + (x - knee) * 0.6);
+}
+
+// Скорость физического мотора m (0..3) при команде speed через таблицу
+static double wheelSpeed(const MotorLinearizer &lin, int m, int speed) {
+  double duty = fabs((double)lin.applyQ16(m + 1, speed)) * SPEED_MAX / DUTY_Q16_ONE;
+  return response(curves[m][speed > 0 ? 0 : 1], duty);
+}
+
+// Наибольший разброс скоростей восьми пар мотор/направление, % от средней
+static double spreadPct(const MotorLinearizer &lin, int speed) {
+  double lo = 1e9, hi = 0, sum = 0;
+  for (int m = 0; m < 4; m++) {
+    for (int d = 0; d < 2; d++) {
+      double v = wheelSpeed(lin, m, d == 0 ? speed : -speed);
+      if (v < lo) lo = v;
+      if (v > hi) hi = v;
+      sum += v;
+    }
+  }
+  double mean = sum / 8;
+  return mean > 0 ? (hi - lo) * 100 / mean : 0;
+}
+
+int runLutScenario() {
+  int failed = 0;
+
+  // Прогон характеризации: каждый такт step(), затем отклик мотора
+  MotorCharacterizer characterizer;
+  characterizer.start(0);
+  uint32_t now = 0;
+  int motor, speed;
+  while (characterizer.step(now, motor, speed)) {
+    const MotorCurve &c = curves[motor - 1][speed >= 0 ? 0 : 1];
+    characterizer.addSample((int32_t)lround(response(c, fabs((double)speed))), now);
+    now += SIM_TICK_MS;
+  }
+  printf("Характеризация: %.1f с на 4 мотора в обе стороны\n", now / 1000.0);
+
+  MotorLinearizer lin;
+  bool ok = characterizer.build(lin);
+  printf("%s Таблица построена\n", ok ? "✓" : "✗");
+  if (!ok) return 1;
+  lin.setEnabled(true);
+
+  // 1. Монотонность каждой таблицы
+  ok = true;
+  for (int m = 0; m < 4; m++) {
+    for (int d = 0; d < 2; d++) {
+      for (int k = 1; k < LUT_POINTS; k++) {
+        if (lin.table[m][d][k] < lin.table[m][d][k - 1]) ok = false;
+      }
+    }
+  }
+  printf("%s Таблицы монотонны\n", ok ? "✓" : "✗");
+  if (!ok) failed++;
+
+  // 2. Скорость 1: скважность за мёртвой зоной, колесо трогается
+  ok = true;
+  for (int m = 0; m < 4; m++) {
+    for (int d = 0; d < 2; d++) {
+      int s = d == 0 ? 1 : -1;
+      double duty = fabs((double)lin.applyQ16(m + 1, s)) * SPEED_MAX / DUTY_Q16_ONE;
+      bool moves = wheelSpeed(lin, m, s) > 0;
+      printf("  %s M%d %s: мёртвая зона %.0f, скорость 1 -> скважность %.2f\n", moves ? "✓" : "✗", m + 1,
+             d == 0 ? "вперёд" : "назад ", curves[m][d].deadDuty, duty);
+      if (!moves) ok = false;
+    }
+  }
+  printf("%s Скорость 1 выводит из мёртвой зоны\n", ok ? "✓" : "✗");
+  if (!ok) failed++;
+
+  // 3. Одинаковая команда — одинаковая скорость (без таблицы — для сравнения)
+  MotorLinearizer raw;
+  static const int speeds[] = {32, 64, 128, 200, 255};
+  ok = true;
+  for (int s : speeds) {
+    double with = spreadPct(lin, s);
+    double without = spreadPct(raw, s);
+    bool sOk = with <= MAX_SPREAD_PCT;
+    printf("  %s Команда %3d: разброс %.1f%% (без таблицы %.1f%%)\n", sOk ? "✓" : "✗", s, with, without);
+    if (!sOk) ok = false;
+  }
+  printf("%s Разброс скоростей не больше %.0f%%\n", ok ? "✓" : "✗", MAX_SPREAD_PCT);
+  if (!ok) failed++;
+
+  return failed;
+}
@@ -0,0 +1,50 @@
+// Симуляция на ПК: pio run -e sim -t exec  (или .pio/build/sim/program [сценарий])
+
+#include <stdio.h>
+#include <string.h>
+
+#include "sim_scenarios.h"
+
+struct Scenario {
+  const char *name;
+  const char *description;
+  int (*run)();
+};
+
+static const Scenario scenarios[] = {
+  {"odometry", "Одометрия по энкодерам и по командам против истинной позы", runOdometryScenario},
+  {"heading",  "Удержание курса по гироскопу при стрейфе с разбросом моторов", runHeadingScenario},
+  {"traction", "Поиск буксующего колеса и антибукс при плохом сцеплении", runTractionScenario},
+  {"link",     "Проводная связь COBS через псевдотерминал: команды, шум журнала, битые кадры", runLinkScenario},
+  {"latency",  "Сверка часов и запоздавшие кадры джойстика при заторах в сети", runLatencyScenario},
+  {"path",     "Проезд маршрута по точкам: pure pursuit и курс по одометрии энкодеров", runPathScenario},
+  {"fixed",    "Фиксированная точка против libm: точность таблиц, насыщение, время против float", runFixedScenario},
+  {"obstacle", "Ограничение скорости у стен: кольцо датчиков, опрос по кругу, замолчавший датчик", runObstacleScenario},
+  {"battery",  "Батарея: шум и просадка через фильтр, отсечка с гистерезисом, компенсация PWM", runBatteryScenario},
+  {"power",    "Ограничение по току: заклинивание, повторная попытка, сброс, бюджет мощности", runPowerScenario},
+  {"lut",      "Характеризация моторов: мёртвая зона, монотонная таблица, одинаковая скорость", runLutScenario},
+  {"mix",      "Одна кинематика: кнопки, joy: и drive: дают один рисунок колёс", runMixScenario},
+};
+
+int main(int argc, char **argv) {
+  const char *only = argc > 1 ? argv[1] : nullptr;
+  int failed = 0;
+  int ran = 0;
+
+  for (const Scenario &s : scenarios) {
+    if (only != nullptr && strcmp(only, s.name) != 0) continue;
+    printf("==================== %s ====================\n%s\n\n", s.name, s.description);
+    int rc = s.run();
+    printf("%s %s\n\n", rc == 0 ? "✓" : "✗", s.name);
+    if (rc != 0) failed++;
+    ran++;
+  }
+
+  if (ran == 0) {
+    printf("Неизвестный сценарий: %s\nДоступные:", only);
+    for (const Scenario &s : scenarios) printf(" %s", s.name);
+    printf("\n");
+    return 2;
+  }
+  return failed == 0 ? 0 : 1;
+}
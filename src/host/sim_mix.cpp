@@ -0,0 +1,88 @@
+// Одна кинематика на все пути команд (drive_mix.cpp): кнопка, "joy:" в
+// omni и tank и "drive:vx:vy:w" с тем же намерением дают один и тот же
+// рисунок колёс, а прямая кинематика одометрии двигает корпус туда, куда
+// названа кнопка. Команды идут через ядро команд (simApplyCommands) и
+// computeWheels, как в такте управления.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../commands.h"
+#include "../drive_mix.h"
+#include "../odometry.h"
+#include "sim_scenarios.h"
+
+#define MIX_SPEED 200
+
+struct MixCase {
+  const char *preset;
+  const char *same[2];      // Команды с тем же намерением (nullptr — нет)
+  int forward, left, turn;  // Ожидаемые знаки движения корпуса
+};
+
+static const MixCase cases[] = {
+  {"forward",      {"drive:0:200:0",  "mode_omni;joy:0:200"},   1,  0,  0},
+  {"backward",     {"drive:0:-200:0", "mode_tank;joy:0:-200"}, -1,  0,  0},
+  {"right",        {"drive:200:0:0",  "mode_omni;joy:200:0"},   0, -1,  0},
+  {"left",         {"drive:-200:0:0", "mode_omni;joy:-200:0"},  0,  1,  0},
+  {"rotate_left",  {"drive:0:0:200",  "mode_tank;joy:-200:0"},  0,  0,  1},
+  {"rotate_right", {"drive:0:0:-200", "mode_tank;joy:200:0"},   0,  0, -1},
+  {"diag_fr",      {"drive:200:200:0", "mode_omni;joy:200:200"}, 1, -1, 0},
+  {"diag_bl",      {"drive:-200:-200:0", "mode_omni;joy:-200:-200"}, -1, 1, 0},
+};
+
+static bool wheelsFor(const char *batch, int wheels[4]) {
+  RobotState st = defaultRobotState();
+  st.config.speed = MIX_SPEED;
+  if (!simApplyCommands(st, batch)) return false;
+  computeWheels(st, wheels);
+  return true;
+}
+
+static int peak(const int w[4]) {
+  int p = 0;
+  for (int i = 0; i < 4; i++) p = abs(w[i]) > p ? abs(w[i]) : p;
+  return p;
+}
+
+// Один рисунок с точностью до общего множителя (пик может быть ограничен)
+static bool samePattern(const int a[4], const int b[4]) {
+  int pa = peak(a), pb = peak(b);
+  if (pa == 0 || pb == 0) return pa == pb;
+  for (int i = 0; i < 4; i++) {
+    if (abs(a[i] * pb - b[i] * pa) > pa + pb) return false;
+  }
+  return true;
+}
+
+static int sign(int32_t v) {
+  return v > 0 ? 1 : (v < 0 ? -1 : 0);
+}
+
+int runMixScenario() {
+  int failed = 0;
+
+  for (const MixCase &c : cases) {
+    int ref[4];
+    bool ok = wheelsFor(c.preset, ref);
+
+    // Прямая кинематика: корпус движется туда, куда названа кнопка
+    Odometry odom;
+    odom.updateFromCommands(ref, 100);
+    const OdomPose &p = odom.pose();
+    ok = ok && sign(p.vForwardMmps) == c.forward && sign(p.vLeftMmps) == c.left && sign(p.omegaMradps) == c.turn;
+    printf("%s %-13s {%4d %4d %4d %4d}  вперёд %+4d мм/с, влево %+4d мм/с, поворот %+5d мрад/с\n", ok ? "✓" : "✗",
+           c.preset, ref[0], ref[1], ref[2], ref[3], p.vForwardMmps, p.vLeftMmps, p.omegaMradps);
+    if (!ok) failed++;
+
+    for (const char *cmd : c.same) {
+      if (cmd == nullptr) continue;
+      int w[4];
+      bool same = wheelsFor(cmd, w) && samePattern(ref, w);
+      printf("  %s %-26s {%4d %4d %4d %4d}\n", same ? "✓" : "✗", cmd, w[0], w[1], w[2], w[3]);
+      if (!same) failed++;
+    }
+  }
+  return failed;
+}
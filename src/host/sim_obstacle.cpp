@@ -0,0 +1,177 @@
+// Ограничение скорости у препятствий (obstacle_governor.cpp) на модели
+// шасси. Кольцо датчиков — как на плате (kBoard.ranges), расстояние каждому
+// считается лучами от ИСТИННОЙ позы до стен, опрос — тем же планировщиком,
+// что на роботе, с задержкой и шумом измерения. Проверяется: робот на
+// полном ходу останавливается перед стеной; вдоль стены и от неё едет как
+// без неё; замолчавший датчик ограничивает скорость к себе.
+
+#include <math.h>
+#include <stdio.h>
+
+#include "../board.h"
+#include "../drive_mix.h"
+#include "../obstacle_governor.h"
+#include "../range.h"
+#include "sim_chassis.h"
+#include "sim_scenarios.h"
+
+#define SIM_TICK_MS 10
+#define ROBOT_HALF_MM 120.0           // От центра до бампера
+#define BEAM_HALF_DEG 15.0            // Конус HC-SR04: луч по центру и по краям
+#define MIN_GAP_MM 50.0               // Бампер не ближе к стене
+#define MAX_STOP_GAP_MM 350.0         // ...и не дальше (не тормозим слишком рано)
+#define MIN_FREE_RATIO 0.9            // Движение вдоль/от стены — как без неё
+
+// Стена — прямая x = c или y = c в мировой системе
+struct SimWall {
+  bool alongY;      // true: x = c
+  double c;
+};
+
+struct ObstacleRun {
+  double x, y;              // Итоговая истинная позиция, мм
+  double maxX;
+  int maxForward;           // Наибольшая поступательная команда вперёд после ограничения
+  uint32_t triggers;
+};
+
+// Расстояние от датчика до ближайшей стены по лучу, мм
+static double castRay(double ox, double oy, double angle, const SimWall *walls, int wallCount) {
+  double best = RANGE_MAX_MM;
+  double dx = cos(angle), dy = sin(angle);
+  for (int w = 0; w < wallCount; w++) {
+    double d = walls[w].alongY ? dx : dy;
+    double o = walls[w].alongY ? ox : oy;
+    if (fabs(d) < 1e-9) continue;
+    double t = (walls[w].c - o) / d;
+    if (t > 0 && t < best) best = t;
+  }
+  return best;
+}
+
+static double sensorDistance(const SimChassis &ch, const BoardRange &r, const SimWall *walls, int wallCount) {
+  double th = ch.theta();
+  double ox = ch.x() + r.xMm * cos(th) - r.yMm * sin(th);
+  double oy = ch.y() + r.xMm * sin(th) + r.yMm * cos(th);
+  double dir = th + r.directionDeg * M_PI / 180;
+  double best = RANGE_MAX_MM;
+  for (int k = -1; k <= 1; k++) {
+    double d = castRay(ox, oy, dir + k * BEAM_HALF_DEG * M_PI / 180, walls, wallCount);
+    // Боковой луч до той же стены длиннее: эхо приходит по нормали
+    if (d < best) best = d;
+  }
+  return best;
+}
+
+// vx — вправо, vy — вперёд (как "drive:vx:vy:w"). failAtMs: с этого
+// момента передний датчик молчит (0 — никогда).
+static ObstacleRun drive(const SimWall *walls, int wallCount, int vx, int vy, uint32_t ms, bool governed,
+                         uint32_t failAtMs = 0) {
+  SimChassis chassis(defaultSimChassisParams());
+  SimulatedRanges ranges(kBoard.rangeCount);
+  ranges.setNoise(5);
+  RangeScheduler scheduler;
+  ObstacleGovernor governor;
+  for (uint8_t i = 0; i < kBoard.rangeCount; i++) {
+    governor.setDirection(i, degreesToAngle(kBoard.ranges[i].directionDeg));
+  }
+
+  ObstacleRun run = {0, 0, 0, 0, 0};
+  for (uint32_t t = 0; t < ms; t += SIM_TICK_MS) {
+    for (uint8_t i = 0; i < kBoard.rangeCount; i++) {
+      ranges.setDistance(i, (uint16_t)sensorDistance(chassis, kBoard.ranges[i], walls, wallCount));
+    }
+    if (failAtMs != 0 && t >= failAtMs) ranges.setFailed(0, true);
+    scheduler.tick(ranges, t);
+    governor.update(scheduler, t);
+
+    int wheels[4];
+    computeAxes(vx, vy, 0, wheels);
+    if (governed) governor.apply(wheels);
+    if (failAtMs != 0 && t >= failAtMs + RANGE_STALE_MS + RANGE_TIMEOUT_MS) {
+      int forward = (wheels[0] + wheels[1] + wheels[2] + wheels[3]) / 4;
+      if (forward > run.maxForward) run.maxForward = forward;
+    }
+    chassis.step(wheels, SIM_TICK_MS / 1000.0);
+    if (chassis.x() > run.maxX) run.maxX = chassis.x();
+  }
+  run.x = chassis.x();
+  run.y = chassis.y();
+  run.triggers = ranges.triggers();
+  return run;
+}
+
+int runObstacleScenario() {
+  int failed = 0;
+
+  printf("Кольцо: %u датчиков, стоп %d мм, без ограничения с %d мм, вслепую до %d\n", kBoard.rangeCount,
+         OBSTACLE_STOP_MM, OBSTACLE_SLOW_MM, OBSTACLE_BLIND_SPEED);
+
+  // 1. Полный ход на стену в 1.5 м
+  SimWall ahead[] = {{true, 1500}};
+  ObstacleRun head = drive(ahead, 1, 0, 255, 6000, true);
+  double gap = 1500 - ROBOT_HALF_MM - head.maxX;
+  double refreshHz = head.triggers / 6.0 / kBoard.rangeCount;
+  bool ok = gap >= MIN_GAP_MM && gap <= MAX_STOP_GAP_MM;
+  printf("%s На стену полным ходом: зазор %.0f мм (допуск %.0f..%.0f), опрос %.1f Гц на датчик\n",
+         ok ? "✓" : "✗", gap, MIN_GAP_MM, MAX_STOP_GAP_MM, refreshHz);
+  if (!ok) failed++;
+
+  // То же без ограничения: в модели нет столкновений, робот проезжает
+  // стену — значит, останавливает именно ограничение
+  ObstacleRun blind = drive(ahead, 1, 0, 255, 6000, false);
+  ok = blind.maxX > 1500 - ROBOT_HALF_MM;
+  printf("%s Без ограничения: бампер прошёл бы стену на %.0f мм\n", ok ? "✓" : "✗",
+         blind.maxX + ROBOT_HALF_MM - 1500);
+  if (!ok) failed++;
+
+  // 2. Стрейф вдоль стены в 400 мм впереди — как в чистом поле
+  SimWall close[] = {{true, 400}};
+  ObstacleRun along = drive(close, 1, 200, 0, 3000, true);
+  ObstacleRun alongFree = drive(nullptr, 0, 200, 0, 3000, true);
+  double ratio = along.y / alongFree.y;
+  ok = ratio >= MIN_FREE_RATIO && along.maxX < 400 - ROBOT_HALF_MM - MIN_GAP_MM;
+  printf("%s Вдоль стены: %.0f мм против %.0f в поле (%.0f%%), вперёд %.0f мм\n", ok ? "✓" : "✗", -along.y,
+         -alongFree.y, ratio * 100, along.maxX);
+  if (!ok) failed++;
+
+  // 3. Назад от стены в 300 мм
+  SimWall touching[] = {{true, 300}};
+  ObstacleRun back = drive(touching, 1, 0, -200, 2000, true);
+  ObstacleRun backFree = drive(nullptr, 0, 0, -200, 2000, true);
+  ratio = back.x / backFree.x;
+  ok = ratio >= MIN_FREE_RATIO;
+  printf("%s Назад от стены: %.0f мм против %.0f в поле (%.0f%%)\n", ok ? "✓" : "✗", -back.x, -backFree.x,
+         ratio * 100);
+  if (!ok) failed++;
+
+  // 4. По диагонали вперёд-вправо на стену: вперёд — до стены, вправо — дальше
+  SimWall diag[] = {{true, 1200}};
+  ObstacleRun slant = drive(diag, 1, 180, 180, 5000, true);
+  ObstacleRun slantFree = drive(nullptr, 0, 180, 180, 5000, true);
+  gap = 1200 - ROBOT_HALF_MM - slant.maxX;
+  ratio = slant.y / slantFree.y;
+  ok = gap >= MIN_GAP_MM && gap <= MAX_STOP_GAP_MM && ratio >= MIN_FREE_RATIO;
+  printf("%s По диагонали: зазор %.0f мм, вправо %.0f мм против %.0f в поле (%.0f%%)\n", ok ? "✓" : "✗", gap,
+         -slant.y, -slantFree.y, ratio * 100);
+  if (!ok) failed++;
+
+  // 5. В угол: стены впереди и справа, едем по диагонали в угол
+  SimWall corner[] = {{true, 900}, {false, -700}};
+  ObstacleRun cornered = drive(corner, 2, 200, 200, 6000, true);
+  double gapFront = 900 - ROBOT_HALF_MM - cornered.maxX;
+  double gapRight = cornered.y - (-700) - ROBOT_HALF_MM;
+  ok = gapFront >= MIN_GAP_MM && gapRight >= MIN_GAP_MM;
+  printf("%s В угол: зазор спереди %.0f мм, справа %.0f мм\n", ok ? "✓" : "✗", gapFront, gapRight);
+  if (!ok) failed++;
+
+  // 6. Передний датчик замолчал на ходу: к нему — не быстрее OBSTACLE_BLIND_SPEED
+  SimWall far[] = {{true, 20000}};
+  ObstacleRun deaf = drive(far, 1, 0, 255, 3000, true, 1000);
+  ok = deaf.maxForward <= OBSTACLE_BLIND_SPEED + 1;
+  printf("%s Датчик замолчал: команда вперёд %d (предел %d)\n", ok ? "✓" : "✗", deaf.maxForward,
+         OBSTACLE_BLIND_SPEED);
+  if (!ok) failed++;
+
+  return failed;
+}
@@ -0,0 +1,83 @@
+// Одометрия (odometry.cpp) на модели шасси: энкодеры должны давать позу
+// с точностью до квантования, команды — заметный дрейф из-за разброса моторов.
+
+#include <math.h>
+#include <stdio.h>
+
+#include "../odometry.h"
+#include "sim_chassis.h"
+#include "sim_scenarios.h"
+
+struct Segment {
+  const char *name;
+  int wheels[4];
+  double seconds;
+};
+
+static const Segment route[] = {
+  {"вперёд",        { 200,  200,  200,  200}, 2.0},
+  {"вправо",        { 200, -200, -200,  200}, 2.0},
+  {"назад",         {-200, -200, -200, -200}, 2.0},
+  {"влево",         {-200,  200,  200, -200}, 2.0},
+  {"разворот",      {-150,  150, -150,  150}, 3.0},
+  {"дуга",          { 100,  200,  100,  200}, 5.0},
+  {"стоп",          {   0,    0,    0,    0}, 1.0},
+};
+
+#define SIM_TICK_MS 10
+#define MAX_POS_ERROR_MM 5.0
+#define MAX_HEADING_ERROR_DEG 1.0
+
+static void poseError(const OdomPose &pose, const SimChassis &chassis, double &posMm, double &headingDeg) {
+  double dx = pose.xUm / 1000.0 - chassis.x();
+  double dy = pose.yUm / 1000.0 - chassis.y();
+  posMm = sqrt(dx * dx + dy * dy);
+
+  double th = angleToMrad(pose.heading) / 1000.0;
+  double d = remainder(th - chassis.theta(), 2 * M_PI);
+  headingDeg = fabs(d) * 180 / M_PI;
+}
+
+int runOdometryScenario() {
+  SimChassisParams params = defaultSimChassisParams();
+  const double gains[4] = {1.0, 0.93, 1.04, 0.97};
+  for (int i = 0; i < 4; i++) params.wheelGain[i] = gains[i];
+
+  SimChassis chassis(params);
+  Odometry encoderOdom;
+  Odometry commandOdom;
+
+  double worstPos = 0, worstHeading = 0;
+
+  printf("%-10s %10s %10s %8s | %9s %7s | %9s %7s\n", "участок", "x, мм", "y, мм", "θ, °",
+         "энк., мм", "энк., °", "ком., мм", "ком., °");
+
+  for (const Segment &seg : route) {
+    int ticks = (int)(seg.seconds * 1000 / SIM_TICK_MS);
+    for (int t = 0; t < ticks; t++) {
+      chassis.step(seg.wheels, SIM_TICK_MS / 1000.0);
+
+      int32_t counts[4];
+      chassis.readCounts(counts);
+      encoderOdom.updateFromCounts(counts, SIM_TICK_MS);
+      commandOdom.updateFromCommands(seg.wheels, SIM_TICK_MS);
+
+      double posErr, headErr;
+      poseError(encoderOdom.pose(), chassis, posErr, headErr);
+      if (posErr > worstPos) worstPos = posErr;
+      if (headErr > worstHeading) worstHeading = headErr;
+    }
+
+    double encPos, encHead, cmdPos, cmdHead;
+    poseError(encoderOdom.pose(), chassis, encPos, encHead);
+    poseError(commandOdom.pose(), chassis, cmdPos, cmdHead);
+    printf("%-10s %10.1f %10.1f %8.1f | %9.2f %7.2f | %9.1f %7.1f\n", seg.name,
+           chassis.x(), chassis.y(), chassis.theta() * 180 / M_PI,
+           encPos, encHead, cmdPos, cmdHead);
+  }
+
+  printf("\nЭнкодеры: худшая ошибка %.2f мм, %.2f° (допуск %.1f мм, %.1f°)\n",
+         worstPos, worstHeading, MAX_POS_ERROR_MM, MAX_HEADING_ERROR_DEG);
+
+  return worstPos <= MAX_POS_ERROR_MM && worstHeading <= MAX_HEADING_ERROR_DEG ? 0 : 1;
+}
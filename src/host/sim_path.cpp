@@ -0,0 +1,114 @@
+// Проезд маршрута (path_follower.cpp) на модели шасси с разбросом моторов.
+// Маршрут загружается теми же текстовыми командами, что по WebSocket
+// ("path_clear;wp:x:y:h;...;path_go"), поза — одометрия по энкодерам,
+// как на роботе; проверяется ИСТИННАЯ поза модели: робот доехал до
+// последней точки, не ушёл с ломаной и развернулся, не сходя с линии.
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "../commands.h"
+#include "../odometry.h"
+#include "../path_follower.h"
+#include "sim_chassis.h"
+#include "sim_scenarios.h"
+
+#define SIM_TICK_MS 10
+#define PATH_TIMEOUT_MS 30000
+#define MAX_FINAL_ERROR_MM 30.0
+#define MAX_FINAL_HEADING_DEG 3.0
+#define MAX_CORNER_DEVIATION_MM 50.0  // Pure pursuit срезает углы: цель уже на следующем отрезке
+#define MAX_LINE_DEVIATION_MM 25.0    // Прямой участок с поворотом корпуса на ходу
+
+struct PathRoute {
+  const char *name;
+  const char *commands;         // Пакет, как его шлёт страница
+  double maxDeviationMm;
+};
+
+static const PathRoute routes[] = {
+  {"квадрат стрейфом",  "path_clear;wp:1000:0:0;wp:1000:1000:0;wp:0:1000:0;wp:0:0:0;path_go",
+   MAX_CORNER_DEVIATION_MM},
+  {"разворот на ходу",  "path_clear;path_speed:400;wp:1500:0:180;path_go", MAX_LINE_DEVIATION_MM},
+  {"квадрат с курсами", "path_clear;wp:800:0:90;wp:800:800:180;wp:0:800:-90;wp:0:0:0;path_go",
+   MAX_CORNER_DEVIATION_MM},
+  {"поворот на месте",  "path_clear;wp:300:0:0;wp:300:0:120;wp:600:0:120;path_go", MAX_LINE_DEVIATION_MM},
+};
+
+// Расстояние от точки до отрезка, мм
+static double segmentDistance(double px, double py, double ax, double ay, double bx, double by) {
+  double dx = bx - ax, dy = by - ay;
+  double len2 = dx * dx + dy * dy;
+  double t = len2 > 0 ? ((px - ax) * dx + (py - ay) * dy) / len2 : 0;
+  if (t < 0) t = 0;
+  if (t > 1) t = 1;
+  return hypot(px - (ax + t * dx), py - (ay + t * dy));
+}
+
+static int runRoute(const PathRoute &route) {
+  SimChassisParams params = defaultSimChassisParams();
+  const double gains[4] = {1.0, 0.92, 1.05, 0.96};
+  for (int i = 0; i < 4; i++) params.wheelGain[i] = gains[i];
+  SimChassis chassis(params);
+  Odometry odometry;
+  PathFollower follower;
+
+  RobotState st = defaultRobotState();
+  if (!simApplyCommands(st, route.commands)) {
+    printf("  %-20s ✗ пакет команд не принят\n", route.name);
+    return 1;
+  }
+
+  double worstDeviation = 0;
+  uint32_t t = 0;
+  for (; t < PATH_TIMEOUT_MS; t += SIM_TICK_MS) {
+    int32_t counts[4];
+    chassis.readCounts(counts);
+    odometry.updateFromCounts(counts, SIM_TICK_MS);
+
+    // Как controlStep: новый "path_go" — старт из текущей позы
+    if (follower.seq() != st.path.seq) follower.start(st.path, odometry.pose());
+
+    BodyVelocity v;
+    int wheels[4] = {0, 0, 0, 0};
+    bool driving = follower.update(st.path, odometry.pose(), SIM_TICK_MS, v);
+    if (driving) bodyToWheels(v, wheels);
+    chassis.step(wheels, SIM_TICK_MS / 1000.0);
+
+    // Отклонение истинной позы от ломаной маршрута (от точки старта)
+    double best = 1e9, ax = 0, ay = 0;
+    for (int k = 0; k < st.path.count; k++) {
+      double bx = st.path.points[k].xMm, by = st.path.points[k].yMm;
+      double d = segmentDistance(chassis.x(), chassis.y(), ax, ay, bx, by);
+      if (d < best) best = d;
+      ax = bx;
+      ay = by;
+    }
+    if (best > worstDeviation) worstDeviation = best;
+
+    if (!driving) break;
+  }
+
+  const Waypoint &goal = st.path.points[st.path.count - 1];
+  double finalError = hypot(chassis.x() - goal.xMm, chassis.y() - goal.yMm);
+  double goalDeg = angleToMrad(goal.heading) / 1000.0 * 180 / M_PI;
+  double headingError = fabs(remainder(chassis.theta() * 180 / M_PI - goalDeg, 360));
+
+  bool done = follower.state() == PATH_DONE;
+  bool ok = done && finalError <= MAX_FINAL_ERROR_MM && headingError <= MAX_FINAL_HEADING_DEG &&
+            worstDeviation <= route.maxDeviationMm;
+  printf("  %-20s %s %5.1f с, в конце %5.1f мм / %4.1f°, отклонение до %5.1f мм (допуск %.0f)\n",
+         route.name, ok ? "✓" : "✗", t / 1000.0, finalError, headingError, worstDeviation, route.maxDeviationMm);
+  if (!done) printf("    маршрут не пройден: %s, точка %u из %u\n", pathStateName(follower.state()),
+                    follower.index() + 1, follower.count());
+  return ok ? 0 : 1;
+}
+
+int runPathScenario() {
+  int failures = 0;
+  for (const PathRoute &route : routes) failures += runRoute(route);
+  printf("\nДопуски: конечная точка %.0f мм и %.0f°, моторы с разбросом до 8%%\n",
+         MAX_FINAL_ERROR_MM, MAX_FINAL_HEADING_DEG);
+  return failures;
+}
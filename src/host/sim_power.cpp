@@ -0,0 +1,148 @@
+// Ограничение по току (power_guard.cpp) на модели тока моторов: ток
+// пропорционален скважности, коэффициент свой у каждого колеса (свободное,
+// под нагрузкой, заклинившее). Проверяется: заклинивание ловится за STALL_DETECT_MS и
+// ограничивается на STALL_COOLDOWN_MS, затем повторная попытка; вращающееся
+// колесо с большим током не считается заклинившим; reset() снимает
+// ограничение сразу; бюджет масштабирует все колёса одним коэффициентом
+// и возвращается к 1.0, а при не реагирующем токе упирается в нижний предел.
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../power_guard.h"
+#include "sim_scenarios.h"
+
+#define SIM_TICK_MS 10
+#define FREE_MA 800                   // Ток на полной команде: колесо вращается свободно
+#define LOADED_MA 1600                //   ...робот толкает груз
+#define STALL_MA 2800                 //   ...колесо заклинило
+#define BUDGET_TOLERANCE_MA 300       // Установившийся суммарный ток у бюджета
+
+struct PowerModel {
+  uint16_t maAt255[4];
+  uint16_t fixedMa;                   // != 0: ток не зависит от команды
+
+  void currents(const int wheels[4], uint16_t ma[4]) const {
+    for (int i = 0; i < 4; i++) {
+      ma[i] = fixedMa != 0 ? fixedMa : (uint16_t)(abs(wheels[i]) * maAt255[i] / 255);
+    }
+  }
+};
+
+struct PowerTrace {
+  uint32_t foldbackAtMs;    // Первый такт с ограничением колеса 0 (0 — не было)
+  uint32_t releaseAtMs;     // Первый такт после него без ограничения
+  int lastWheels[4];
+  uint32_t lastTotalMa;
+};
+
+// command — команды колёс до ограничения; speeds == nullptr — датчиков нет
+static PowerTrace run(PowerGuard &guard, const PowerModel &model, const int command[4], const int32_t *speeds,
+                      uint32_t fromMs, uint32_t ms) {
+  PowerTrace tr = {0, 0, {0, 0, 0, 0}, 0};
+  int prev[4] = {command[0], command[1], command[2], command[3]};
+  for (uint32_t t = fromMs; t < fromMs + ms; t += SIM_TICK_MS) {
+    // Ток этого такта — от команды, записанной в прошлом такте
+    uint16_t ma[4];
+    model.currents(prev, ma);
+    int wheels[4] = {command[0], command[1], command[2], command[3]};
+    guard.apply(wheels, ma, speeds, t);
+
+    bool limited = (guard.stalledMask() & 1) != 0;
+    if (limited && tr.foldbackAtMs == 0) tr.foldbackAtMs = t;
+    if (!limited && tr.foldbackAtMs != 0 && tr.releaseAtMs == 0) tr.releaseAtMs = t;
+    for (int i = 0; i < 4; i++) prev[i] = wheels[i];
+    tr.lastTotalMa = guard.totalMilliamps();
+  }
+  for (int i = 0; i < 4; i++) tr.lastWheels[i] = prev[i];
+  return tr;
+}
+
+int runPowerScenario() {
+  int failed = 0;
+  const int forward[4] = {200, 200, 200, 200};
+
+  printf("Заклинивание: %d мА за %d мс -> %d на %d мс; бюджет %d мА, не ниже %d/256\n", STALL_CURRENT_MA,
+         STALL_DETECT_MS, STALL_FOLDBACK_DUTY, STALL_COOLDOWN_MS, POWER_BUDGET_MA, POWER_MIN_SCALE_Q8);
+
+  // 1. Колесо 0 упёрлось: ограничение через STALL_DETECT_MS, остальные не тронуты
+  PowerModel stuck = {{STALL_MA, FREE_MA, FREE_MA, FREE_MA}, 0};
+  PowerGuard guard;
+  PowerTrace tr = run(guard, stuck, forward, nullptr, 1000, 1000);
+  uint32_t detectMs = tr.foldbackAtMs - 1000;
+  bool ok = tr.foldbackAtMs != 0 && detectMs >= STALL_DETECT_MS && detectMs <= STALL_DETECT_MS + 2 * SIM_TICK_MS &&
+            tr.lastWheels[0] == STALL_FOLDBACK_DUTY && tr.lastWheels[1] == 200 && guard.stalledMask() == 1;
+  printf("%s Заклинивание: через %u мс, колесо 0 -> %d, остальные %d\n", ok ? "✓" : "✗", detectMs,
+         tr.lastWheels[0], tr.lastWheels[1]);
+  if (!ok) failed++;
+
+  // 2. Колесо освободилось: ограничение держится STALL_COOLDOWN_MS, затем полная команда
+  PowerModel freed = {{FREE_MA, FREE_MA, FREE_MA, FREE_MA}, 0};
+  PowerTrace cool = run(guard, freed, forward, nullptr, 2000, 2000);
+  uint32_t heldMs = cool.releaseAtMs - tr.foldbackAtMs;
+  ok = cool.releaseAtMs != 0 && heldMs >= STALL_COOLDOWN_MS && heldMs <= STALL_COOLDOWN_MS + 2 * SIM_TICK_MS &&
+       cool.lastWheels[0] == 200;
+  printf("%s Повторная попытка через %u мс, колесо 0 снова %d\n", ok ? "✓" : "✗", heldMs, cool.lastWheels[0]);
+  if (!ok) failed++;
+
+  // 3. Всё ещё упёрто: после попытки снова ограничение
+  PowerGuard retryGuard;
+  PowerTrace again = run(retryGuard, stuck, forward, nullptr, 1000, 3000);
+  ok = again.releaseAtMs != 0 && retryGuard.stalledMask() == 1 && again.lastWheels[0] == STALL_FOLDBACK_DUTY;
+  printf("%s Всё ещё упёрто: попытка на %u мс, затем снова %d\n", ok ? "✓" : "✗", again.releaseAtMs - 1000,
+         again.lastWheels[0]);
+  if (!ok) failed++;
+
+  // 4. Большой ток, но колесо вращается (датчик скорости): не заклинивание
+  PowerGuard movingGuard;
+  const int32_t speeds[4] = {400, 400, 400, 400};
+  PowerTrace moving = run(movingGuard, stuck, forward, speeds, 1000, 1000);
+  ok = moving.foldbackAtMs == 0 && moving.lastWheels[0] == 200;
+  printf("%s Ток %d мА при вращении: без ограничения\n", ok ? "✓" : "✗", 200 * STALL_MA / 255);
+  if (!ok) failed++;
+
+  // 5. reset() (остановка, смена режима) сразу после срабатывания снимает ограничение
+  PowerGuard resetGuard;
+  run(resetGuard, stuck, forward, nullptr, 1000, 400);
+  bool wasLimited = resetGuard.stalledMask() == 1;
+  resetGuard.reset();
+  PowerTrace afterReset = run(resetGuard, freed, forward, nullptr, 1400, SIM_TICK_MS);
+  ok = wasLimited && afterReset.lastWheels[0] == 200 && resetGuard.stalledMask() == 0;
+  printf("%s reset() после срабатывания: колесо 0 сразу %d\n", ok ? "✓" : "✗", afterReset.lastWheels[0]);
+  if (!ok) failed++;
+
+  // 6. Бюджет: смешанная команда с перерасходом — ток к бюджету, пропорции сохраняются
+  PowerGuard budgetGuard;
+  PowerModel loaded = {{LOADED_MA, LOADED_MA, LOADED_MA, LOADED_MA}, 0};
+  const int mixed[4] = {255, 128, -255, -128};
+  PowerTrace budget = run(budgetGuard, loaded, mixed, nullptr, 0, 2000);
+  int32_t want = (int32_t)budget.lastWheels[0] * 128;
+  int32_t got = (int32_t)budget.lastWheels[1] * 255;
+  ok = budget.lastTotalMa <= POWER_BUDGET_MA + BUDGET_TOLERANCE_MA &&
+       budget.lastTotalMa + BUDGET_TOLERANCE_MA >= POWER_BUDGET_MA &&
+       abs(want - got) <= 255 && budget.lastWheels[2] == -budget.lastWheels[0] &&
+       budget.lastWheels[3] == -budget.lastWheels[1];
+  printf("%s Бюджет: %u мА (без ограничения %u), команды %d %d %d %d, scale %u/256\n", ok ? "✓" : "✗",
+         budget.lastTotalMa, (255 + 128) * 2 * LOADED_MA / 255, budget.lastWheels[0], budget.lastWheels[1],
+         budget.lastWheels[2], budget.lastWheels[3], budgetGuard.scaleQ8());
+  if (!ok) failed++;
+
+  // 7. Нагрузка снята: коэффициент возвращается к 1.0
+  const int gentle[4] = {100, 100, 100, 100};
+  PowerTrace recovered = run(budgetGuard, freed, gentle, nullptr, 2000, 1000);
+  ok = budgetGuard.scaleQ8() == 256 && recovered.lastWheels[0] == 100;
+  printf("%s Без перерасхода: scale %u/256, команда %d\n", ok ? "✓" : "✗", budgetGuard.scaleQ8(),
+         recovered.lastWheels[0]);
+  if (!ok) failed++;
+
+  // 8. Ток не реагирует на команду (датчик врёт, КЗ): не ниже POWER_MIN_SCALE_Q8
+  PowerGuard floorGuard;
+  PowerModel deaf = {{0, 0, 0, 0}, 2000};
+  PowerTrace floor = run(floorGuard, deaf, forward, speeds, 0, 3000);
+  ok = floorGuard.scaleQ8() == POWER_MIN_SCALE_Q8 && floor.lastWheels[0] == 200 * POWER_MIN_SCALE_Q8 / 256;
+  printf("%s Ток не реагирует: scale %u/256, команда %d\n", ok ? "✓" : "✗", floorGuard.scaleQ8(),
+         floor.lastWheels[0]);
+  if (!ok) failed++;
+
+  return failed;
+}
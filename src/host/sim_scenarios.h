@@ -0,0 +1,22 @@
+#pragma once
+
+// Сценарии симуляции на ПК. Каждый возвращает 0, если проверка пройдена.
+
+struct RobotState;
+
+// Пакет "cmd1;cmd2;..." через ядро команд (sim_commands.cpp) поверх st.
+// false — пакет отклонён, st не изменён.
+bool simApplyCommands(RobotState &st, const char *batch);
+
+int runOdometryScenario();
+int runHeadingScenario();
+int runTractionScenario();
+int runLinkScenario();
+int runLatencyScenario();
+int runPathScenario();
+int runFixedScenario();
+int runObstacleScenario();
+int runBatteryScenario();
+int runPowerScenario();
+int runLutScenario();
+int runMixScenario();
@@ -0,0 +1,111 @@
+// Проскальзывание (traction.cpp) на модели шасси с плохим сцеплением
+// одного колеса: резкий разгон срывает колесо M2 в буксование.
+// Проверяется, что детектор указывает на буксующее колесо, не срабатывает
+// при хорошем сцеплении, а снижение команды сокращает время буксования.
+
+#include <stdio.h>
+#include <string.h>
+
+#include "../odometry.h"
+#include "../traction.h"
+#include "sim_chassis.h"
+#include "sim_scenarios.h"
+
+#define SIM_TICK_MS 10
+#define SPEED_WINDOW_TICKS 4      // Скорость по энкодерам: разность за 40 мс
+#define SLIPPERY_WHEEL 1          // M2
+#define MIN_SLIP_REDUCTION 0.5    // Антибукс должен сократить буксование вдвое
+
+struct TractionSegment {
+  int wheels[4];
+  double seconds;
+};
+
+static const TractionSegment route[] = {
+  {{   0,    0,    0,    0}, 0.5},
+  {{ 255,  255,  255,  255}, 2.0},   // Резкий разгон вперёд
+  {{   0,    0,    0,    0}, 1.0},
+  {{-255,  255,  255, -255}, 1.5},   // Резкий старт влево
+  {{   0,    0,    0,    0}, 1.0},
+  {{-255, -255, -255, -255}, 2.0},   // Резкий разгон назад
+  {{   0,    0,    0,    0}, 1.0},
+};
+
+struct TractionRun {
+  int slipTicks;          // Тактов, когда колесо модели буксует под тягой
+  int flaggedTicks;       // Тактов, когда детектор указал колесо
+  int correctTicks;       // ...и это колесо действительно буксует
+  uint32_t events;
+};
+
+static TractionRun runRoute(bool slippery, bool control) {
+  SimChassisParams params = defaultSimChassisParams();
+  for (int i = 0; i < 4; i++) params.gripMmps[i] = 400;
+  if (slippery) params.gripMmps[SLIPPERY_WHEEL] = 120;
+
+  SimChassis chassis(params);
+  TractionControl traction;
+  TractionRun run = {0, 0, 0, 0};
+
+  int32_t history[SPEED_WINDOW_TICKS][4];
+  memset(history, 0, sizeof(history));
+  int tick = 0;
+
+  for (const TractionSegment &seg : route) {
+    int ticks = (int)(seg.seconds * 1000 / SIM_TICK_MS);
+    for (int t = 0; t < ticks; t++, tick++) {
+      // Скорости колёс по отсчётам энкодеров за окно
+      int32_t counts[4], speeds[4];
+      chassis.readCounts(counts);
+      int32_t *oldest = history[tick % SPEED_WINDOW_TICKS];
+      for (int i = 0; i < 4; i++) {
+        speeds[i] = Odometry::countsToUm(counts[i] - oldest[i]) / (SPEED_WINDOW_TICKS * SIM_TICK_MS);
+        oldest[i] = counts[i];
+      }
+
+      int wheels[4] = {seg.wheels[0], seg.wheels[1], seg.wheels[2], seg.wheels[3]};
+      int shaped[4];
+      memcpy(shaped, wheels, sizeof(shaped));
+      if (tick >= SPEED_WINDOW_TICKS) traction.apply(shaped, speeds);
+      chassis.step(control ? shaped : wheels, SIM_TICK_MS / 1000.0);
+
+      uint8_t flagged = traction.slipMask();
+      for (int i = 0; i < 4; i++) {
+        // Срыв при торможении (команда 0) антибукс не лечит и не считается
+        if (chassis.slipping(i) && seg.wheels[i] != 0) run.slipTicks++;
+        if (flagged & (1 << i)) {
+          run.flaggedTicks++;
+          if (chassis.slipping(i)) run.correctTicks++;
+        }
+      }
+    }
+  }
+  run.events = traction.events();
+  return run;
+}
+
+static void printRun(const char *name, const TractionRun &run) {
+  printf("  %-28s буксование %4d мс, указано %4d мс (верно %4d мс), событий %u\n", name,
+         run.slipTicks * SIM_TICK_MS, run.flaggedTicks * SIM_TICK_MS,
+         run.correctTicks * SIM_TICK_MS, run.events);
+}
+
+int runTractionScenario() {
+  TractionRun grip = runRoute(false, true);
+  TractionRun detect = runRoute(true, false);
+  TractionRun controlled = runRoute(true, true);
+
+  printRun("хорошее сцепление:", grip);
+  printRun("скользкое M2, только поиск:", detect);
+  printRun("скользкое M2, антибукс:", controlled);
+
+  bool noFalse = grip.events == 0;
+  bool accurate = detect.flaggedTicks > 0 && detect.correctTicks * 10 >= detect.flaggedTicks * 9;
+  double reduction = detect.slipTicks > 0 ? 1.0 - (double)controlled.slipTicks / detect.slipTicks : 0;
+
+  printf("\nЛожных срабатываний: %u, точность указания: %d%%, буксование сокращено на %.0f%%\n",
+         grip.events, detect.flaggedTicks > 0 ? detect.correctTicks * 100 / detect.flaggedTicks : 0,
+         reduction * 100);
+
+  return noFalse && accurate && reduction >= MIN_SLIP_REDUCTION ? 0 : 1;
+}
@@ -0,0 +1,450 @@
+// Заменитель робота на ПК: тот же протокол и то же ядро команд, что на
+// ESP32, но вместо AsyncWebServer — сокеты POSIX (ws_server.h), а вместо
+// моторов — модель шасси (sim_chassis.h). Для нагрузочных тестов
+// (ws_load.cpp) и работы со страницей управления без железа.
+//   pio run -e standin  &&  .pio/build/standin/program [порт] [-v] [-n роботов]
+//   браузер: http://localhost:8080/
+//
+// Флот: "-n N" запускает N роботов на портах порт..порт+N-1, каждый —
+// отдельным процессом (свои глобальные состояния, свой CPU, как у
+// отдельных ESP32). Ctrl+C останавливает всех.
+
+#include <errno.h>
+#include <malloc.h>
+#include <math.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/prctl.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "../command_core.h"
+#include "../drive_mix.h"
+#include "../fixed.h"
+#include "../web_page.h"
+#include "../ws_broadcast.h"
+#include "sim_chassis.h"
+#include "ws_server.h"
+
+#define STANDIN_PORT 8080
+#define STANDIN_FLEET_MAX 64          // Роботов в одном запуске "-n"
+#define CONTROL_PERIOD_MS 10          // Как на роботе: 100 Гц
+#define TELEMETRY_PERIOD_MS 500
+
+static uint32_t millis() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint32_t)(ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+}
+
+// ==================== СОСТОЯНИЕ ====================
+
+SeqLock<RobotState> robotState(defaultRobotState());
+WsBroadcaster broadcaster;
+WsFrameAssembler assembler;
+ClientClocks clientClocks;
+static bool verbose = false;
+static uint32_t startMs = 0;
+
+void commandLog(const char *fmt, ...) {
+  if (!verbose) return;
+  va_list ap;
+  va_start(ap, fmt);
+  vprintf(fmt, ap);
+  va_end(ap);
+}
+
+// ==================== ШАССИ ====================
+// Такт управления читает снимок, как controlTask на роботе, считает
+// скорости колёс тем же кодом (drive_mix.h) и двигает модель шасси.
+// Поза модели — истинная, без одометрии: её видно в потоке "pose:N".
+
+struct StandinPose {
+  int32_t xUm, yUm;
+  uint32_t heading;         // Двоичный угол (fixed.h)
+  int32_t vForwardMmps, vLeftMmps;
+  int32_t omegaMradps;
+};
+
+static std::atomic<uint32_t> controlTicks{0};
+static std::atomic<uint32_t> appliedChanges{0};
+static std::atomic<bool> running{true};
+static SeqLock<StandinPose> chassisPose(StandinPose{});
+
+static void controlLoop() {
+  SimChassis chassis(defaultSimChassisParams());
+  const double dtS = CONTROL_PERIOD_MS / 1000.0;
+  uint32_t lastSeq = 0;
+  while (running.load()) {
+    RobotState st;
+    uint32_t seq = robotState.read(st);
+    if (seq != lastSeq) {
+      appliedChanges.fetch_add(1, std::memory_order_relaxed);
+      lastSeq = seq;
+    }
+
+    int wheels[4];
+    computeWheels(st, wheels);
+    double x0 = chassis.x(), y0 = chassis.y();
+    chassis.step(wheels, dtS);
+
+    // Скорость в системе корпуса: смещение за такт, повёрнутое на -θ
+    double dx = (chassis.x() - x0) / dtS, dy = (chassis.y() - y0) / dtS;
+    double c = cos(chassis.theta()), s = sin(chassis.theta());
+    StandinPose pose;
+    pose.xUm = (int32_t)(chassis.x() * 1000);
+    pose.yUm = (int32_t)(chassis.y() * 1000);
+    pose.heading = uradToAngle((int64_t)(remainder(chassis.theta(), 2 * M_PI) * 1e6));
+    pose.vForwardMmps = (int32_t)(dx * c + dy * s);
+    pose.vLeftMmps = (int32_t)(-dx * s + dy * c);
+    pose.omegaMradps = (int32_t)(chassis.omega() * 1000);
+    chassisPose.write(pose);
+
+    controlTicks.fetch_add(1, std::memory_order_relaxed);
+    std::this_thread::sleep_for(std::chrono::milliseconds(CONTROL_PERIOD_MS));
+  }
+}
+
+// ==================== ОТВЕТЫ ====================
+
+static std::string configJson() {
+  RobotConfig cfg = robotState.read().config;
+  char buf[320];
+  snprintf(buf, sizeof(buf),
+           "{\"mapping\":[%d,%d,%d,%d],\"invert\":[%s,%s,%s,%s],\"omniMode\":%s,\"stopProfile\":%d,"
+           "\"linearize\":%s,\"headingHold\":%s,\"obstacle\":%s,\"maxAge\":%u,\"ageDecay\":%s,\"pwm\":[%u,%u,%u,%u]}",
+           cfg.motorMapping[0], cfg.motorMapping[1], cfg.motorMapping[2], cfg.motorMapping[3],
+           cfg.motorInvert[0] ? "true" : "false", cfg.motorInvert[1] ? "true" : "false",
+           cfg.motorInvert[2] ? "true" : "false", cfg.motorInvert[3] ? "true" : "false",
+           cfg.omniMode ? "true" : "false", cfg.stopProfile, cfg.linearize ? "true" : "false",
+           cfg.headingHold ? "true" : "false", cfg.obstacleGuard ? "true" : "false", cfg.cmdMaxAgeMs, cfg.cmdAgeDecay ? "true" : "false",
+           cfg.pwmProfile[0], cfg.pwmProfile[1], cfg.pwmProfile[2], cfg.pwmProfile[3]);
+  return buf;
+}
+
+static std::string wsStatsJson() {
+  ClientQueueStats st[WS_MAX_CLIENTS];
+  size_t n = broadcaster.stats(st, WS_MAX_CLIENTS);
+  std::string json = "{\"ws_clients\":[";
+  for (size_t i = 0; i < n; i++) {
+    char item[160];
+    snprintf(item, sizeof(item),
+             "%s{\"id\":%u,\"telemetry\":%u,\"reliable\":%u,\"peak\":%u,\"sent\":%u,\"dropped\":%u,\"deferred\":%u}",
+             i > 0 ? "," : "", st[i].id, st[i].telemetryDepth, st[i].reliableDepth, st[i].peakDepth,
+             st[i].sent, st[i].dropped, st[i].deferred);
+    json += item;
+  }
+  return json + "]}";
+}
+
+// Память процесса: куча (malloc) и RSS — для поиска роста под нагрузкой;
+// время CPU процесса (все потоки) — для сравнения флотов разного размера
+static std::string memJson() {
+  struct mallinfo2 mi = mallinfo2();
+  long pages = 0, residentPages = 0;
+  FILE *f = fopen("/proc/self/statm", "r");
+  if (f != nullptr) {
+    if (fscanf(f, "%ld %ld", &pages, &residentPages) != 2) residentPages = 0;
+    fclose(f);
+  }
+  struct rusage ru;
+  getrusage(RUSAGE_SELF, &ru);
+  long cpuMs = (ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1000 + (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1000;
+  char buf[192];
+  snprintf(buf, sizeof(buf),
+           "{\"heap_used\":%zu,\"heap_arena\":%zu,\"rss_kb\":%ld,\"clients\":%zu,\"cpu_ms\":%ld,\"uptime_ms\":%u}",
+           mi.uordblks, mi.arena, residentPages * (sysconf(_SC_PAGESIZE) / 1024), broadcaster.clientCount(), cpuMs,
+           millis() - startMs);
+  return buf;
+}
+
+static void sendTo(uint32_t clientId, const std::string &msg, MsgClass cls = MsgClass::Reliable) {
+  broadcaster.sendTo(clientId, msg.data(), msg.size(), cls);
+}
+
+static void sendAll(const std::string &msg, MsgClass cls = MsgClass::Reliable) {
+  broadcaster.broadcast(msg.data(), msg.size(), cls);
+}
+
+// ==================== ПОТОК ПОЗЫ ====================
+// Как poseTick в main.cpp: подписка "pose:N" на клиента, поза уходит
+// классом Telemetry. Здесь всё в потоке poll(), без атомиков.
+
+struct PoseSubscriber {
+  uint32_t clientId;        // 0 = свободно
+  uint16_t periodMs;
+  uint32_t lastSent;
+};
+
+static PoseSubscriber poseSubscribers[WS_MAX_CLIENTS];
+
+static void setPoseRate(uint32_t clientId, uint8_t hz) {
+  PoseSubscriber *slot = nullptr;
+  for (PoseSubscriber &s : poseSubscribers) {
+    if (s.clientId == clientId) slot = &s;
+  }
+  if (slot == nullptr) {
+    if (hz == 0) return;
+    for (PoseSubscriber &s : poseSubscribers) {
+      if (s.clientId == 0 && slot == nullptr) slot = &s;
+    }
+    if (slot == nullptr) return;
+  }
+  slot->clientId = hz == 0 ? 0 : clientId;
+  slot->periodMs = hz == 0 ? 0 : 1000 / hz;
+}
+
+static std::string poseJson(uint32_t now) {
+  StandinPose pose = chassisPose.read();
+  char buf[192];
+  snprintf(buf, sizeof(buf),
+           "{\"pose\":{\"x\":%.1f,\"y\":%.1f,\"th\":%d,\"vf\":%d,\"vl\":%d,\"w\":%d,\"src\":\"sim\",\"t\":%u}}",
+           pose.xUm / 1000.0, pose.yUm / 1000.0, angleToMrad(pose.heading), pose.vForwardMmps, pose.vLeftMmps,
+           pose.omegaMradps, now);
+  return buf;
+}
+
+static void poseTick() {
+  uint32_t now = millis();
+  std::string json;
+  for (PoseSubscriber &s : poseSubscribers) {
+    if (s.clientId == 0 || now - s.lastSent < s.periodMs) continue;
+    s.lastSent = now;
+    if (json.empty()) json = poseJson(now);
+    sendTo(s.clientId, json, MsgClass::Telemetry);
+  }
+}
+
+// Как handleCommand в main.cpp; эффекты, которым нужно железо
+// (характеризация, самописец, NVS, бенчмарки), здесь пропускаются
+static void handleCommand(uint32_t clientId, const uint8_t *payload, size_t len) {
+  CommandEffects fx = {};
+  MessageResult r = processCommandMessage(clientId, (const char*)payload, len, millis(),
+                                          robotState, clientClocks, fx);
+  char buf[96];
+
+  if (r.failed) {
+    if (r.batch) {
+      snprintf(buf, sizeof(buf), "{\"ack\":\"batch\",\"ok\":false,\"index\":%d}", r.count);
+      sendTo(clientId, buf);
+    }
+    return;
+  }
+  if (r.count == 0) return;
+
+  if (fx.clockSet) clientClocks.sync(clientId, fx.clockOffsetMs, fx.clockRttMs);
+  if (fx.poseRateSet) setPoseRate(clientId, fx.poseRate);
+
+  if (r.batch) {
+    snprintf(buf, sizeof(buf), "{\"ack\":\"batch\",\"ok\":true,\"n\":%d%s%s", r.count,
+             fx.saved ? ",\"saved\":true" : "", r.age == AGE_STALE ? ",\"stale\":true" : "");
+    std::string ack = buf;
+    if (fx.sendConfig) ack += ",\"config\":" + configJson();
+    sendTo(clientId, ack + "}");
+  } else {
+    if (fx.sendConfig) sendAll(configJson());
+    if (fx.saved) sendAll("{\"status\":\"saved\"}");
+  }
+  if (fx.wsStats) sendTo(clientId, wsStatsJson());
+  if (fx.pong) {
+    snprintf(buf, sizeof(buf), "{\"pong\":%u}", millis());
+    sendTo(clientId, buf);
+  }
+  if (fx.sync) {
+    snprintf(buf, sizeof(buf), "{\"sync\":{\"t1\":%u,\"t2\":%u}}", fx.syncT1, millis() % CLOCK_STAMP_MODULO);
+    sendTo(clientId, buf);
+  }
+}
+
+// ==================== ФРОНТЕНД ====================
+
+class StandinHandler : public WsServerHandler {
+public:
+  bool onConnect(uint32_t clientId) override {
+    if (!broadcaster.addClient(clientId)) return false;
+    sendTo(clientId, configJson());
+    return true;
+  }
+
+  void onData(uint32_t clientId, const WsChunk &chunk, const uint8_t *data, size_t len) override;
+
+  void onDisconnect(uint32_t clientId) override {
+    broadcaster.removeClient(clientId);
+    assembler.release(clientId);
+    clientClocks.remove(clientId);
+    setPoseRate(clientId, 0);
+    // Остановить при отключении, как на роботе
+    robotState.update([](RobotState &st) {
+      st.drive.kind = DRIVE_STOP;
+      st.drive.stopProfile = STOP_BRAKE_COAST;
+      return true;
+    });
+  }
+
+  bool onHttpGet(const std::string &path, std::string &body, std::string &type) override {
+    if (path == "/") {
+      body = index_html;
+      type = "text/html";
+    } else if (path == "/ws_stats") {
+      body = wsStatsJson();
+    } else if (path == "/mem") {
+      body = memJson();
+    } else {
+      return false;
+    }
+    return true;
+  }
+};
+
+static StandinHandler handler;
+static PosixWsServer server(handler);
+
+static bool transportSend(uint32_t clientId, SharedMessage &m) {
+  return server.send(clientId, m.data(), m.length());
+}
+
+static void transportKick(uint32_t clientId) {
+  printf("Клиент #%u не успевает принимать, отключаю\n", clientId);
+  server.kick(clientId);
+}
+
+void StandinHandler::onData(uint32_t clientId, const WsChunk &chunk, const uint8_t *data, size_t len) {
+  const uint8_t *payload;
+  size_t payloadLen;
+  uint8_t opcode;
+  char buf[64];
+
+  switch (assembler.feed(clientId, chunk, data, len, &payload, &payloadLen, &opcode)) {
+    case WsAssembleResult::Incomplete:
+      return;
+    case WsAssembleResult::Complete:
+      if (opcode == 0x1) handleCommand(clientId, payload, payloadLen);
+      break;
+    case WsAssembleResult::TooLarge:
+      snprintf(buf, sizeof(buf), "{\"error\":\"too_large\",\"limit\":%d}", WS_MAX_MESSAGE);
+      sendTo(clientId, buf);
+      break;
+    case WsAssembleResult::NoSlot:
+      sendTo(clientId, "{\"error\":\"busy\"}");
+      break;
+    case WsAssembleResult::Protocol:
+      sendTo(clientId, "{\"error\":\"fragment\"}");
+      break;
+  }
+  // Ответы уходят сразу, как после WS_EVT_DATA на роботе
+  broadcaster.pump(transportSend, transportKick);
+}
+
+// ==================== ФЛОТ ====================
+// Родитель только запускает роботов и ждёт их. Ctrl+C из терминала
+// получают все процессы группы; kill родителю пересылается роботам.
+// Робот, потерявший родителя, останавливается сам (PR_SET_PDEATHSIG).
+
+static pid_t fleetPids[STANDIN_FLEET_MAX];
+static int fleetCount = 0;
+
+// Возвращает номер робота в дочернем процессе; в родителе — -1 после
+// остановки всех роботов
+static int runFleet(int robots, uint16_t basePort) {
+  for (int i = 0; i < robots; i++) {
+    pid_t pid = fork();
+    if (pid == 0) {
+      prctl(PR_SET_PDEATHSIG, SIGINT);
+      return i;
+    }
+    if (pid < 0) {
+      fprintf(stderr, "✗ Не удалось запустить робота %d\n", i);
+      break;
+    }
+    fleetPids[fleetCount++] = pid;
+  }
+  printf("✓ Флот: %d роботов, порты %u..%u\n", fleetCount, basePort, basePort + fleetCount - 1);
+  fflush(stdout);
+
+  signal(SIGINT, [](int) {
+    for (int i = 0; i < fleetCount; i++) kill(fleetPids[i], SIGINT);
+  });
+  signal(SIGTERM, [](int) {
+    for (int i = 0; i < fleetCount; i++) kill(fleetPids[i], SIGINT);
+  });
+  int failed = 0;
+  for (int i = 0; i < fleetCount; i++) {
+    int status;
+    while (waitpid(fleetPids[i], &status, 0) < 0 && errno == EINTR) {
+    }
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) failed++;
+  }
+  printf("Флот остановлен, с ошибкой: %d\n", failed);
+  return -1;
+}
+
+// ==================== ЦИКЛ ====================
+
+int main(int argc, char **argv) {
+  uint16_t port = STANDIN_PORT;
+  int robots = 1;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-v") == 0) {
+      verbose = true;
+    } else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+      robots = atoi(argv[++i]);
+    } else {
+      port = (uint16_t)atoi(argv[i]);
+    }
+  }
+  if (robots < 1 || robots > STANDIN_FLEET_MAX) {
+    fprintf(stderr, "✗ Роботов: 1..%d\n", STANDIN_FLEET_MAX);
+    return 2;
+  }
+
+  if (robots > 1) {
+    int robot = runFleet(robots, port);
+    if (robot < 0) return 0;
+    port = (uint16_t)(port + robot);
+  }
+
+  startMs = millis();
+  if (!server.listen(port)) {
+    fprintf(stderr, "✗ Порт %u занят\n", port);
+    return 1;
+  }
+  if (robots == 1) {
+    printf("✓ Заменитель робота: http://localhost:%u/  (клиентов до %d)\n", port, WS_MAX_CLIENTS);
+  }
+
+  signal(SIGINT, [](int) { running.store(false); });
+  signal(SIGPIPE, SIG_IGN);
+  std::thread control(controlLoop);
+  uint32_t lastTelemetry = millis();
+
+  while (running.load()) {
+    server.poll(CONTROL_PERIOD_MS);
+
+    uint32_t now = millis();
+    if (now - lastTelemetry >= TELEMETRY_PERIOD_MS) {
+      lastTelemetry = now;
+      char buf[160];
+      snprintf(buf, sizeof(buf),
+               "{\"telemetry\":{\"battery_mv\":7800,\"soc\":80,\"low\":false,\"ticks\":%u,\"applied\":%u}}",
+               controlTicks.load(), appliedChanges.load());
+      sendAll(buf, MsgClass::Telemetry);
+    }
+    poseTick();
+    broadcaster.pump(transportSend, transportKick);
+  }
+
+  control.join();
+  const WsServerStats &st = server.stats();
+  printf("\nПорт %u: соединений %u (WebSocket %u, отказано %u), фреймов принято %u, отправлено %u\n", port,
+         st.accepted, st.upgraded, st.rejected, st.framesIn, st.framesOut);
+  return 0;
+}
@@ -0,0 +1,518 @@
+// Нагрузочный тест WebSocket: много клиентов одновременно, как десяток
+// телефонов с открытой страницей управления, только больше.
+//   pio run -e wsload  &&  .pio/build/wsload/program -c 48 -r 50 -t 20
+// Каждый клиент шлёт "joy:x:y" с частотой -r, каждое -n сообщение —
+// "ping"; задержка считается от отправки ping до ответа {"pong":..}, то
+// есть включает очередь команд и очередь отправки робота. До и после
+// прогона снимается /mem заменителя (standin.cpp), чтобы увидеть рост
+// памяти. С роботом /mem нет — тогда строка про память пропускается.
+//
+// Флот: -R N — N роботов на портах -p..-p+N-1 (standin -n N). Каждый из
+// -c операторов подключён ко всем роботам, как консоль, открытая на весь
+// флот. -P Гц подписывает каждое соединение на поток позы ("pose:N") —
+// основной исходящий трафик роботов. -f файл проигрывает записанную
+// сессию вместо генератора: строки "мс команда" от начала сессии,
+// по кругу. В конце — строка "fleet ..." для таблиц по числу роботов.
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include <algorithm>
+#include <deque>
+#include <string>
+#include <vector>
+
+#define LOAD_DEFAULT_PORT 8080
+#define LOAD_DEFAULT_CLIENTS 16
+#define LOAD_DEFAULT_RATE_HZ 50       // Как handleMove на странице
+#define LOAD_DEFAULT_SECONDS 10
+#define LOAD_DEFAULT_PING_EVERY 10
+#define LOAD_CONNECT_TIMEOUT_MS 3000
+#define LOAD_OUT_LIMIT 65536          // Клиент не копит больше — робот не успевает читать
+#define LOAD_ROBOTS_MAX 64
+
+static uint64_t nowUs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+enum LoadState { LOAD_HANDSHAKE, LOAD_OPEN, LOAD_CLOSED };
+
+struct LoadClient {
+  int fd;
+  int robot;                    // Индекс в targets
+  LoadState state;
+  std::string in;
+  std::string out;
+  std::deque<uint64_t> pings;   // Время отправки ping, ответы приходят по порядку
+  uint64_t nextSendUs;
+  uint64_t sessionStartUs;      // Начало текущего круга записанной сессии
+  size_t step;                  // Следующая строка сессии
+  uint32_t sent;
+  uint16_t closeCode;
+};
+
+struct LoadTotals {
+  uint32_t connected;
+  uint32_t refused;             // Не открылся TCP или нет 101
+  uint32_t rejected;            // Закрыт с кодом 1013: клиентов слишком много
+  uint32_t kicked;              // Закрыт с кодом 1008: не успевал принимать
+  uint32_t dropped;             // Закрыт без кода
+  uint64_t msgsOut;
+  uint64_t msgsIn;
+  uint64_t bytesIn;
+  uint32_t errors;              // {"error":...} от робота
+  uint32_t skipped;             // Сообщение не отправлено: буфер клиента полон
+  std::vector<uint32_t> latencyUs;
+};
+
+// Шаг записанной сессии (-f)
+struct SessionStep {
+  uint32_t atMs;
+  std::string text;
+};
+
+static std::vector<struct sockaddr_in> targets;
+
+static uint64_t cpuUs(int who) {
+  struct rusage ru;
+  getrusage(who, &ru);
+  return (uint64_t)(ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1000000 + ru.ru_utime.tv_usec + ru.ru_stime.tv_usec;
+}
+
+static int openSocket(int robot, bool nonBlocking) {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0) return -1;
+  int one = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  if (nonBlocking) fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+  if (connect(fd, (struct sockaddr *)&targets[robot], sizeof(targets[robot])) < 0 && errno != EINPROGRESS) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+// Простой GET с ответом целиком (Connection: close)
+static bool httpGet(int robot, const char *path, std::string &body) {
+  int fd = openSocket(robot, false);
+  if (fd < 0) return false;
+  char req[128];
+  int n = snprintf(req, sizeof(req), "GET %s HTTP/1.1\r\nHost: robot\r\nConnection: close\r\n\r\n", path);
+  if (write(fd, req, n) != n) {
+    close(fd);
+    return false;
+  }
+  std::string resp;
+  char buf[1024];
+  ssize_t got;
+  while ((got = read(fd, buf, sizeof(buf))) > 0) resp.append(buf, got);
+  close(fd);
+
+  size_t headerEnd = resp.find("\r\n\r\n");
+  if (resp.compare(0, 12, "HTTP/1.1 200") != 0 || headerEnd == std::string::npos) return false;
+  body = resp.substr(headerEnd + 4);
+  return true;
+}
+
+static long jsonNumber(const std::string &json, const char *key) {
+  std::string pattern = std::string("\"") + key + "\":";
+  size_t at = json.find(pattern);
+  return at == std::string::npos ? -1 : atol(json.c_str() + at + pattern.size());
+}
+
+// Клиент обязан маскировать фреймы (RFC 6455, 5.3)
+static void queueText(LoadClient &c, const char *text, size_t len) {
+  uint8_t header[8];
+  size_t hl = 0;
+  header[hl++] = 0x81;
+  if (len < 126) {
+    header[hl++] = 0x80 | (uint8_t)len;
+  } else {
+    header[hl++] = 0x80 | 126;
+    header[hl++] = (uint8_t)(len >> 8);
+    header[hl++] = (uint8_t)len;
+  }
+  uint32_t key = (uint32_t)rand();
+  uint8_t mask[4] = {(uint8_t)key, (uint8_t)(key >> 8), (uint8_t)(key >> 16), (uint8_t)(key >> 24)};
+  c.out.append((const char *)header, hl);
+  c.out.append((const char *)mask, 4);
+  for (size_t i = 0; i < len; i++) c.out += (char)(text[i] ^ mask[i & 3]);
+}
+
+static void closeClient(LoadClient &c) {
+  if (c.state == LOAD_CLOSED) return;
+  close(c.fd);
+  c.state = LOAD_CLOSED;
+}
+
+static void handleMessage(LoadClient &c, const char *data, size_t len, LoadTotals &tot) {
+  tot.msgsIn++;
+  if (len >= 8 && memcmp(data, "{\"pong\":", 8) == 0 && !c.pings.empty()) {
+    tot.latencyUs.push_back((uint32_t)(nowUs() - c.pings.front()));
+    c.pings.pop_front();
+  } else if (len >= 9 && memcmp(data, "{\"error\":", 9) == 0) {
+    tot.errors++;
+  }
+}
+
+// Фреймы сервера не маскируются и не дробятся (ответы короткие)
+static void parseFrames(LoadClient &c, LoadTotals &tot) {
+  for (;;) {
+    if (c.in.size() < 2) return;
+    const uint8_t *p = (const uint8_t *)c.in.data();
+    uint8_t opcode = p[0] & 0x0F;
+    uint64_t len = p[1] & 0x7F;
+    size_t hl = 2;
+    if (len == 126) {
+      if (c.in.size() < 4) return;
+      len = ((uint64_t)p[2] << 8) | p[3];
+      hl = 4;
+    } else if (len == 127) {
+      if (c.in.size() < 10) return;
+      len = 0;
+      for (int i = 0; i < 8; i++) len = (len << 8) | p[2 + i];
+      hl = 10;
+    }
+    if (c.in.size() < hl + len) return;
+
+    const char *payload = c.in.data() + hl;
+    if (opcode == 0x1) {
+      handleMessage(c, payload, len, tot);
+    } else if (opcode == 0x8) {
+      c.closeCode = len >= 2 ? (uint16_t)(((uint8_t)payload[0] << 8) | (uint8_t)payload[1]) : 0;
+      c.in.clear();
+      return;
+    }
+    c.in.erase(0, hl + len);
+  }
+}
+
+static bool readClient(LoadClient &c, LoadTotals &tot) {
+  char buf[4096];
+  bool eof = false;
+  for (;;) {
+    ssize_t got = read(c.fd, buf, sizeof(buf));
+    if (got > 0) {
+      c.in.append(buf, got);
+      tot.bytesIn += got;
+      continue;
+    }
+    if (got < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+    // Сервер мог закрыть соединение сразу после фрейма close — сначала разобрать его
+    eof = true;
+    break;
+  }
+
+  if (c.state == LOAD_HANDSHAKE) {
+    size_t headerEnd = c.in.find("\r\n\r\n");
+    if (headerEnd == std::string::npos) return !eof;
+    if (c.in.compare(0, 12, "HTTP/1.1 101") != 0) return false;
+    c.in.erase(0, headerEnd + 4);
+    c.state = LOAD_OPEN;
+    tot.connected++;
+  }
+  parseFrames(c, tot);
+  return !eof && c.closeCode == 0;
+}
+
+static bool writeClient(LoadClient &c) {
+  while (!c.out.empty()) {
+    ssize_t n = write(c.fd, c.out.data(), c.out.size());
+    if (n < 0) return errno == EAGAIN || errno == EWOULDBLOCK;
+    c.out.erase(0, n);
+  }
+  return true;
+}
+
+static uint32_t percentile(const std::vector<uint32_t> &sorted, int pct) {
+  if (sorted.empty()) return 0;
+  return sorted[std::min(sorted.size() - 1, sorted.size() * pct / 100)];
+}
+
+// Файл сессии: "мс команда" на строку, # — комментарий. Время — от
+// начала сессии, по неубыванию.
+static bool loadSession(const char *path, std::vector<SessionStep> &steps) {
+  FILE *f = fopen(path, "r");
+  if (f == nullptr) return false;
+  char line[512];
+  uint32_t last = 0;
+  bool ok = true;
+  while (fgets(line, sizeof(line), f) != nullptr) {
+    line[strcspn(line, "\r\n")] = 0;
+    if (line[0] == 0 || line[0] == '#') continue;
+    char *text;
+    unsigned long at = strtoul(line, &text, 10);
+    while (*text == ' ' || *text == '\t') text++;
+    if (text == line || *text == 0 || at < last) {
+      fprintf(stderr, "✗ %s: неверная строка \"%s\"\n", path, line);
+      ok = false;
+      break;
+    }
+    last = (uint32_t)at;
+    steps.push_back({last, text});
+  }
+  fclose(f);
+  return ok && !steps.empty();
+}
+
+static void usage(const char *prog) {
+  fprintf(stderr,
+          "Использование: %s [-h адрес] [-p порт] [-R роботов] [-c клиентов] [-r Гц] [-t секунд]\n"
+          "               [-n ping каждое N] [-P поза, Гц] [-f файл сессии]\n", prog);
+}
+
+int main(int argc, char **argv) {
+  const char *host = "127.0.0.1";
+  int port = LOAD_DEFAULT_PORT;
+  int robots = 1;
+  int clients = LOAD_DEFAULT_CLIENTS;
+  int rateHz = LOAD_DEFAULT_RATE_HZ;
+  int seconds = LOAD_DEFAULT_SECONDS;
+  int pingEvery = LOAD_DEFAULT_PING_EVERY;
+  int poseHz = 0;
+  const char *sessionPath = nullptr;
+
+  int opt;
+  while ((opt = getopt(argc, argv, "h:p:R:c:r:t:n:P:f:")) != -1) {
+    switch (opt) {
+      case 'h': host = optarg; break;
+      case 'p': port = atoi(optarg); break;
+      case 'R': robots = atoi(optarg); break;
+      case 'c': clients = atoi(optarg); break;
+      case 'r': rateHz = atoi(optarg); break;
+      case 't': seconds = atoi(optarg); break;
+      case 'n': pingEvery = atoi(optarg); break;
+      case 'P': poseHz = atoi(optarg); break;
+      case 'f': sessionPath = optarg; break;
+      default: usage(argv[0]); return 2;
+    }
+  }
+  if (clients < 1 || rateHz < 1 || seconds < 1 || pingEvery < 1 || robots < 1 || robots > LOAD_ROBOTS_MAX ||
+      poseHz < 0 || poseHz > 100) {
+    usage(argv[0]);
+    return 2;
+  }
+
+  std::vector<SessionStep> session;
+  if (sessionPath != nullptr && !loadSession(sessionPath, session)) {
+    fprintf(stderr, "✗ Сессия %s не прочитана\n", sessionPath);
+    return 2;
+  }
+
+  targets.resize(robots);
+  for (int r = 0; r < robots; r++) {
+    targets[r].sin_family = AF_INET;
+    targets[r].sin_port = htons(port + r);
+    if (inet_pton(AF_INET, host, &targets[r].sin_addr) != 1) {
+      fprintf(stderr, "✗ Неверный адрес %s\n", host);
+      return 2;
+    }
+  }
+
+  // /mem до прогона: память и CPU каждого робота
+  std::vector<std::string> memBefore(robots), memAfter(robots);
+  bool haveMem = true;
+  for (int r = 0; r < robots; r++) haveMem = httpGet(r, "/mem", memBefore[r]) && haveMem;
+
+  const int connCount = clients * robots;
+  std::vector<LoadTotals> totals(robots, LoadTotals{});
+  std::vector<LoadClient> conns(connCount);
+  const uint64_t periodUs = 1000000 / rateHz;
+  uint64_t start = nowUs();
+  uint64_t consoleCpuStart = cpuUs(RUSAGE_SELF);
+  for (int i = 0; i < connCount; i++) {
+    LoadClient &c = conns[i];
+    c.robot = i % robots;
+    c.fd = openSocket(c.robot, true);
+    c.state = c.fd < 0 ? LOAD_CLOSED : LOAD_HANDSHAKE;
+    if (c.fd < 0) {
+      totals[c.robot].refused++;
+      continue;
+    }
+    c.out = "GET /ws HTTP/1.1\r\nHost: robot\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+            "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\nSec-WebSocket-Version: 13\r\n\r\n";
+    // Клиенты начинают вразнобой, а не одной пачкой каждый период
+    c.nextSendUs = start + (uint64_t)i * periodUs / connCount;
+    c.sessionStartUs = c.nextSendUs;
+  }
+  if (robots == 1) {
+    printf("%d клиентов → %s:%d, %d Гц каждый, %d с\n", clients, host, port, rateHz, seconds);
+  } else {
+    printf("%d роботов (%s:%d..%d) × %d клиентов, %d Гц каждый, %d с\n", robots, host, port, port + robots - 1,
+           clients, rateHz, seconds);
+  }
+  if (poseHz > 0) printf("Поток позы: %d Гц на соединение\n", poseHz);
+  if (!session.empty()) printf("Сессия %s: %zu команд за %u мс, по кругу\n", sessionPath, session.size(),
+                               session.back().atMs);
+
+  const uint64_t endUs = start + (uint64_t)seconds * 1000000;
+  const uint64_t sessionUs = session.empty() ? 0 : (uint64_t)session.back().atMs * 1000 + periodUs;
+  std::vector<struct pollfd> fds(connCount);
+  while (nowUs() < endUs) {
+    uint64_t now = nowUs();
+    int open = 0;
+    for (int i = 0; i < connCount; i++) {
+      LoadClient &c = conns[i];
+      LoadTotals &tot = totals[c.robot];
+      fds[i] = {c.state == LOAD_CLOSED ? -1 : c.fd, POLLIN, 0};
+      if (c.state == LOAD_CLOSED) continue;
+      open++;
+
+      if (c.state == LOAD_HANDSHAKE && now - start > LOAD_CONNECT_TIMEOUT_MS * 1000ULL) {
+        tot.refused++;
+        closeClient(c);
+        continue;
+      }
+      if (c.state == LOAD_OPEN && now >= c.nextSendUs) {
+        if (c.out.size() >= LOAD_OUT_LIMIT) {
+          tot.skipped++;
+        } else if (!session.empty()) {
+          // Записанная сессия: команда по расписанию, ping — после каждой N-й
+          const SessionStep &step = session[c.step];
+          queueText(c, step.text.data(), step.text.size());
+          tot.msgsOut++;
+          if (++c.sent % pingEvery == 0) {
+            queueText(c, "ping", 4);
+            c.pings.push_back(nowUs());
+            tot.msgsOut++;
+          }
+        } else if (++c.sent % pingEvery == 0) {
+          queueText(c, "ping", 4);
+          c.pings.push_back(nowUs());
+          tot.msgsOut++;
+        } else {
+          char cmd[24];
+          int n = snprintf(cmd, sizeof(cmd), "joy:%d:%d", (int)(c.sent * 7 % 511) - 255, 200);
+          queueText(c, cmd, n);
+          tot.msgsOut++;
+        }
+
+        if (session.empty()) {
+          c.nextSendUs += periodUs;
+        } else {
+          if (++c.step == session.size()) {
+            c.step = 0;
+            c.sessionStartUs += sessionUs;
+          }
+          c.nextSendUs = c.sessionStartUs + (uint64_t)session[c.step].atMs * 1000;
+        }
+      }
+      if (!c.out.empty()) fds[i].events |= POLLOUT;
+    }
+    if (open == 0) break;
+
+    poll(fds.data(), fds.size(), 1);
+
+    for (int i = 0; i < connCount; i++) {
+      LoadClient &c = conns[i];
+      LoadTotals &tot = totals[c.robot];
+      if (c.state == LOAD_CLOSED || fds[i].revents == 0) continue;
+      bool wasHandshake = c.state == LOAD_HANDSHAKE;
+      bool alive = true;
+      if (fds[i].revents & (POLLIN | POLLHUP | POLLERR)) alive = readClient(c, tot);
+      if (alive && wasHandshake && c.state == LOAD_OPEN && poseHz > 0) {
+        char cmd[16];
+        int n = snprintf(cmd, sizeof(cmd), "pose:%d", poseHz);
+        queueText(c, cmd, n);
+        tot.msgsOut++;
+      }
+      if (alive && (fds[i].revents & POLLOUT)) alive = writeClient(c);
+      if (alive) continue;
+
+      if (c.closeCode == 1013) {
+        tot.rejected++;
+        tot.connected--;      // 101 пришёл, но клиента не приняли
+      } else if (c.closeCode == 1008) {
+        tot.kicked++;
+      } else if (wasHandshake) {
+        tot.refused++;
+      } else {
+        tot.dropped++;
+      }
+      closeClient(c);
+    }
+  }
+
+  double elapsed = (nowUs() - start) / 1e6;
+  double consoleCpu = (cpuUs(RUSAGE_SELF) - consoleCpuStart) / 1e6;
+  for (LoadClient &c : conns) closeClient(c);
+  // Сервер должен успеть заметить отключения, прежде чем мерить память
+  usleep(200000);
+  for (int r = 0; r < robots; r++) haveMem = haveMem && httpGet(r, "/mem", memAfter[r]);
+
+  // Итог по флоту: счётчики складываются, задержки сливаются
+  LoadTotals tot = {};
+  for (int r = 0; r < robots; r++) {
+    LoadTotals &t = totals[r];
+    tot.connected += t.connected;
+    tot.refused += t.refused;
+    tot.rejected += t.rejected;
+    tot.kicked += t.kicked;
+    tot.dropped += t.dropped;
+    tot.msgsOut += t.msgsOut;
+    tot.msgsIn += t.msgsIn;
+    tot.bytesIn += t.bytesIn;
+    tot.errors += t.errors;
+    tot.skipped += t.skipped;
+    tot.latencyUs.insert(tot.latencyUs.end(), t.latencyUs.begin(), t.latencyUs.end());
+    std::sort(t.latencyUs.begin(), t.latencyUs.end());
+  }
+
+  std::sort(tot.latencyUs.begin(), tot.latencyUs.end());
+  printf("\nПодключено %u из %d (отказано %u, отключено за медленность %u, оборвано %u, не открылось %u)\n",
+         tot.connected, connCount, tot.rejected, tot.kicked, tot.dropped, tot.refused);
+  printf("Отправлено %llu сообщений (%.0f/с), пропущено %u; принято %llu (%.0f/с, %.1f КБ/с), ошибок %u\n",
+         (unsigned long long)tot.msgsOut, tot.msgsOut / elapsed, tot.skipped, (unsigned long long)tot.msgsIn,
+         tot.msgsIn / elapsed, tot.bytesIn / elapsed / 1024, tot.errors);
+  printf("Задержка ping→pong, мс (%zu замеров): p50 %.2f  p90 %.2f  p99 %.2f  макс %.2f\n",
+         tot.latencyUs.size(), percentile(tot.latencyUs, 50) / 1000.0, percentile(tot.latencyUs, 90) / 1000.0,
+         percentile(tot.latencyUs, 99) / 1000.0, tot.latencyUs.empty() ? 0.0 : tot.latencyUs.back() / 1000.0);
+
+  // CPU роботов — по cpu_ms из /mem (заменитель), в % одного ядра
+  double robotCpu = 0;
+  if (haveMem) {
+    long heapBefore = 0, heapAfter = 0, rssBefore = 0, rssAfter = 0;
+    for (int r = 0; r < robots; r++) {
+      heapBefore += jsonNumber(memBefore[r], "heap_used");
+      heapAfter += jsonNumber(memAfter[r], "heap_used");
+      rssBefore += jsonNumber(memBefore[r], "rss_kb");
+      rssAfter += jsonNumber(memAfter[r], "rss_kb");
+      robotCpu += (jsonNumber(memAfter[r], "cpu_ms") - jsonNumber(memBefore[r], "cpu_ms")) / 1000.0;
+    }
+    printf("Память: куча %ld → %ld байт (%+ld), RSS %ld → %ld КБ (%+ld)\n", heapBefore, heapAfter,
+           heapAfter - heapBefore, rssBefore, rssAfter, rssAfter - rssBefore);
+    printf("CPU: роботы %.1f%% ядра (на робота %.1f%%), консоль %.1f%%\n", robotCpu * 100 / elapsed,
+           robotCpu * 100 / elapsed / robots, consoleCpu * 100 / elapsed);
+  } else {
+    printf("Память: /mem недоступен (не заменитель?)\n");
+    printf("CPU: консоль %.1f%%\n", consoleCpu * 100 / elapsed);
+  }
+
+  if (robots > 1) {
+    printf("\nРобот  порт   клиентов  принято/с   КБ/с   p50 мс  p99 мс\n");
+    for (int r = 0; r < robots; r++) {
+      const LoadTotals &t = totals[r];
+      printf("%5d  %5d  %8u  %9.0f  %5.1f  %6.2f  %6.2f\n", r, port + r, t.connected, t.msgsIn / elapsed,
+             t.bytesIn / elapsed / 1024, percentile(t.latencyUs, 50) / 1000.0, percentile(t.latencyUs, 99) / 1000.0);
+    }
+  }
+
+  // Одна строка для сводных таблиц: for n in 1 2 4 8; do ...; done | grep ^fleet
+  printf("\nfleet robots=%d clients=%u msgs_in_s=%.0f kb_in_s=%.1f p50_ms=%.2f p99_ms=%.2f cpu_robots=%.1f "
+         "cpu_console=%.1f\n", robots, tot.connected, tot.msgsIn / elapsed, tot.bytesIn / elapsed / 1024,
+         percentile(tot.latencyUs, 50) / 1000.0, percentile(tot.latencyUs, 99) / 1000.0,
+         haveMem ? robotCpu * 100 / elapsed : -1.0, consoleCpu * 100 / elapsed);
+  return tot.connected == 0 ? 1 : 0;
+}
@@ -0,0 +1,359 @@
+#include "ws_server.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "sha1.h"
+
+#define WS_OP_CONTINUATION 0x0
+#define WS_OP_TEXT 0x1
+#define WS_OP_CLOSE 0x8
+#define WS_OP_PING 0x9
+#define WS_OP_PONG 0xA
+
+static const char *const wsGuid = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+static void setNonBlocking(int fd) {
+  int flags = fcntl(fd, F_GETFL, 0);
+  if (flags >= 0) fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+}
+
+PosixWsServer::~PosixWsServer() {
+  for (Conn &c : conns) close(c.fd);
+  if (listenFd >= 0) close(listenFd);
+}
+
+bool PosixWsServer::listen(uint16_t port) {
+  listenFd = socket(AF_INET, SOCK_STREAM, 0);
+  if (listenFd < 0) return false;
+
+  int one = 1;
+  setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+  sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  addr.sin_port = htons(port);
+  if (bind(listenFd, (sockaddr*)&addr, sizeof(addr)) != 0 || ::listen(listenFd, 128) != 0) {
+    close(listenFd);
+    listenFd = -1;
+    return false;
+  }
+  setNonBlocking(listenFd);
+  return true;
+}
+
+PosixWsServer::Conn *PosixWsServer::find(uint32_t clientId) {
+  for (Conn &c : conns) {
+    if (c.upgraded && c.id == clientId) return &c;
+  }
+  return nullptr;
+}
+
+size_t PosixWsServer::clientCount() const {
+  size_t n = 0;
+  for (const Conn &c : conns) {
+    if (c.connected && !c.closing) n++;
+  }
+  return n;
+}
+
+// ---------- Отправка ----------
+
+void PosixWsServer::queueFrame(Conn &c, uint8_t opcode, const uint8_t *data, size_t len) {
+  // Сервер шлёт фреймы без маски и без фрагментации
+  uint8_t header[10];
+  size_t h = 0;
+  header[h++] = 0x80 | opcode;
+  if (len < 126) {
+    header[h++] = (uint8_t)len;
+  } else if (len < 65536) {
+    header[h++] = 126;
+    header[h++] = (uint8_t)(len >> 8);
+    header[h++] = (uint8_t)len;
+  } else {
+    header[h++] = 127;
+    for (int i = 7; i >= 0; i--) header[h++] = (uint8_t)((uint64_t)len >> (8 * i));
+  }
+  c.out.append((const char*)header, h);
+  c.out.append((const char*)data, len);
+  st.framesOut++;
+}
+
+bool PosixWsServer::send(uint32_t clientId, const char *data, size_t len) {
+  Conn *c = find(clientId);
+  if (c == nullptr || c->closing) return true;  // Клиент уже ушёл, сообщение не нужно
+  if (c->out.size() + len > WS_HOST_OUT_LIMIT) {
+    st.sendBlocked++;
+    return false;
+  }
+  queueFrame(*c, WS_OP_TEXT, (const uint8_t*)data, len);
+  return true;
+}
+
+void PosixWsServer::kick(uint32_t clientId) {
+  Conn *c = find(clientId);
+  if (c == nullptr) return;
+  static const uint8_t status[2] = {0x03, 0xF0};  // 1008: нарушение политики
+  queueFrame(*c, WS_OP_CLOSE, status, sizeof(status));
+  c->closing = true;
+}
+
+void PosixWsServer::ping(uint32_t clientId) {
+  Conn *c = find(clientId);
+  if (c != nullptr && !c->closing) queueFrame(*c, WS_OP_PING, nullptr, 0);
+}
+
+// ---------- Приём ----------
+
+void PosixWsServer::accept() {
+  for (;;) {
+    int fd = ::accept(listenFd, nullptr, nullptr);
+    if (fd < 0) return;
+    setNonBlocking(fd);
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    Conn c = {};
+    c.fd = fd;
+    c.id = nextId++;
+    if (nextId >= LINK_CLIENT_ID) nextId = 1;
+    conns.push_back(c);
+    st.accepted++;
+  }
+}
+
+// false = соединение закрыто собеседником или ошибка
+bool PosixWsServer::readConn(Conn &c) {
+  char buf[4096];
+  for (;;) {
+    ssize_t n = read(c.fd, buf, sizeof(buf));
+    if (n > 0) {
+      c.in.append(buf, (size_t)n);
+      st.bytesIn += (uint64_t)n;
+      continue;
+    }
+    if (n == 0) return false;
+    return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+  }
+}
+
+static std::string headerValue(const std::string &request, const char *name) {
+  size_t nameLen = strlen(name);
+  size_t pos = request.find("\r\n");
+  while (pos != std::string::npos && pos + 2 < request.size()) {
+    size_t line = pos + 2;
+    size_t end = request.find("\r\n", line);
+    if (end == std::string::npos) break;
+    if (end - line > nameLen && strncasecmp(request.c_str() + line, name, nameLen) == 0 &&
+        request[line + nameLen] == ':') {
+      size_t v = line + nameLen + 1;
+      while (v < end && request[v] == ' ') v++;
+      return request.substr(v, end - v);
+    }
+    pos = end;
+  }
+  return std::string();
+}
+
+// false = закрыть соединение
+bool PosixWsServer::handleHttp(Conn &c) {
+  size_t end = c.in.find("\r\n\r\n");
+  if (end == std::string::npos) return c.in.size() < WS_HOST_HEADER_LIMIT;
+
+  std::string request = c.in.substr(0, end + 2);
+  c.in.erase(0, end + 4);
+
+  size_t sp1 = request.find(' ');
+  size_t sp2 = sp1 == std::string::npos ? sp1 : request.find(' ', sp1 + 1);
+  if (sp2 == std::string::npos || request.compare(0, sp1, "GET") != 0) {
+    c.out += "HTTP/1.1 405 Method Not Allowed\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+    c.closing = true;
+    return true;
+  }
+  std::string path = request.substr(sp1 + 1, sp2 - sp1 - 1);
+
+  std::string key = headerValue(request, "Sec-WebSocket-Key");
+  if (path == "/ws" && !key.empty()) {
+    std::string source = key + wsGuid;
+    uint8_t digest[20];
+    char accept[32];
+    sha1((const uint8_t*)source.data(), source.size(), digest);
+    base64Encode(digest, sizeof(digest), accept);
+
+    c.out += "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+             "Sec-WebSocket-Accept: ";
+    c.out += accept;
+    c.out += "\r\n\r\n";
+    c.upgraded = true;
+    st.upgraded++;
+
+    c.connected = handler.onConnect(c.id);
+    if (!c.connected) {
+      st.rejected++;
+      static const uint8_t status[2] = {0x03, 0xF5};  // 1013: попробуйте позже
+      queueFrame(c, WS_OP_CLOSE, status, sizeof(status));
+      c.closing = true;
+    }
+    return true;
+  }
+
+  st.httpRequests++;
+  std::string body, type = "application/json";
+  char head[160];
+  if (handler.onHttpGet(path, body, type)) {
+    snprintf(head, sizeof(head), "HTTP/1.1 200 OK\r\nContent-Type: %s\r\nContent-Length: %zu\r\n"
+             "Connection: close\r\n\r\n", type.c_str(), body.size());
+    c.out += head;
+    c.out += body;
+  } else {
+    c.out += "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+  }
+  c.closing = true;
+  return true;
+}
+
+// Разбор фреймов клиента. Данные сообщений отдаются кусками по мере
+// прихода, как у AsyncWebSocket; управляющие фреймы — целиком.
+bool PosixWsServer::handleFrames(Conn &c) {
+  size_t pos = 0;
+  for (;;) {
+    if (!c.inFrame) {
+      size_t avail = c.in.size() - pos;
+      if (avail < 2) break;
+      const uint8_t *p = (const uint8_t*)c.in.data() + pos;
+
+      bool masked = p[1] & 0x80;
+      uint64_t len = p[1] & 0x7F;
+      size_t h = 2;
+      if (len == 126) {
+        if (avail < 4) break;
+        len = (uint64_t)p[2] << 8 | p[3];
+        h = 4;
+      } else if (len == 127) {
+        if (avail < 10) break;
+        len = 0;
+        for (int i = 0; i < 8; i++) len = len << 8 | p[2 + i];
+        h = 10;
+      }
+      if (!masked) return false;  // Клиент обязан маскировать (RFC 6455)
+      if (avail < h + 4) break;
+
+      uint8_t opcode = p[0] & 0x0F;
+      if (opcode >= WS_OP_CLOSE) {
+        // Управляющий фрейм: короткий и целиком
+        if (len > 125) return false;
+        if (avail < h + 4 + len) break;
+        uint8_t payload[125];
+        for (uint64_t i = 0; i < len; i++) payload[i] = p[h + 4 + i] ^ p[h + (i & 3)];
+        pos += h + 4 + (size_t)len;
+        st.framesIn++;
+
+        if (opcode == WS_OP_PING) queueFrame(c, WS_OP_PONG, payload, (size_t)len);
+        if (opcode == WS_OP_CLOSE) {
+          queueFrame(c, WS_OP_CLOSE, payload, len >= 2 ? 2 : 0);
+          c.closing = true;
+          break;
+        }
+        continue;
+      }
+
+      if (opcode != WS_OP_CONTINUATION) {
+        c.messageOpcode = opcode;
+        c.frameNum = 0;
+      } else {
+        c.frameNum++;
+      }
+      c.frameOpcode = opcode;
+      c.final = p[0] & 0x80;
+      c.frameLen = len;
+      c.frameIndex = 0;
+      memcpy(c.mask, p + h, 4);
+      c.inFrame = true;
+      pos += h + 4;
+      st.framesIn++;
+    }
+
+    // Данные фрейма: сколько есть, снять маску и отдать куском
+    size_t avail = c.in.size() - pos;
+    uint64_t left = c.frameLen - c.frameIndex;
+    size_t n = left < avail ? (size_t)left : avail;
+    if (n == 0 && left > 0) break;
+
+    uint8_t *data = (uint8_t*)&c.in[pos];
+    for (size_t i = 0; i < n; i++) data[i] ^= c.mask[(c.frameIndex + i) & 3];
+
+    WsChunk chunk;
+    chunk.messageOpcode = c.messageOpcode;
+    chunk.frameNum = c.frameNum;
+    chunk.final = c.final;
+    chunk.frameLen = c.frameLen;
+    chunk.index = c.frameIndex;
+    if (c.connected) handler.onData(c.id, chunk, data, n);
+
+    c.frameIndex += n;
+    pos += n;
+    if (c.frameIndex == c.frameLen) c.inFrame = false;
+  }
+  c.in.erase(0, pos);
+  return true;
+}
+
+void PosixWsServer::closeConn(Conn &c) {
+  if (c.connected) handler.onDisconnect(c.id);
+  close(c.fd);
+  c.fd = -1;
+}
+
+void PosixWsServer::poll(int timeoutMs) {
+  std::vector<pollfd> fds;
+  fds.reserve(conns.size() + 1);
+  fds.push_back({listenFd, POLLIN, 0});
+  for (const Conn &c : conns) {
+    fds.push_back({c.fd, (short)(POLLIN | (c.out.empty() ? 0 : POLLOUT)), 0});
+  }
+  if (::poll(fds.data(), fds.size(), timeoutMs) < 0) return;
+
+  if (fds[0].revents & POLLIN) accept();
+
+  for (size_t i = 0; i < fds.size() - 1 && i < conns.size(); i++) {
+    Conn &c = conns[i];
+    bool alive = true;
+
+    if (fds[i + 1].revents & (POLLIN | POLLHUP | POLLERR)) {
+      alive = readConn(c);
+      if (alive && !c.closing && !c.upgraded) alive = handleHttp(c);
+      // Фреймы могли прийти одним пакетом с рукопожатием
+      if (alive && !c.closing && c.upgraded) alive = handleFrames(c);
+    }
+
+    // Запись — сколько примет сокет
+    while (alive && !c.out.empty()) {
+      ssize_t n = write(c.fd, c.out.data(), c.out.size());
+      if (n > 0) {
+        st.bytesOut += (uint64_t)n;
+        c.out.erase(0, (size_t)n);
+        continue;
+      }
+      if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) break;
+      alive = false;
+    }
+
+    if (!alive || (c.closing && c.out.empty())) closeConn(c);
+  }
+
+  for (size_t i = 0; i < conns.size();) {
+    if (conns[i].fd < 0) {
+      conns[i] = std::move(conns.back());
+      conns.pop_back();
+    } else {
+      i++;
+    }
+  }
+}
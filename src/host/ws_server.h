@@ -0,0 +1,99 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+#include "../transport.h"
+#include "../ws_assembler.h"
+
+// ==================== HTTP/WEBSOCKET НА СОКЕТАХ POSIX ====================
+// Замена AsyncWebServer + AsyncWebSocket для заменителя робота на ПК.
+// Один поток, poll(). События те же, что у AsyncWebSocket: подключение,
+// кусок данных (WsChunk: фрейм может прийти несколькими кусками) и
+// отключение, поэтому сборка сообщений и ядро команд работают тем же
+// кодом, что на ESP32. Исходящие сообщения копятся в буфере соединения;
+// переполненный буфер = "очередь библиотеки полна" (canSend() == false).
+
+#define WS_HOST_OUT_LIMIT 65536       // Байт в буфере отправки соединения
+#define WS_HOST_HEADER_LIMIT 8192     // Заголовок HTTP длиннее — соединение закрывается
+
+class WsServerHandler {
+public:
+  virtual ~WsServerHandler() {}
+
+  // Клиент WebSocket подключился; false = отказать (соединение закрывается)
+  virtual bool onConnect(uint32_t clientId) = 0;
+  // Кусок сообщения: data уже без маски, chunk описывает его место во фрейме
+  virtual void onData(uint32_t clientId, const WsChunk &chunk, const uint8_t *data, size_t len) = 0;
+  virtual void onDisconnect(uint32_t clientId) = 0;
+  // GET на любой путь, кроме /ws. false = 404
+  virtual bool onHttpGet(const std::string &path, std::string &body, std::string &contentType) = 0;
+};
+
+struct WsServerStats {
+  uint32_t accepted;
+  uint32_t upgraded;
+  uint32_t rejected;        // onConnect отказал
+  uint32_t httpRequests;
+  uint64_t bytesIn;
+  uint64_t bytesOut;
+  uint32_t framesIn;
+  uint32_t framesOut;
+  uint32_t sendBlocked;     // send() вернул false: буфер соединения полон
+};
+
+class PosixWsServer : public Transport {
+public:
+  explicit PosixWsServer(WsServerHandler &handler) : handler(handler) {}
+  ~PosixWsServer();
+
+  bool listen(uint16_t port);
+  // Один проход: приём, чтение, разбор, запись. Ждёт событий не дольше timeoutMs.
+  void poll(int timeoutMs);
+
+  bool owns(uint32_t clientId) const override { return clientId < LINK_CLIENT_ID; }
+  bool send(uint32_t clientId, const char *data, size_t len) override;
+  void kick(uint32_t clientId) override;
+
+  // Ping текущему клиенту (как AsyncWebSocketClient::ping)
+  void ping(uint32_t clientId);
+
+  size_t clientCount() const;
+  const WsServerStats &stats() const { return st; }
+
+private:
+  struct Conn {
+    int fd;
+    uint32_t id;
+    bool upgraded;
+    bool connected;           // onConnect принял клиента
+    bool closing;             // Закрыть, когда буфер отправки опустеет
+    std::string in;
+    std::string out;
+    // Разбираемый фрейм
+    bool inFrame;
+    uint8_t frameOpcode;
+    uint8_t messageOpcode;
+    uint32_t frameNum;
+    bool final;
+    uint64_t frameLen;
+    uint64_t frameIndex;
+    uint8_t mask[4];
+  };
+
+  Conn *find(uint32_t clientId);
+  void accept();
+  bool readConn(Conn &c);
+  bool handleHttp(Conn &c);
+  bool handleFrames(Conn &c);
+  void queueFrame(Conn &c, uint8_t opcode, const uint8_t *data, size_t len);
+  void closeConn(Conn &c);
+
+  WsServerHandler &handler;
+  int listenFd = -1;
+  uint32_t nextId = 1;
+  std::vector<Conn> conns;
+  WsServerStats st = {};
+};
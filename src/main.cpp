@@ -3,6 +3,41 @@
 #include <ESPAsyncWebServer.h>
 #include <AsyncTCP.h>
 #include <Preferences.h>
+#include <esp_heap_caps.h>
+#include <soc/gpio_reg.h>
+
+#include <stdarg.h>
+#include <atomic>
+
+#include "ads1115_current.h"
+#include "battery.h"
+#include "bench.h"
+#include "board.h"
+#include "client_clock.h"
+#include "command_core.h"
+#include "commands.h"
+#include "drive_mix.h"
+#include "fixed.h"
+#include "flight_recorder.h"
+#include "gyro.h"
+#include "heading_hold.h"
+#include "hcsr04_range.h"
+#include "heap_profile.h"
+#include "motor_lut.h"
+#include "motor_output.h"
+#include "mpu6050_gyro.h"
+#include "obstacle_governor.h"
+#include "odometry.h"
+#include "path_follower.h"
+#include "power_guard.h"
+#include "pwm_profile.h"
+#include "robot_state.h"
+#include "serial_link.h"
+#include "traction.h"
+#include "transport.h"
+#include "web_page.h"
+#include "ws_assembler.h"
+#include "ws_broadcast.h"
 
 // ==================== КОНФИГУРАЦИЯ ====================
 
@@ -10,1399 +45,2002 @@
 const char* ssid = "DiasPhone";
 const char* password = "diasdias";
 
-// Пины моторов (TA6586 драйверы)
-// Драйвер 1
-#define MOTOR1_D0 32  // PWM для вперед
-#define MOTOR1_D1 33  // Направление (LOW/HIGH)
-#define MOTOR2_D0 25  // PWM для вперед
-#define MOTOR2_D1 26  // Направление (LOW/HIGH)
-
-// Драйвер 2
-#define MOTOR3_D0 19  // PWM для вперед
-#define MOTOR3_D1 18  // Направление (LOW/HIGH)
-#define MOTOR4_D0 17  // PWM для вперед
-#define MOTOR4_D1 16  // Направление (LOW/HIGH)
-
-// PWM настройки
-#define PWM_FREQ 5000      // 5 кГц
-#define PWM_RESOLUTION 8   // 8 бит (0-255)
-
-// PWM каналы для каждого мотора
-#define PWM_CHANNEL_M1 0
-#define PWM_CHANNEL_M2 1
-#define PWM_CHANNEL_M3 2
-#define PWM_CHANNEL_M4 3
+// Пины моторов, каналы LEDC, АЦП батареи и шина I2C — в board.h
+// (вариант платы — отдельный заголовок). Частота и разрешение PWM —
+// профиль из настроек (pwm_profile.h), у каждого мотора свой таймер LEDC.
+
+// Датчик напряжения батареи: делитель на ADC1 (работает вместе с WiFi)
+#define BATTERY_PRESENT_MV 2000   // Ниже — делитель не подключен, компенсации и отсечки нет
+
+#define TELEMETRY_PERIOD_MS 500
+
+// Последовательный порт: журнал и проводная связь (кадры COBS, serial_link.h)
+#define SERIAL_BAUD 921600
+#define SERIAL_TX_BUFFER 4096       // Кадр пишется целиком, без ожидания
+#define SERIAL_RX_BUFFER 1024
+#define LINK_TIMEOUT_MS 1000        // Без кадров дольше — клиент отключён, робот стоит
 
 // ==================== ГЛОБАЛЬНЫЕ ПЕРЕМЕННЫЕ ====================
 
 AsyncWebServer server(80);
 AsyncWebSocket ws("/ws");
+WsBroadcaster broadcaster;
+WsFrameAssembler assembler;
 Preferences preferences;
 
-// Текущая скорость (0-255)
-int currentSpeed = 200;  // ~80% от 255
-
-// Режим управления: true = Omni (strafe), false = Tank (rotation)
-bool omniMode = true;
-
-// Конфигурация моторов
-// motorMapping[логическая_позиция] = физический_мотор
-// Логические позиции: 0=передний-правый, 1=передний-левый, 2=задний-левый, 3=задний-правый
+// Настройки и намерение движения: один снимок под seqlock (см. robot_state.h).
 // По умолчанию для X-конфигурации: M1↗ M2↖ M3↙ M4↘
-int motorMapping[4] = {1, 2, 3, 4};  // По умолчанию: прямое соответствие
-bool motorInvert[4] = {false, false, false, false};  // Инверсия направления
+SeqLock<RobotState> robotState(defaultRobotState());
+
+// Напряжение батареи с пина АЦП через делитель.
+// Один замер за такт управления: в Arduino core 2.x нет драйвера
+// непрерывного режима АЦП, а analogReadMilliVolts() занимает десятки мкс.
+class AdcVoltageSource : public VoltageSource {
+public:
+  bool sample(uint32_t &millivolts) override {
+    millivolts = analogReadMilliVolts(kBoard.batteryAdcPin) * kBoard.batteryDividerNum / kBoard.batteryDividerDen;
+    return millivolts >= BATTERY_PRESENT_MV;
+  }
+};
+
+AdcVoltageSource adcBattery;
+BatteryMonitor battery(&adcBattery);
+
+Ads1115CurrentSource currentSense;
+PowerGuard powerGuard;
+
+// Гироскоп для удержания курса (nullptr = не установлен)
+Mpu6050Gyro mpuGyro;
+GyroSource *gyro = nullptr;
+HeadingHold headingHold;
+
+// Кольцо датчиков расстояния (nullptr = на плате нет) и ограничение
+// скорости к препятствиям. Опрос и ограничение — в задаче управления.
+Hcsr04Ranges hcsrRanges;
+RangeSource *rangeSource = nullptr;
+RangeScheduler rangeScheduler;
+ObstacleGovernor obstacleGovernor;
+
+// Таблица линеаризации: меняется только задачей управления
+// (окончание характеризации, lin_reset), в NVS пишется из loop()
+MotorLinearizer linearizer;
+uint8_t lutPersist[sizeof(MotorLinearizer::table)];
+std::atomic<bool> lutSavePending{false};
+std::atomic<bool> lutResetPending{false};
+
+// Профили PWM, настроенные в таймерах (по физическим моторам).
+// Меняются только в задаче управления (и в setup() до её запуска).
+uint8_t appliedPwm[4] = {PWM_PROFILE_5K_8, PWM_PROFILE_5K_8, PWM_PROFILE_5K_8, PWM_PROFILE_5K_8};
+uint8_t requestedPwm[4] = {0xFF, 0xFF, 0xFF, 0xFF};  // 0xFF = ещё не настроен
+uint8_t outputBits[4] = {8, 8, 8, 8};                // Разрешение из appliedPwm (для горячего пути)
+
+// Таблица выходов для текущих маппинга и инверсии (motor_output.h).
+// Собирается и читается только задачей управления (и в setup()).
+MotorOutputTable motorOutputs;
+
+// Что записано в физические моторы (для самописца): скважность Q15 со
+// знаком и маска торможения. Пишутся там же, где моторы.
+int16_t outputDutyQ15[4] = {0, 0, 0, 0};
+uint8_t outputBrakeMask = 0;
+
+// false = бенчмарк: путь записи в моторы выполняется полностью, но мотор
+// остаётся в холостом ходу. Меняется только в задаче управления.
+bool motorOutputsArmed = true;
+
+// Бортовой самописец: буфер переживает программный и аварийный сброс
+__NOINIT_ATTR FlightLog flightLog;
+FlightRecorder flightRecorder;
 
 // ==================== ФУНКЦИИ РАБОТЫ С НАСТРОЙКАМИ ====================
 
-void loadConfig() {
-  preferences.begin("robot", true);  // true = read-only
+// Ключи настроек в открытом пространстве NVS. Общие для loadConfig/
+// saveConfig и бенчмарка (пространство "bench"), чтобы замер шёл тем же путём.
+// Таблица линеаризации — отдельный блок, её читает loadConfig.
+void readConfigKeys(Preferences &prefs, RobotConfig &cfg) {
+  for (int i = 0; i < 4; i++) {
+    String key = "map" + String(i);
+    cfg.motorMapping[i] = prefs.getInt(key.c_str(), i + 1);  // По умолчанию 1,2,3,4
+
+    key = "inv" + String(i);
+    cfg.motorInvert[i] = prefs.getBool(key.c_str(), false);  // По умолчанию не инвертировано
+  }
+
+  cfg.omniMode = prefs.getBool("omniMode", true);
+  cfg.stopProfile = (StopProfile)prefs.getUChar("stopProf", STOP_COAST);
+  if (cfg.stopProfile >= STOP_PROFILE_COUNT) cfg.stopProfile = STOP_COAST;
+  cfg.linearize = prefs.getBool("lin", false);
+  cfg.headingHold = prefs.getBool("hdgHold", false);
+  cfg.obstacleGuard = prefs.getBool("obstacle", false);
+  cfg.cmdMaxAgeMs = prefs.getUShort("maxAge", CMD_AGE_DEFAULT_MS);
+  if (cfg.cmdMaxAgeMs > CMD_AGE_MAX_MS) cfg.cmdMaxAgeMs = CMD_AGE_DEFAULT_MS;
+  cfg.cmdAgeDecay = prefs.getBool("ageDecay", false);
+
+  for (int i = 0; i < 4; i++) {
+    String key = "pwm" + String(i);
+    cfg.pwmProfile[i] = prefs.getUChar(key.c_str(), PWM_PROFILE_5K_8);
+    if (cfg.pwmProfile[i] >= PWM_PROFILE_COUNT) cfg.pwmProfile[i] = PWM_PROFILE_5K_8;
+  }
+}
 
-  // Загрузка маппинга моторов
+void writeConfigKeys(Preferences &prefs, const RobotConfig &cfg) {
   for (int i = 0; i < 4; i++) {
     String key = "map" + String(i);
-    motorMapping[i] = preferences.getInt(key.c_str(), i + 1);  // По умолчанию 1,2,3,4
+    prefs.putInt(key.c_str(), cfg.motorMapping[i]);
 
     key = "inv" + String(i);
-    motorInvert[i] = preferences.getBool(key.c_str(), false);  // По умолчанию не инвертировано
+    prefs.putBool(key.c_str(), cfg.motorInvert[i]);
   }
 
-  omniMode = preferences.getBool("omniMode", true);
+  prefs.putBool("omniMode", cfg.omniMode);
+  prefs.putUChar("stopProf", cfg.stopProfile);
+  prefs.putBool("lin", cfg.linearize);
+  prefs.putBool("hdgHold", cfg.headingHold);
+  prefs.putBool("obstacle", cfg.obstacleGuard);
+  prefs.putUShort("maxAge", cfg.cmdMaxAgeMs);
+  prefs.putBool("ageDecay", cfg.cmdAgeDecay);
+
+  for (int i = 0; i < 4; i++) {
+    String key = "pwm" + String(i);
+    prefs.putUChar(key.c_str(), cfg.pwmProfile[i]);
+  }
+}
+
+void loadConfig() {
+  HeapScope heapScope(HEAP_TAG_NVS);
+  RobotState st = robotState.read();
+  RobotConfig &cfg = st.config;
+
+  preferences.begin("robot", true);  // true = read-only
+  readConfigKeys(preferences, cfg);
+
+  // Таблица линеаризации: без сохранённой таблицы коррекция выключена
+  bool haveLut = preferences.getBytesLength("lut") == sizeof(linearizer.table) &&
+                 preferences.getBytes("lut", linearizer.table, sizeof(linearizer.table)) == sizeof(linearizer.table);
+  if (!haveLut) linearizer.setIdentity();
+  cfg.linearize = haveLut && cfg.linearize;
 
   preferences.end();
 
+  robotState.write(st);
+
   Serial.println("\nКонфигурация загружена из EEPROM:");
   Serial.print("  Маппинг: [");
   for (int i = 0; i < 4; i++) {
-    Serial.print(motorMapping[i]);
+    Serial.print(cfg.motorMapping[i]);
     if (i < 3) Serial.print(", ");
   }
   Serial.println("]");
   Serial.print("  Инверсия: [");
   for (int i = 0; i < 4; i++) {
-    Serial.print(motorInvert[i] ? "1" : "0");
+    Serial.print(cfg.motorInvert[i] ? "1" : "0");
     if (i < 3) Serial.print(", ");
   }
   Serial.println("]");
-  Serial.printf("  Режим: %s\n", omniMode ? "Omni (strafe)" : "Tank (rotation)");
-}
-
-void saveConfig() {
-  preferences.begin("robot", false);  // false = read-write
-
+  Serial.printf("  Режим: %s\n", cfg.omniMode ? "Omni (strafe)" : "Tank (rotation)");
+  Serial.printf("  Остановка: %s\n", stopProfileName(cfg.stopProfile));
+  Serial.printf("  Линеаризация: %s\n", cfg.linearize ? "вкл" : (haveLut ? "выкл" : "нет таблицы"));
+  Serial.print("  PWM: [");
   for (int i = 0; i < 4; i++) {
-    String key = "map" + String(i);
-    preferences.putInt(key.c_str(), motorMapping[i]);
-
-    key = "inv" + String(i);
-    preferences.putBool(key.c_str(), motorInvert[i]);
+    Serial.print(pwmProfile(cfg.pwmProfile[i]).name);
+    if (i < 3) Serial.print(", ");
   }
+  Serial.println("]");
+  Serial.printf("  Удержание курса: %s\n", cfg.headingHold ? "вкл" : "выкл");
+  Serial.printf("  Ограничение у препятствий: %s\n", cfg.obstacleGuard ? "вкл" : "выкл");
+  Serial.printf("  Возраст команд: до %u мс, запоздавшие %s\n", cfg.cmdMaxAgeMs,
+                cfg.cmdAgeDecay ? "ослаблять" : "отбрасывать");
+}
 
-  preferences.putBool("omniMode", omniMode);
+void saveConfig() {
+  HeapScope heapScope(HEAP_TAG_NVS);
+  RobotConfig cfg = robotState.read().config;
 
+  preferences.begin("robot", false);  // false = read-write
+  writeConfigKeys(preferences, cfg);
   preferences.end();
   Serial.println("✓ Конфигурация сохранена в EEPROM");
 }
 
-void resetConfig() {
-  motorMapping[0] = 1;
-  motorMapping[1] = 2;
-  motorMapping[2] = 3;
-  motorMapping[3] = 4;
-
-  motorInvert[0] = false;
-  motorInvert[1] = false;
-  motorInvert[2] = false;
-  motorInvert[3] = false;
+// Таблица линеаризации (копия, подготовленная задачей управления)
+void saveLinearization() {
+  HeapScope heapScope(HEAP_TAG_NVS);
+  RobotConfig cfg = robotState.read().config;
 
-  Serial.println("✓ Конфигурация сброшена к дефолту");
+  preferences.begin("robot", false);
+  preferences.putBytes("lut", lutPersist, sizeof(lutPersist));
+  preferences.putBool("lin", cfg.linearize);
+  preferences.end();
+  Serial.println("✓ Таблица линеаризации сохранена в EEPROM");
 }
 
 String getConfigJSON() {
+  RobotConfig cfg = robotState.read().config;
+
   String json = "{\"mapping\":[";
   for (int i = 0; i < 4; i++) {
-    json += String(motorMapping[i]);
+    json += String(cfg.motorMapping[i]);
     if (i < 3) json += ",";
   }
   json += "],\"invert\":[";
   for (int i = 0; i < 4; i++) {
-    json += motorInvert[i] ? "true" : "false";
+    json += cfg.motorInvert[i] ? "true" : "false";
     if (i < 3) json += ",";
   }
   json += "],\"omniMode\":";
-  json += omniMode ? "true" : "false";
-  json += "}";
+  json += cfg.omniMode ? "true" : "false";
+  json += ",\"stopProfile\":" + String(cfg.stopProfile);
+  json += ",\"linearize\":";
+  json += cfg.linearize ? "true" : "false";
+  json += ",\"headingHold\":";
+  json += cfg.headingHold ? "true" : "false";
+  json += ",\"obstacle\":";
+  json += cfg.obstacleGuard ? "true" : "false";
+  json += ",\"maxAge\":" + String(cfg.cmdMaxAgeMs);
+  json += ",\"ageDecay\":";
+  json += cfg.cmdAgeDecay ? "true" : "false";
+  json += ",\"pwm\":[";
+  for (int i = 0; i < 4; i++) {
+    json += String(cfg.pwmProfile[i]);
+    if (i < 3) json += ",";
+  }
+  json += "]}";
   return json;
 }
 
 // ==================== ФУНКЦИИ УПРАВЛЕНИЯ МОТОРАМИ ====================
 
+// Записать скважности набора выходов (по таблице TA6586):
+//   вперёд — D1 = LOW, D0 = PWM; назад — D1 = HIGH, D0 = ИНВЕРТИРОВАННЫЙ
+//   PWM (больше скорость = меньше скважность); 0 — холостой ход.
+// dutyQ16: -65536..65536 (доля скважности со знаком, см. pwm_profile.h).
+// Пины направления всех выходов пишутся записями в регистры GPIO (по паре
+// W1TC/W1TS на банк: GPIO 0..31 и 32..39), затем одна пауза 10 мкс (только если направление где-то сменилось),
+// затем каналы LEDC. В цикле нет ветвлений: направление, инверсия
+// скважности и "не вооружено" (бенчмарк) — маски. Два выхода на один
+// мотор: побеждает последний, как при записи по очереди.
+// Не вооружено: скважность 0 и D1 = LOW (D1 = HIGH при D0 = 0 — полный
+// ход назад), а смена направления считается по теневым уровням пинов,
+// поэтому пауза 10 мкс выдерживается так же, как с моторами.
+void writeOutputs(const MotorOutput *outs, const int32_t *dutyQ16, int n) {
+  static uint64_t shadowLevel = 0;   // Уровни пинов направления, как если бы выходы были вооружены
+  const uint32_t armed = motorOutputsArmed ? UINT32_MAX : 0;
+  const uint64_t armed64 = (uint64_t)(int64_t)(int32_t)armed;
+  uint64_t setMask = 0;
+  uint64_t clearMask = 0;
+  uint32_t counts[MOTOR_OUTPUTS_MAX];
+
+  for (int k = 0; k < n; k++) {
+    const MotorOutput &o = outs[k];
+    int32_t d = dutyQ16[k];
+    uint32_t reverse = (uint32_t)(d >> 31);               // 0 или все единицы
+    uint32_t magnitude = ((uint32_t)d ^ reverse) - reverse;
+    uint32_t max = (1u << outputBits[o.motor]) - 1;
+    // Инверсный PWM: max - c == c ^ max
+    counts[k] = (pwmCounts(magnitude, outputBits[o.motor]) ^ (reverse & max)) & armed;
+
+    uint64_t dirReverse = (uint64_t)(int64_t)(int32_t)reverse;
+    setMask = (setMask & ~o.dirMask) | (o.dirMask & dirReverse);
+    clearMask = (clearMask & ~o.dirMask) | (o.dirMask & ~dirReverse);
+
+    outputDutyQ15[o.motor] = (int16_t)fxClamp(d / 2, -FX_Q15_ONE, FX_Q15_ONE);
+    outputBrakeMask &= ~(1u << o.motor);
+  }
+
+  uint64_t level = ((uint64_t)REG_READ(GPIO_OUT1_REG) << 32) | REG_READ(GPIO_OUT_REG);
+  level = (level & armed64) | (shadowLevel & ~armed64);
+  bool flips = ((level & clearMask) | (~level & setMask)) != 0;
+  shadowLevel = (level & ~clearMask) | setMask;
+  clearMask |= setMask & ~armed64;
+  setMask &= armed64;
+  REG_WRITE(GPIO_OUT_W1TC_REG, (uint32_t)clearMask);
+  REG_WRITE(GPIO_OUT_W1TS_REG, (uint32_t)setMask);
+  REG_WRITE(GPIO_OUT1_W1TC_REG, (uint32_t)(clearMask >> 32));
+  REG_WRITE(GPIO_OUT1_W1TS_REG, (uint32_t)(setMask >> 32));
+  if (flips) delayMicroseconds(10);
+
+  for (int k = 0; k < n; k++) {
+    ledcWrite(outs[k].channel, counts[k]);
+  }
+}
+
 // Установить скорость и направление для одного ФИЗИЧЕСКОГО мотора
+void setPhysicalMotorQ16(int motorNum, int32_t dutyQ16) {
+  if (motorNum < 1 || motorNum > 4) return;
+  MotorOutput o = boardMotorOutput(motorNum - 1);
+  writeOutputs(&o, &dutyQ16, 1);
+}
+
 void setPhysicalMotor(int motorNum, int speed) {
   // speed: -255 до 255 (отрицательное = назад, положительное = вперед, 0 = стоп)
+  setPhysicalMotorQ16(motorNum, speedToDutyQ16(speed));
+}
 
-  int pwmChannel, pinD0, pinD1;
+// Активное торможение ФИЗИЧЕСКОГО мотора: D0 = HIGH, D1 = HIGH (по таблице TA6586)
+void brakePhysicalMotor(int motorNum) {
+  if (motorNum < 1 || motorNum > 4) return;
+  const BoardMotor &pins = kBoard.motors[motorNum - 1];
 
-  switch(motorNum) {
-    case 1:
-      pwmChannel = PWM_CHANNEL_M1;
-      pinD0 = MOTOR1_D0;
-      pinD1 = MOTOR1_D1;
-      break;
-    case 2:
-      pwmChannel = PWM_CHANNEL_M2;
-      pinD0 = MOTOR2_D0;
-      pinD1 = MOTOR2_D1;
-      break;
-    case 3:
-      pwmChannel = PWM_CHANNEL_M3;
-      pinD0 = MOTOR3_D0;
-      pinD1 = MOTOR3_D1;
-      break;
-    case 4:
-      pwmChannel = PWM_CHANNEL_M4;
-      pinD0 = MOTOR4_D0;
-      pinD1 = MOTOR4_D1;
-      break;
-    default:
-      return;
+  outputDutyQ15[motorNum - 1] = 0;
+  outputBrakeMask |= 1 << (motorNum - 1);
+  digitalWrite(pins.pinD1, HIGH);
+  ledcWrite(pins.pwmChannel, 1u << outputBits[motorNum - 1]);  // duty = 2^N: постоянный HIGH
+}
+
+// Настроить таймер PWM ФИЗИЧЕСКОГО мотора на профиль (при ошибке —
+// профиль по умолчанию). Скважность после перенастройки нужно записать заново.
+void configurePwm(int motorNum, uint8_t profile) {
+  if (motorNum < 1 || motorNum > 4) return;
+  uint8_t pwmChannel = kBoard.motors[motorNum - 1].pwmChannel;
+
+  const PwmProfile &p = pwmProfile(profile);
+  if (ledcSetup(pwmChannel, p.freq, p.bits) == 0) {
+    Serial.printf("✗ PWM %s недоступен для мотора %d\n", p.name, motorNum);
+    profile = PWM_PROFILE_5K_8;
+    ledcSetup(pwmChannel, pwmProfile(profile).freq, pwmProfile(profile).bits);
   }
+  appliedPwm[motorNum - 1] = profile;
+  outputBits[motorNum - 1] = pwmProfile(profile).bits;
+  Serial.printf("✓ Мотор %d: PWM %s\n", motorNum, pwmProfile(profile).name);
+}
 
-  if (speed == 0) {
-    // Холостой ход (по таблице TA6586)
-    digitalWrite(pinD1, LOW);
-    ledcWrite(pwmChannel, 0);
-  } else if (speed > 0) {
-    // Вперёд: D0 = HIGH/PWM, D1 = LOW (по таблице TA6586)
-    digitalWrite(pinD1, LOW);
-    delayMicroseconds(10);
-    ledcWrite(pwmChannel, abs(speed));
-  } else {
-    // Назад: D0 = LOW/PWM, D1 = HIGH (по таблице TA6586)
-    // LOW/PWM означает ИНВЕРТИРОВАННЫЙ PWM: больше скорость = меньше duty cycle!
-    int invertedPWM = 255 - abs(speed);
-    digitalWrite(pinD1, HIGH);
-    delayMicroseconds(10);
-    ledcWrite(pwmChannel, invertedPWM);
+// Применить профили из настроек; true = хотя бы один таймер перенастроен
+bool applyPwmProfiles(const RobotConfig &cfg) {
+  bool reconfigured = false;
+  for (int m = 1; m <= 4; m++) {
+    if (cfg.pwmProfile[m - 1] != requestedPwm[m - 1]) {
+      requestedPwm[m - 1] = cfg.pwmProfile[m - 1];
+      configurePwm(m, cfg.pwmProfile[m - 1]);
+      reconfigured = true;
+    }
   }
+  return reconfigured;
 }
 
-// Установить скорость для ЛОГИЧЕСКОГО мотора (с учетом маппинга и инверсии)
-void setMotor(int logicalMotor, int speed) {
-  // logicalMotor: 1-4 (логические позиции)
-  // speed: -255 до 255
+// Остановить все моторы (холостой ход)
+void stopAllMotors() {
+  for (int m = 1; m <= 4; m++) {
+    setPhysicalMotor(m, 0);
+  }
+}
 
-  if (logicalMotor < 1 || logicalMotor > 4) return;
+// Затормозить все моторы
+void brakeAllMotors() {
+  for (int m = 1; m <= 4; m++) {
+    brakePhysicalMotor(m);
+  }
+}
 
-  int index = logicalMotor - 1;  // Преобразовать в индекс массива (0-3)
-  int physicalMotor = motorMapping[index];
+// Записать скорости четырёх логических колёс по таблице выходов
+// (маппинг и инверсия уже в ней). Физические моторы, на которые не
+// ссылается маппинг, стоят в таблице со знаком 0 — холостой ход.
+void writeWheels(const MotorOutputTable &table, const int wheels[4]) {
+  int32_t dutyQ16[MOTOR_OUTPUTS_MAX];
+  for (int k = 0; k < table.count; k++) {
+    const MotorOutput &o = table.outputs[k];
+    // Коррекция по таблице характеризации физического мотора
+    dutyQ16[k] = linearizer.applyQ16(o.motor + 1, wheels[o.wheel] * o.sign);
+  }
+  writeOutputs(table.outputs, dutyQ16, table.count);
+}
 
-  // Применить инверсию если включена
-  if (motorInvert[index]) {
-    speed = -speed;
+// ==================== ТРАНСПОРТЫ: ОТПРАВКА ====================
+
+// Список клиентов и очереди AsyncWebSocket не потокобезопасны, а
+// отправляют loop, задача связи и задача AsyncTCP (ответы на WS_EVT_DATA).
+// Поэтому КАЖДЫЙ вызов ws / AsyncWebSocketClient из нашего кода идёт под
+// wsLock. Порядок блокировок: broadcaster -> wsLock (send() вызывается из
+// pump()), обратного нет: под wsLock не вызывается ничего, что берёт
+// блокировку рассылки.
+std::mutex wsLock;
+
+class WsTransport : public Transport {
+public:
+  bool owns(uint32_t clientId) const override { return clientId < LINK_CLIENT_ID; }
+
+  // false = очередь библиотеки полна
+  bool send(uint32_t clientId, const char *data, size_t len) override {
+    std::lock_guard<std::mutex> guard(wsLock);
+    AsyncWebSocketClient *client = ws.client(clientId);
+    if (client == nullptr) return true;  // Клиент уже ушёл, сообщение не нужно
+    if (!client->canSend()) return false;
+    client->text(data, len);
+    return true;
   }
 
-  setPhysicalMotor(physicalMotor, speed);
-}
+  // Из очереди рассылки: буфер библиотеки создаётся один раз на сообщение
+  // и отдаётся всем клиентам, а не копируется в text() каждому
+  bool send(uint32_t clientId, SharedMessage &m) override {
+    std::lock_guard<std::mutex> guard(wsLock);
+    AsyncWebSocketClient *client = ws.client(clientId);
+    if (client == nullptr) return true;
+    if (!client->canSend()) return false;
+
+    AsyncWebSocketMessageBuffer *buffer = (AsyncWebSocketMessageBuffer*)m.attachment();
+    if (buffer == nullptr) {
+      buffer = ws.makeBuffer((uint8_t*)m.data(), m.length());
+      if (buffer == nullptr) return false;  // Нет памяти: попробуем в следующий проход
+      buffer->lock();                       // Не удалять, пока жив SharedMessage
+      m.attach(buffer, releaseBuffer);
+    }
+    client->text(buffer);
+    return true;
+  }
 
-// Остановить все моторы
-void stopAllMotors() {
-  setMotor(1, 0);
-  setMotor(2, 0);
-  setMotor(3, 0);
-  setMotor(4, 0);
-}
+  void kick(uint32_t clientId) override {
+    Serial.printf("WebSocket клиент #%u не успевает принимать, отключаю\n", clientId);
+    std::lock_guard<std::mutex> guard(wsLock);
+    AsyncWebSocketClient *client = ws.client(clientId);
+    if (client) client->close();
+  }
+
+  // Раз за проход loop: удалить буферы, которые уже никому не нужны
+  void cleanup() {
+    std::lock_guard<std::mutex> guard(wsLock);
+    ws.cleanupClients();
+    ws._cleanBuffers();
+  }
+
+private:
+  // Сообщение освобождено: буфер удалит _cleanBuffers(), когда его
+  // отправят все клиенты
+  static void releaseBuffer(void *buffer) {
+    std::lock_guard<std::mutex> guard(wsLock);
+    ((AsyncWebSocketMessageBuffer*)buffer)->unlock();
+  }
+};
+
+// UART0 (USB) без блокировок: пишется только то, что помещается в буфер
+class UartStream : public ByteStream {
+public:
+  size_t read(uint8_t *buf, size_t maxLen) override {
+    int n = Serial.available();
+    if (n <= 0) return 0;
+    return Serial.read(buf, (size_t)n < maxLen ? (size_t)n : maxLen);
+  }
+  size_t write(const uint8_t *data, size_t len) override { return Serial.write(data, len); }
+  size_t writable() override { return Serial.availableForWrite(); }
+};
+
+class LinkTransport : public Transport {
+public:
+  explicit LinkTransport(ByteStream &io) : link(io) {}
+
+  bool owns(uint32_t clientId) const override { return clientId == LINK_CLIENT_ID; }
+
+  bool send(uint32_t clientId, const char *data, size_t len) override {
+    if (!connected) return true;
+    return link.send((const uint8_t*)data, len);
+  }
+
+  // Один клиент на порт: переполнение = хост не читает, считается отключённым
+  void kick(uint32_t clientId) override { timedOut = true; }
+
+  SerialLink link;
+  bool connected = false;
+  uint32_t lastFrameMs = 0;
+  std::atomic<bool> timedOut{false};
+};
+
+WsTransport wsTransport;
+UartStream uartStream;
+LinkTransport linkTransport(uartStream);
 
-// ==================== ФУНКЦИИ ДВИЖЕНИЯ OMNI-РОБОТА ====================
-// Предполагается X-конфигурация колес (смотря сверху):
-//     M1 ↗  ↖ M2
-//         ╲╱
-//         ╱╲
-//     M3 ↙  ↘ M4
+Transport *const transports[] = {&wsTransport, &linkTransport};
 
-void moveForward() {
-  setMotor(1, currentSpeed);
-  setMotor(2, currentSpeed);
-  setMotor(3, currentSpeed);
-  setMotor(4, currentSpeed);
+bool transportSend(uint32_t clientId, SharedMessage &m) {
+  for (Transport *t : transports) {
+    if (t->owns(clientId)) return t->send(clientId, m);
+  }
+  return true;  // Неизвестный клиент: сообщение некому доставить
 }
 
-void moveBackward() {
-  setMotor(1, -currentSpeed);
-  setMotor(2, -currentSpeed);
-  setMotor(3, -currentSpeed);
-  setMotor(4, -currentSpeed);
+void transportKick(uint32_t clientId) {
+  for (Transport *t : transports) {
+    if (t->owns(clientId)) t->kick(clientId);
+  }
 }
 
-void moveLeft() {
-  setMotor(1, -currentSpeed);
-  setMotor(2, currentSpeed);
-  setMotor(3, currentSpeed);
-  setMotor(4, -currentSpeed);
+void pumpTransports() {
+  HeapScope heapScope(HEAP_TAG_SEND);
+  broadcaster.pump(transportSend, transportKick);
 }
 
-void moveRight() {
-  setMotor(1, currentSpeed);
-  setMotor(2, -currentSpeed);
-  setMotor(3, -currentSpeed);
-  setMotor(4, currentSpeed);
+String getLinkStatsJSON() {
+  const LinkStats &st = linkTransport.link.stats();
+  String json = "{\"link\":{\"connected\":";
+  json += linkTransport.connected ? "true" : "false";
+  json += ",\"baud\":" + String(SERIAL_BAUD);
+  json += ",\"rx\":" + String(st.rxFrames);
+  json += ",\"tx\":" + String(st.txFrames);
+  json += ",\"bad\":" + String(st.badFrames);
+  json += ",\"overflows\":" + String(st.overflows);
+  json += ",\"deferred\":" + String(st.txDeferred) + "}}";
+  return json;
 }
 
-void rotateLeft() {
-  setMotor(1, -currentSpeed);
-  setMotor(2, currentSpeed);
-  setMotor(3, -currentSpeed);
-  setMotor(4, currentSpeed);
+void sendAll(const String &msg, MsgClass cls = MsgClass::Reliable) {
+  broadcaster.broadcast(msg.c_str(), msg.length(), cls);
 }
 
-void rotateRight() {
-  setMotor(1, currentSpeed);
-  setMotor(2, -currentSpeed);
-  setMotor(3, currentSpeed);
-  setMotor(4, -currentSpeed);
+void sendTo(uint32_t clientId, const String &msg, MsgClass cls = MsgClass::Reliable) {
+  broadcaster.sendTo(clientId, msg.c_str(), msg.length(), cls);
 }
 
-void moveDiagonalForwardLeft() {
-  setMotor(1, 0);
-  setMotor(2, currentSpeed);
-  setMotor(3, currentSpeed);
-  setMotor(4, 0);
+String getWsStatsJSON() {
+  ClientQueueStats st[WS_MAX_CLIENTS];
+  size_t n = broadcaster.stats(st, WS_MAX_CLIENTS);
+
+  String json = "{\"ws_clients\":[";
+  for (size_t i = 0; i < n; i++) {
+    if (i > 0) json += ",";
+    json += "{\"id\":" + String(st[i].id);
+    json += ",\"telemetry\":" + String(st[i].telemetryDepth);
+    json += ",\"reliable\":" + String(st[i].reliableDepth);
+    json += ",\"peak\":" + String(st[i].peakDepth);
+    json += ",\"sent\":" + String(st[i].sent);
+    json += ",\"dropped\":" + String(st[i].dropped);
+    json += ",\"deferred\":" + String(st[i].deferred);
+    json += "}";
+  }
+  json += "]}";
+  return json;
 }
 
-void moveDiagonalForwardRight() {
-  setMotor(1, currentSpeed);
-  setMotor(2, 0);
-  setMotor(3, 0);
-  setMotor(4, currentSpeed);
+// ==================== ЦИКЛ УПРАВЛЕНИЯ ====================
+// Команды не пишут в моторы напрямую: они меняют "намерение" движения и
+// настройки, а задача управления раз в CONTROL_PERIOD_MS применяет
+// последнее опубликованное состояние. Пакет команд публикуется целиком,
+// поэтому моторы никогда не видят промежуточных состояний между командами.
+
+#define CONTROL_PERIOD_MS 10      // 100 Гц
+
+#define BRAKE_HOLD_MS 300          // Торможение перед холостым ходом (STOP_BRAKE_COAST)
+#define STOP_TEST_RUN_MS 1500      // Разгон перед замером остановки
+#define STOP_TEST_TIMEOUT_MS 3000  // Максимальное время ожидания остановки
+#define STANDSTILL_THRESHOLD 2     // |скорость колеса| ниже порога = стоит
+
+// Источник измеренных скоростей ЛОГИЧЕСКИХ колёс, мм/с (замер остановки,
+// определение заклинивания, проскальзывание). false = датчиков скорости нет.
+typedef bool (*WheelSpeedSource)(int32_t speeds[4]);
+WheelSpeedSource wheelSpeedSource = nullptr;
+
+// Остановка из обработчиков событий (отключение клиента и т.п.)
+void requestStop(StopProfile profile) {
+  robotState.update([profile](RobotState &st) {
+    st.drive.kind = DRIVE_STOP;
+    st.drive.stopProfile = profile;
+    return true;
+  });
 }
 
-void moveDiagonalBackwardLeft() {
-  setMotor(1, -currentSpeed);
-  setMotor(2, 0);
-  setMotor(3, 0);
-  setMotor(4, -currentSpeed);
+// Состояние выходного каскада между тактами
+enum StopTestPhase : uint8_t { STOP_TEST_IDLE, STOP_TEST_RUN, STOP_TEST_STOPPING };
+
+struct OutputState {
+  uint32_t brakeUntil;        // != 0: перейти в холостой ход в этот момент
+  StopTestPhase testPhase;
+  uint32_t testStart;         // Начало текущей фазы замера
+  bool driving;               // Колёса крутятся по commanded[]
+  bool lowCutoff;             // Моторы отключены по низкому напряжению
+  uint32_t cutoffVersion;     // Версия снимка при отсечке: до новой — стоять
+  int commanded[4];           // Скорости колёс из намерения движения
+  int written[4];             // Последнее записанное в моторы (после компенсации)
+  // Скорости, которые дают моторы: written после всех ограничений
+  // (препятствия, антибукс, ток, насыщение), но без компенсации
+  // напряжения — она держит скорость на уровне команды. Для одометрии.
+  int effective[4];
+};
+
+OutputState output = {0, STOP_TEST_IDLE, 0, false, false, 0, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}};
+
+void beginStop(StopProfile profile, uint32_t now) {
+  output.brakeUntil = 0;
+
+  switch (profile) {
+    case STOP_COAST:
+      stopAllMotors();
+      break;
+    case STOP_BRAKE:
+      brakeAllMotors();
+      break;
+    case STOP_BRAKE_COAST:
+      brakeAllMotors();
+      output.brakeUntil = now + BRAKE_HOLD_MS;
+      if (output.brakeUntil == 0) output.brakeUntil = 1;
+      break;
+    default:
+      stopAllMotors();
+      break;
+  }
 }
 
-void moveDiagonalBackwardRight() {
-  setMotor(1, 0);
-  setMotor(2, -currentSpeed);
-  setMotor(3, -currentSpeed);
-  setMotor(4, 0);
+bool wheelsAtStandstill(bool &haveSensor) {
+  int32_t speeds[4];
+  haveSensor = wheelSpeedSource != nullptr && wheelSpeedSource(speeds);
+  if (!haveSensor) return false;
+
+  for (int i = 0; i < 4; i++) {
+    if (abs(speeds[i]) >= STANDSTILL_THRESHOLD) return false;
+  }
+  return true;
 }
 
-// ==================== WEBSOCKET ОБРАБОТЧИКИ ====================
+void reportStopTest(StopProfile profile, bool haveSensor, uint32_t elapsed) {
+  String json = "{\"stop_test\":{\"profile\":\"";
+  json += stopProfileName(profile);
+  json += "\",\"sensor\":";
+  json += haveSensor ? "true" : "false";
+  json += ",\"ms\":" + String(elapsed) + "}}";
+  Serial.println("Замер остановки: " + json);
+  sendAll(json);
+}
 
-void handleWebSocketMessage(void *arg, uint8_t *data, size_t len) {
-  AwsFrameInfo *info = (AwsFrameInfo*)arg;
-  if (info->final && info->index == 0 && info->len == len && info->opcode == WS_TEXT) {
-    data[len] = 0;
-    String command = (char*)data;
-
-    Serial.println("Команда: " + command);
-
-    // Команды управления
-    if (command == "forward") {
-      moveForward();
-    } else if (command == "backward") {
-      moveBackward();
-    } else if (command == "left") {
-      moveLeft();
-    } else if (command == "right") {
-      moveRight();
-    } else if (command == "rotate_left") {
-      rotateLeft();
-    } else if (command == "rotate_right") {
-      rotateRight();
-    } else if (command == "diag_fl") {
-      moveDiagonalForwardLeft();
-    } else if (command == "diag_fr") {
-      moveDiagonalForwardRight();
-    } else if (command == "diag_bl") {
-      moveDiagonalBackwardLeft();
-    } else if (command == "diag_br") {
-      moveDiagonalBackwardRight();
-    } else if (command == "stop") {
-      stopAllMotors();
-    } else if (command == "mode_omni") {
-      omniMode = true;
-      Serial.println("✓ Режим: Omni (strafe)");
-    } else if (command == "mode_tank") {
-      omniMode = false;
-      Serial.println("✓ Режим: Tank (rotation)");
+// Замер: разгон вперёд на текущей скорости, затем остановка профилем
+// и ожидание, пока все колёса не встанут (по датчикам скорости)
+void stopTestTick(const RobotState &st, bool changed, uint32_t now) {
+  if (changed) {
+    int speed = battery.compensate(st.config.speed);
+    int wheels[4] = {speed, speed, speed, speed};
+    writeWheels(motorOutputs, wheels);
+    output.brakeUntil = 0;
+    output.testPhase = STOP_TEST_RUN;
+    output.testStart = now;
+    return;
+  }
+
+  if (output.testPhase == STOP_TEST_RUN && now - output.testStart >= STOP_TEST_RUN_MS) {
+    beginStop(st.drive.stopProfile, now);
+    output.testPhase = STOP_TEST_STOPPING;
+    output.testStart = now;
+  } else if (output.testPhase == STOP_TEST_STOPPING) {
+    bool haveSensor;
+    bool still = wheelsAtStandstill(haveSensor);
+    uint32_t elapsed = now - output.testStart;
+
+    if (still || elapsed >= STOP_TEST_TIMEOUT_MS) {
+      reportStopTest(st.drive.stopProfile, haveSensor, elapsed);
+      output.testPhase = STOP_TEST_IDLE;
     }
-    // Команды калибровки - тест по ЛОГИЧЕСКОЙ позиции (с учетом маппинга)
-    else if (command.startsWith("test_")) {
-      int pos = command.substring(5, 6).toInt();  // test_0_fwd -> 0
-      String action = command.substring(7);       // fwd/bwd/stop
-
-      if (pos >= 0 && pos < 4) {
-        int logicalMotor = pos + 1;  // 0->1, 1->2, 2->3, 3->4
-        if (action == "fwd") {
-          setMotor(logicalMotor, currentSpeed);
-        } else if (action == "bwd") {
-          setMotor(logicalMotor, -currentSpeed);
-        } else if (action == "stop") {
-          setMotor(logicalMotor, 0);
-        }
+  }
+}
+
+// ==================== ХАРАКТЕРИЗАЦИЯ МОТОРОВ ====================
+// Каждый физический мотор по очереди прогоняется по ступеням скважности
+// (motor_lut.h). Отклик — скорость колеса с датчика, а без энкодеров —
+// оценка противо-ЭДС по току: E = Vbat * duty - I * R.
+
+#define MOTOR_RESISTANCE_MOHM 3000  // Сопротивление обмотки мотора, мОм
+
+MotorCharacterizer characterizer;
+
+bool measureMotorResponse(const RobotConfig &cfg, int physicalMotor, int speed, int32_t &response) {
+  int32_t speeds[4];
+  if (wheelSpeedSource != nullptr && wheelSpeedSource(speeds)) {
+    for (int i = 0; i < 4; i++) {
+      if (cfg.motorMapping[i] == physicalMotor) {
+        response = speeds[i];
+        return true;
       }
     }
-    // Изменение скорости
-    else if (command.startsWith("speed:")) {
-      int newSpeed = command.substring(6).toInt();
-      if (newSpeed >= 0 && newSpeed <= 255) {
-        currentSpeed = newSpeed;
-        Serial.println("Скорость изменена на: " + String(currentSpeed));
+    return false;
+  }
+
+  uint16_t ma[4];
+  if (!currentSense.sample(ma)) return false;
+
+  uint32_t vbat = battery.millivolts();
+  if (vbat == 0) vbat = BATTERY_NOMINAL_MV;
+  int32_t applied = (int32_t)(vbat * (uint32_t)abs(speed) / 255);
+  int32_t emf = applied - (int32_t)((uint32_t)ma[physicalMotor - 1] * MOTOR_RESISTANCE_MOHM / 1000);
+  response = emf > 0 ? emf : 0;
+  return true;
+}
+
+void reportCharacterize(bool ok, const char *error) {
+  String json = "{\"characterize\":{\"ok\":";
+  json += ok ? "true" : "false";
+  if (error != nullptr) {
+    json += ",\"error\":\"";
+    json += error;
+    json += "\"";
+  }
+  if (ok) {
+    // lut[мотор][направление]: узлы 0, 16, 32 ... 255 желаемой скорости
+    json += ",\"lut\":[";
+    for (int m = 0; m < 4; m++) {
+      if (m > 0) json += ",";
+      json += "[";
+      for (int d = 0; d < 2; d++) {
+        if (d > 0) json += ",";
+        json += "[";
+        for (int k = 0; k < LUT_POINTS; k++) {
+          if (k > 0) json += ",";
+          json += String(linearizer.table[m][d][k]);
+        }
+        json += "]";
       }
+      json += "]";
     }
-    // Управление джойстиком: "joy:x:y" где x,y от -255 до 255
-    else if (command.startsWith("joy:")) {
-      int firstColon = command.indexOf(':', 4);
-      int joyX = command.substring(4, firstColon).toInt();
-      int joyY = command.substring(firstColon + 1).toInt();
-
-      // X-конфигурация омни-платформы с двумя режимами
-      //     M1 ↗  ↖ M2
-      //         ╲╱
-      //         ╱╲
-      //     M3 ↙  ↘ M4
-
-      int m1, m2, m3, m4;
-
-      if (omniMode) {
-        // OMNI MODE: X = стрейф влево/вправо, Y = вперёд/назад
-        // Формулы: M1=Y+X, M2=Y-X, M3=Y+X, M4=Y-X
-        m1 = constrain(joyY + joyX, -255, 255);
-        m2 = constrain(joyY - joyX, -255, 255);
-        m3 = constrain(joyY + joyX, -255, 255);
-        m4 = constrain(joyY - joyX, -255, 255);
-      } else {
-        // TANK MODE: X = разворот влево/вправо, Y = вперёд/назад
-        // Формулы: M1=Y-X, M2=Y+X, M3=Y-X, M4=Y+X
-        m1 = constrain(joyY - joyX, -255, 255);
-        m2 = constrain(joyY + joyX, -255, 255);
-        m3 = constrain(joyY - joyX, -255, 255);
-        m4 = constrain(joyY + joyX, -255, 255);
-      }
+    json += "]";
+  }
+  json += "}}";
+  Serial.println(ok ? "✓ Характеризация завершена" : String("✗ Характеризация: ") + error);
+  sendAll(json);
+}
 
-      setMotor(1, m1);
-      setMotor(2, m2);
-      setMotor(3, m3);
-      setMotor(4, m4);
-    }
-    // Команды настройки
-    else if (command == "get_config") {
-      ws.textAll(getConfigJSON());
-    } else if (command == "save_config") {
-      saveConfig();
-      ws.textAll("{\"status\":\"saved\"}");
-    } else if (command == "reset_config") {
-      resetConfig();
-      ws.textAll(getConfigJSON());
-    }
-    // Установка маппинга: "set_map:0:2" = логическая_позиция:физический_мотор
-    else if (command.startsWith("set_map:")) {
-      int firstColon = command.indexOf(':', 8);
-      int logicalPos = command.substring(8, firstColon).toInt();
-      int physicalMotor = command.substring(firstColon + 1).toInt();
-
-      if (logicalPos >= 0 && logicalPos < 4 && physicalMotor >= 1 && physicalMotor <= 4) {
-        motorMapping[logicalPos] = physicalMotor;
-        Serial.printf("Маппинг установлен: позиция %d -> мотор %d\n", logicalPos, physicalMotor);
-      }
+// Завершить прогон: моторы стоят, намерение возвращается в "stop"
+void finishCharacterize(bool enableLut) {
+  stopAllMotors();
+  robotState.update([enableLut](RobotState &st) {
+    st.drive.kind = DRIVE_STOP;
+    st.drive.stopProfile = STOP_COAST;
+    if (enableLut) st.config.linearize = true;
+    return true;
+  });
+}
+
+void characterizeTick(const RobotState &st, bool changed, uint32_t now) {
+  static int activeMotor = 0;
+  static int activeSpeed = 0;
+
+  if (!characterizer.running()) {
+    if (!changed) return;  // Прогон закончен, ждём публикации "stop"
+
+    int32_t probe;
+    if (!measureMotorResponse(st.config, 1, 0, probe)) {
+      reportCharacterize(false, "no_sensor");
+      finishCharacterize(false);
+      return;
     }
-    // Установка инверсии: "set_inv:0:true"
-    else if (command.startsWith("set_inv:")) {
-      int firstColon = command.indexOf(':', 8);
-      int logicalPos = command.substring(8, firstColon).toInt();
-      String value = command.substring(firstColon + 1);
-
-      if (logicalPos >= 0 && logicalPos < 4) {
-        motorInvert[logicalPos] = (value == "true");
-        Serial.printf("Инверсия установлена: позиция %d = %s\n", logicalPos, value.c_str());
-      }
+
+    Serial.println("Характеризация моторов...");
+    stopAllMotors();
+    output.brakeUntil = 0;
+    activeMotor = 0;
+    activeSpeed = 0;
+    characterizer.start(now);
+  }
+
+  int motor, speed;
+  if (!characterizer.step(now, motor, speed)) {
+    bool ok = characterizer.build(linearizer);
+    if (ok) {
+      memcpy(lutPersist, linearizer.table, sizeof(lutPersist));
+      lutSavePending.store(true, std::memory_order_release);
     }
+    reportCharacterize(ok, ok ? nullptr : "no_response");
+    finishCharacterize(ok);
+    return;
+  }
+
+  // Таблица не применяется: характеризуется "сырая" скважность
+  if (motor != activeMotor && activeMotor != 0) setPhysicalMotor(activeMotor, 0);
+  if (motor != activeMotor || speed != activeSpeed) setPhysicalMotor(motor, speed);
+  activeMotor = motor;
+  activeSpeed = speed;
+
+  int32_t response;
+  if (measureMotorResponse(st.config, motor, speed, response)) {
+    characterizer.addSample(response, now);
   }
 }
 
-void onEvent(AsyncWebSocket *server, AsyncWebSocketClient *client, AwsEventType type,
-             void *arg, uint8_t *data, size_t len) {
-  switch (type) {
-    case WS_EVT_CONNECT:
-      Serial.printf("WebSocket клиент #%u подключен\n", client->id());
-      // Отправить текущую конфигурацию при подключении
-      client->text(getConfigJSON());
-      break;
-    case WS_EVT_DISCONNECT:
-      Serial.printf("WebSocket клиент #%u отключен\n", client->id());
-      stopAllMotors(); // Остановить при отключении
-      break;
-    case WS_EVT_DATA:
-      handleWebSocketMessage(arg, data, len);
-      break;
-    case WS_EVT_PONG:
-    case WS_EVT_ERROR:
-      break;
+// ==================== ОДОМЕТРИЯ ====================
+// Поза считается в задаче управления каждый такт и публикуется снимком
+// под seqlock; поток позы клиентам отправляет loop().
+
+// Накопленные отсчёты энкодеров ЛОГИЧЕСКИХ колёс. nullptr = энкодеров нет,
+// поза считается по измеренным скоростям колёс (wheelSpeedSource), а без
+// них — по командам, которые дошли до моторов (output.effective).
+WheelCountSource wheelCountSource = nullptr;
+
+Odometry odometry;
+SeqLock<OdomPose> odomPose(OdomPose{});
+std::atomic<bool> odomResetPending{false};
+
+// Что колёса делали с прошлого такта
+void odometryTick(uint32_t dtMs) {
+  if (odomResetPending.exchange(false)) odometry.reset();
+
+  int32_t counts[4];
+  int32_t speeds[4];
+  if (wheelCountSource != nullptr && wheelCountSource(counts)) {
+    odometry.updateFromCounts(counts, dtMs);
+  } else if (wheelSpeedSource != nullptr && wheelSpeedSource(speeds)) {
+    odometry.updateFromSpeeds(speeds, dtMs);
+  } else {
+    static const int idle[4] = {0, 0, 0, 0};
+    odometry.updateFromCommands(output.driving && !output.lowCutoff ? output.effective : idle, dtMs);
   }
+  odomPose.write(odometry.pose());
 }
 
-// ==================== HTML ИНТЕРФЕЙС ====================
+// ==================== МАРШРУТ ====================
+// Следование по точкам (path_follower.h) в задаче управления по позе
+// одометрии; прогресс клиентам отправляет loop().
 
-const char index_html[] PROGMEM = R"rawliteral(
-<!DOCTYPE html>
-<html>
-<head>
-  <meta charset="UTF-8">
-  <meta name="viewport" content="width=device-width, initial-scale=1.0">
-  <title>Omni Robot Control</title>
-  <style>
-    * {
-      margin: 0;
-      padding: 0;
-      box-sizing: border-box;
-    }
-    body {
-      font-family: -apple-system, BlinkMacSystemFont, 'Segoe UI', sans-serif;
-      background: #f8fafc;
-      min-height: 100vh;
-      padding: 20px;
-    }
-    .container {
-      max-width: 700px;
-      margin: 0 auto;
-      background: white;
-      border-radius: 12px;
-      box-shadow: 0 1px 3px rgba(0,0,0,0.1);
-      border: 1px solid #e2e8f0;
-      overflow: hidden;
-    }
-    .header {
-      background: white;
-      border-bottom: 1px solid #e2e8f0;
-      padding: 20px;
-      text-align: center;
-    }
-    .header h1 {
-      font-size: 20px;
-      margin-bottom: 8px;
-      color: #0f172a;
-      font-weight: 600;
-    }
-    .status {
-      font-size: 13px;
-      font-weight: 500;
-    }
-    .status.connected { color: #10b981; }
-    .status.disconnected { color: #64748b; }
+#define PATH_REPORT_PERIOD_MS 200
 
-    .tabs {
-      display: flex;
-      background: #f8fafc;
-      border-bottom: 1px solid #e2e8f0;
-    }
-    .tab {
-      flex: 1;
-      padding: 14px;
-      text-align: center;
-      cursor: pointer;
-      border: none;
-      background: none;
-      font-size: 14px;
-      font-weight: 500;
-      color: #64748b;
-      transition: all 0.2s;
-    }
-    .tab.active {
-      background: white;
-      color: #3b82f6;
-      border-bottom: 2px solid #3b82f6;
-    }
+PathFollower pathFollower;
 
-    .mode-btn {
-      padding: 10px 20px;
-      border: none;
-      background: transparent;
-      color: #64748b;
-      font-size: 14px;
-      font-weight: 500;
-      cursor: pointer;
-      border-radius: 6px;
-      transition: all 0.2s;
-    }
-    .mode-btn.active {
-      background: white;
-      color: #3b82f6;
-      box-shadow: 0 1px 3px rgba(0,0,0,0.1);
-    }
+// Скорости колёс маршрута на этот такт; false = маршрут пройден или прерван
+bool pathTick(const RobotState &st, uint32_t dtMs) {
+  if (st.drive.kind != DRIVE_PATH) {
+    pathFollower.abort();     // Другая команда движения
+    return false;
+  }
+  if (pathFollower.seq() != st.path.seq) pathFollower.start(st.path, odometry.pose());
 
-    .tab-content {
-      display: none;
-      padding: 30px 20px;
-      max-height: 75vh;
-      overflow-y: auto;
-    }
-    .tab-content.active {
-      display: block;
-    }
+  BodyVelocity v;
+  if (!pathFollower.update(st.path, odometry.pose(), dtMs, v)) return false;
+  bodyToWheels(v, output.commanded);
+  return true;
+}
 
-    .speed-control {
-      margin-bottom: 20px;
-      text-align: center;
-    }
-    .speed-control label {
-      display: block;
-      font-size: 14px;
-      font-weight: 500;
-      margin-bottom: 10px;
-      color: #475569;
-    }
-    .speed-slider {
-      width: 100%;
-      margin: 10px 0;
-      height: 6px;
-      border-radius: 3px;
-      background: #e2e8f0;
-      outline: none;
-      -webkit-appearance: none;
-    }
-    .speed-slider::-webkit-slider-thumb {
-      -webkit-appearance: none;
-      appearance: none;
-      width: 18px;
-      height: 18px;
-      border-radius: 50%;
-      background: #3b82f6;
-      cursor: pointer;
-      border: 2px solid white;
-      box-shadow: 0 1px 3px rgba(0,0,0,0.2);
-    }
-    .speed-slider::-moz-range-thumb {
-      width: 18px;
-      height: 18px;
-      border-radius: 50%;
-      background: #3b82f6;
-      cursor: pointer;
-      border: 2px solid white;
-      box-shadow: 0 1px 3px rgba(0,0,0,0.2);
-    }
-    .speed-value {
-      font-size: 28px;
-      font-weight: 600;
-      color: #3b82f6;
-    }
+void pathReportTick() {
+  static uint32_t lastSent = 0;
+  static uint8_t lastState = PATH_IDLE;
+  uint32_t now = millis();
+  uint8_t state = pathFollower.state();
+
+  bool stateChanged = state != lastState;
+  if (!stateChanged && (state != PATH_FOLLOWING || now - lastSent < PATH_REPORT_PERIOD_MS)) return;
+  lastSent = now;
+  lastState = state;
+
+  String json = "{\"path\":{\"state\":\"";
+  json += pathStateName(state);
+  json += "\",\"index\":" + String(pathFollower.index());
+  json += ",\"count\":" + String(pathFollower.count());
+  json += ",\"remaining\":" + String(pathFollower.remainingMm());
+  json += ",\"xtrack\":" + String(pathFollower.crossTrackMm()) + "}}";
+  if (stateChanged) Serial.println("Маршрут: " + json);
+  // Смена состояния (пройден, прерван) доставляется, прогресс — как телеметрия
+  sendAll(json, stateChanged ? MsgClass::Reliable : MsgClass::Telemetry);
+}
 
-    .joystick-layout {
-      display: grid;
-      grid-template-columns: 1fr 1fr;
-      gap: 15px;
-      margin-bottom: 20px;
-    }
+// ==================== УДЕРЖАНИЕ КУРСА ====================
 
-    .control-grid {
-      display: grid;
-      grid-template-columns: repeat(3, 1fr);
-      gap: 10px;
-    }
-    .btn {
-      padding: 20px;
-      font-size: 24px;
-      border: 1px solid #e2e8f0;
-      border-radius: 8px;
-      cursor: pointer;
-      background: white;
-      color: #3b82f6;
-      transition: all 0.15s;
-      user-select: none;
-      -webkit-user-select: none;
-      -webkit-touch-callout: none;
-      font-weight: 500;
-      box-shadow: 0 1px 2px rgba(0,0,0,0.05);
-    }
-    .btn:active {
-      transform: scale(0.98);
-      background: #eff6ff;
-      border-color: #3b82f6;
-    }
-    .btn.empty {
-      background: transparent;
-      cursor: default;
-      border: none;
-      box-shadow: none;
-    }
-    .btn.stop {
-      background: #ef4444;
-      color: white;
-      border-color: #ef4444;
-      grid-column: 2;
-    }
-    .btn.stop:active {
-      background: #dc2626;
-      border-color: #dc2626;
-    }
+// Поправка omega на этот такт (0 = регулятор не работает)
+int headingTick(const RobotState &st, uint32_t now) {
+  uint32_t yaw = 0;
+  int32_t rate = 0;
+  bool haveGyro = gyro != nullptr && gyro->read(yaw, rate);
+  if (gyro != nullptr) gyro->setStationary(!output.driving);
 
-    .rotate-buttons {
-      display: grid;
-      grid-template-columns: 1fr 1fr;
-      gap: 10px;
-      height: 100%;
-    }
+  bool hold = haveGyro && st.config.headingHold && output.driving && translationOnly(st);
+  return headingHold.update(hold, yaw, rate, now);
+}
 
-    .rotate-buttons .btn {
-      font-size: 18px;
-    }
+// ==================== ПРОСКАЛЬЗЫВАНИЕ ====================
+// Антибукс работает в задаче управления; о новых срывах клиентам сообщает
+// loop() по счётчику событий.
 
-    .emergency-stop {
-      width: 100%;
-      padding: 18px;
-      font-size: 16px;
-      font-weight: 600;
-      background: #ef4444;
-      color: white;
-      border: 1px solid #ef4444;
-      border-radius: 8px;
-      cursor: pointer;
-      margin-top: 20px;
-      box-shadow: 0 1px 3px rgba(239,68,68,0.3);
-      transition: all 0.15s;
-    }
-    .emergency-stop:active {
-      background: #dc2626;
-      border-color: #dc2626;
-      transform: scale(0.98);
-    }
+TractionControl traction;
 
-    /* Калибровка - визуальный квадрат */
-    .info-box {
-      background: #f0f9ff;
-      border: 1px solid #bae6fd;
-      padding: 14px;
-      margin-bottom: 20px;
-      border-radius: 8px;
-    }
-    .info-box p {
-      font-size: 13px;
-      color: #0369a1;
-      line-height: 1.6;
-      margin-bottom: 6px;
-    }
-    .info-box p:last-child {
-      margin-bottom: 0;
-    }
+void slipReportTick() {
+  static uint32_t reported = 0;
+  uint32_t events = traction.events();
+  if (events == reported) return;
+  reported = events;
 
-    .robot-visual {
-      display: grid;
-      grid-template-columns: 1fr 1fr;
-      gap: 15px;
-      margin-bottom: 24px;
-      padding: 16px;
-      background: #f8fafc;
-      border-radius: 8px;
-      border: 1px solid #e2e8f0;
-    }
+  uint8_t mask = traction.slipMask();
+  int wheel = 0;
+  for (int i = 0; i < 4; i++) {
+    if (mask & (1 << i)) wheel = i + 1;
+  }
+  String json = "{\"slip\":{\"wheel\":" + String(wheel);
+  json += ",\"residual\":" + String(traction.residualMmps());
+  json += ",\"events\":" + String(events) + "}}";
+  Serial.println("Проскальзывание: " + json);
+  sendAll(json, MsgClass::Telemetry);
+}
 
-    .motor-corner {
-      background: white;
-      border-radius: 8px;
-      padding: 14px;
-      border: 1px solid #e2e8f0;
-      box-shadow: 0 1px 2px rgba(0,0,0,0.05);
-    }
+// Один такт управления по снимку состояния версии version; changed = снимок новый
+void controlStep(const RobotState &st, uint32_t version, bool changed, uint32_t now) {
+  static uint32_t lastTick = now;
+  uint32_t dtMs = now - lastTick;
+  odometryTick(dtMs);
+  lastTick = now;
+
+  if (lutResetPending.exchange(false)) {
+    linearizer.setIdentity();
+    memcpy(lutPersist, linearizer.table, sizeof(lutPersist));
+    lutSavePending.store(true, std::memory_order_release);
+  }
+  linearizer.setEnabled(st.config.linearize);
 
-    .corner-header {
-      text-align: center;
-      margin-bottom: 12px;
-      padding-bottom: 10px;
-      border-bottom: 1px solid #e2e8f0;
-    }
+  // Новый PWM профиль: таймеры перенастроены, скважность пишется заново.
+  // Во время характеризации профиль не меняется — таблица строится под него.
+  if (!characterizer.running() && applyPwmProfiles(st.config)) {
+    changed = true;
+  }
+
+  // Новые маппинг или инверсия: пересобрать таблицу выходов
+  if (!motorOutputs.matches(st.config)) {
+    compileMotorOutputs(st.config, motorOutputs);
+    changed = true;
+  }
+
+  battery.update();
+  currentSense.poll();
+  if (rangeSource != nullptr) {
+    rangeScheduler.tick(*rangeSource, now);
+    obstacleGovernor.update(rangeScheduler, now);
+  }
 
-    .corner-header h3 {
-      font-size: 13px;
-      color: #475569;
-      margin-bottom: 4px;
-      font-weight: 500;
+  // Отсечка по низкому напряжению: моторы стоят, пока батарея не
+  // восстановится и не придёт новая команда. Без нагрузки просадка уходит
+  // сразу, и само по себе возобновлённое намерение гоняло бы батарею между
+  // отсечкой и восстановлением (а характеризация начиналась бы заново).
+  if (battery.isLow()) {
+    if (!output.lowCutoff) {
+      Serial.printf("✗ Низкое напряжение батареи: %u мВ, моторы отключены\n", battery.millivolts());
+      flightRecorder.trigger(FREEZE_LOW_BATTERY, now);
+      stopAllMotors();
+      output.lowCutoff = true;
+      output.driving = false;
+      output.brakeUntil = 0;
+      output.testPhase = STOP_TEST_IDLE;
+      output.cutoffVersion = version;
+      pathFollower.abort();
+      if (characterizer.running()) {
+        characterizer.abort();
+        reportCharacterize(false, "low_battery");
+      }
     }
+    return;
+  }
+  if (output.lowCutoff) {
+    if (version == output.cutoffVersion) return;
+    // Команда оператора после отсечки: применить её, даже если снимок
+    // уже был прочитан, пока батарея была низкой
+    output.lowCutoff = false;
+    changed = true;
+  }
+
+  if (st.drive.kind == DRIVE_STOP_TEST) {
+    output.driving = false;
+    stopTestTick(st, changed, now);
+    return;
+  }
+  output.testPhase = STOP_TEST_IDLE;
 
-    .corner-header .icon {
-      font-size: 24px;
-      margin-bottom: 4px;
+  if (st.drive.kind == DRIVE_CHARACTERIZE) {
+    output.driving = false;
+    characterizeTick(st, changed, now);
+    return;
+  }
+  if (characterizer.running()) {
+    // Прервано другой командой — таблица не меняется
+    characterizer.abort();
+    stopAllMotors();
+    reportCharacterize(false, "aborted");
+  }
+
+  // Маршрут задаёт скорости колёс каждый такт; пройден — остановка профилем
+  if (st.drive.kind == DRIVE_PATH || pathFollower.state() == PATH_FOLLOWING) {
+    if (pathTick(st, dtMs)) {
+      output.driving = true;
+      output.brakeUntil = 0;
+    } else if (st.drive.kind == DRIVE_PATH && output.driving) {
+      output.driving = false;
+      powerGuard.reset();
+      traction.reset();
+      beginStop(st.config.stopProfile, now);
     }
+  }
 
-    .test-controls {
-      display: grid;
-      grid-template-columns: repeat(3, 1fr);
-      gap: 6px;
-      margin-bottom: 12px;
+  if (changed && st.drive.kind != DRIVE_PATH) {
+    if (st.drive.kind == DRIVE_STOP) {
+      output.driving = false;
+      powerGuard.reset();
+      traction.reset();
+      beginStop(st.drive.stopProfile, now);
+    } else {
+      computeWheels(st, output.commanded);
+      output.driving = true;
+      output.brakeUntil = 0;
     }
+  }
+
+  int omega = headingTick(st, now);
 
-    .test-controls .btn {
-      padding: 10px 6px;
-      font-size: 16px;
+  // Удержание курса, антибукс, компенсация напряжения и ограничение
+  // по току каждый такт; запись в моторы только при изменении
+  if (output.driving) {
+    int wheels[4];
+    memcpy(wheels, output.commanded, sizeof(wheels));
+    applyHeadingCorrection(wheels, omega);
+    if (st.config.obstacleGuard && rangeSource != nullptr) {
+      obstacleGovernor.apply(wheels);
     }
 
-    .btn.forward {
-      background: white;
-      color: #10b981;
-      border-color: #d1fae5;
+    int32_t speeds[4];
+    bool haveSpeeds = wheelSpeedSource != nullptr && wheelSpeedSource(speeds);
+    if (haveSpeeds) {
+      traction.apply(wheels, speeds);
+    } else {
+      traction.reset();
     }
-    .btn.forward:active {
-      background: #f0fdf4;
-      border-color: #10b981;
+
+    for (int i = 0; i < 4; i++) {
+      wheels[i] = battery.compensate(wheels[i]);
     }
-    .btn.backward {
-      background: white;
-      color: #f59e0b;
-      border-color: #fed7aa;
+
+    uint16_t physicalMa[4];
+    if (currentSense.sample(physicalMa)) {
+      uint16_t wheelMa[4];
+      for (int i = 0; i < 4; i++) {
+        int m = st.config.motorMapping[i];
+        wheelMa[i] = (m >= 1 && m <= 4) ? physicalMa[m - 1] : 0;
+      }
+      powerGuard.apply(wheels, wheelMa, haveSpeeds ? speeds : nullptr, now);
     }
-    .btn.backward:active {
-      background: #fffbeb;
-      border-color: #f59e0b;
+
+    bool differs = changed;
+    for (int i = 0; i < 4; i++) {
+      if (wheels[i] != output.written[i]) differs = true;
     }
-    .btn.test-stop {
-      background: #ef4444;
-      color: white;
-      border-color: #ef4444;
+    if (differs) {
+      writeWheels(motorOutputs, wheels);
+      memcpy(output.written, wheels, sizeof(wheels));
     }
-    .btn.test-stop:active {
-      background: #dc2626;
-      border-color: #dc2626;
+    uint16_t batteryScale = battery.scaleQ8();
+    for (int i = 0; i < 4; i++) {
+      output.effective[i] = wheels[i] * FX_Q8_ONE / batteryScale;
     }
+  }
 
-    .corner-settings {
-      margin-top: 10px;
-    }
+  // Торможение закончено — холостой ход, чтобы не греть драйверы
+  if (output.brakeUntil != 0 && (int32_t)(now - output.brakeUntil) >= 0) {
+    output.brakeUntil = 0;
+    stopAllMotors();
+  }
+}
 
-    .setting-item {
-      margin-bottom: 8px;
-    }
+// ==================== БЕНЧМАРК ====================
+// Замеры горячих путей на железе (bench.h): "bench" или GET /bench?run.
+// Моторная часть выполняется одним тактом задачи управления (единственный
+// писатель моторов) и только когда робот стоит. Выходы на это время
+// разоружены: тот же код и те же записи в порты, но моторы в холостом ходу.
+// Разбор команд, JSON, NVS и эхо WebSocket замеряются в loop().
+
+#define BENCH_ITERATIONS 200
+#define BENCH_NVS_ITERATIONS 8
+#define BENCH_ECHO_COUNT 10
+#define BENCH_ECHO_TIMEOUT_MS 1000
+#define BENCH_MAX_RESULTS 24
+#define BENCH_HTTP_CLIENT 0       // Запуск по HTTP: без эха, результат — GET /bench
+#define BENCH_PARSE_CLIENT 0x80000002u  // Клиент замера разбора (свои часы, не WebSocket)
+
+enum BenchPhase : uint8_t { BENCH_IDLE, BENCH_MOTORS, BENCH_HOST, BENCH_ECHO, BENCH_FAILED };
+
+std::atomic<uint8_t> benchPhase{BENCH_IDLE};
+std::atomic<uint32_t> benchClient{BENCH_HTTP_CLIENT};
+BenchStats benchResults[BENCH_MAX_RESULTS];
+uint8_t benchCount = 0;
+volatile int32_t benchSink = 0;         // Не даёт компилятору выбросить замеряемый код
+std::atomic<bool> commandLogQuiet{false};
+std::atomic<uint32_t> benchPongUs{0};   // Время прихода pong (0 = ещё нет)
+
+static uint32_t benchCycles() {
+  return ESP.getCycleCount();
+}
 
-    .setting-item label {
-      display: block;
-      font-size: 12px;
-      color: #64748b;
-      margin-bottom: 4px;
-      font-weight: 500;
-    }
+// false = замер уже идёт
+bool requestBench(uint32_t clientId) {
+  uint8_t idle = BENCH_IDLE;
+  if (!benchPhase.compare_exchange_strong(idle, BENCH_MOTORS)) return false;
+  benchClient.store(clientId);
+  return true;
+}
 
-    .setting-item select {
-      width: 100%;
-      padding: 8px;
-      border: 1px solid #e2e8f0;
-      border-radius: 6px;
-      font-size: 13px;
-      background: white;
-      color: #475569;
-      cursor: pointer;
-      transition: all 0.15s;
-    }
+// Из задачи управления после такта
+void benchMotorsTick(const RobotState &st) {
+  if (benchPhase.load(std::memory_order_acquire) != BENCH_MOTORS) return;
 
-    .setting-item select:focus {
-      outline: none;
-      border-color: #3b82f6;
-      box-shadow: 0 0 0 3px rgba(59,130,246,0.1);
-    }
+  bool idle = st.drive.kind == DRIVE_STOP && !output.driving && output.brakeUntil == 0 &&
+              output.testPhase == STOP_TEST_IDLE && !characterizer.running();
+  if (!idle) {
+    benchPhase.store(BENCH_FAILED, std::memory_order_release);
+    return;
+  }
 
-    .invert-check {
-      display: flex;
-      align-items: center;
-      justify-content: center;
-      padding: 8px;
-      background: #f8fafc;
-      border-radius: 6px;
-      border: 1px solid #e2e8f0;
-    }
+  benchCount = 0;
+  motorOutputsArmed = false;
 
-    .invert-check input[type="checkbox"] {
-      width: 16px;
-      height: 16px;
-      margin-right: 8px;
-      cursor: pointer;
-      accent-color: #3b82f6;
-    }
+  // Смена направления на каждом вызове — худший случай для TA6586
+  benchRun(benchResults[benchCount++], "set_physical_motor", BENCH_ITERATIONS, benchCycles, [](uint32_t i) {
+    setPhysicalMotor((i & 3) + 1, (i & 4) ? 200 : -200);
+  });
 
-    .invert-check label {
-      font-size: 12px;
-      color: #475569;
-      cursor: pointer;
-      margin: 0;
-      font-weight: 500;
-    }
+  // Все четыре колеса за вызов, переставленный маппинг с инверсией
+  RobotConfig cfg = st.config;
+  static const uint8_t swapped[4] = {2, 1, 4, 3};
+  for (int i = 0; i < 4; i++) {
+    cfg.motorMapping[i] = swapped[i];
+    cfg.motorInvert[i] = (i & 1) != 0;
+  }
+  static MotorOutputTable benchTable;
+  compileMotorOutputs(cfg, benchTable);
+  benchRun(benchResults[benchCount++], "write_wheels", BENCH_ITERATIONS, benchCycles, [](uint32_t i) {
+    int s = (i & 1) ? 180 : -180;
+    int wheels[4] = {s, -s, s, -s};
+    writeWheels(benchTable, wheels);
+  });
 
-    .action-buttons {
-      display: grid;
-      grid-template-columns: 2fr 1fr;
-      gap: 10px;
-      margin-top: 20px;
-    }
+  RobotState joy = st;
+  joy.drive.kind = DRIVE_JOY;
+  joy.config.omniMode = true;
+  benchRun(benchResults[benchCount++], "joy_mix", BENCH_ITERATIONS, benchCycles, [&joy](uint32_t i) {
+    joy.drive.joyX = (int16_t)((i * 37) % 511) - 255;
+    joy.drive.joyY = (int16_t)((i * 91) % 511) - 255;
+    int wheels[4];
+    computeWheels(joy, wheels);
+    benchSink += wheels[0];
+  });
+  joy.drive.kind = DRIVE_AXES;
+  benchRun(benchResults[benchCount++], "axes_mix", BENCH_ITERATIONS, benchCycles, [&joy](uint32_t i) {
+    joy.drive.joyX = (int16_t)((i * 37) % 511) - 255;
+    joy.drive.joyY = (int16_t)((i * 91) % 511) - 255;
+    joy.drive.joyW = (int16_t)((i * 53) % 511) - 255;
+    int wheels[4];
+    computeWheels(joy, wheels);
+    benchSink += wheels[0];
+  });
 
-    .action-buttons .btn {
-      padding: 14px;
-      font-size: 14px;
-    }
+  // fixed.h против float на тех же входах. float считается на FPU этой
+  // задачи — так выглядел бы путь моторов без фиксированной точки.
+  benchRun(benchResults[benchCount++], "fx_sin", BENCH_ITERATIONS, benchCycles, [](uint32_t i) {
+    benchSink += fxSinQ15(i * 0x9E3779B9u);
+  });
+  benchRun(benchResults[benchCount++], "float_sin", BENCH_ITERATIONS, benchCycles, [](uint32_t i) {
+    benchSink += (int32_t)(sinf((float)(i * 0x9E3779B9u) * 1.4629181e-9f) * 32767.0f);
+  });
+  benchRun(benchResults[benchCount++], "fx_atan2", BENCH_ITERATIONS, benchCycles, [](uint32_t i) {
+    benchSink += (int32_t)fxAtan2((int32_t)((i * 37) % 511) - 255, (int32_t)((i * 91) % 511) - 255);
+  });
+  benchRun(benchResults[benchCount++], "float_atan2", BENCH_ITERATIONS, benchCycles, [](uint32_t i) {
+    benchSink += (int32_t)(atan2f((float)((int32_t)((i * 37) % 511) - 255),
+                                  (float)((int32_t)((i * 91) % 511) - 255)) * 1000.0f);
+  });
+  benchRun(benchResults[benchCount++], "fx_rotate", BENCH_ITERATIONS, benchCycles, [](uint32_t i) {
+    FxVec2 v = fxRotate({(int32_t)(i * 7) - 700, 300}, i * 0x9E3779B9u);
+    benchSink += v.x + v.y;
+  });
+  benchRun(benchResults[benchCount++], "float_rotate", BENCH_ITERATIONS, benchCycles, [](uint32_t i) {
+    float a = (float)(i * 0x9E3779B9u) * 1.4629181e-9f;
+    float c = cosf(a), s = sinf(a);
+    float x = (float)((int32_t)(i * 7) - 700), y = 300.0f;
+    benchSink += (int32_t)(x * c - y * s) + (int32_t)(x * s + y * c);
+  });
 
-    .btn.save {
-      background: #3b82f6;
-      color: white;
-      border-color: #3b82f6;
-    }
-    .btn.save:active {
-      background: #2563eb;
-      border-color: #2563eb;
-    }
-    .btn.reset {
-      background: white;
-      color: #ef4444;
-      border-color: #fecaca;
-    }
-    .btn.reset:active {
-      background: #fef2f2;
-      border-color: #ef4444;
-    }
+  motorOutputsArmed = true;
+  stopAllMotors();
+  benchPhase.store(BENCH_HOST, std::memory_order_release);
+}
 
-    @media (max-width: 600px) {
-      .robot-visual {
-        gap: 15px;
-        padding: 15px;
-      }
-      .motor-corner {
-        padding: 12px;
-      }
-      .corner-header .icon {
-        font-size: 24px;
-      }
-      .test-controls .btn {
-        padding: 10px 5px;
-        font-size: 12px;
-      }
-    }
-  </style>
-</head>
-<body>
-  <div class="container">
-    <div class="header">
-      <h1>🤖 Omni Robot Control</h1>
-      <div class="status" id="status">Подключение...</div>
-    </div>
-
-    <div class="tabs">
-      <button class="tab active" onclick="switchTab(0)">Управление</button>
-      <button class="tab" onclick="switchTab(1)">Калибровка</button>
-    </div>
-
-    <!-- Вкладка 1: Управление -->
-    <div class="tab-content active" id="tab-control">
-      <!-- Переключатель режимов управления и типа -->
-      <div style="text-align:center; margin-bottom:20px;">
-        <div style="display:inline-flex; background:#f1f5f9; border-radius:8px; padding:4px; margin-bottom:10px;">
-          <button id="modeJoystick" class="mode-btn active" onclick="switchMode('joystick')">🕹️ Джойстик</button>
-          <button id="modeButtons" class="mode-btn" onclick="switchMode('buttons')">🎮 Кнопки</button>
-        </div>
-        <br>
-        <div style="display:inline-flex; background:#e0f2fe; border-radius:8px; padding:4px;">
-          <button id="driveOmni" class="mode-btn active" onclick="switchDriveMode('omni')">🔄 Omni (Strafe)</button>
-          <button id="driveTank" class="mode-btn" onclick="switchDriveMode('tank')">🎯 Tank (Rotation)</button>
-        </div>
-      </div>
-
-      <div class="speed-control">
-        <label>Скорость</label>
-        <input type="range" class="speed-slider" min="0" max="255" value="200" id="speedSlider" oninput="updateSpeed()">
-        <div class="speed-value" id="speedValue">200</div>
-      </div>
-
-      <!-- Режим джойстика -->
-      <div id="joystick-mode" class="control-mode">
-        <div style="text-align:center; margin-bottom:10px; color:#64748b; font-size:13px;">
-          🕹️ Вверх/Вниз: движение • Влево/Вправо: <span id="joystickModeText">стрейф</span>
-        </div>
-        <div style="display:grid; grid-template-columns:1fr 1fr; gap:15px; margin-bottom:20px;">
-          <!-- Джойстик слева -->
-          <div>
-            <h3 style="text-align:center; margin-bottom:10px; color:#475569; font-weight:500; font-size:14px;">Джойстик</h3>
-            <div style="position:relative; width:100%; padding-bottom:100%; background:#f8fafc; border-radius:12px; border:2px solid #e2e8f0;">
-              <canvas id="joystickCanvas" style="position:absolute; width:100%; height:100%; touch-action:none;"></canvas>
-            </div>
-          </div>
-
-          <!-- Кнопки влево/вправо справа -->
-          <div>
-            <h3 style="text-align:center; margin-bottom:10px; color:#475569; font-weight:500; font-size:14px;" id="joystickSideLabel">Стрейф</h3>
-            <div class="rotate-buttons">
-              <button class="btn" ontouchstart="sendCommand('left')" ontouchend="sendCommand('stop')" onmousedown="sendCommand('left')" onmouseup="sendCommand('stop')">⟲</button>
-              <button class="btn" ontouchstart="sendCommand('right')" ontouchend="sendCommand('stop')" onmousedown="sendCommand('right')" onmouseup="sendCommand('stop')">⟳</button>
-            </div>
-          </div>
-        </div>
-      </div>
-
-      <!-- Режим кнопок -->
-      <div id="buttons-mode" class="control-mode" style="display:none;">
-        <div style="text-align:center; margin-bottom:10px; color:#64748b; font-size:13px;">
-          🎮 ⬆️⬇️ движение • ⬅️➡️ <span id="buttonsModeText">разворот</span>
-        </div>
-        <div class="joystick-layout">
-        <!-- Левая половина: направления -->
-        <div>
-          <h3 style="text-align:center; margin-bottom:10px; color:#475569; font-weight:500; font-size:14px;">Движение</h3>
-          <div class="control-grid">
-            <div class="btn empty"></div>
-            <button class="btn" ontouchstart="sendCommand('forward')" ontouchend="sendCommand('stop')" onmousedown="sendCommand('forward')" onmouseup="sendCommand('stop')">⬆️</button>
-            <div class="btn empty"></div>
-
-            <button class="btn" ontouchstart="sendCommand('rotate_left')" ontouchend="sendCommand('stop')" onmousedown="sendCommand('rotate_left')" onmouseup="sendCommand('stop')">⬅️</button>
-            <button class="btn stop" onclick="sendCommand('stop')">⏹️</button>
-            <button class="btn" ontouchstart="sendCommand('rotate_right')" ontouchend="sendCommand('stop')" onmousedown="sendCommand('rotate_right')" onmouseup="sendCommand('stop')">➡️</button>
-
-            <div class="btn empty"></div>
-            <button class="btn" ontouchstart="sendCommand('backward')" ontouchend="sendCommand('stop')" onmousedown="sendCommand('backward')" onmouseup="sendCommand('stop')">⬇️</button>
-            <div class="btn empty"></div>
-          </div>
-        </div>
-
-        <!-- Правая половина: стрейф/разворот -->
-        <div>
-          <h3 style="text-align:center; margin-bottom:10px; color:#475569; font-weight:500; font-size:14px;" id="buttonsSideLabel">Разворот</h3>
-          <div class="rotate-buttons">
-            <button class="btn" ontouchstart="sendCommand('left')" ontouchend="sendCommand('stop')" onmousedown="sendCommand('left')" onmouseup="sendCommand('stop')">⟲</button>
-            <button class="btn" ontouchstart="sendCommand('right')" ontouchend="sendCommand('stop')" onmousedown="sendCommand('right')" onmouseup="sendCommand('stop')">⟳</button>
-          </div>
-        </div>
-      </div>
-      </div>
-
-      <button class="emergency-stop" onclick="sendCommand('stop')">🛑 АВАРИЙНЫЙ СТОП</button>
-    </div>
-
-    <!-- Вкладка 2: Калибровка -->
-    <div class="tab-content" id="tab-calibration">
-      <div class="speed-control">
-        <label>Скорость тестирования</label>
-        <input type="range" class="speed-slider" min="0" max="255" value="200" id="speedSlider2" oninput="updateSpeed2()">
-        <div class="speed-value" id="speedValue2">200</div>
-      </div>
-
-      <div class="info-box">
-        <p><strong>Инструкция:</strong></p>
-        <p>1. Нажми кнопки теста для каждого угла</p>
-        <p>2. Выбери правильный физический мотор из списка</p>
-        <p>3. Поставь галочку "Реверс" если мотор крутится наоборот</p>
-        <p>4. Нажми "Сохранить" когда все настроено</p>
-      </div>
-
-      <div class="robot-visual">
-        <!-- Передний-левый (M2) -->
-        <div class="motor-corner">
-          <div class="corner-header">
-            <div class="icon">↖️</div>
-            <h3>Передний-левый</h3>
-          </div>
-          <div class="test-controls">
-            <button class="btn forward" ontouchstart="sendCommand('test_1_fwd')" ontouchend="sendCommand('test_1_stop')" onmousedown="sendCommand('test_1_fwd')" onmouseup="sendCommand('test_1_stop')">⬆️</button>
-            <button class="btn test-stop" onclick="sendCommand('test_1_stop')">⏹️</button>
-            <button class="btn backward" ontouchstart="sendCommand('test_1_bwd')" ontouchend="sendCommand('test_1_stop')" onmousedown="sendCommand('test_1_bwd')" onmouseup="sendCommand('test_1_stop')">⬇️</button>
-          </div>
-          <div class="corner-settings">
-            <div class="setting-item">
-              <label>Физический мотор:</label>
-              <select id="map1" onchange="updateMapping(1)">
-                <option value="1">Мотор 1 (32,33)</option>
-                <option value="2">Мотор 2 (25,26)</option>
-                <option value="3">Мотор 3 (19,18)</option>
-                <option value="4">Мотор 4 (17,16)</option>
-              </select>
-            </div>
-            <div class="invert-check">
-              <input type="checkbox" id="inv1" onchange="updateInvert(1)">
-              <label for="inv1">Реверс</label>
-            </div>
-          </div>
-        </div>
-
-        <!-- Передний-правый (M1) -->
-        <div class="motor-corner">
-          <div class="corner-header">
-            <div class="icon">↗️</div>
-            <h3>Передний-правый</h3>
-          </div>
-          <div class="test-controls">
-            <button class="btn forward" ontouchstart="sendCommand('test_0_fwd')" ontouchend="sendCommand('test_0_stop')" onmousedown="sendCommand('test_0_fwd')" onmouseup="sendCommand('test_0_stop')">⬆️</button>
-            <button class="btn test-stop" onclick="sendCommand('test_0_stop')">⏹️</button>
-            <button class="btn backward" ontouchstart="sendCommand('test_0_bwd')" ontouchend="sendCommand('test_0_stop')" onmousedown="sendCommand('test_0_bwd')" onmouseup="sendCommand('test_0_stop')">⬇️</button>
-          </div>
-          <div class="corner-settings">
-            <div class="setting-item">
-              <label>Физический мотор:</label>
-              <select id="map0" onchange="updateMapping(0)">
-                <option value="1">Мотор 1 (32,33)</option>
-                <option value="2">Мотор 2 (25,26)</option>
-                <option value="3">Мотор 3 (19,18)</option>
-                <option value="4">Мотор 4 (17,16)</option>
-              </select>
-            </div>
-            <div class="invert-check">
-              <input type="checkbox" id="inv0" onchange="updateInvert(0)">
-              <label for="inv0">Реверс</label>
-            </div>
-          </div>
-        </div>
-
-        <!-- Задний-левый (M3) -->
-        <div class="motor-corner">
-          <div class="corner-header">
-            <div class="icon">↙️</div>
-            <h3>Задний-левый</h3>
-          </div>
-          <div class="test-controls">
-            <button class="btn forward" ontouchstart="sendCommand('test_2_fwd')" ontouchend="sendCommand('test_2_stop')" onmousedown="sendCommand('test_2_fwd')" onmouseup="sendCommand('test_2_stop')">⬆️</button>
-            <button class="btn test-stop" onclick="sendCommand('test_2_stop')">⏹️</button>
-            <button class="btn backward" ontouchstart="sendCommand('test_2_bwd')" ontouchend="sendCommand('test_2_stop')" onmousedown="sendCommand('test_2_bwd')" onmouseup="sendCommand('test_2_stop')">⬇️</button>
-          </div>
-          <div class="corner-settings">
-            <div class="setting-item">
-              <label>Физический мотор:</label>
-              <select id="map2" onchange="updateMapping(2)">
-                <option value="1">Мотор 1 (32,33)</option>
-                <option value="2">Мотор 2 (25,26)</option>
-                <option value="3">Мотор 3 (19,18)</option>
-                <option value="4">Мотор 4 (17,16)</option>
-              </select>
-            </div>
-            <div class="invert-check">
-              <input type="checkbox" id="inv2" onchange="updateInvert(2)">
-              <label for="inv2">Реверс</label>
-            </div>
-          </div>
-        </div>
-
-        <!-- Задний-правый (M4) -->
-        <div class="motor-corner">
-          <div class="corner-header">
-            <div class="icon">↘️</div>
-            <h3>Задний-правый</h3>
-          </div>
-          <div class="test-controls">
-            <button class="btn forward" ontouchstart="sendCommand('test_3_fwd')" ontouchend="sendCommand('test_3_stop')" onmousedown="sendCommand('test_3_fwd')" onmouseup="sendCommand('test_3_stop')">⬆️</button>
-            <button class="btn test-stop" onclick="sendCommand('test_3_stop')">⏹️</button>
-            <button class="btn backward" ontouchstart="sendCommand('test_3_bwd')" ontouchend="sendCommand('test_3_stop')" onmousedown="sendCommand('test_3_bwd')" onmouseup="sendCommand('test_3_stop')">⬇️</button>
-          </div>
-          <div class="corner-settings">
-            <div class="setting-item">
-              <label>Физический мотор:</label>
-              <select id="map3" onchange="updateMapping(3)">
-                <option value="1">Мотор 1 (32,33)</option>
-                <option value="2">Мотор 2 (25,26)</option>
-                <option value="3">Мотор 3 (19,18)</option>
-                <option value="4">Мотор 4 (17,16)</option>
-              </select>
-            </div>
-            <div class="invert-check">
-              <input type="checkbox" id="inv3" onchange="updateInvert(3)">
-              <label for="inv3">Реверс</label>
-            </div>
-          </div>
-        </div>
-      </div>
-
-      <div class="action-buttons">
-        <button class="btn save" onclick="saveSettings()">💾 Сохранить настройки</button>
-        <button class="btn reset" onclick="resetSettings()">🔄 Сброс</button>
-      </div>
-    </div>
-  </div>
-
-  <script>
-    let ws;
-    const statusEl = document.getElementById('status');
-    let currentDriveMode = 'omni';  // 'omni' or 'tank'
-
-    function initWebSocket() {
-      ws = new WebSocket('ws://' + window.location.hostname + '/ws');
-
-      ws.onopen = function() {
-        statusEl.textContent = '✓ Подключено';
-        statusEl.className = 'status connected';
-        sendCommand('get_config');
-      };
-
-      ws.onclose = function() {
-        statusEl.textContent = '✗ Отключено';
-        statusEl.className = 'status disconnected';
-        setTimeout(initWebSocket, 2000);
-      };
-
-      ws.onerror = function() {
-        statusEl.textContent = '✗ Ошибка подключения';
-        statusEl.className = 'status disconnected';
-      };
-
-      ws.onmessage = function(event) {
-        try {
-          const data = JSON.parse(event.data);
-          if (data.mapping && data.invert) {
-            loadConfigToUI(data);
-          } else if (data.status === 'saved') {
-            alert('💾 Настройки сохранены в память ESP32!');
-          }
-        } catch (e) {
-          console.log('Получено сообщение:', event.data);
-        }
-      };
-    }
+// ==================== САМОПИСЕЦ ====================
+
+#define CONTROL_WATCHDOG_MS 100   // Пауза между тактами, после которой срабатывает триггер
+
+// Запись такта: только копирование уже посчитанных значений
+void recordTick(const RobotState &st, uint32_t now, uint32_t loopUs) {
+  FlightRecord r;
+  r.timeMs = now;
+  r.loopUs = (uint16_t)(loopUs > 65535 ? 65535 : loopUs);
+  r.driveKind = st.drive.kind;
+  r.flags = 0;
+  if (output.driving) r.flags |= FREC_FLAG_DRIVING;
+  if (output.lowCutoff) r.flags |= FREC_FLAG_LOW_CUTOFF;
+  if (headingHold.holding()) r.flags |= FREC_FLAG_HOLDING;
+  if (obstacleGovernor.limitedMask() != 0) r.flags |= FREC_FLAG_OBSTACLE;
+  r.joyX = (int16_t)st.drive.joyX;
+  r.joyY = (int16_t)st.drive.joyY;
+  r.joyW = (int16_t)st.drive.joyW;
+  r.preset = st.drive.preset;
+  r.speed = (uint8_t)st.config.speed;
 
-    function sendCommand(cmd) {
-      if (ws && ws.readyState === WebSocket.OPEN) {
-        ws.send(cmd);
-      }
-    }
+  for (int i = 0; i < 4; i++) {
+    r.shaped[i] = output.driving ? (int16_t)output.written[i] : 0;
+    r.dutyQ15[i] = outputDutyQ15[i];
+  }
+  r.batteryMv = (uint16_t)battery.millivolts();
+  if (currentSense.sample(r.currentMa)) {
+    r.flags |= FREC_FLAG_CURRENT;
+  } else {
+    memset(r.currentMa, 0, sizeof(r.currentMa));
+  }
 
-    function updateSpeed() {
-      const speed = document.getElementById('speedSlider').value;
-      document.getElementById('speedValue').textContent = speed;
-      document.getElementById('speedSlider2').value = speed;
-      document.getElementById('speedValue2').textContent = speed;
-      sendCommand('speed:' + speed);
-    }
+  uint32_t yaw;
+  int32_t rate;
+  r.yawCdeg = 0;
+  if (gyro != nullptr && gyro->read(yaw, rate)) {
+    r.yawCdeg = (int16_t)(angleToMdeg(yaw) / 10);
+    r.flags |= FREC_FLAG_GYRO;
+  }
+  r.omega = (int16_t)headingHold.correction();
+  r.residualMmps = fxSat16(traction.residualMmps());
+  r.slipMask = traction.slipMask();
+  r.brakeMask = outputBrakeMask;
+  r.reserved = 0;
 
-    function updateSpeed2() {
-      const speed = document.getElementById('speedSlider2').value;
-      document.getElementById('speedValue2').textContent = speed;
-      document.getElementById('speedSlider').value = speed;
-      document.getElementById('speedValue').textContent = speed;
-      sendCommand('speed:' + speed);
-    }
+  flightRecorder.record(r);
+}
 
-    function switchTab(index) {
-      const tabs = document.querySelectorAll('.tab');
-      const contents = document.querySelectorAll('.tab-content');
+// Такты на снимке прошлого такта (писатель не успел опубликовать).
+// Задача управления не печатает: Serial может блокировать и делит UART с
+// проводной связью. Счётчик уходит в телеметрию.
+std::atomic<uint32_t> stateReadMisses{0};
+
+// Снимок читается один раз за такт, поэтому новое состояние (включая
+// маппинг и инверсию) применяется целиком или не применяется
+void controlTick() {
+  static uint32_t appliedVersion = UINT32_MAX;
+  static uint32_t lastStart = 0;
+
+  static RobotState lastGood = defaultRobotState();
+
+  uint32_t startUs = micros();
+  uint32_t now = millis();
+  RobotState st;
+  uint32_t version;
+  // Такт не ждёт писателя: при неудаче — снимок прошлого такта
+  if (robotState.tryRead(st, version)) {
+    lastGood = st;
+  } else {
+    stateReadMisses.fetch_add(1, std::memory_order_relaxed);
+    st = lastGood;
+    version = appliedVersion;
+  }
+  bool changed = version != appliedVersion;
+  appliedVersion = version;
 
-      tabs.forEach((tab, i) => {
-        tab.classList.toggle('active', i === index);
-      });
+  // Задача управления не получала процессор: зафиксировать, что было до паузы
+  if (lastStart != 0 && now - lastStart > CONTROL_WATCHDOG_MS) {
+    Serial.printf("✗ Такт управления пропущен: пауза %u мс\n", now - lastStart);
+    flightRecorder.trigger(FREEZE_WATCHDOG, now);
+  }
+  lastStart = now;
 
-      contents.forEach((content, i) => {
-        content.classList.toggle('active', i === index);
-      });
+  controlStep(st, version, changed, now);
+  recordTick(st, now, micros() - startUs);
+  benchMotorsTick(st);
+}
 
-      sendCommand('stop');
-    }
+void controlTask(void *param) {
+  TickType_t lastWake = xTaskGetTickCount();
+  for (;;) {
+    controlTick();
+    vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(CONTROL_PERIOD_MS));
+  }
+}
 
-    function loadConfigToUI(config) {
-      for (let i = 0; i < 4; i++) {
-        document.getElementById('map' + i).value = config.mapping[i];
-        document.getElementById('inv' + i).checked = config.invert[i];
-      }
+// ==================== ТЕЛЕМЕТРИЯ ====================
+
+String getTelemetryJSON() {
+  String json = "{\"telemetry\":{";
+  json += "\"battery_mv\":" + String(battery.millivolts());
+  json += ",\"soc\":" + String(battery.stateOfCharge());
+  json += ",\"low\":";
+  json += battery.isLow() ? "true" : "false";
+  json += ",\"pwm_scale\":" + String(battery.scaleQ8() / 256.0f, 2);
+
+  uint16_t ma[4];
+  if (currentSense.sample(ma)) {
+    json += ",\"current_ma\":[";
+    for (int i = 0; i < 4; i++) {
+      if (i > 0) json += ",";
+      json += String(ma[i]);
+    }
+    json += "],\"total_ma\":" + String(powerGuard.totalMilliamps());
+    json += ",\"stalled\":" + String(powerGuard.stalledMask());
+    json += ",\"power_scale\":" + String(powerGuard.scaleQ8() / 256.0f, 2);
+  }
+  if (characterizer.running()) {
+    json += ",\"char_progress\":" + String(characterizer.progress());
+  }
+  uint32_t yaw;
+  int32_t rate;
+  if (gyro != nullptr && gyro->read(yaw, rate)) {
+    json += ",\"yaw\":" + String(angleToMdeg(yaw) / 1000.0f, 1);
+    json += ",\"heading\":{\"hold\":";
+    json += headingHold.holding() ? "true" : "false";
+    json += ",\"err\":" + String(headingHold.errorMdeg() / 1000.0f, 2);
+    json += ",\"omega\":" + String(headingHold.correction()) + "}";
+  }
+  uint32_t misses = stateReadMisses.load(std::memory_order_relaxed);
+  if (misses != 0) json += ",\"state_misses\":" + String(misses);
+  if (flightRecorder.frozen()) {
+    json += ",\"recorder\":\"";
+    json += freezeReasonName(flightRecorder.reason());
+    json += "\"";
+  }
+  if (rangeSource != nullptr) {
+    // Расстояния по датчикам, мм: null — не установлен, -1 — замолчал
+    json += ",\"ranges\":{\"mm\":[";
+    for (uint8_t i = 0; i < obstacleGovernor.sensors(); i++) {
+      uint16_t mm = obstacleGovernor.rangeMm(i);
+      if (i > 0) json += ",";
+      json += mm == OBSTACLE_NOT_FITTED ? String("null") : String(mm == OBSTACLE_BLIND ? -1 : (int)mm);
+    }
+    json += "],\"limited\":" + String(obstacleGovernor.limitedMask());
+    json += ",\"events\":" + String(obstacleGovernor.events()) + "}";
+  }
+  if (wheelSpeedSource != nullptr) {
+    json += ",\"traction\":{\"slip\":" + String(traction.slipMask());
+    json += ",\"residual\":" + String(traction.residualMmps());
+    json += ",\"events\":" + String(traction.events()) + "}";
+  }
+  json += "}}";
+  return json;
+}
+
+void telemetryTick() {
+  static uint32_t lastSent = 0;
+  uint32_t now = millis();
+  if (now - lastSent < TELEMETRY_PERIOD_MS) return;
+  lastSent = now;
+
+  if (broadcaster.clientCount() == 0) return;
+  HeapScope heapScope(HEAP_TAG_TELEMETRY);
+  sendAll(getTelemetryJSON(), MsgClass::Telemetry);
+}
 
-      // Load drive mode
-      if (config.omniMode !== undefined) {
-        currentDriveMode = config.omniMode ? 'omni' : 'tank';
-        updateDriveModeUI();
+// ==================== ПОТОК ПОЗЫ ====================
+// Подписка — на клиента: "pose:N" задаёт частоту до POSE_MAX_RATE_HZ.
+// Поза уходит классом Telemetry: медленный клиент теряет старые позы,
+// а не копит очередь.
+
+struct PoseSubscriber {
+  std::atomic<uint32_t> clientId;   // 0 = свободно
+  std::atomic<uint16_t> periodMs;   // 0 = не отправлять
+  uint32_t lastSent;                // Только loop()
+};
+
+PoseSubscriber poseSubscribers[WS_MAX_CLIENTS];
+
+void setPoseRate(uint32_t clientId, uint8_t hz) {
+  for (PoseSubscriber &s : poseSubscribers) {
+    if (s.clientId.load() == clientId) {
+      if (hz == 0) {
+        s.periodMs.store(0);
+        s.clientId.store(0);
+      } else {
+        s.periodMs.store(1000 / hz);
       }
+      return;
     }
+  }
+  if (hz == 0) return;
 
-    function updateMapping(pos) {
-      const value = document.getElementById('map' + pos).value;
-      sendCommand('set_map:' + pos + ':' + value);
+  for (PoseSubscriber &s : poseSubscribers) {
+    uint32_t expected = 0;
+    if (s.clientId.compare_exchange_strong(expected, clientId)) {
+      s.periodMs.store(1000 / hz);
+      return;
     }
+  }
+}
 
-    function updateInvert(pos) {
-      const value = document.getElementById('inv' + pos).checked;
-      sendCommand('set_inv:' + pos + ':' + value);
-    }
+String getPoseJSON() {
+  OdomPose pose = odomPose.read();
+  String json = "{\"pose\":{\"x\":" + String(pose.xUm / 1000.0f, 1);
+  json += ",\"y\":" + String(pose.yUm / 1000.0f, 1);
+  json += ",\"th\":" + String(angleToMrad(pose.heading));
+  json += ",\"vf\":" + String(pose.vForwardMmps);
+  json += ",\"vl\":" + String(pose.vLeftMmps);
+  json += ",\"w\":" + String(pose.omegaMradps);
+  json += ",\"src\":\"";
+  json += pose.fromEncoders ? "enc" : "cmd";
+  json += "\",\"t\":" + String(millis()) + "}}";
+  return json;
+}
 
-    function saveSettings() {
-      // Применить все текущие настройки
-      for (let i = 0; i < 4; i++) {
-        updateMapping(i);
-        updateInvert(i);
-      }
-      // Отправить текущий режим вождения
-      sendCommand(currentDriveMode === 'omni' ? 'mode_omni' : 'mode_tank');
-      // Сохранить в EEPROM
-      sendCommand('save_config');
-    }
+void poseTick() {
+  HeapScope heapScope(HEAP_TAG_TELEMETRY);
+  uint32_t now = millis();
+  String json;
 
-    function resetSettings() {
-      if (confirm('Сбросить все настройки к дефолту?')) {
-        sendCommand('reset_config');
-        alert('🔄 Настройки сброшены! Не забудь сохранить.');
-      }
+  for (PoseSubscriber &s : poseSubscribers) {
+    uint32_t id = s.clientId.load();
+    uint16_t period = s.periodMs.load();
+    if (id == 0 || period == 0 || now - s.lastSent < period) continue;
+
+    s.lastSent = now;
+    if (json.length() == 0) json = getPoseJSON();
+    sendTo(id, json, MsgClass::Telemetry);
+  }
+}
+
+// ==================== ПРОФИЛЬ КУЧИ ====================
+// Замер раз в HEAP_SAMPLE_PERIOD_MS (heap_profile.h), сводка в журнал раз
+// в минуту. Строки собираются в буфере на стеке: Serial.printf длиннее
+// 64 байт сам выделяет память и попадал бы в счётчики.
+
+#define HEAP_REPORT_SAMPLES 6       // Сводка в журнал: раз в 6 замеров
+#define HEAP_LOW_BLOCK_BYTES 16384  // Наибольший блок меньше — предупреждение
+
+HeapSample heapSampleNow() {
+  HeapSample s;
+  s.ms = millis();
+  s.freeBytes = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+  s.largestBlock = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+  s.minFree = heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT);
+  return s;
+}
+
+String getHeapJSON() {
+  HeapSample now = heapSampleNow();
+  String json = "{\"heap\":{\"free\":" + String(now.freeBytes);
+  json += ",\"largest\":" + String(now.largestBlock);
+  json += ",\"min_free\":" + String(now.minFree);
+  json += ",\"frag\":" + String(HeapProfile::fragmentation(now));
+#ifdef HEAP_PROFILE_WRAP
+  json += ",\"counting\":true";
+#else
+  json += ",\"counting\":false";
+#endif
+  json += ",\"allocs\":" + String(heapProfile.totalAllocs());
+  json += ",\"frees\":" + String(heapProfile.totalFrees());
+
+  json += ",\"tags\":[";
+  for (int t = 0; t < HEAP_TAG_COUNT; t++) {
+    HeapTagCounters c = heapProfile.tagCounters(t);
+    if (t > 0) json += ",";
+    json += "{\"tag\":\"";
+    json += heapTagName(t);
+    json += "\",\"allocs\":" + String(c.allocs);
+    json += ",\"bytes\":" + String(c.bytes);
+    json += ",\"calls\":" + String(c.calls) + "}";
+  }
+
+  // Выделения в истории — в порядке tags
+  json += "],\"period\":" + String(HEAP_SAMPLE_PERIOD_MS);
+  json += ",\"history\":[";
+  for (size_t i = 0; i < heapProfile.historyCount(); i++) {
+    const HeapHistoryEntry &e = heapProfile.history(i);
+    if (i > 0) json += ",";
+    json += "{\"t\":" + String(e.sample.ms);
+    json += ",\"free\":" + String(e.sample.freeBytes);
+    json += ",\"largest\":" + String(e.sample.largestBlock);
+    json += ",\"min_free\":" + String(e.sample.minFree);
+    json += ",\"allocs\":[";
+    for (int t = 0; t < HEAP_TAG_COUNT; t++) {
+      if (t > 0) json += ",";
+      json += String(e.allocs[t]);
+    }
+    json += "]}";
+  }
+  json += "]";
+
+#ifdef HEAP_TRACE_SITES
+  json += ",\"sites\":[";
+  bool first = true;
+  for (size_t i = 0; i < HEAP_SITES; i++) {
+    HeapSite site;
+    if (!heapProfile.site(i, site)) continue;
+    if (!first) json += ",";
+    first = false;
+    json += "{\"pc\":\"0x" + String((uint32_t)site.pc, HEX);
+    json += "\",\"tag\":\"";
+    json += heapTagName(site.tag);
+    json += "\",\"n\":" + String(site.count);
+    json += ",\"bytes\":" + String(site.bytes) + "}";
+  }
+  json += "],\"sites_dropped\":" + String(heapProfile.sitesDropped());
+#endif
+  json += "}}";
+  return json;
+}
+
+// Места выделения в журнал, по строке на место: удобно скормить
+// xtensa-esp32-elf-addr2line -pfiaC -e firmware.elf
+void printHeapSites() {
+#ifdef HEAP_TRACE_SITES
+  char line[96];
+  Serial.println("Места выделения (pc, метка, число, байт):");
+  for (size_t i = 0; i < HEAP_SITES; i++) {
+    HeapSite site;
+    if (!heapProfile.site(i, site)) continue;
+    snprintf(line, sizeof(line), "  0x%08x %-9s %6u %8u", (unsigned)site.pc, heapTagName(site.tag),
+             site.count, site.bytes);
+    Serial.println(line);
+  }
+#endif
+}
+
+void heapTick() {
+  static uint32_t lastSample = 0;
+  static uint8_t samples = 0;
+  uint32_t now = millis();
+  if (now - lastSample < HEAP_SAMPLE_PERIOD_MS) return;
+  lastSample = now;
+
+  HeapSample s = heapSampleNow();
+  heapProfile.record(s);
+  if (++samples < HEAP_REPORT_SAMPLES) return;
+  samples = 0;
+
+  // Выделения по меткам за последнюю минуту, только ненулевые
+  char line[256];
+  int n = snprintf(line, sizeof(line), "%s Куча: свободно %u, блок %u (фрагм. %u%%), минимум %u; за минуту:",
+                   s.largestBlock < HEAP_LOW_BLOCK_BYTES ? "✗" : " ", s.freeBytes, s.largestBlock,
+                   HeapProfile::fragmentation(s), s.minFree);
+  size_t count = heapProfile.historyCount();
+  for (int t = 0; t < HEAP_TAG_COUNT && n < (int)sizeof(line); t++) {
+    uint32_t sum = 0;
+    for (size_t i = count > HEAP_REPORT_SAMPLES ? count - HEAP_REPORT_SAMPLES : 0; i < count; i++) {
+      sum += heapProfile.history(i).allocs[t];
+    }
+    if (sum > 0) n += snprintf(line + n, sizeof(line) - n, " %s %u", heapTagName(t), sum);
+  }
+  Serial.println(line);
+}
+
+// ==================== СРАВНЕНИЕ PWM ПРОФИЛЕЙ ====================
+// Без моторов: для каждого профиля считается, сколько разных значений
+// скважности получают скорости 1..PWM_BENCH_LOW_SPEED после таблицы
+// линеаризации. Берётся худший из четырёх моторов.
+
+static int32_t benchDuty(int speed, void *ctx) {
+  return linearizer.applyQ16(*(int*)ctx, speed);
+}
+
+String getPwmBenchJSON() {
+  PwmBenchResult worst[PWM_PROFILE_COUNT];
+  for (int m = 1; m <= 4; m++) {
+    PwmBenchResult r[PWM_PROFILE_COUNT];
+    pwmBench(benchDuty, &m, r);
+    for (int p = 0; p < PWM_PROFILE_COUNT; p++) {
+      if (m == 1 || r[p].levels < worst[p].levels) worst[p].levels = r[p].levels;
+      if (m == 1 || r[p].maxErrorPpm > worst[p].maxErrorPpm) worst[p].maxErrorPpm = r[p].maxErrorPpm;
+      worst[p].profile = r[p].profile;
+      worst[p].stepPpm = r[p].stepPpm;
     }
+  }
+
+  String json = "{\"pwm_bench\":{\"low_speed\":" + String(PWM_BENCH_LOW_SPEED);
+  json += ",\"profiles\":[";
+  for (int p = 0; p < PWM_PROFILE_COUNT; p++) {
+    const PwmProfile &prof = pwmProfile(p);
+    if (p > 0) json += ",";
+    json += "{\"id\":" + String(p);
+    json += ",\"name\":\"" + String(prof.name) + "\"";
+    json += ",\"freq\":" + String(prof.freq);
+    json += ",\"bits\":" + String(prof.bits);
+    json += ",\"levels\":" + String(worst[p].levels);
+    json += ",\"step_ppm\":" + String(worst[p].stepPpm);
+    json += ",\"max_error_ppm\":" + String(worst[p].maxErrorPpm) + "}";
+    Serial.printf("  %-10s %5u Гц %2u бит: %2u уровней, шаг %u ppm\n", prof.name,
+                  prof.freq, prof.bits, worst[p].levels, worst[p].stepPpm);
+  }
+  json += "],\"active\":[";
+  for (int i = 0; i < 4; i++) {
+    if (i > 0) json += ",";
+    json += String(appliedPwm[i]);
+  }
+  json += "]}}";
+  return json;
+}
+
+// ==================== WEBSOCKET ОБРАБОТЧИКИ ====================
+
+// Журнал обработчиков команд (commands.cpp)
+void commandLog(const char *fmt, ...) {
+  if (commandLogQuiet.load(std::memory_order_relaxed)) return;
+  HeapScope heapScope(HEAP_TAG_LOG);
+  char buf[128];
+  va_list ap;
+  va_start(ap, fmt);
+  vsnprintf(buf, sizeof(buf), fmt, ap);
+  va_end(ap);
+  Serial.print(buf);
+}
+
+// Обработка сообщения: одна команда или пакет "cmd1;cmd2;..." (payload без завершающего нуля),
+// разбор и публикация — command_core.h. Ядро команд общее для всех транспортов:
+// команды разных клиентов выполняются по одной (настройки, NVS, подписки).
+std::mutex commandLock;
+
+// ---------- Возраст кадров управления ----------
+// Часы клиентов меняются только под commandLock (handleCommand).
+
+ClientClocks clientClocks;
+
+// Ответ на замер часов: t1 клиента и время робота t2, по модулю меток
+String getSyncJSON(uint32_t t1) {
+  return "{\"sync\":{\"t1\":" + String(t1) + ",\"t2\":" + String(millis() % CLOCK_STAMP_MODULO) + "}}";
+}
+
+String getClockStatsJSON() {
+  String json = "{\"clocks\":[";
+  bool first = true;
+  for (int i = 0; i < WS_MAX_CLIENTS + 1; i++) {
+    const ClientClock &c = clientClocks.slot(i);
+    if (c.clientId == 0) continue;
+    if (!first) json += ",";
+    first = false;
+
+    json += "{\"id\":" + String(c.clientId);
+    json += ",\"offset\":" + String(c.offsetMs);
+    json += ",\"rtt\":" + String(c.rttMs);
+    json += ",\"syncs\":" + String(c.syncs);
+    json += ",\"frames\":" + String(c.frames);
+    json += ",\"age_mean\":" + String(c.frames > 0 ? c.ageSumMs / c.frames : 0);
+    json += ",\"age_max\":" + String(c.ageMaxMs);
+    json += ",\"age_last\":" + String(c.lastAgeMs);
+    json += ",\"age_hist\":[";
+    for (int b = 0; b < CLOCK_AGE_BUCKETS; b++) {
+      if (b > 0) json += ",";
+      json += String(c.buckets[b]);
+    }
+    json += "],\"decayed\":" + String(c.decayed);
+    json += ",\"stale\":" + String(c.stale) + "}";
+  }
+  json += "]}";
+  return json;
+}
+
+void handleCommand(uint32_t clientId, const uint8_t *payload, size_t len) {
+  std::lock_guard<std::mutex> guard(commandLock);
+  HeapScope heapScope(HEAP_TAG_COMMAND);
+  CommandEffects fx = {};
 
-    // ========== ПЕРЕКЛЮЧЕНИЕ РЕЖИМА ВОЖДЕНИЯ ==========
-    function switchDriveMode(mode) {
-      currentDriveMode = mode;
-      sendCommand(mode === 'omni' ? 'mode_omni' : 'mode_tank');
-      updateDriveModeUI();
+  MessageResult r = processCommandMessage(clientId, (const char*)payload, len, millis(),
+                                          robotState, clientClocks, fx);
+
+  if (r.failed) {
+    // Одиночные неизвестные команды игнорируются, как и раньше
+    if (r.batch) {
+      sendTo(clientId, "{\"ack\":\"batch\",\"ok\":false,\"index\":" + String(r.count) + "}");
     }
+    return;
+  }
+  if (r.count == 0) return;
+
+  if (fx.saved) saveConfig();
+  if (fx.linReset) lutResetPending.store(true);
+  if (fx.odomReset) odomResetPending.store(true);
+  if (fx.estop) flightRecorder.trigger(FREEZE_ESTOP, millis());
+  if (fx.recFreeze) flightRecorder.trigger(FREEZE_MANUAL, millis());
+  if (fx.recArm) flightRecorder.rearm();
+  if (fx.bench && !requestBench(clientId)) sendTo(clientId, "{\"bench\":{\"error\":\"busy\"}}");
+  if (fx.poseRateSet) setPoseRate(clientId, fx.poseRate);
+  if (fx.clockSet && !clientClocks.sync(clientId, fx.clockOffsetMs, fx.clockRttMs)) {
+    Serial.println("✗ Таблица часов клиентов заполнена");
+  }
+  if (fx.heapReset) heapProfile.reset();
+
+  // Ответы считаются отдельно от разбора: разбор должен обходиться без кучи
+  HeapScope replyScope(HEAP_TAG_REPLY);
+  if (fx.heapStats) printHeapSites();
+
+  if (r.batch) {
+    String ack = "{\"ack\":\"batch\",\"ok\":true,\"n\":" + String(r.count);
+    if (fx.saved) ack += ",\"saved\":true";
+    if (r.age == AGE_STALE) ack += ",\"stale\":true";
+    if (fx.sendConfig) ack += ",\"config\":" + getConfigJSON();
+    ack += "}";
+    sendTo(clientId, ack);
+    if (fx.wsStats) sendTo(clientId, getWsStatsJSON());
+    if (fx.linkStats) sendTo(clientId, getLinkStatsJSON());
+    if (fx.pwmBench) sendTo(clientId, getPwmBenchJSON());
+    if (fx.pong) sendTo(clientId, "{\"pong\":" + String(millis()) + "}");
+    if (fx.sync) sendTo(clientId, getSyncJSON(fx.syncT1));
+    if (fx.clockStats) sendTo(clientId, getClockStatsJSON());
+    if (fx.heapStats) sendTo(clientId, getHeapJSON());
+    return;
+  }
 
-    function updateDriveModeUI() {
-      const btnOmni = document.getElementById('driveOmni');
-      const btnTank = document.getElementById('driveTank');
-      const joystickModeText = document.getElementById('joystickModeText');
-      const buttonsModeText = document.getElementById('buttonsModeText');
-      const joystickSideLabel = document.getElementById('joystickSideLabel');
-      const buttonsSideLabel = document.getElementById('buttonsSideLabel');
-
-      if (currentDriveMode === 'omni') {
-        btnOmni.classList.add('active');
-        btnTank.classList.remove('active');
-        joystickModeText.textContent = 'стрейф';
-        buttonsModeText.textContent = 'стрейф';
-        joystickSideLabel.textContent = 'Стрейф';
-        buttonsSideLabel.textContent = 'Стрейф';
-      } else {
-        btnOmni.classList.remove('active');
-        btnTank.classList.add('active');
-        joystickModeText.textContent = 'разворот';
-        buttonsModeText.textContent = 'разворот';
-        joystickSideLabel.textContent = 'Разворот';
-        buttonsSideLabel.textContent = 'Разворот';
+  if (fx.sendConfig) sendAll(getConfigJSON());
+  if (fx.saved) sendAll("{\"status\":\"saved\"}");
+  if (fx.wsStats) sendTo(clientId, getWsStatsJSON());
+  if (fx.linkStats) sendTo(clientId, getLinkStatsJSON());
+  if (fx.pwmBench) sendTo(clientId, getPwmBenchJSON());
+  if (fx.pong) sendTo(clientId, "{\"pong\":" + String(millis()) + "}");
+  if (fx.sync) sendTo(clientId, getSyncJSON(fx.syncT1));
+  if (fx.clockStats) sendTo(clientId, getClockStatsJSON());
+  if (fx.heapStats) sendTo(clientId, getHeapJSON());
+}
+
+// Сборка сообщения из кусков и передача целого сообщения в обработчик команд
+void handleWebSocketMessage(AsyncWebSocketClient *client, void *arg, uint8_t *data, size_t len) {
+  HeapScope heapScope(HEAP_TAG_WS);
+  AwsFrameInfo *info = (AwsFrameInfo*)arg;
+
+  WsChunk chunk;
+  chunk.messageOpcode = info->message_opcode;
+  chunk.frameNum = info->num;
+  chunk.final = info->final;
+  chunk.frameLen = info->len;
+  chunk.index = info->index;
+
+  const uint8_t *payload;
+  size_t payloadLen;
+  uint8_t opcode;
+  WsAssembleResult result = assembler.feed(client->id(), chunk, data, len,
+                                           &payload, &payloadLen, &opcode);
+
+  switch (result) {
+    case WsAssembleResult::Incomplete:
+      break;
+    case WsAssembleResult::Complete:
+      if (opcode == WS_TEXT) {
+        handleCommand(client->id(), payload, payloadLen);
       }
-    }
+      break;
+    case WsAssembleResult::TooLarge:
+      Serial.printf("✗ Сообщение от #%u больше %d байт, отброшено\n", client->id(), WS_MAX_MESSAGE);
+      sendTo(client->id(), "{\"error\":\"too_large\",\"limit\":" + String(WS_MAX_MESSAGE) + "}");
+      break;
+    case WsAssembleResult::NoSlot:
+      sendTo(client->id(), "{\"error\":\"busy\"}");
+      break;
+    case WsAssembleResult::Protocol:
+      sendTo(client->id(), "{\"error\":\"fragment\"}");
+      break;
+  }
+}
 
-    document.addEventListener('selectstart', function(e) {
-      e.preventDefault();
-    });
+// Клиент любого транспорта появился / ушёл
+bool clientConnected(uint32_t clientId) {
+  if (!broadcaster.addClient(clientId)) {
+    Serial.println("✗ Слишком много клиентов");
+    return false;
+  }
+  // Отправить текущую конфигурацию при подключении
+  sendTo(clientId, getConfigJSON());
+  pumpTransports();
+  return true;
+}
+
+void clientDisconnected(uint32_t clientId) {
+  broadcaster.removeClient(clientId);
+  setPoseRate(clientId, 0);
+  {
+    std::lock_guard<std::mutex> guard(commandLock);
+    clientClocks.remove(clientId);
+  }
+  requestStop(STOP_BRAKE_COAST); // Остановить при отключении
+}
 
-    // ========== ДЖОЙСТИК ==========
-    let joystickActive = false;
-    let joystickX = 0;
-    let joystickY = 0;
-
-    function initJoystick() {
-      const canvas = document.getElementById('joystickCanvas');
-      if (!canvas) return;
-
-      const ctx = canvas.getContext('2d');
-      const rect = canvas.getBoundingClientRect();
-      canvas.width = rect.width;
-      canvas.height = rect.height;
-
-      const centerX = canvas.width / 2;
-      const centerY = canvas.height / 2;
-      const maxRadius = Math.min(canvas.width, canvas.height) / 2 - 20;
-
-      function drawJoystick() {
-        ctx.clearRect(0, 0, canvas.width, canvas.height);
-
-        // Внешний круг
-        ctx.beginPath();
-        ctx.arc(centerX, centerY, maxRadius, 0, 2 * Math.PI);
-        ctx.strokeStyle = '#e2e8f0';
-        ctx.lineWidth = 2;
-        ctx.stroke();
-
-        // Центр
-        ctx.beginPath();
-        ctx.arc(centerX, centerY, 5, 0, 2 * Math.PI);
-        ctx.fillStyle = '#cbd5e1';
-        ctx.fill();
-
-        // Стик
-        const stickX = centerX + joystickX * maxRadius / 255;
-        const stickY = centerY + joystickY * maxRadius / 255;
-        ctx.beginPath();
-        ctx.arc(stickX, stickY, 30, 0, 2 * Math.PI);
-        ctx.fillStyle = joystickActive ? '#3b82f6' : '#94a3b8';
-        ctx.fill();
-        ctx.strokeStyle = 'white';
-        ctx.lineWidth = 3;
-        ctx.stroke();
+void onEvent(AsyncWebSocket *server, AsyncWebSocketClient *client, AwsEventType type,
+             void *arg, uint8_t *data, size_t len) {
+  switch (type) {
+    case WS_EVT_CONNECT:
+      Serial.printf("WebSocket клиент #%u подключен\n", client->id());
+      if (!clientConnected(client->id())) {
+        std::lock_guard<std::mutex> guard(wsLock);
+        client->close();
       }
+      break;
+    case WS_EVT_DISCONNECT:
+      Serial.printf("WebSocket клиент #%u отключен\n", client->id());
+      {
+        // Библиотека удаляет клиента после события: дождаться отправки,
+        // начатой другой задачей, пока объект ещё жив
+        std::lock_guard<std::mutex> guard(wsLock);
+      }
+      assembler.release(client->id());
+      clientDisconnected(client->id());
+      break;
+    case WS_EVT_DATA:
+      handleWebSocketMessage(client, arg, data, len);
+      // Ответы уходят сразу, не дожидаясь следующего прохода loop()
+      pumpTransports();
+      break;
+    case WS_EVT_PONG:
+      if (client->id() == benchClient.load()) benchPongUs.store(micros());
+      break;
+    case WS_EVT_ERROR:
+      break;
+  }
+}
 
-      function handleMove(clientX, clientY) {
-        const rect = canvas.getBoundingClientRect();
-        const x = clientX - rect.left - centerX;
-        const y = clientY - rect.top - centerY;
+// ==================== ПРОВОДНАЯ СВЯЗЬ ====================
+// Кадры COBS по USB-UART (serial_link.h) — тот же протокол, что по
+// WebSocket. Задача связи просыпается по приходу байт (onReceive), поэтому
+// команда применяется в ближайший такт управления без ожидания loop().
+// Клиент "подключается" первым целым кадром и отключается, если кадров нет
+// LINK_TIMEOUT_MS (хост шлёт "ping"): обрыв кабеля останавливает робота.
 
-        const distance = Math.sqrt(x * x + y * y);
-        const angle = Math.atan2(y, x);
+TaskHandle_t linkTaskHandle = nullptr;
 
-        const clampedDistance = Math.min(distance, maxRadius);
+void onLinkFrame(void *ctx, const uint8_t *data, size_t len) {
+  if (!linkTransport.connected) {
+    linkTransport.connected = clientConnected(LINK_CLIENT_ID);
+    if (!linkTransport.connected) return;
+    Serial.println("✓ Проводной клиент подключен");
+  }
+  linkTransport.lastFrameMs = millis();
+  handleCommand(LINK_CLIENT_ID, data, len);
+}
 
-        joystickX = Math.round((clampedDistance * Math.cos(angle) / maxRadius) * 255);
-        joystickY = -Math.round((clampedDistance * Math.sin(angle) / maxRadius) * 255);  // Инвертируем Y
+void linkTask(void *param) {
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(100));
+    HeapScope heapScope(HEAP_TAG_LINK);
+    uint32_t frames = linkTransport.link.stats().rxFrames;
+    linkTransport.link.poll(onLinkFrame, nullptr, nullptr);
 
-        drawJoystick();
-        sendCommand('joy:' + joystickX + ':' + joystickY);
-      }
+    if (linkTransport.connected &&
+        (linkTransport.timedOut.exchange(false) || millis() - linkTransport.lastFrameMs > LINK_TIMEOUT_MS)) {
+      linkTransport.connected = false;
+      clientDisconnected(LINK_CLIENT_ID);
+      Serial.println("✗ Проводной клиент отключен");
+    }
+    if (linkTransport.link.stats().rxFrames != frames) pumpTransports();
+  }
+}
 
-      function handleEnd() {
-        joystickActive = false;
-        joystickX = 0;
-        joystickY = 0;
-        drawJoystick();
-        sendCommand('stop');
-      }
+// ==================== БЕНЧМАРК: ПРОТОКОЛ, JSON, NVS ====================
+
+struct BenchCommand {
+  const char *name;
+  const char *text;
+};
+
+static const BenchCommand benchCommands[] = {
+  {"parse_preset",  "forward"},
+  {"parse_joy",     "joy:-120:200"},
+  {"parse_speed",   "speed:180"},
+  {"parse_set_map", "set_map:0:2"},
+  {"parse_test",    "test_0_fwd"},
+  {"parse_batch",   "joy:10:20;speed:100;mode_omni"},
+  {"parse_stamped", "at:1000;joy:-120:200"},
+};
+
+WsFrameAssembler benchAssembler;   // Свой, чтобы не занимать слоты клиентов
+BenchStats benchEcho;              // Эхо WebSocket, мкс
+uint32_t benchPingUs = 0;
+uint32_t benchPingMs = 0;
+std::mutex benchMutex;
+String benchLastJSON;              // Под benchMutex: читается из HTTP
+
+// Путь handleWebSocketMessage -> handleCommand: сборка кадра и ядро команд
+// (метка "at:", пакет, часы клиента, публикация) на своих снимке и часах,
+// чтобы замер не менял состояние робота
+static SeqLock<RobotState> benchState(defaultRobotState());
+static ClientClocks benchClocks;
+
+static void benchParse(const char *text) {
+  size_t len = strlen(text);
+  WsChunk chunk = {WS_TEXT, 0, true, len, 0};
+  const uint8_t *payload;
+  size_t payloadLen;
+  uint8_t opcode;
+  if (benchAssembler.feed(0, chunk, (const uint8_t*)text, len, &payload, &payloadLen, &opcode) !=
+      WsAssembleResult::Complete) {
+    return;
+  }
 
-      // Touch events
-      canvas.addEventListener('touchstart', (e) => {
-        e.preventDefault();
-        joystickActive = true;
-        handleMove(e.touches[0].clientX, e.touches[0].clientY);
-      });
+  CommandEffects fx = {};
+  MessageResult r = processCommandMessage(BENCH_PARSE_CLIENT, (const char*)payload, payloadLen, millis(),
+                                          benchState, benchClocks, fx);
+  benchSink += r.count;
+}
 
-      canvas.addEventListener('touchmove', (e) => {
-        e.preventDefault();
-        if (joystickActive) {
-          handleMove(e.touches[0].clientX, e.touches[0].clientY);
-        }
-      });
+void benchHost() {
+  // Журнал команд в Serial не замеряется: он блокирует на заполненном буфере
+  commandLogQuiet.store(true);
+  benchState.write(robotState.read());
+  // Метка "at:1000" — свежий кадр: часы клиента отстают от робота на это время
+  benchClocks.sync(BENCH_PARSE_CLIENT, millis() - 1000, 0);
+  for (const BenchCommand &c : benchCommands) {
+    benchRun(benchResults[benchCount++], c.name, BENCH_ITERATIONS, benchCycles, [&c](uint32_t) {
+      benchParse(c.text);
+    });
+  }
+  commandLogQuiet.store(false);
 
-      canvas.addEventListener('touchend', (e) => {
-        e.preventDefault();
-        handleEnd();
-      });
+  benchRun(benchResults[benchCount++], "config_json", BENCH_ITERATIONS / 4, benchCycles, [](uint32_t) {
+    benchSink += getConfigJSON().length();
+  });
 
-      // Mouse events
-      canvas.addEventListener('mousedown', (e) => {
-        joystickActive = true;
-        handleMove(e.clientX, e.clientY);
-      });
+  // Те же ключи, что saveConfig/loadConfig, в отдельном пространстве NVS:
+  // настройки робота не трогаются
+  Preferences prefs;
+  prefs.begin("bench", false);
+  RobotConfig cfg = robotState.read().config;
+  benchRun(benchResults[benchCount++], "nvs_save", BENCH_NVS_ITERATIONS, benchCycles, [&](uint32_t i) {
+    cfg.cmdMaxAgeMs = i % CMD_AGE_MAX_MS;  // Как save_config после смены настройки: один ключ новый
+    writeConfigKeys(prefs, cfg);
+  });
+  benchRun(benchResults[benchCount++], "nvs_load", BENCH_NVS_ITERATIONS, benchCycles, [&](uint32_t) {
+    readConfigKeys(prefs, cfg);
+    benchSink += cfg.cmdMaxAgeMs;
+  });
+  prefs.clear();
+  prefs.end();
+}
 
-      canvas.addEventListener('mousemove', (e) => {
-        if (joystickActive) {
-          handleMove(e.clientX, e.clientY);
-        }
-      });
+// Эхо: ping WebSocket, pong отвечает браузер
+bool benchSendPing() {
+  std::lock_guard<std::mutex> guard(wsLock);
+  AsyncWebSocketClient *client = ws.client(benchClient.load());
+  benchPongUs.store(0);
+  benchPingUs = micros();
+  benchPingMs = millis();
+  return client != nullptr && client->ping();
+}
 
-      canvas.addEventListener('mouseup', handleEnd);
-      canvas.addEventListener('mouseleave', handleEnd);
+String getBenchJSON() {
+  String json = "{\"bench\":{\"cpu_mhz\":" + String(ESP.getCpuFreqMHz());
+  json += ",\"items\":[";
+  for (int i = 0; i < benchCount; i++) {
+    const BenchStats &b = benchResults[i];
+    if (i > 0) json += ",";
+    json += "{\"name\":\"" + String(b.name) + "\"";
+    json += ",\"n\":" + String(b.n);
+    json += ",\"min\":" + String(b.min);
+    json += ",\"mean\":" + String(b.mean());
+    json += ",\"max\":" + String(b.max) + "}";
+    Serial.printf("  %-20s %10u %10u %10u тактов\n", b.name, b.min, b.mean(), b.max);
+  }
+  json += "],\"ws_echo_us\":";
+  if (benchEcho.n > 0) {
+    json += "{\"n\":" + String(benchEcho.n);
+    json += ",\"min\":" + String(benchEcho.min);
+    json += ",\"mean\":" + String(benchEcho.mean());
+    json += ",\"max\":" + String(benchEcho.max) + "}";
+  } else {
+    json += "null";
+  }
+  json += "}}";
+  return json;
+}
 
-      drawJoystick();
-    }
+void benchFinish(const String &json) {
+  uint32_t client = benchClient.load();
+  if (client != BENCH_HTTP_CLIENT) sendTo(client, json);
+  {
+    std::lock_guard<std::mutex> guard(benchMutex);
+    benchLastJSON = json;
+  }
+  benchPhase.store(BENCH_IDLE);
+}
 
-    // ========== ПЕРЕКЛЮЧЕНИЕ РЕЖИМОВ ==========
-    function switchMode(mode) {
-      const joystickMode = document.getElementById('joystick-mode');
-      const buttonsMode = document.getElementById('buttons-mode');
-      const btnJoystick = document.getElementById('modeJoystick');
-      const btnButtons = document.getElementById('modeButtons');
-
-      if (mode === 'joystick') {
-        joystickMode.style.display = 'block';
-        buttonsMode.style.display = 'none';
-        btnJoystick.classList.add('active');
-        btnButtons.classList.remove('active');
-        setTimeout(initJoystick, 100);
-      } else {
-        joystickMode.style.display = 'none';
-        buttonsMode.style.display = 'block';
-        btnJoystick.classList.remove('active');
-        btnButtons.classList.add('active');
+// Из loop(): продолжение после моторной части
+void benchTick() {
+  switch (benchPhase.load(std::memory_order_acquire)) {
+    case BENCH_HOST:
+      benchHost();
+      benchEcho.reset("ws_echo");
+      if (benchClient.load() != BENCH_HTTP_CLIENT && benchSendPing()) {
+        benchPhase.store(BENCH_ECHO);
+        return;
+      }
+      break;
+    case BENCH_ECHO: {
+      uint32_t pong = benchPongUs.exchange(0);
+      if (pong != 0) {
+        benchEcho.add(pong - benchPingUs);
+        if (benchEcho.n < BENCH_ECHO_COUNT && benchSendPing()) return;
+      } else if (millis() - benchPingMs < BENCH_ECHO_TIMEOUT_MS) {
+        return;
       }
+      break;
     }
+    case BENCH_FAILED:
+      Serial.println("✗ Бенчмарк: робот должен стоять");
+      benchFinish("{\"bench\":{\"error\":\"not_stopped\"}}");
+      return;
+    default:
+      return;
+  }
 
-    initWebSocket();
-    setTimeout(() => {
-      initJoystick();
-    }, 500);
-  </script>
-</body>
-</html>
-)rawliteral";
+  Serial.println("Бенчмарк (min / mean / max):");
+  benchFinish(getBenchJSON());
+}
 
 // ==================== SETUP ====================
 
 void setup() {
-  Serial.begin(115200);
+  Serial.setRxBufferSize(SERIAL_RX_BUFFER);
+  Serial.setTxBufferSize(SERIAL_TX_BUFFER);
+  Serial.begin(SERIAL_BAUD);
   delay(1000);
 
   Serial.println("\n\n=================================");
@@ -1414,31 +2052,78 @@ void setup() {
   Serial.println("  Назад:  D0=LOW/PWM (инверсный), D1=HIGH");
   Serial.println("  Холостой: D0=LOW, D1=LOW\n");
 
+  // Самописец: после аварийного сброса сохранить последние такты до него
+  esp_reset_reason_t resetReason = esp_reset_reason();
+  bool crashed = resetReason == ESP_RST_PANIC || resetReason == ESP_RST_INT_WDT ||
+                 resetReason == ESP_RST_TASK_WDT || resetReason == ESP_RST_WDT ||
+                 resetReason == ESP_RST_BROWNOUT;
+  flightRecorder.begin(&flightLog, (uint8_t)resetReason, crashed);
+  if (flightRecorder.frozen()) {
+    Serial.printf("✗ Самописец заморожен (%s, сброс %d): GET /flight_recorder, затем rec_arm\n",
+                  freezeReasonName(flightRecorder.reason()), (int)resetReason);
+  }
+
   // Загрузить конфигурацию из памяти
   loadConfig();
 
+  compileMotorOutputs(robotState.read().config, motorOutputs);
+  Serial.printf("✓ Плата: %s\n", kBoard.name);
+
   // Настройка пинов моторов
-  pinMode(MOTOR1_D1, OUTPUT);
-  pinMode(MOTOR2_D1, OUTPUT);
-  pinMode(MOTOR3_D1, OUTPUT);
-  pinMode(MOTOR4_D1, OUTPUT);
-
-  // Настройка PWM каналов
-  ledcSetup(PWM_CHANNEL_M1, PWM_FREQ, PWM_RESOLUTION);
-  ledcSetup(PWM_CHANNEL_M2, PWM_FREQ, PWM_RESOLUTION);
-  ledcSetup(PWM_CHANNEL_M3, PWM_FREQ, PWM_RESOLUTION);
-  ledcSetup(PWM_CHANNEL_M4, PWM_FREQ, PWM_RESOLUTION);
-
-  ledcAttachPin(MOTOR1_D0, PWM_CHANNEL_M1);
-  ledcAttachPin(MOTOR2_D0, PWM_CHANNEL_M2);
-  ledcAttachPin(MOTOR3_D0, PWM_CHANNEL_M3);
-  ledcAttachPin(MOTOR4_D0, PWM_CHANNEL_M4);
+  for (const BoardMotor &m : kBoard.motors) {
+    pinMode(m.pinD1, OUTPUT);
+  }
+
+  // Настройка PWM каналов (профили из конфигурации)
+  applyPwmProfiles(robotState.read().config);
+
+  for (const BoardMotor &m : kBoard.motors) {
+    ledcAttachPin(m.pinD0, m.pwmChannel);
+  }
 
   // Остановить все моторы при старте
   stopAllMotors();
 
+  // АЦП батареи: 11 дБ = диапазон до ~3.1 В на пине
+  analogSetPinAttenuation(kBoard.batteryAdcPin, ADC_11db);
+
+  // Датчики тока (необязательные)
+  if (currentSense.begin()) {
+    Serial.println("✓ Датчики тока ADS1115 найдены");
+  } else {
+    Serial.println("  Датчики тока не найдены, ограничение по току отключено");
+  }
+
+  // Гироскоп (необязательный): калибровка нуля, пока моторы стоят
+  if (mpuGyro.begin()) {
+    gyro = &mpuGyro;
+    Serial.println("✓ Гироскоп MPU6050 найден, удержание курса доступно");
+  } else {
+    Serial.println("  Гироскоп не найден, удержание курса отключено");
+  }
+
+  // Датчики расстояния (необязательные): установлены ли — видно по первым ответам
+  if (hcsrRanges.begin()) {
+    for (uint8_t i = 0; i < kBoard.rangeCount; i++) {
+      obstacleGovernor.setDirection(i, degreesToAngle(kBoard.ranges[i].directionDeg));
+    }
+    rangeSource = &hcsrRanges;
+    Serial.printf("✓ Датчики расстояния: %u на плате\n", kBoard.rangeCount);
+  }
+
   Serial.println("✓ Моторы инициализированы");
 
+  // Задача управления: единственное место, где пишутся моторы
+  xTaskCreatePinnedToCore(controlTask, "control", 4096, nullptr, 3, nullptr, 1);
+
+  // Проводная связь: приход байт будит задачу связи. Задача пишет
+  // robotState, поэтому живёт на ядре 0, а не под задачей управления
+  // (правило приоритетов — в robot_state.h)
+  xTaskCreatePinnedToCore(linkTask, "link", 4096, nullptr, 2, &linkTaskHandle, 0);
+  Serial.onReceive([]() {
+    if (linkTaskHandle != nullptr) xTaskNotifyGive(linkTaskHandle);
+  });
+
   // Подключение к WiFi
   Serial.print("Подключение к WiFi: ");
   Serial.println(ssid);
@@ -1473,6 +2158,57 @@ void setup() {
     request->send(200, "text/html", index_html);
   });
 
+  // Состояние очередей WebSocket клиентов
+  server.on("/ws_stats", HTTP_GET, [](AsyncWebServerRequest *request){
+    HeapScope heapScope(HEAP_TAG_HTTP);
+    request->send(200, "application/json", getWsStatsJSON());
+  });
+
+  server.on("/clock_stats", HTTP_GET, [](AsyncWebServerRequest *request){
+    HeapScope heapScope(HEAP_TAG_HTTP);
+    std::lock_guard<std::mutex> guard(commandLock);
+    request->send(200, "application/json", getClockStatsJSON());
+  });
+
+  // Профиль кучи: GET /heap, /heap?reset — обнулить счётчики выделений
+  server.on("/heap", HTTP_GET, [](AsyncWebServerRequest *request){
+    HeapScope heapScope(HEAP_TAG_HTTP);
+    if (request->hasParam("reset")) heapProfile.reset();
+    request->send(200, "application/json", getHeapJSON());
+  });
+
+  // Дамп самописца (бинарный, декодер: src/host/frec_decode.cpp).
+  // Незамороженный буфер сначала замораживается — повторить запрос.
+  server.on("/flight_recorder", HTTP_GET, [](AsyncWebServerRequest *request){
+    if (!flightRecorder.frozen()) {
+      flightRecorder.trigger(FREEZE_MANUAL, millis());
+      AsyncWebServerResponse *response = request->beginResponse(503, "application/json", "{\"recorder\":\"freezing\"}");
+      response->addHeader("Retry-After", "1");
+      request->send(response);
+      return;
+    }
+    AsyncWebServerResponse *response = request->beginResponse("application/octet-stream", flightRecorder.dumpSize(),
+      [](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+        return flightRecorder.readDump(buffer, maxLen, index);
+      });
+    response->addHeader("Content-Disposition", "attachment; filename=\"flight.frec\"");
+    request->send(response);
+  });
+
+  // Микробенчмарки: GET /bench — последние результаты, /bench?run — запустить
+  server.on("/bench", HTTP_GET, [](AsyncWebServerRequest *request){
+    if (request->hasParam("run")) {
+      if (requestBench(BENCH_HTTP_CLIENT)) {
+        request->send(202, "application/json", "{\"bench\":\"running\"}");
+      } else {
+        request->send(409, "application/json", "{\"bench\":{\"error\":\"busy\"}}");
+      }
+      return;
+    }
+    std::lock_guard<std::mutex> guard(benchMutex);
+    request->send(200, "application/json", benchLastJSON.length() > 0 ? benchLastJSON : String("{\"bench\":null}"));
+  });
+
   // Запуск сервера
   server.begin();
   Serial.println("✓ Веб-сервер запущен\n");
@@ -1482,6 +2218,14 @@ void setup() {
 // ==================== LOOP ====================
 
 void loop() {
-  ws.cleanupClients();
+  wsTransport.cleanup();
+  telemetryTick();
+  poseTick();
+  slipReportTick();
+  pathReportTick();
+  benchTick();
+  heapTick();
+  if (lutSavePending.exchange(false, std::memory_order_acquire)) saveLinearization();
+  pumpTransports();
   delay(10);
 }
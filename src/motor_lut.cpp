@@ -0,0 +1,147 @@
+#include "motor_lut.h"
+
+#include <string.h>
+
+// ==================== ТАБЛИЦА ====================
+
+void MotorLinearizer::setIdentity() {
+  for (int m = 0; m < 4; m++) {
+    for (int d = 0; d < 2; d++) {
+      for (int k = 0; k < LUT_POINTS; k++) {
+        table[m][d][k] = k * 16 > 255 ? 255 : k * 16;
+      }
+    }
+  }
+}
+
+int32_t MotorLinearizer::applyQ16(int physicalMotor, int speed) const {
+  if (!enabled || speed == 0 || physicalMotor < 1 || physicalMotor > 4) return speedToDutyQ16(speed);
+
+  const uint8_t *lut = table[physicalMotor - 1][speed > 0 ? 0 : 1];
+  int a = speed > 0 ? speed : -speed;
+  if (a > SPEED_MAX) a = SPEED_MAX;
+
+  // Позиция в узлах в Q8: 255 -> узел 16
+  int32_t pos = (int32_t)a * (LUT_POINTS - 1) * 256 / SPEED_MAX;
+  int idx = pos >> 8;
+  int32_t dutyQ8;  // Скважность 0..255 в Q8
+  if (idx >= LUT_POINTS - 1) {
+    dutyQ8 = (int32_t)lut[LUT_POINTS - 1] << 8;
+  } else {
+    int32_t frac = pos & 255;
+    dutyQ8 = ((int32_t)lut[idx] << 8) + ((int32_t)lut[idx + 1] - (int32_t)lut[idx]) * frac;
+  }
+
+  int32_t q16 = (int32_t)((int64_t)dutyQ8 * DUTY_Q16_ONE / (SPEED_MAX * 256));
+  return speed > 0 ? q16 : -q16;
+}
+
+// ==================== ХАРАКТЕРИЗАЦИЯ ====================
+
+void MotorCharacterizer::start(uint32_t now) {
+  active = true;
+  motor = 0;
+  dir = 0;
+  point = 0;
+  stepStart = now;
+  sum = 0;
+  count = 0;
+  memset(response, 0, sizeof(response));
+}
+
+bool MotorCharacterizer::step(uint32_t now, int &outMotor, int &outSpeed) {
+  if (!active) return false;
+
+  uint32_t duration = point == 0 ? CHAR_SPINDOWN_MS : CHAR_SETTLE_MS + CHAR_MEASURE_MS;
+
+  if (now - stepStart >= duration) {
+    if (point > 0) {
+      response[motor][dir][point] = count > 0 ? (int32_t)(sum / count) : 0;
+    }
+    sum = 0;
+    count = 0;
+    stepStart = now;
+
+    if (++point >= LUT_POINTS) {
+      point = 0;
+      if (++dir >= 2) {
+        dir = 0;
+        if (++motor >= 4) {
+          active = false;
+          return false;
+        }
+      }
+    }
+  }
+
+  outMotor = motor + 1;
+  outSpeed = point == 0 ? 0 : (dir == 0 ? dutyAt(point) : -dutyAt(point));
+  return true;
+}
+
+void MotorCharacterizer::addSample(int32_t value, uint32_t now) {
+  if (!active || point == 0 || now - stepStart < CHAR_SETTLE_MS) return;
+  sum += value < 0 ? -value : value;
+  count++;
+}
+
+uint8_t MotorCharacterizer::progress() const {
+  if (!active) return 100;
+  int done = (motor * 2 + dir) * LUT_POINTS + point;
+  return (uint8_t)(done * 100 / (4 * 2 * LUT_POINTS));
+}
+
+bool MotorCharacterizer::build(MotorLinearizer &out) const {
+  // Отклик делаем монотонным и находим общий максимум: самая слабая
+  // пара мотор/направление задаёт скорость, достижимую всеми
+  int32_t curve[4][2][LUT_POINTS];
+  int32_t common = INT32_MAX;
+
+  for (int m = 0; m < 4; m++) {
+    for (int d = 0; d < 2; d++) {
+      int32_t best = 0;
+      for (int k = 0; k < LUT_POINTS; k++) {
+        if (response[m][d][k] > best) best = response[m][d][k];
+        curve[m][d][k] = best;
+      }
+      if (best < common) common = best;
+    }
+  }
+  if (common <= 0) return false;
+
+  for (int m = 0; m < 4; m++) {
+    for (int d = 0; d < 2; d++) {
+      const int32_t *r = curve[m][d];
+      uint8_t *lut = out.table[m][d];
+
+      // Узел 0: граница мёртвой зоны. На последней ступени без отклика
+      // колесо ещё стоит, поэтому граница ищется продолжением отклика двух
+      // первых ступеней за ней до нуля (с округлением вверх — не внутрь
+      // зоны): скорость 1 уже трогает колесо.
+      int dead = 0;
+      while (dead + 1 < LUT_POINTS && r[dead + 1] <= 0) dead++;
+      int edge = dutyAt(dead < LUT_POINTS - 1 ? dead + 1 : dead);
+      if (dead + 2 < LUT_POINTS && r[dead + 2] > r[dead + 1]) {
+        int e1 = dutyAt(dead + 1), e2 = dutyAt(dead + 2);
+        edge = e1 - (int)((int64_t)r[dead + 1] * (e2 - e1) / (r[dead + 2] - r[dead + 1]));
+        if (edge <= dutyAt(dead)) edge = dutyAt(dead) + 1;
+      }
+      lut[0] = (uint8_t)edge;
+
+      for (int j = 1; j < LUT_POINTS; j++) {
+        int32_t target = (int64_t)common * j / (LUT_POINTS - 1);
+        int k = 1;
+        while (k < LUT_POINTS - 1 && r[k] < target) k++;
+
+        // Первый отрезок за мёртвой зоной начинается от её границы
+        int32_t r0 = k - 1 <= dead ? 0 : r[k - 1], r1 = r[k];
+        int d0 = k - 1 <= dead ? edge : dutyAt(k - 1), d1 = dutyAt(k);
+        int duty = r1 > r0 ? d0 + (int)((int64_t)(target - r0) * (d1 - d0) / (r1 - r0)) : d1;
+        if (duty < lut[j - 1]) duty = lut[j - 1];
+        if (duty > 255) duty = 255;
+        lut[j] = (uint8_t)duty;
+      }
+    }
+  }
+  return true;
+}
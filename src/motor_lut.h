@@ -0,0 +1,70 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "pwm_profile.h"
+
+// ==================== ЛИНЕАРИЗАЦИЯ МОТОРОВ ====================
+// У каждого мотора своя мёртвая зона, своя кривая "скважность -> скорость"
+// и разная отдача вперёд/назад (назад TA6586 работает инверсным PWM).
+// Характеризация прогоняет каждый ФИЗИЧЕСКИЙ мотор в обе стороны по
+// ступеням скважности, измеряет отклик и строит таблицу, которая
+// переводит желаемую скорость 0..255 в скважность так, чтобы все моторы
+// давали одинаковую скорость при одинаковой команде.
+// В рабочем режиме коррекция — один поиск в таблице на колесо; дробная
+// часть интерполяции сохраняется (результат в Q16, см. pwm_profile.h).
+
+#define LUT_POINTS 17             // Узлы 0, 16, 32 ... 256 (последний = 255)
+#define CHAR_SETTLE_MS 250        // Разгон на ступени перед замером
+#define CHAR_MEASURE_MS 100       // Окно усреднения отклика
+#define CHAR_SPINDOWN_MS 600      // Остановка между моторами/направлениями
+
+class MotorLinearizer {
+public:
+  MotorLinearizer() { setIdentity(); }
+
+  void setIdentity();
+  void setEnabled(bool on) { enabled = on; }
+  bool isEnabled() const { return enabled; }
+
+  // speed: -255..255 для ФИЗИЧЕСКОГО мотора 1..4 -> скважность Q16 со знаком
+  int32_t applyQ16(int physicalMotor, int speed) const;
+
+  // Таблица целиком (для NVS): [мотор][0=вперёд,1=назад][узел]
+  uint8_t table[4][2][LUT_POINTS];
+
+private:
+  bool enabled = false;
+};
+
+// Пошаговый прогон характеризации (вызывается из задачи управления)
+class MotorCharacterizer {
+public:
+  void start(uint32_t now);
+  void abort() { active = false; }
+  bool running() const { return active; }
+
+  // Что крутить в этом такте: мотор 1..4 и скорость (0 = пауза).
+  // false = прогон закончен.
+  bool step(uint32_t now, int &motor, int &speed);
+
+  // Отклик текущего мотора (скорость или её оценка), каждый такт
+  void addSample(int32_t response, uint32_t now);
+
+  // Построить таблицу по измерениям; false = отклик не измерен
+  bool build(MotorLinearizer &out) const;
+
+  uint8_t progress() const;  // 0..100 %
+
+private:
+  static int dutyAt(int point) { return point * 16 > 255 ? 255 : point * 16; }
+
+  bool active = false;
+  uint8_t motor = 0;          // 0..3
+  uint8_t dir = 0;            // 0 = вперёд, 1 = назад
+  uint8_t point = 0;          // 0 = пауза перед серией, 1..16 = ступени
+  uint32_t stepStart = 0;
+  int64_t sum = 0;
+  uint32_t count = 0;
+  int32_t response[4][2][LUT_POINTS];
+};
@@ -0,0 +1,39 @@
+#include "motor_output.h"
+
+#include <string.h>
+
+bool MotorOutputTable::matches(const RobotConfig &cfg) const {
+  return memcmp(motorMapping, cfg.motorMapping, sizeof(motorMapping)) == 0 &&
+         memcmp(motorInvert, cfg.motorInvert, sizeof(motorInvert)) == 0;
+}
+
+MotorOutput boardMotorOutput(uint8_t motor) {
+  const BoardMotor &b = kBoard.motors[motor & 3];
+  return {0, (uint8_t)(motor & 3), b.pwmChannel, 1, (uint64_t)1 << b.pinD1};
+}
+
+void compileMotorOutputs(const RobotConfig &cfg, MotorOutputTable &table) {
+  bool driven[4] = {false, false, false, false};
+  uint8_t n = 0;
+
+  for (uint8_t wheel = 0; wheel < 4; wheel++) {
+    int m = cfg.motorMapping[wheel];
+    if (m < 1 || m > 4) continue;
+    MotorOutput o = boardMotorOutput((uint8_t)(m - 1));
+    o.wheel = wheel;
+    o.sign = cfg.motorInvert[wheel] ? -1 : 1;
+    table.outputs[n++] = o;
+    driven[m - 1] = true;
+  }
+
+  for (uint8_t m = 0; m < 4; m++) {
+    if (driven[m]) continue;
+    MotorOutput o = boardMotorOutput(m);
+    o.sign = 0;
+    table.outputs[n++] = o;
+  }
+
+  table.count = n;
+  memcpy(table.motorMapping, cfg.motorMapping, sizeof(table.motorMapping));
+  memcpy(table.motorInvert, cfg.motorInvert, sizeof(table.motorInvert));
+}
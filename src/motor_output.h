@@ -0,0 +1,46 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "board.h"
+#include "robot_state.h"
+
+// ==================== ТАБЛИЦА ВЫХОДОВ ====================
+// Маппинг и инверсия из калибровки компилируются в плоскую таблицу: на
+// каждое ЛОГИЧЕСКОЕ колесо — канал LEDC, маска пина направления в
+// регистрах GPIO и знак. Горячий путь (writeWheels в main.cpp) — цикл по
+// таблице без проверок диапазона, поиска по маппингу и ветвлений по
+// номерам пинов. Таблица пересобирается задачей управления, когда
+// меняются маппинг или инверсия (set_map, set_inv, reset_config,
+// loadConfig).
+//
+// Физические моторы, на которые не ссылается ни одно колесо, тоже в
+// таблице — со знаком 0: цикл пишет им холостой ход.
+
+#define MOTOR_OUTPUTS_MAX 8   // 4 колеса + до 4 незадействованных моторов
+
+struct MotorOutput {
+  uint8_t wheel;        // ЛОГИЧЕСКОЕ колесо 0..3 (источник скорости)
+  uint8_t motor;        // ФИЗИЧЕСКИЙ мотор 0..3 (индекс kBoard.motors)
+  uint8_t channel;      // Канал LEDC
+  int8_t sign;          // 1, -1 = инверсия, 0 = мотор не задействован
+  uint64_t dirMask;     // 1 << D1: младшие 32 бита — GPIO_OUT_*, старшие — GPIO_OUT1_*
+};
+
+struct MotorOutputTable {
+  MotorOutput outputs[MOTOR_OUTPUTS_MAX];
+  uint8_t count = 0;
+
+  // Из каких настроек собрана (сравнение раз в такт)
+  int8_t motorMapping[4] = {0, 0, 0, 0};
+  bool motorInvert[4] = {false, false, false, false};
+
+  bool matches(const RobotConfig &cfg) const;
+};
+
+// Выход одного ФИЗИЧЕСКОГО мотора 0..3 (прямые записи: остановка, тесты)
+MotorOutput boardMotorOutput(uint8_t motor);
+
+// Собрать таблицу. Колесо с маппингом вне 1..4 не пишется никуда; два
+// колеса на одном моторе пишутся по порядку — последнее побеждает.
+void compileMotorOutputs(const RobotConfig &cfg, MotorOutputTable &table);
@@ -0,0 +1,114 @@
+#include "mpu6050_gyro.h"
+
+#include <Wire.h>
+
+#define MPU6050_REG_SMPLRT_DIV 0x19
+#define MPU6050_REG_CONFIG 0x1A
+#define MPU6050_REG_GYRO_CONFIG 0x1B
+#define MPU6050_REG_INT_PIN_CFG 0x37
+#define MPU6050_REG_INT_ENABLE 0x38
+#define MPU6050_REG_GYRO_ZOUT_H 0x47
+#define MPU6050_REG_PWR_MGMT_1 0x6B
+
+// Двоичный угол на 1 мград·мкс, Q32 (как в gyro.cpp)
+#define ANGLE_PER_MDEG_US_Q32 51240956LL
+
+bool Mpu6050Gyro::writeRegister(uint8_t reg, uint8_t value) {
+  Wire.beginTransmission(MPU6050_ADDRESS);
+  Wire.write(reg);
+  Wire.write(value);
+  return Wire.endTransmission() == 0;
+}
+
+bool Mpu6050Gyro::readRawZ(int16_t &raw) {
+  Wire.beginTransmission(MPU6050_ADDRESS);
+  Wire.write(MPU6050_REG_GYRO_ZOUT_H);
+  if (Wire.endTransmission(false) != 0) return false;
+
+  if (Wire.requestFrom((uint8_t)MPU6050_ADDRESS, (uint8_t)2) != 2) return false;
+  raw = (int16_t)((Wire.read() << 8) | Wire.read());
+  return true;
+}
+
+bool Mpu6050Gyro::begin() {
+  Wire.begin(GYRO_SDA_PIN, GYRO_SCL_PIN, 400000);  // Шина уже может быть запущена ADS1115
+
+  Wire.beginTransmission(MPU6050_ADDRESS);
+  found = Wire.endTransmission() == 0;
+  if (!found) return false;
+
+  // Тактирование от PLL гироскопа X, DLPF 44 Гц (гироскоп 1 кГц),
+  // ODR = 1000 / (1 + 4) = 200 Гц, ±500 °/с, INT по готовности данных,
+  // сбрасывается любым чтением
+  found = writeRegister(MPU6050_REG_PWR_MGMT_1, 0x01) &&
+          writeRegister(MPU6050_REG_CONFIG, 0x03) &&
+          writeRegister(MPU6050_REG_SMPLRT_DIV, 1000 / GYRO_ODR_HZ - 1) &&
+          writeRegister(MPU6050_REG_GYRO_CONFIG, 0x08) &&
+          writeRegister(MPU6050_REG_INT_PIN_CFG, 0x10) &&
+          writeRegister(MPU6050_REG_INT_ENABLE, 0x01);
+  if (!found) return false;
+
+  // Смещение нуля: среднее за секунду неподвижности
+  delay(100);
+  int32_t sum = 0;
+  int n = 0;
+  for (int i = 0; i < GYRO_CALIBRATION_SAMPLES; i++) {
+    int16_t raw;
+    if (readRawZ(raw)) {
+      sum += raw;
+      n++;
+    }
+    delay(1000 / GYRO_ODR_HZ);
+  }
+  biasQ8 = n > 0 ? (sum << 8) / n : 0;
+
+  pinMode(GYRO_INT_PIN, INPUT);
+  xTaskCreatePinnedToCore(taskEntry, "gyro", 2048, this, 4, &task, 1);
+  attachInterruptArg(GYRO_INT_PIN, onDataReady, this, RISING);
+  return true;
+}
+
+void IRAM_ATTR Mpu6050Gyro::onDataReady(void *arg) {
+  Mpu6050Gyro *self = (Mpu6050Gyro*)arg;
+  BaseType_t woken = pdFALSE;
+  vTaskNotifyGiveFromISR(self->task, &woken);
+  if (woken) portYIELD_FROM_ISR();
+}
+
+void Mpu6050Gyro::taskEntry(void *arg) {
+  ((Mpu6050Gyro*)arg)->sampleLoop();
+}
+
+void Mpu6050Gyro::sampleLoop() {
+  const uint32_t periodUs = 1000000 / GYRO_ODR_HZ;
+
+  for (;;) {
+    // Таймаут — на случай потерянного фронта INT: читаем и сбрасываем его
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(20));
+
+    int16_t raw;
+    if (!readRawZ(raw)) continue;
+
+    int32_t rawQ8 = ((int32_t)raw << 8) - biasQ8;
+    int32_t mdps = (int32_t)(((int64_t)rawQ8 * 10000 / GYRO_LSB_PER_DPS_X10) >> 8);
+
+    // На стоянке ноль медленно подстраивается (дрейф от температуры)
+    if (still.load(std::memory_order_relaxed) && abs(mdps) < GYRO_BIAS_TRACK_LIMIT_MDPS) {
+      biasQ8 += rawQ8 >> GYRO_BIAS_TRACK_SHIFT;
+      mdps = 0;
+    }
+
+    // Угол по номинальному периоду ODR: темп задаёт датчик
+    uint32_t step = (uint32_t)(((int64_t)mdps * periodUs * ANGLE_PER_MDEG_US_Q32) >> 32);
+    angle.fetch_add(step, std::memory_order_relaxed);
+    rate.store(mdps, std::memory_order_relaxed);
+    lastSample.store(millis(), std::memory_order_release);
+  }
+}
+
+bool Mpu6050Gyro::read(uint32_t &yaw, int32_t &rateMdps) {
+  if (!found || millis() - lastSample.load(std::memory_order_acquire) > GYRO_STALE_MS) return false;
+  yaw = angle.load(std::memory_order_relaxed);
+  rateMdps = rate.load(std::memory_order_relaxed);
+  return true;
+}
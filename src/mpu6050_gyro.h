@@ -0,0 +1,55 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+
+#include <Arduino.h>
+
+#include "board.h"
+#include "gyro.h"
+
+// ==================== ГИРОСКОП MPU6050 ====================
+// MPU6050 на общей шине I2C с ADS1115 (Wire, пины из board.h).
+// Датчик сам задаёт темп: ODR 200 Гц, по готовности данных поднимает INT.
+// Прерывание будит отдельную задачу, которая читает ось Z (2 байта) и
+// интегрирует угол. Задача управления читает только атомарные значения
+// и шину не ждёт. Транзакции разных задач на Wire разделяет блокировка
+// внутри драйвера I2C Arduino core.
+
+#define MPU6050_ADDRESS 0x68
+#define GYRO_SDA_PIN (kBoard.i2cSda)      // Та же шина, что у ADS1115
+#define GYRO_SCL_PIN (kBoard.i2cScl)
+#define GYRO_INT_PIN (kBoard.gyroIntPin)
+#define GYRO_ODR_HZ 200
+#define GYRO_LSB_PER_DPS_X10 655          // ±500 °/с: 65.5 LSB на °/с
+#define GYRO_CALIBRATION_SAMPLES 200      // 1 с при старте (робот стоит)
+#define GYRO_STALE_MS 50                  // Нет отсчётов дольше — данных нет
+#define GYRO_BIAS_TRACK_SHIFT 9           // Подстройка нуля на стоянке (IIR)
+#define GYRO_BIAS_TRACK_LIMIT_MDPS 1500   // ...только если |скорость| меньше
+
+class Mpu6050Gyro : public GyroSource {
+public:
+  // false = датчик не найден. Калибрует ноль, робот должен стоять.
+  bool begin();
+
+  bool read(uint32_t &yaw, int32_t &rateMdps) override;
+  void setStationary(bool stationary) override { still.store(stationary, std::memory_order_relaxed); }
+
+  bool present() const { return found; }
+
+private:
+  static void IRAM_ATTR onDataReady(void *arg);
+  static void taskEntry(void *arg);
+  void sampleLoop();
+
+  bool writeRegister(uint8_t reg, uint8_t value);
+  bool readRawZ(int16_t &raw);
+
+  bool found = false;
+  TaskHandle_t task = nullptr;
+  int32_t biasQ8 = 0;                       // Смещение нуля, сырые единицы Q8 (только задача датчика)
+  std::atomic<uint32_t> angle{0};
+  std::atomic<int32_t> rate{0};
+  std::atomic<uint32_t> lastSample{0};
+  std::atomic<bool> still{true};
+};
@@ -0,0 +1,69 @@
+#include "obstacle_governor.h"
+
+#include "fixed.h"
+#include "pwm_profile.h"
+
+static const int8_t sx[4] = {1, -1, -1, 1};
+
+void ObstacleGovernor::setDirection(uint8_t sensor, uint32_t direction) {
+  if (sensor >= RANGE_SENSORS_MAX) return;
+  dirCos[sensor] = fxCosQ15(direction);
+  dirSin[sensor] = fxSinQ15(direction);
+}
+
+int32_t ObstacleGovernor::speedLimit(uint16_t mm) {
+  if (mm <= OBSTACLE_STOP_MM) return 0;
+  if (mm >= OBSTACLE_SLOW_MM) return SPEED_MAX;
+  return (int32_t)(mm - OBSTACLE_STOP_MM) * SPEED_MAX / (OBSTACLE_SLOW_MM - OBSTACLE_STOP_MM);
+}
+
+void ObstacleGovernor::update(const RangeScheduler &ranges, uint32_t now) {
+  uint8_t n = ranges.count();
+  for (uint8_t i = 0; i < n; i++) {
+    uint16_t mm;
+    if (ranges.reading(i, now, mm)) {
+      cap[i] = mm >= OBSTACLE_SLOW_MM ? -1 : speedLimit(mm);
+    } else if (ranges.fitted(i)) {
+      mm = OBSTACLE_BLIND;
+      cap[i] = OBSTACLE_BLIND_SPEED;
+    } else {
+      mm = OBSTACLE_NOT_FITTED;
+      cap[i] = -1;
+    }
+    range[i].store(mm, std::memory_order_relaxed);
+  }
+  count.store(n, std::memory_order_relaxed);
+}
+
+uint8_t ObstacleGovernor::apply(int wheels[4]) {
+  uint8_t n = count.load(std::memory_order_relaxed);
+
+  // Поступательная часть корпуса в единицах команды колеса
+  int32_t forward = (wheels[0] + wheels[1] + wheels[2] + wheels[3]) / 4;
+  int32_t left = -(wheels[0] - wheels[1] - wheels[2] + wheels[3]) / 4;
+  int32_t dForward = 0, dLeft = 0;
+  uint8_t mask = 0;
+
+  for (int pass = 0; pass < OBSTACLE_PASSES; pass++) {
+    for (uint8_t i = 0; i < n; i++) {
+      if (cap[i] < 0) continue;
+      // Составляющая к датчику; от препятствия (toward < 0) не ограничивается
+      int32_t toward = fxMulQ15(forward + dForward, dirCos[i]) + fxMulQ15(left + dLeft, dirSin[i]);
+      if (toward <= cap[i]) continue;
+      int32_t excess = toward - cap[i];
+      dForward -= fxMulQ15(excess, dirCos[i]);
+      dLeft -= fxMulQ15(excess, dirSin[i]);
+      mask |= 1 << i;
+    }
+  }
+
+  if (mask != 0) {
+    for (int i = 0; i < 4; i++) wheels[i] += dForward - sx[i] * dLeft;
+    fxLimitPeak4(wheels, SPEED_MAX);
+    if (limited.load(std::memory_order_relaxed) == 0) {
+      eventCount.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+  limited.store(mask, std::memory_order_relaxed);
+  return mask;
+}
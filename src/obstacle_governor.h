@@ -0,0 +1,58 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+
+#include "range.h"
+
+// ==================== ОГРАНИЧЕНИЕ СКОРОСТИ У ПРЕПЯТСТВИЙ ====================
+// Стоит между кинематикой и антибуксом. Команды колёс раскладываются на
+// движение корпуса (те же знаки колёс, что в bodyToWheels):
+//   s_i = F + sx_i * R + sw_i * W + sd_i * D
+//   sx = {1, -1, -1, 1} (вправо), sw = {-1, 1, -1, 1} (поворот), sd — скрутка
+// Для каждого датчика, видящего препятствие, ограничивается только
+// составляющая (F, -R) В СТОРОНУ датчика:
+//   предел = SPEED_MAX * (d - OBSTACLE_STOP_MM) / (OBSTACLE_SLOW_MM - OBSTACLE_STOP_MM)
+// Движение от препятствия и вдоль него не меняется, поворот тоже.
+// Датчик, который отвечал, но замолчал, ограничивает скорость к себе
+// OBSTACLE_BLIND_SPEED: не видно — едем осторожно. Датчик, который не
+// ответил ни разу, считается неустановленным.
+
+#define OBSTACLE_STOP_MM 150          // Ближе — к препятствию нельзя
+#define OBSTACLE_SLOW_MM 800          // Дальше — без ограничения
+#define OBSTACLE_BLIND_SPEED 80       // Предел к замолчавшему датчику
+#define OBSTACLE_PASSES 2             // Проходов по датчикам (кольцо — не ортогональные направления)
+
+#define OBSTACLE_NOT_FITTED 0xFFFF    // rangeMm(): датчик не установлен
+#define OBSTACLE_BLIND 0xFFFE         // rangeMm(): установлен, показаний нет
+
+class ObstacleGovernor {
+public:
+  // Направление датчика: двоичный угол (fixed.h), 0 — вперёд, против часовой
+  void setDirection(uint8_t sensor, uint32_t direction);
+
+  // Раз в такт: снять показания планировщика (и для телеметрии)
+  void update(const RangeScheduler &ranges, uint32_t now);
+
+  // wheels: команды ЛОГИЧЕСКИХ колёс -255..255, меняются на месте.
+  // Возвращает маску датчиков, ограничивших движение.
+  uint8_t apply(int wheels[4]);
+
+  // Предел скорости к препятствию на расстоянии mm
+  static int32_t speedLimit(uint16_t mm);
+
+  // Для телеметрии (читаются из другой задачи)
+  uint8_t sensors() const { return count.load(std::memory_order_relaxed); }
+  uint16_t rangeMm(uint8_t sensor) const { return range[sensor].load(std::memory_order_relaxed); }
+  uint8_t limitedMask() const { return limited.load(std::memory_order_relaxed); }
+  uint32_t events() const { return eventCount.load(std::memory_order_relaxed); }
+
+private:
+  int32_t dirCos[RANGE_SENSORS_MAX] = {};   // Q15
+  int32_t dirSin[RANGE_SENSORS_MAX] = {};
+  int32_t cap[RANGE_SENSORS_MAX] = {};      // Предел к датчику; < 0 — нет
+  std::atomic<uint8_t> count{0};
+  std::atomic<uint16_t> range[RANGE_SENSORS_MAX] = {};
+  std::atomic<uint8_t> limited{0};
+  std::atomic<uint32_t> eventCount{0};
+};
@@ -0,0 +1,81 @@
+#include "odometry.h"
+
+#define SQRT2_OVER_4_Q16 23170        // √2/4 = 0.35355
+// Двоичный угол на 1 мкм суммы (-s1 + s2 - s3 + s4), Q16: 2^32 / (2π * 4R)
+#define TURN_PER_UM_Q16 (FX_ANGLE_PER_RAD * 65536 / (4LL * ODOM_TRACK_RADIUS_MM * 1000))
+#define UM_PER_COUNT_Q8 ((int32_t)(3.14159265 * ODOM_WHEEL_DIAMETER_MM * 1000 * 256 / ODOM_COUNTS_PER_REV))
+
+int32_t Odometry::countsToUm(int32_t counts) {
+  return (int32_t)(((int64_t)counts * UM_PER_COUNT_Q8) >> 8);
+}
+
+int32_t Odometry::commandToUm(int command, uint32_t dtMs) {
+  // мм/с * мс = мкм
+  return (int32_t)((int64_t)command * ODOM_MAX_WHEEL_MMPS * (int32_t)dtMs / 255);
+}
+
+void Odometry::reset() {
+  current = {0, 0, 0, 0, 0, 0, current.fromEncoders};
+  remX = 0;
+  remY = 0;
+}
+
+void Odometry::updateFromCounts(const int32_t counts[4], uint32_t dtMs) {
+  int32_t um[4];
+  for (int i = 0; i < 4; i++) {
+    um[i] = haveCounts ? countsToUm(counts[i] - lastCounts[i]) : 0;
+    lastCounts[i] = counts[i];
+  }
+  haveCounts = true;
+  integrate(um, dtMs, true);
+}
+
+void Odometry::updateFromSpeeds(const int32_t mmps[4], uint32_t dtMs) {
+  int32_t um[4];
+  for (int i = 0; i < 4; i++) {
+    um[i] = mmps[i] * (int32_t)dtMs;   // мм/с * мс = мкм
+  }
+  haveCounts = false;
+  integrate(um, dtMs, true);
+}
+
+void Odometry::updateFromCommands(const int commands[4], uint32_t dtMs) {
+  int32_t um[4];
+  for (int i = 0; i < 4; i++) {
+    um[i] = commandToUm(commands[i], dtMs);
+  }
+  haveCounts = false;  // При возврате энкодеров начать с нового отсчёта
+  integrate(um, dtMs, false);
+}
+
+void Odometry::integrate(const int32_t s[4], uint32_t dtMs, bool fromEncoders) {
+  int64_t sumForward = (int64_t)s[0] + s[1] + s[2] + s[3];
+  int64_t sumRight = (int64_t)s[0] - s[1] - s[2] + s[3];
+  int64_t sumTurn = -(int64_t)s[0] + s[1] - s[2] + s[3];
+
+  int32_t forward = (int32_t)((sumForward * SQRT2_OVER_4_Q16) >> 16);
+  int32_t left = -(int32_t)((sumRight * SQRT2_OVER_4_Q16) >> 16);
+  int32_t turn = (int32_t)((sumTurn * TURN_PER_UM_Q16) >> 16);
+
+  // Поворот смещения на угол середины такта
+  uint32_t mid = current.heading + (uint32_t)(turn / 2);
+  int32_t c = fxCosQ15(mid);
+  int32_t sn = fxSinQ15(mid);
+
+  int64_t dx = (int64_t)forward * c - (int64_t)left * sn + remX;
+  int64_t dy = (int64_t)forward * sn + (int64_t)left * c + remY;
+  current.xUm += (int32_t)(dx >> 15);
+  current.yUm += (int32_t)(dy >> 15);
+  remX = (int32_t)(dx & 0x7FFF);
+  remY = (int32_t)(dy & 0x7FFF);
+  current.heading += (uint32_t)turn;
+
+  if (dtMs > 0) {
+    current.vForwardMmps = forward / (int32_t)dtMs;
+    current.vLeftMmps = left / (int32_t)dtMs;
+    // мкрад / мс = мрад/с
+    int32_t urad = (int32_t)(((int64_t)turn * FX_URAD_PER_TURN) >> 32);
+    current.omegaMradps = urad / (int32_t)dtMs;
+  }
+  current.fromEncoders = fromEncoders;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "fixed.h"
+
+// ==================== ОДОМЕТРИЯ ====================
+// Счисление пути по четырём колёсам X-конфигурации (см. main.cpp):
+// перемещения колёс за такт переводятся прямой кинематикой в смещение
+// корпуса (вперёд, влево, поворот) и интегрируются в позу (x, y, θ).
+// Всё в целых числах: координаты в мкм, угол — двоичный (2^32 = оборот),
+// sin/cos — таблица Q15 (fixed.h). Источник перемещений — энкодеры,
+// если они есть, затем измеренные скорости колёс, иначе команды,
+// фактически записанные в моторы (оценка без обратной связи).
+//
+// Кинематика (логические колёса M1..M4, s — путь колеса по поверхности):
+//   вперёд  = √2/4 * ( s1 + s2 + s3 + s4)
+//   вправо  = √2/4 * ( s1 - s2 - s3 + s4)
+//   поворот = 1/4R * (-s1 + s2 - s3 + s4)   (против часовой)
+
+#define ODOM_WHEEL_DIAMETER_MM 60     // Диаметр omni-колеса
+#define ODOM_TRACK_RADIUS_MM 100      // От центра робота до пятна контакта колеса
+#define ODOM_COUNTS_PER_REV 360       // Энкодер: отсчётов на оборот колеса
+#define ODOM_MAX_WHEEL_MMPS 600       // Скорость колеса при команде 255 (без энкодеров)
+
+// Угол: uint32_t, 2^32 = 360°, переполнение = естественный переход через 0
+#define ODOM_ANGLE_HALF_TURN 0x80000000u
+
+// Источник накопленных отсчётов энкодеров ЛОГИЧЕСКИХ колёс.
+// false = энкодеров нет.
+typedef bool (*WheelCountSource)(int32_t counts[4]);
+
+struct OdomPose {
+  int32_t xUm;            // Вперёд от точки сброса, мкм
+  int32_t yUm;            // Влево от точки сброса, мкм
+  uint32_t heading;       // Против часовой, двоичный угол
+  int32_t vForwardMmps;   // Скорость корпуса (в системе робота)
+  int32_t vLeftMmps;
+  int32_t omegaMradps;    // Угловая скорость, мрад/с
+  bool fromEncoders;      // Последний такт посчитан по измерениям колёс (энкодеры или скорость)
+};
+
+class Odometry {
+public:
+  void reset();
+
+  // Перемещения ЛОГИЧЕСКИХ колёс за такт dtMs, мкм
+  void integrate(const int32_t wheelUm[4], uint32_t dtMs, bool fromEncoders);
+
+  // Такт по накопленным отсчётам энкодеров (первый вызов только запоминает их)
+  void updateFromCounts(const int32_t counts[4], uint32_t dtMs);
+  // Такт по измеренным скоростям колёс, мм/с
+  void updateFromSpeeds(const int32_t mmps[4], uint32_t dtMs);
+  // Такт по командам колёс -255..255
+  void updateFromCommands(const int commands[4], uint32_t dtMs);
+
+  const OdomPose &pose() const { return current; }
+
+  static int32_t countsToUm(int32_t counts);
+  static int32_t commandToUm(int command, uint32_t dtMs);
+
+private:
+  OdomPose current = {0, 0, 0, 0, 0, 0, false};
+  int32_t lastCounts[4] = {0, 0, 0, 0};
+  bool haveCounts = false;
+  int32_t remX = 0;     // Остатки округления (1/32768 мкм)
+  int32_t remY = 0;
+};
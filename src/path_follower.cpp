@@ -0,0 +1,149 @@
+#include "path_follower.h"
+
+#define INV_SQRT2_Q16 46341           // 1/√2 = 0.70711
+
+static const char *const kStateNames[] = {"idle", "following", "done", "aborted"};
+
+const char *pathStateName(uint8_t state) {
+  return state <= PATH_ABORTED ? kStateNames[state] : "?";
+}
+
+// ==================== СЛЕДОВАНИЕ ====================
+
+void PathFollower::start(const PathPlan &plan, const OdomPose &pose) {
+  startXMm = pose.xUm / 1000;
+  startYMm = pose.yUm / 1000;
+  segment = 0;
+  speedMmps = 0;
+  speedRemMmps2 = 0;
+  planSeq = plan.seq;
+
+  total.store(plan.count, std::memory_order_relaxed);
+  target.store(0, std::memory_order_relaxed);
+  crossTrack.store(0, std::memory_order_relaxed);
+  remaining.store(0, std::memory_order_relaxed);
+  status.store(plan.count > 0 ? PATH_FOLLOWING : PATH_DONE, std::memory_order_relaxed);
+}
+
+void PathFollower::abort() {
+  speedMmps = 0;
+  if (state() == PATH_FOLLOWING) status.store(PATH_ABORTED, std::memory_order_relaxed);
+}
+
+bool PathFollower::update(const PathPlan &plan, const OdomPose &pose, uint32_t dtMs, BodyVelocity &out) {
+  out = {0, 0, 0};
+  if (state() != PATH_FOLLOWING) return false;
+
+  const int32_t px = pose.xUm / 1000;
+  const int32_t py = pose.yUm / 1000;
+  const uint8_t last = plan.count - 1;
+
+  // Начало отрезка k (отрезок ведёт к points[k])
+  auto segStartX = [&](uint8_t k) { return k == 0 ? startXMm : plan.points[k - 1].xMm; };
+  auto segStartY = [&](uint8_t k) { return k == 0 ? startYMm : plan.points[k - 1].yMm; };
+
+  // Текущий отрезок: переходим к следующему, когда проекция робота
+  // прошла его конец. Отрезок нулевой длины (поворот на месте) пройден,
+  // когда курс совпал.
+  int32_t along, len, headingErr;
+  for (;;) {
+    int32_t ax = segStartX(segment), ay = segStartY(segment);
+    int32_t dx = plan.points[segment].xMm - ax, dy = plan.points[segment].yMm - ay;
+    len = fxHypot(dx, dy);
+    along = len > 0 ? (int32_t)(((int64_t)(px - ax) * dx + (int64_t)(py - ay) * dy) / len) : 0;
+    headingErr = angleToMrad(plan.points[segment].heading - pose.heading);
+    if (len > 0) {
+      crossTrack.store((int32_t)(((int64_t)dx * (py - ay) - (int64_t)dy * (px - ax)) / len),
+                       std::memory_order_relaxed);
+    }
+
+    if (segment == last) break;
+    bool passed = len < PURSUIT_ARRIVE_MM ? headingErr > -PURSUIT_ARRIVE_MRAD && headingErr < PURSUIT_ARRIVE_MRAD
+                                          : along >= len;
+    if (!passed) break;
+    segment++;
+    target.store(segment, std::memory_order_relaxed);
+  }
+
+  // Цель pure pursuit: на PURSUIT_LOOKAHEAD_MM дальше проекции по ломаной
+  int32_t reach = fxClamp(along, 0, len) + PURSUIT_LOOKAHEAD_MM;
+  int32_t gx = plan.points[last].xMm, gy = plan.points[last].yMm;
+  int32_t pathLeft = len - fxClamp(along, 0, len);
+  bool goalFound = false;
+  for (uint8_t k = segment; k <= last; k++) {
+    int32_t ax = segStartX(k), ay = segStartY(k);
+    int32_t dx = plan.points[k].xMm - ax, dy = plan.points[k].yMm - ay;
+    int32_t kLen = k == segment ? len : fxHypot(dx, dy);
+    if (k > segment) pathLeft += kLen;
+    if (goalFound) continue;
+    if (reach <= kLen && kLen > 0) {
+      gx = ax + (int32_t)((int64_t)dx * reach / kLen);
+      gy = ay + (int32_t)((int64_t)dy * reach / kLen);
+      goalFound = true;
+    } else {
+      reach -= kLen;
+    }
+  }
+
+  int32_t finalDist = fxHypot(plan.points[last].xMm - px, plan.points[last].yMm - py);
+  if (segment == last) pathLeft = finalDist;
+  remaining.store(pathLeft, std::memory_order_relaxed);
+
+  if (segment == last && finalDist <= PURSUIT_ARRIVE_MM &&
+      headingErr > -PURSUIT_ARRIVE_MRAD && headingErr < PURSUIT_ARRIVE_MRAD) {
+    speedMmps = 0;
+    status.store(PATH_DONE, std::memory_order_relaxed);
+    return false;
+  }
+
+  // Величина скорости: разгон, крейсерская, торможение к последней точке
+  int32_t cruise = plan.speedMmps < PATH_SPEED_MAX_MMPS ? plan.speedMmps : PATH_SPEED_MAX_MMPS;
+  int32_t limit = cruise;
+  int32_t braking = (int32_t)fxIsqrt64(2ULL * PURSUIT_ACCEL_MMPS2 * (uint32_t)pathLeft);
+  if (braking < limit) limit = braking;
+  if (segment == last && PURSUIT_ARRIVE_GAIN * finalDist < limit) limit = PURSUIT_ARRIVE_GAIN * finalDist;
+
+  if (limit > speedMmps) {
+    int32_t gain = PURSUIT_ACCEL_MMPS2 * (int32_t)dtMs + speedRemMmps2;
+    speedMmps += gain / 1000;
+    speedRemMmps2 = gain % 1000;
+    if (speedMmps > limit) speedMmps = limit;
+  } else {
+    speedMmps = limit;
+  }
+  int32_t speed = speedMmps;
+  if (segment != last || finalDist > PURSUIT_ARRIVE_MM) {
+    if (speed < PURSUIT_MIN_SPEED_MMPS) speed = PURSUIT_MIN_SPEED_MMPS;
+  } else {
+    speed = 0;    // Осталось довернуть
+  }
+
+  // Скорость на цель, в системе робота. Колёса и корпус отстают от
+  // команды, и при повороте на ходу скорость уносило бы вбок: в систему
+  // робота она переводится по курсу, который будет через PURSUIT_TURN_LEAD_MS.
+  FxVec2 v = fxScaleTo({gx - px, gy - py}, speed);
+  // мрад/с · мс = мкрад
+  uint32_t heading = pose.heading + uradToAngle((int64_t)pose.omegaMradps * PURSUIT_TURN_LEAD_MS);
+  FxVec2 body = fxRotate(v, 0u - heading);
+  out.vForwardMmps = body.x;
+  out.vLeftMmps = body.y;
+
+  out.omegaMradps = fxClamp(headingErr * PURSUIT_TURN_GAIN, -PURSUIT_MAX_OMEGA_MRADPS, PURSUIT_MAX_OMEGA_MRADPS);
+  return true;
+}
+
+// ==================== КИНЕМАТИКА ====================
+
+void bodyToWheels(const BodyVelocity &v, int wheels[4]) {
+  int32_t a = fxMulQ16(fxSubSat(v.vForwardMmps, v.vLeftMmps), INV_SQRT2_Q16);
+  int32_t b = fxMulQ16(fxAddSat(v.vForwardMmps, v.vLeftMmps), INV_SQRT2_Q16);
+  int32_t rot = v.omegaMradps * ODOM_TRACK_RADIUS_MM / 1000;
+  int32_t s[4] = {a - rot, b + rot, b - rot, a + rot};
+  fxLimitPeak4(s, ODOM_MAX_WHEEL_MMPS);
+
+  // Округление к ближайшему: шаг команды ~2.4 мм/с
+  for (int i = 0; i < 4; i++) {
+    int32_t num = s[i] * 255;
+    wheels[i] = (num + (num >= 0 ? ODOM_MAX_WHEEL_MMPS / 2 : -ODOM_MAX_WHEEL_MMPS / 2)) / ODOM_MAX_WHEEL_MMPS;
+  }
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+
+#include "odometry.h"
+#include "robot_state.h"
+
+// ==================== ПРОЕЗД МАРШРУТА ====================
+// Робот сам едет по точкам (x, y, курс) по позе одометрии, такт за тактом
+// в задаче управления. Корпус голономный, поэтому перемещение и поворот
+// независимы:
+//   - перемещение — pure pursuit: цель на PURSUIT_LOOKAHEAD_MM впереди
+//     проекции робота на ломаную маршрута (через углы — на следующий
+//     отрезок), скорость направлена на цель. Величина скорости: разгон
+//     PURSUIT_ACCEL_MMPS2, крейсерская из маршрута, торможение к последней
+//     точке по sqrt(2·a·d);
+//   - поворот — П-регулятор курса к курсу конечной точки текущего отрезка,
+//     с ограничением угловой скорости.
+// Первый отрезок начинается в позе, где был дан "path_go". Маршрут пройден,
+// когда робот в PURSUIT_ARRIVE_MM от последней точки и курс совпал.
+// Все вычисления целочисленные, единицы — мм, мм/с, мрад/с.
+
+#define PURSUIT_LOOKAHEAD_MM 150
+#define PURSUIT_ACCEL_MMPS2 800
+#define PURSUIT_ARRIVE_GAIN 3         // У последней точки: скорость ≤ 3/с · расстояние
+#define PURSUIT_ARRIVE_MM 15
+#define PURSUIT_ARRIVE_MRAD 35        // ~2°
+#define PURSUIT_MIN_SPEED_MMPS 25     // Ниже колёса не трогаются с места
+#define PURSUIT_TURN_GAIN 4           // мрад/с на мрад ошибки курса
+#define PURSUIT_MAX_OMEGA_MRADPS 1500
+#define PURSUIT_TURN_LEAD_MS 150      // Упреждение курса при повороте на ходу (отставание колёс и корпуса)
+
+enum PathState : uint8_t {
+  PATH_IDLE,
+  PATH_FOLLOWING,
+  PATH_DONE,
+  PATH_ABORTED      // Прервано другой командой движения
+};
+
+const char *pathStateName(uint8_t state);
+
+// Скорость корпуса в системе робота
+struct BodyVelocity {
+  int32_t vForwardMmps;
+  int32_t vLeftMmps;
+  int32_t omegaMradps;    // Против часовой
+};
+
+class PathFollower {
+public:
+  // Начать маршрут из текущей позы
+  void start(const PathPlan &plan, const OdomPose &pose);
+
+  // Такт: скорость корпуса на dtMs. false = маршрут пройден (или не
+  // начат) — робот должен стоять.
+  bool update(const PathPlan &plan, const OdomPose &pose, uint32_t dtMs, BodyVelocity &out);
+
+  void abort();
+
+  uint16_t seq() const { return planSeq; }
+
+  // Прогресс для отчёта (читается из другой задачи)
+  PathState state() const { return (PathState)status.load(std::memory_order_relaxed); }
+  uint8_t index() const { return target.load(std::memory_order_relaxed); }
+  uint8_t count() const { return total.load(std::memory_order_relaxed); }
+  int32_t remainingMm() const { return remaining.load(std::memory_order_relaxed); }
+  int32_t crossTrackMm() const { return crossTrack.load(std::memory_order_relaxed); }
+
+private:
+  int32_t startXMm = 0;         // Начало первого отрезка
+  int32_t startYMm = 0;
+  uint8_t segment = 0;          // Индекс точки, к которой ведёт текущий отрезок
+  int32_t speedMmps = 0;        // Текущая величина скорости (разгон/торможение)
+  int32_t speedRemMmps2 = 0;    // Остаток разгона (мм/с · мс)
+  uint16_t planSeq = 0;
+
+  std::atomic<uint8_t> status{PATH_IDLE};
+  std::atomic<uint8_t> target{0};
+  std::atomic<uint8_t> total{0};
+  std::atomic<int32_t> remaining{0};
+  std::atomic<int32_t> crossTrack{0};
+};
+
+// Обратная кинематика X-конфигурации (к odometry.h): скорость корпуса ->
+// команды ЛОГИЧЕСКИХ колёс -255..255. Если колесо выходит за 255, все
+// четыре масштабируются одним коэффициентом — направление сохраняется.
+//   s1 = (v - vl)/√2 - ωR    s2 = (v + vl)/√2 + ωR
+//   s3 = (v + vl)/√2 - ωR    s4 = (v - vl)/√2 + ωR
+void bodyToWheels(const BodyVelocity &v, int wheels[4]);
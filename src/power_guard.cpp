@@ -0,0 +1,71 @@
+#include "power_guard.h"
+
+#include <stdlib.h>
+
+#include "fixed.h"
+
+void PowerGuard::reset() {
+  for (int i = 0; i < 4; i++) {
+    overSince[i] = 0;
+    foldbackUntil[i] = 0;   // Новая команда начинается с полной скважности
+  }
+  budgetScale = 256;
+  stalled.store(0, std::memory_order_relaxed);
+  scale.store(256, std::memory_order_relaxed);
+}
+
+void PowerGuard::apply(int wheels[4], const uint16_t currentMa[4], const int32_t *speeds, uint32_t now) {
+  uint8_t mask = 0;
+  uint32_t sum = 0;
+
+  // 1. Заклинивание отдельных колёс
+  for (int i = 0; i < 4; i++) {
+    sum += currentMa[i];
+
+    bool moving = speeds != nullptr && abs(speeds[i]) >= MOTION_THRESHOLD;
+    bool over = abs(wheels[i]) >= STALL_MIN_DUTY && currentMa[i] >= STALL_CURRENT_MA && !moving;
+
+    if (over) {
+      if (overSince[i] == 0) overSince[i] = now ? now : 1;
+      if (now - overSince[i] >= STALL_DETECT_MS) {
+        foldbackUntil[i] = now + STALL_COOLDOWN_MS;
+        if (foldbackUntil[i] == 0) foldbackUntil[i] = 1;
+        overSince[i] = 0;
+      }
+    } else {
+      overSince[i] = 0;
+    }
+
+    if (foldbackUntil[i] != 0) {
+      if ((int32_t)(now - foldbackUntil[i]) >= 0) {
+        foldbackUntil[i] = 0;  // Повторная попытка на полной команде
+      } else {
+        mask |= 1 << i;
+        wheels[i] = fxClamp(wheels[i], -STALL_FOLDBACK_DUTY, STALL_FOLDBACK_DUTY);
+      }
+    }
+  }
+
+  // 2. Общий бюджет. Ток примерно пропорционален скважности: при
+  // превышении коэффициент уменьшается пропорционально перерасходу,
+  // при запасе больше 1/8 бюджета — медленно возвращается к 1.0.
+  // Нижняя граница не даёт "задушить" робот, если ток не реагирует.
+  int32_t s = budgetScale;
+  if (sum > POWER_BUDGET_MA) {
+    int32_t step = (int32_t)((sum - POWER_BUDGET_MA) * (uint32_t)s / sum) / 2;
+    s -= step > 0 ? step : 1;
+  } else if (sum < POWER_BUDGET_MA - POWER_BUDGET_MA / 8) {
+    s += POWER_RECOVER_STEP;
+  }
+  budgetScale = (uint16_t)fxClamp(s, POWER_MIN_SCALE_Q8, FX_Q8_ONE);
+
+  if (budgetScale < FX_Q8_ONE) {
+    for (int i = 0; i < 4; i++) {
+      wheels[i] = fxScaleQ8(wheels[i], budgetScale);
+    }
+  }
+
+  stalled.store(mask, std::memory_order_relaxed);
+  scale.store(budgetScale, std::memory_order_relaxed);
+  total.store(sum, std::memory_order_relaxed);
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+
+// ==================== ТОК КОЛЁС: ЗАЩИТА ОТ ЗАКЛИНИВАНИЯ И БЮДЖЕТ МОЩНОСТИ ====================
+// Стоит между кинематикой (скорости колёс) и записью в моторы.
+//   1. Заклинивание: большой ток без движения дольше STALL_DETECT_MS ->
+//      скважность этого колеса ограничивается STALL_FOLDBACK_DUTY на время
+//      STALL_COOLDOWN_MS, затем повторная попытка.
+//   2. Бюджет: если суммарный ток больше POWER_BUDGET_MA, все четыре
+//      команды масштабируются одним коэффициентом — направление движения
+//      сохраняется, просадка питания ESP32 не наступает.
+
+#define STALL_CURRENT_MA 1800        // Ток, который считается заклиниванием
+#define STALL_MIN_DUTY 60            // Ниже этой команды заклинивание не ищем
+#define STALL_DETECT_MS 250          // Сколько держится ток перед срабатыванием
+#define STALL_COOLDOWN_MS 1500       // Время ограничения после срабатывания
+#define STALL_FOLDBACK_DUTY 70       // Ограничение скважности заклинившего колеса
+#define POWER_BUDGET_MA 4500         // Суммарный ток четырёх моторов
+#define POWER_MIN_SCALE_Q8 64        // Бюджет не снижает команды ниже 25%
+#define POWER_RECOVER_STEP 4         // Восстановление коэффициента за такт (Q8)
+#define MOTION_THRESHOLD 2           // |скорость| ниже = колесо стоит
+
+// Источник тока по ФИЗИЧЕСКИМ каналам 1..4 (индексы 0..3), мА
+class CurrentSource {
+public:
+  virtual ~CurrentSource() {}
+  virtual bool sample(uint16_t milliamps[4]) = 0;
+};
+
+class PowerGuard {
+public:
+  // wheels: команды ЛОГИЧЕСКИХ колёс -255..255, меняются на месте.
+  // currentMa: ток тех же логических колёс.
+  // speeds: измеренные скорости колёс или nullptr, если датчиков нет
+  //         (тогда заклинивание определяется только по току).
+  void apply(int wheels[4], const uint16_t currentMa[4], const int32_t *speeds, uint32_t now);
+
+  // Сбросить накопленное состояние (моторы остановлены)
+  void reset();
+
+  uint8_t stalledMask() const { return stalled.load(std::memory_order_relaxed); }
+  uint16_t scaleQ8() const { return scale.load(std::memory_order_relaxed); }
+  uint32_t totalMilliamps() const { return total.load(std::memory_order_relaxed); }
+
+private:
+  uint32_t overSince[4] = {0, 0, 0, 0};    // Начало превышения (0 = нет)
+  uint32_t foldbackUntil[4] = {0, 0, 0, 0};
+  uint16_t budgetScale = 256;              // Q8
+  std::atomic<uint8_t> stalled{0};
+  std::atomic<uint16_t> scale{256};
+  std::atomic<uint32_t> total{0};
+};
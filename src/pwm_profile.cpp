@@ -0,0 +1,50 @@
+#include "pwm_profile.h"
+
+static const PwmProfile profiles[PWM_PROFILE_COUNT] = {
+  {"5k_8bit",   5000,  8},
+  {"20k_10bit", 20000, 10},
+  {"25k_11bit", 25000, 11},
+  {"1k_12bit",  1000,  12},
+};
+
+const PwmProfile &pwmProfile(uint8_t id) {
+  return profiles[id < PWM_PROFILE_COUNT ? id : (uint8_t)PWM_PROFILE_5K_8];
+}
+
+uint32_t pwmCounts(uint32_t dutyQ16, uint8_t bits) {
+  uint32_t max = (1u << bits) - 1;
+  if (dutyQ16 >= DUTY_Q16_ONE) return max;
+  uint32_t counts = (uint32_t)(((uint64_t)dutyQ16 * max + DUTY_Q16_ONE / 2) >> 16);
+  return counts > max ? max : counts;
+}
+
+void pwmBench(SpeedToDutyFn fn, void *ctx, PwmBenchResult results[PWM_PROFILE_COUNT]) {
+  for (uint8_t p = 0; p < PWM_PROFILE_COUNT; p++) {
+    uint8_t bits = profiles[p].bits;
+    uint32_t max = (1u << bits) - 1;
+    uint32_t last = UINT32_MAX;
+    uint16_t levels = 0;
+    uint32_t maxError = 0;
+
+    for (int speed = 1; speed <= PWM_BENCH_LOW_SPEED; speed++) {
+      int32_t q16 = fn(speed, ctx);
+      uint32_t duty = q16 < 0 ? (uint32_t)-q16 : (uint32_t)q16;
+      uint32_t counts = pwmCounts(duty, bits);
+      if (counts != last) {
+        levels++;
+        last = counts;
+      }
+
+      // Ошибка в миллионных долях: |counts/max - duty/65536|
+      int64_t actual = (int64_t)counts * 1000000 / max;
+      int64_t wanted = (int64_t)duty * 1000000 / DUTY_Q16_ONE;
+      uint32_t err = (uint32_t)(actual > wanted ? actual - wanted : wanted - actual);
+      if (err > maxError) maxError = err;
+    }
+
+    results[p].profile = p;
+    results[p].levels = levels;
+    results[p].stepPpm = (uint16_t)(1000000 / max);
+    results[p].maxErrorPpm = (uint16_t)(maxError > 65535 ? 65535 : maxError);
+  }
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "fixed.h"
+
+// ==================== PWM ПРОФИЛИ ====================
+// Частота и разрешение PWM выбираются во время работы (отдельно для
+// каждого физического мотора) и хранятся в NVS.
+// Вся математика скважности внутри — в доле Q16 (65536 = 100%),
+// в отсчёты таймера LEDC она переводится только при записи.
+// Ограничение LEDC: частота * 2^разрешение <= 80 МГц.
+
+#define DUTY_Q16_ONE 65536
+#define SPEED_MAX 255               // Команды скорости: -255..255
+#define PWM_BENCH_LOW_SPEED 32      // Низкие скорости для сравнения профилей (1..N)
+
+enum PwmProfileId : uint8_t {
+  PWM_PROFILE_5K_8,     // 5 кГц / 8 бит — как раньше, слышно
+  PWM_PROFILE_20K_10,   // 20 кГц / 10 бит — за пределом слышимости
+  PWM_PROFILE_25K_11,   // 25 кГц / 11 бит
+  PWM_PROFILE_1K_12,    // 1 кГц / 12 бит — максимум шагов на малых скоростях
+  PWM_PROFILE_COUNT
+};
+
+struct PwmProfile {
+  const char *name;
+  uint32_t freq;
+  uint8_t bits;
+};
+
+const PwmProfile &pwmProfile(uint8_t id);
+
+// Скорость -255..255 -> доля Q16 со знаком
+inline int32_t speedToDutyQ16(int speed) {
+  return fxClamp(speed, -SPEED_MAX, SPEED_MAX) * DUTY_Q16_ONE / SPEED_MAX;
+}
+
+// Доля Q16 (без знака) -> отсчёты таймера с округлением, 0..2^bits-1
+uint32_t pwmCounts(uint32_t dutyQ16, uint8_t bits);
+
+// Инверсный PWM для "назад" TA6586: больше скорость = меньше скважность
+inline uint32_t pwmInvertedCounts(uint32_t dutyQ16, uint8_t bits) {
+  return ((1u << bits) - 1) - pwmCounts(dutyQ16, bits);
+}
+
+// Сравнение профилей на малых скоростях: сколько разных значений
+// скважности даёт диапазон 1..PWM_BENCH_LOW_SPEED (после преобразования
+// speed -> Q16, например таблицей линеаризации) и шаг одного отсчёта.
+struct PwmBenchResult {
+  uint8_t profile;
+  uint16_t levels;          // Разных отсчётов таймера на низких скоростях
+  uint16_t stepPpm;         // Один отсчёт таймера, миллионные доли
+  uint16_t maxErrorPpm;     // Наибольшая ошибка квантования
+};
+
+typedef int32_t (*SpeedToDutyFn)(int speed, void *ctx);
+void pwmBench(SpeedToDutyFn fn, void *ctx, PwmBenchResult results[PWM_PROFILE_COUNT]);
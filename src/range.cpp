@@ -0,0 +1,59 @@
+#include "range.h"
+
+// ==================== ПЛАНИРОВЩИК ====================
+
+void RangeScheduler::tick(RangeSource &source, uint32_t now) {
+  sensors = source.count() < RANGE_SENSORS_MAX ? source.count() : RANGE_SENSORS_MAX;
+  if (sensors == 0) return;
+  if (current >= sensors) current = 0;
+
+  if (!inFlight) {
+    source.trigger(current, now);
+    started = now;
+    inFlight = true;
+    return;
+  }
+
+  uint16_t mm;
+  RangeStatus status = source.poll(current, now, mm);
+  if (status == RANGE_PENDING && now - started < RANGE_TIMEOUT_MS) return;
+
+  if (status == RANGE_READY) {
+    distance[current] = mm < RANGE_MAX_MM ? mm : RANGE_MAX_MM;
+    readAt[current] = now;
+    valid[current] = true;
+    seenMask |= 1 << current;
+  } else {
+    valid[current] = false;
+    failed++;
+  }
+  // Следующий запускается в следующем такте: эхо этого успевает затихнуть
+  inFlight = false;
+  current = (current + 1) % sensors;
+}
+
+bool RangeScheduler::reading(uint8_t sensor, uint32_t now, uint16_t &mm) const {
+  if (sensor >= sensors || !valid[sensor] || now - readAt[sensor] > RANGE_STALE_MS) return false;
+  mm = distance[sensor];
+  return true;
+}
+
+// ==================== МОДЕЛЬ ДЛЯ ХОСТА ====================
+
+void SimulatedRanges::trigger(uint8_t sensor, uint32_t now) {
+  triggeredAt = now;
+  started++;
+  int32_t mm = truth[sensor];
+  if (noise > 0) {
+    lcg = lcg * 1664525u + 1013904223u;
+    mm += (int32_t)((lcg >> 16) % (2u * noise + 1)) - noise;
+  }
+  sampled = (uint16_t)(mm < 0 ? 0 : (mm > RANGE_MAX_MM ? RANGE_MAX_MM : mm));
+}
+
+RangeStatus SimulatedRanges::poll(uint8_t sensor, uint32_t now, uint16_t &mm) {
+  if ((deadMask >> sensor) & 1) return RANGE_PENDING;
+  if (now - triggeredAt < latencyMs) return RANGE_PENDING;
+  mm = sampled;
+  return RANGE_READY;
+}
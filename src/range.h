@@ -0,0 +1,90 @@
+#pragma once
+
+#include <stdint.h>
+
+// ==================== ДАТЧИКИ РАССТОЯНИЯ ====================
+// Кольцо датчиков (ультразвук HC-SR04 или ToF) опрашивается по кругу,
+// по одному: соседние ультразвуковые датчики слышат чужое эхо. Источник
+// только запускает измерение и отвечает, готово ли оно; планировщик
+// (RangeScheduler) зовётся раз в такт задачи управления и никогда не
+// ждёт: измерение, не готовое сейчас, проверяется в следующем такте.
+
+#define RANGE_SENSORS_MAX 8
+#define RANGE_MAX_MM 4000             // Эха нет в пределах дальности: путь свободен
+#define RANGE_TIMEOUT_MS 60           // Датчик не ответил — сбой, следующий
+#define RANGE_STALE_MS 500            // Старше — показания нет
+
+enum RangeStatus : uint8_t {
+  RANGE_PENDING,      // Измерение идёт
+  RANGE_READY,        // mm готово (RANGE_MAX_MM — препятствий нет)
+  RANGE_FAILED        // Датчик не ответил
+};
+
+class RangeSource {
+public:
+  virtual ~RangeSource() {}
+
+  virtual uint8_t count() const = 0;
+
+  // Запустить измерение датчика (предыдущее уже закончено)
+  virtual void trigger(uint8_t sensor, uint32_t now) = 0;
+
+  // Состояние запущенного измерения; без ожидания
+  virtual RangeStatus poll(uint8_t sensor, uint32_t now, uint16_t &mm) = 0;
+};
+
+// Опрос по кругу и последние показания. Только задача управления.
+class RangeScheduler {
+public:
+  // Раз в такт: проверить текущий датчик, по готовности — запустить следующий
+  void tick(RangeSource &source, uint32_t now);
+
+  // Свежее показание датчика; false — нет (не опрошен, сбой, устарело)
+  bool reading(uint8_t sensor, uint32_t now, uint16_t &mm) const;
+
+  // Датчик хоть раз ответил — установлен
+  bool fitted(uint8_t sensor) const { return sensor < RANGE_SENSORS_MAX && (seenMask >> sensor) & 1; }
+
+  uint8_t count() const { return sensors; }
+  uint32_t failures() const { return failed; }
+
+private:
+  uint8_t sensors = 0;
+  uint8_t current = 0;
+  bool inFlight = false;
+  uint32_t started = 0;
+  uint8_t seenMask = 0;
+  uint16_t distance[RANGE_SENSORS_MAX] = {};
+  uint32_t readAt[RANGE_SENSORS_MAX] = {};
+  bool valid[RANGE_SENSORS_MAX] = {};
+  uint32_t failed = 0;
+};
+
+// Датчики для хоста: расстояние задаёт сценарий (например, лучом от
+// истинной позы до стен), измерение готово через latencyMs, как у
+// ультразвука, с шумом. Датчик можно "отключить" — он перестаёт отвечать.
+class SimulatedRanges : public RangeSource {
+public:
+  explicit SimulatedRanges(uint8_t sensors, uint32_t latencyMs = 12) : sensors(sensors), latencyMs(latencyMs) {}
+
+  void setDistance(uint8_t sensor, uint16_t mm) { truth[sensor] = mm; }
+  void setNoise(uint16_t mm) { noise = mm; }
+  void setFailed(uint8_t sensor, bool dead) { deadMask = dead ? deadMask | (1u << sensor) : deadMask & ~(1u << sensor); }
+
+  uint8_t count() const override { return sensors; }
+  void trigger(uint8_t sensor, uint32_t now) override;
+  RangeStatus poll(uint8_t sensor, uint32_t now, uint16_t &mm) override;
+
+  uint32_t triggers() const { return started; }
+
+private:
+  uint8_t sensors;
+  uint32_t latencyMs;
+  uint16_t noise = 0;
+  uint32_t lcg = 2463534242u;
+  uint8_t deadMask = 0;
+  uint16_t truth[RANGE_SENSORS_MAX] = {};
+  uint16_t sampled = 0;           // Расстояние на момент запуска
+  uint32_t triggeredAt = 0;
+  uint32_t started = 0;
+};
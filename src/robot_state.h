@@ -0,0 +1,237 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <mutex>
+
+#ifdef ARDUINO
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#else
+#include <thread>
+#endif
+
+#include "pwm_profile.h"
+
+// ==================== ОБЩЕЕ СОСТОЯНИЕ РОБОТА ====================
+// Настройки и текущее намерение движения хранятся одним снимком.
+// Писатели (обработчики команд) публикуют новый снимок под seqlock,
+// читатели (задача управления, HTTP, телеметрия) копируют его без
+// блокировок и повторяют чтение, если попали на запись.
+// Задача управления читает снимок один раз в начале такта, поэтому
+// изменения калибровки вступают в силу на границе такта и целиком.
+//
+// Правило приоритетов: читатель, вытеснивший писателя на том же ядре,
+// не дождётся конца записи. Поэтому писатели (AsyncTCP, задача связи)
+// работают на ядре 0 или с приоритетом не ниже задачи управления, а
+// задача управления всё равно не ждёт: tryRead() с ограниченным числом
+// попыток, при неудаче — снимок прошлого такта. Остальные читатели
+// после SEQLOCK_READ_TRIES попыток уступают процессор на тик.
+
+#define SEQLOCK_READ_TRIES 64
+
+// ---------- Seqlock ----------
+// Чётный seq = данные стабильны, нечётный = идёт запись.
+// Писатели сериализуются мьютексом, читатели не блокируются никогда.
+// T должен быть тривиально копируемым.
+template <typename T>
+class SeqLock {
+public:
+  explicit SeqLock(const T &initial) : seq(0), data(initial) {}
+
+  // Копия снимка не более чем за SEQLOCK_READ_TRIES попыток.
+  // false — писатель не закончил, out испорчен и не используется.
+  bool tryRead(T &out, uint32_t &version) const {
+    for (int i = 0; i < SEQLOCK_READ_TRIES; i++) {
+      uint32_t s0 = seq.load(std::memory_order_acquire);
+      if (s0 & 1) continue;
+      out = data;
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (seq.load(std::memory_order_relaxed) == s0) {
+        version = s0 >> 1;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Копия снимка; возвращает версию (число публикаций).
+  // Между сериями попыток уступает процессор: писатель с меньшим
+  // приоритетом на этом же ядре успевает закончить запись.
+  uint32_t read(T &out) const {
+    uint32_t version;
+    while (!tryRead(out, version)) {
+#ifdef ARDUINO
+      vTaskDelay(1);
+#else
+      std::this_thread::yield();
+#endif
+    }
+    return version;
+  }
+
+  T read() const {
+    T out;
+    read(out);
+    return out;
+  }
+
+  uint32_t version() const {
+    return seq.load(std::memory_order_acquire) >> 1;
+  }
+
+  void write(const T &value) {
+    std::lock_guard<std::mutex> guard(writer);
+    publish(value);
+  }
+
+  // Чтение-изменение-запись под блокировкой писателя.
+  // fn(T&) возвращает false, если изменения нужно отбросить.
+  template <typename F>
+  bool update(F fn) {
+    std::lock_guard<std::mutex> guard(writer);
+    T copy = data;
+    if (!fn(copy)) return false;
+    publish(copy);
+    return true;
+  }
+
+private:
+  void publish(const T &value) {
+    uint32_t s = seq.load(std::memory_order_relaxed);
+    seq.store(s + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    data = value;
+    std::atomic_thread_fence(std::memory_order_release);
+    seq.store(s + 2, std::memory_order_release);
+  }
+
+  std::atomic<uint32_t> seq;
+  T data;
+  std::mutex writer;
+};
+
+// ---------- Намерение движения ----------
+
+enum DriveKind : uint8_t {
+  DRIVE_STOP,
+  DRIVE_PRESET,   // Кнопки: forward/left/rotate_left/diag_fl...
+  DRIVE_JOY,      // Джойстик "joy:x:y"
+  DRIVE_TEST,     // Тест отдельных колёс из калибровки
+  DRIVE_STOP_TEST, // Замер тормозного пути: разгон, затем остановка профилем
+  DRIVE_CHARACTERIZE, // Автоматическая характеризация моторов (motor_lut.h)
+  DRIVE_PATH,     // Проезд маршрута по точкам (path_follower.h)
+  DRIVE_AXES,     // Три оси "drive:vx:vy:w" (геймпад): стрейф, ход и поворот разом
+  DRIVE_KIND_COUNT
+};
+
+// Профили остановки выходного каскада TA6586
+enum StopProfile : uint8_t {
+  STOP_COAST,        // Холостой ход: D0=LOW, D1=LOW, робот катится
+  STOP_BRAKE,        // Торможение: D0=HIGH, D1=HIGH, держится до новой команды
+  STOP_BRAKE_COAST,  // Торможение на BRAKE_HOLD_MS, затем холостой ход
+  STOP_PROFILE_COUNT
+};
+
+inline const char *stopProfileName(StopProfile profile) {
+  switch (profile) {
+    case STOP_BRAKE:       return "brake";
+    case STOP_BRAKE_COAST: return "brake_coast";
+    default:               return "coast";
+  }
+}
+
+enum DrivePreset : uint8_t {
+  PRESET_FORWARD, PRESET_BACKWARD, PRESET_LEFT, PRESET_RIGHT,
+  PRESET_ROTATE_LEFT, PRESET_ROTATE_RIGHT,
+  PRESET_DIAG_FL, PRESET_DIAG_FR, PRESET_DIAG_BL, PRESET_DIAG_BR,
+  PRESET_COUNT
+};
+
+struct DriveIntent {
+  DriveKind kind;
+  DrivePreset preset;
+  int16_t joyX, joyY;   // DRIVE_AXES: joyX — вправо, joyY — вперёд
+  int16_t joyW;         // DRIVE_AXES: поворот, против часовой
+  int8_t test[4];       // -1/0/+1 для каждой логической позиции
+  StopProfile stopProfile;  // Для DRIVE_STOP и DRIVE_STOP_TEST
+};
+
+// ---------- Маршрут ----------
+// Точки загружаются командами "wp:x:y:h" и едут по "path_go". Координаты —
+// в системе одометрии (от последнего odom_reset): x вперёд, y влево.
+
+#define PATH_MAX_WAYPOINTS 32
+#define PATH_SPEED_MIN_MMPS 50
+#define PATH_SPEED_DEFAULT_MMPS 300
+#define PATH_SPEED_MAX_MMPS 600       // Без поворота корпус может ~850 мм/с
+
+struct Waypoint {
+  int32_t xMm;
+  int32_t yMm;
+  uint32_t heading;     // Курс в точке, двоичный угол (odometry.h)
+};
+
+struct PathPlan {
+  Waypoint points[PATH_MAX_WAYPOINTS];
+  uint8_t count;
+  uint16_t speedMmps;   // Крейсерская скорость корпуса
+  uint16_t seq;         // Номер запуска: "path_go" увеличивает
+};
+
+// ---------- Снимок ----------
+
+// Возраст кадра управления с меткой клиента (client_clock.h)
+#define CMD_AGE_MAX_MS 5000           // Верхняя граница настройки max_age
+#define CMD_AGE_DEFAULT_MS 250        // Дольше — оператор уже видит другое
+
+struct RobotConfig {
+  int speed;            // Текущая скорость (0-255)
+  bool omniMode;        // true = Omni (strafe), false = Tank (rotation)
+  // motorMapping[логическая_позиция] = физический_мотор
+  // Логические позиции: 0=передний-правый, 1=передний-левый, 2=задний-левый, 3=задний-правый
+  int8_t motorMapping[4];
+  bool motorInvert[4];  // Инверсия направления
+  StopProfile stopProfile;  // Профиль обычной команды "stop"
+  bool linearize;       // Коррекция скважности по таблице характеризации
+  uint8_t pwmProfile[4];  // PwmProfileId по ФИЗИЧЕСКИМ моторам 1..4
+  bool headingHold;     // Удержание курса по гироскопу
+  bool obstacleGuard;   // Ограничение скорости к препятствиям (obstacle_governor.h)
+  uint16_t cmdMaxAgeMs; // Старше — уставка запоздала; 0 = не проверять
+  bool cmdAgeDecay;     // Запоздавшую уставку ослаблять, а не отбрасывать
+};
+
+struct RobotState {
+  RobotConfig config;
+  DriveIntent drive;
+  PathPlan path;
+};
+
+inline RobotConfig defaultRobotConfig() {
+  RobotConfig cfg;
+  cfg.speed = 200;  // ~80% от 255
+  cfg.omniMode = true;
+  for (int i = 0; i < 4; i++) {
+    cfg.motorMapping[i] = i + 1;  // По умолчанию: прямое соответствие
+    cfg.motorInvert[i] = false;
+  }
+  cfg.stopProfile = STOP_COAST;
+  cfg.linearize = false;
+  cfg.headingHold = false;
+  cfg.obstacleGuard = false;
+  cfg.cmdMaxAgeMs = CMD_AGE_DEFAULT_MS;
+  cfg.cmdAgeDecay = false;
+  for (int i = 0; i < 4; i++) {
+    cfg.pwmProfile[i] = PWM_PROFILE_5K_8;
+  }
+  return cfg;
+}
+
+inline RobotState defaultRobotState() {
+  RobotState st;
+  st.config = defaultRobotConfig();
+  st.drive = {DRIVE_STOP, PRESET_FORWARD, 0, 0, 0, {0, 0, 0, 0}, STOP_COAST};
+  st.path = {};
+  st.path.speedMmps = PATH_SPEED_DEFAULT_MMPS;
+  return st;
+}
@@ -0,0 +1,63 @@
+#include "serial_link.h"
+
+#include <string.h>
+
+void SerialLink::endFrame(LinkFrameFn onFrame, LinkFrameFn onNoise, void *ctx) {
+  if (rxOverflow) {
+    st.overflows++;
+  } else if (rxLen > 0) {
+    size_t n;
+    bool ok = cobsDecode(rx, rxLen, rxPlain, n) && n >= 2;
+    if (ok) {
+      uint16_t crc = (uint16_t)(rxPlain[n - 2] | (rxPlain[n - 1] << 8));
+      ok = crc16Ccitt(rxPlain, n - 2) == crc;
+    }
+
+    if (ok) {
+      st.rxFrames++;
+      onFrame(ctx, rxPlain, n - 2);
+    } else {
+      st.badFrames++;
+      if (onNoise != nullptr) onNoise(ctx, rx, rxLen);
+    }
+  }
+  rxLen = 0;
+  rxOverflow = false;
+}
+
+void SerialLink::poll(LinkFrameFn onFrame, LinkFrameFn onNoise, void *ctx) {
+  uint8_t buf[128];
+  size_t n;
+  while ((n = io.read(buf, sizeof(buf))) > 0) {
+    for (size_t i = 0; i < n; i++) {
+      if (buf[i] == 0) {
+        endFrame(onFrame, onNoise, ctx);
+      } else if (rxLen < sizeof(rx)) {
+        rx[rxLen++] = buf[i];
+      } else {
+        rxOverflow = true;  // Остаток кадра пропускается до разделителя
+      }
+    }
+  }
+}
+
+bool SerialLink::send(const uint8_t *data, size_t len) {
+  if (len > LINK_MAX_PAYLOAD) return false;
+
+  memcpy(txPlain, data, len);
+  uint16_t crc = crc16Ccitt(data, len);
+  txPlain[len] = (uint8_t)crc;
+  txPlain[len + 1] = (uint8_t)(crc >> 8);
+
+  tx[0] = 0;
+  size_t n = cobsEncode(txPlain, len + 2, tx + 1) + 1;
+  tx[n++] = 0;
+
+  if (io.writable() < n) {
+    st.txDeferred++;
+    return false;
+  }
+  io.write(tx, n);
+  st.txFrames++;
+  return true;
+}
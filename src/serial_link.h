@@ -0,0 +1,63 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "cobs.h"
+
+// ==================== ПРОВОДНАЯ СВЯЗЬ: КАДРЫ COBS ====================
+// Кадр = COBS(сообщение + CRC-16 little-endian), с нулём до и после.
+// Сообщения — те же, что по WebSocket (текстовые команды, JSON ответы).
+// Ведущий ноль отрезает всё, что попало в порт между кадрами (на ESP32 —
+// текст журнала Serial): такой отрезок не проходит CRC и отдаётся как шум.
+// Один и тот же класс работает на роботе и на ПК (src/host/link_*.cpp).
+
+#define LINK_MAX_PAYLOAD 2048                                     // Как WS_MAX_MESSAGE
+#define LINK_MAX_FRAME COBS_MAX_ENCODED(LINK_MAX_PAYLOAD + 2)     // Кадр без разделителей
+
+// Неблокирующий поток байт (UART, псевдотерминал)
+class ByteStream {
+public:
+  virtual ~ByteStream() {}
+  virtual size_t read(uint8_t *buf, size_t maxLen) = 0;
+  virtual size_t write(const uint8_t *data, size_t len) = 0;
+  // Сколько байт можно записать без ожидания
+  virtual size_t writable() = 0;
+};
+
+typedef void (*LinkFrameFn)(void *ctx, const uint8_t *data, size_t len);
+
+struct LinkStats {
+  uint32_t rxFrames;
+  uint32_t txFrames;
+  uint32_t badFrames;     // Не COBS или не сошлась CRC (в т.ч. текст журнала)
+  uint32_t overflows;     // Кадр длиннее LINK_MAX_FRAME
+  uint32_t txDeferred;    // Нет места в буфере передачи
+};
+
+class SerialLink {
+public:
+  explicit SerialLink(ByteStream &stream) : io(stream) {}
+
+  // Разобрать пришедшие байты. onFrame — на каждое целое сообщение,
+  // onNoise (может быть nullptr) — на отрезок, который кадром не оказался.
+  void poll(LinkFrameFn onFrame, LinkFrameFn onNoise, void *ctx);
+
+  // false = сообщение больше LINK_MAX_PAYLOAD или в буфере передачи нет
+  // места под весь кадр (повторить позже: кадр не пишется по частям)
+  bool send(const uint8_t *data, size_t len);
+
+  const LinkStats &stats() const { return st; }
+
+private:
+  void endFrame(LinkFrameFn onFrame, LinkFrameFn onNoise, void *ctx);
+
+  ByteStream &io;
+  uint8_t rx[LINK_MAX_FRAME];
+  size_t rxLen = 0;
+  bool rxOverflow = false;
+  uint8_t rxPlain[LINK_MAX_FRAME];
+  uint8_t txPlain[LINK_MAX_PAYLOAD + 2];
+  uint8_t tx[LINK_MAX_FRAME + 2];
+  LinkStats st = {};
+};
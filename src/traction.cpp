@@ -0,0 +1,89 @@
+#include "traction.h"
+
+#include <stdlib.h>
+
+#include "fixed.h"
+#include "odometry.h"
+
+// Знак колеса в r = (s1 + s2 - s3 - s4) / 4
+static const int8_t residualPattern[4] = {1, 1, -1, -1};
+
+void TractionControl::reset() {
+  candidate = -1;
+  confirm = 0;
+  for (int i = 0; i < 4; i++) scaleQ8[i] = 256;
+  slipping.store(0, std::memory_order_relaxed);
+  residual.store(0, std::memory_order_relaxed);
+}
+
+// Какое колесо буксует: из пары, обгоняющей корпус, то, что крутится
+// быстрее всех относительно своей команды. -1 = определить нельзя.
+int8_t TractionControl::identify(const int wheels[4], const int32_t speeds[4], int32_t r) const {
+  int8_t best = -1;
+  int32_t bestRatio = 0;
+
+  for (int i = 0; i < 4; i++) {
+    if (abs(wheels[i]) < SLIP_MIN_COMMAND) continue;
+
+    // Колесо должно обгонять корпус в направлении своей команды
+    int32_t excess = residualPattern[i] * r;
+    if ((wheels[i] > 0) != (excess > 0)) continue;
+
+    // Скорость относительно ожидаемой по команде, Q8
+    int32_t expected = abs(wheels[i]) * ODOM_MAX_WHEEL_MMPS / 255;
+    int32_t ratio = abs(speeds[i]) * 256 / (expected > 0 ? expected : 1);
+    if (best < 0 || ratio > bestRatio) {
+      best = (int8_t)i;
+      bestRatio = ratio;
+    }
+  }
+  return best;
+}
+
+uint8_t TractionControl::apply(int wheels[4], const int32_t speeds[4]) {
+  int32_t r = (speeds[0] + speeds[1] - speeds[2] - speeds[3]) / 4;
+  int32_t meanAbs = (abs(speeds[0]) + abs(speeds[1]) + abs(speeds[2]) + abs(speeds[3])) / 4;
+  int32_t threshold = SLIP_RESIDUAL_MIN_MMPS + ((meanAbs * SLIP_RESIDUAL_RATIO_Q8) >> 8);
+  residual.store(r, std::memory_order_relaxed);
+
+  // Признанное проскальзывание держится, пока |r| не упадёт вдвое ниже
+  // порога: колесо со сниженной командой ещё не зацепилось
+  uint8_t current = slipping.load(std::memory_order_relaxed);
+  int8_t wheel = -1;
+  if (abs(r) > threshold) {
+    wheel = identify(wheels, speeds, r);
+  } else if (current && abs(r) > threshold / 2) {
+    wheel = candidate;
+  }
+
+  if (wheel >= 0 && wheel == candidate) {
+    if (confirm < SLIP_CONFIRM_TICKS) confirm++;
+  } else {
+    candidate = wheel;
+    confirm = wheel >= 0 ? 1 : 0;
+  }
+
+  uint8_t mask = 0;
+  bool slip = candidate >= 0 && confirm >= SLIP_CONFIRM_TICKS;
+  if (slip && !(current & (1 << candidate))) {
+    eventCount.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  for (int i = 0; i < 4; i++) {
+    int32_t s = scaleQ8[i];
+    if (slip && i == candidate) {
+      s = fxClamp(s - TRACTION_CUT_Q8, TRACTION_MIN_SCALE_Q8, FX_Q8_ONE);
+    } else if (s < FX_Q8_ONE) {
+      s = fxClamp(s + TRACTION_RECOVER_Q8, TRACTION_MIN_SCALE_Q8, FX_Q8_ONE);
+    }
+    scaleQ8[i] = (uint16_t)s;
+
+    if (s < FX_Q8_ONE) {
+      wheels[i] = fxScaleQ8(wheels[i], s);
+      mask |= 1 << i;
+    }
+  }
+
+  slipping.store(slip ? (uint8_t)(1 << candidate) : 0, std::memory_order_relaxed);
+  return mask;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+
+// ==================== ПРОСКАЛЬЗЫВАНИЕ И ТЯГА ====================
+// Четыре колеса задают три степени свободы корпуса, поэтому у жёсткого
+// корпуса скорости колёс связаны: s1 + s2 = s3 + s4. Рассогласование
+//   r = (s1 + s2 - s3 - s4) / 4
+// — это то, на сколько колёса расходятся с любым возможным движением
+// корпуса. Большое |r| = какое-то колесо проскальзывает. Знак r говорит,
+// какая пара "обгоняет" корпус (M1/M2 при r > 0, M3/M4 при r < 0); из неё
+// выбирается колесо, которое сильнее всех крутится быстрее своей команды
+// (буксует на разгоне). Команда этого колеса снижается, пока сцепление
+// не восстановится, затем плавно возвращается — как антибукс.
+// Нужны измеренные скорости колёс (мм/с), без датчиков модуль не работает.
+
+#define SLIP_RESIDUAL_MIN_MMPS 20     // Абсолютный порог |r|
+#define SLIP_RESIDUAL_RATIO_Q8 13     // ...плюс 5% средней |скорости| колёс
+#define SLIP_MIN_COMMAND 30           // Колёса с меньшей командой не проверяются
+#define SLIP_CONFIRM_TICKS 3          // Тактов подряд до признания проскальзывания
+#define TRACTION_CUT_Q8 32            // Снижение команды колеса за такт проскальзывания
+#define TRACTION_MIN_SCALE_Q8 64      // Не ниже 25% команды
+#define TRACTION_RECOVER_Q8 4          // Возврат за такт со сцеплением
+
+class TractionControl {
+public:
+  // wheels: команды ЛОГИЧЕСКИХ колёс -255..255 после кинематики, меняются
+  // на месте. speeds: измеренные скорости тех же колёс, мм/с.
+  // Возвращает маску колёс, у которых сейчас ограничена команда.
+  uint8_t apply(int wheels[4], const int32_t speeds[4]);
+
+  void reset();
+
+  // Для телеметрии (читаются из другой задачи)
+  uint8_t slipMask() const { return slipping.load(std::memory_order_relaxed); }
+  int32_t residualMmps() const { return residual.load(std::memory_order_relaxed); }
+  uint32_t events() const { return eventCount.load(std::memory_order_relaxed); }
+
+private:
+  int8_t identify(const int wheels[4], const int32_t speeds[4], int32_t r) const;
+
+  int8_t candidate = -1;            // Колесо, набирающее подтверждение
+  uint8_t confirm = 0;
+  uint16_t scaleQ8[4] = {256, 256, 256, 256};
+  std::atomic<uint8_t> slipping{0};
+  std::atomic<int32_t> residual{0};
+  std::atomic<uint32_t> eventCount{0};
+};
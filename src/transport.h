@@ -0,0 +1,29 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "ws_broadcast.h"
+
+// ==================== ТРАНСПОРТЫ КЛИЕНТОВ ====================
+// Ядро команд (handleCommand) и рассылка (ws_broadcast.h) работают с
+// числовым id клиента и не знают, откуда он пришёл. Транспорт владеет
+// диапазоном id и доставляет сообщения своим клиентам.
+//   WebSocket: id от AsyncWebSocket (1, 2, 3 ...)
+//   Последовательный порт: LINK_CLIENT_ID (один клиент на порт)
+
+#define LINK_CLIENT_ID 0x80000001u
+
+class Transport {
+public:
+  virtual ~Transport() {}
+
+  virtual bool owns(uint32_t clientId) const = 0;
+  // Одно сообщение клиенту; false = транспорт сейчас не может принять
+  virtual bool send(uint32_t clientId, const char *data, size_t len) = 0;
+  // То же из очереди рассылки: транспорт может один раз подготовить свой
+  // буфер для всех клиентов (SharedMessage::attach)
+  virtual bool send(uint32_t clientId, SharedMessage &m) { return send(clientId, m.data(), m.length()); }
+  // Отключить клиента, переполнившего очередь надёжных сообщений
+  virtual void kick(uint32_t clientId) = 0;
+};
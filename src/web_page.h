@@ -0,0 +1,1112 @@
+#pragma once
+
+// ==================== HTML ИНТЕРФЕЙС ====================
+// Страница управления ("/"). Отдельным файлом, чтобы её же отдавал
+// заменитель робота на ПК (src/host/standin.cpp).
+
+#ifndef PROGMEM
+#define PROGMEM
+#endif
+
+const char index_html[] PROGMEM = R"rawliteral(
+<!DOCTYPE html>
+<html>
+<head>
+  <meta charset="UTF-8">
+  <meta name="viewport" content="width=device-width, initial-scale=1.0">
+  <title>Omni Robot Control</title>
+  <style>
+    * {
+      margin: 0;
+      padding: 0;
+      box-sizing: border-box;
+    }
+    body {
+      font-family: -apple-system, BlinkMacSystemFont, 'Segoe UI', sans-serif;
+      background: #f8fafc;
+      min-height: 100vh;
+      padding: 20px;
+    }
+    .container {
+      max-width: 700px;
+      margin: 0 auto;
+      background: white;
+      border-radius: 12px;
+      box-shadow: 0 1px 3px rgba(0,0,0,0.1);
+      border: 1px solid #e2e8f0;
+      overflow: hidden;
+    }
+    .header {
+      background: white;
+      border-bottom: 1px solid #e2e8f0;
+      padding: 20px;
+      text-align: center;
+    }
+    .header h1 {
+      font-size: 20px;
+      margin-bottom: 8px;
+      color: #0f172a;
+      font-weight: 600;
+    }
+    .status {
+      font-size: 13px;
+      font-weight: 500;
+    }
+    .status.connected { color: #10b981; }
+    .status.disconnected { color: #64748b; }
+    .battery {
+      font-size: 12px;
+      color: #64748b;
+      margin-top: 4px;
+    }
+    .battery.low { color: #ef4444; font-weight: 600; }
+
+    .tabs {
+      display: flex;
+      background: #f8fafc;
+      border-bottom: 1px solid #e2e8f0;
+    }
+    .tab {
+      flex: 1;
+      padding: 14px;
+      text-align: center;
+      cursor: pointer;
+      border: none;
+      background: none;
+      font-size: 14px;
+      font-weight: 500;
+      color: #64748b;
+      transition: all 0.2s;
+    }
+    .tab.active {
+      background: white;
+      color: #3b82f6;
+      border-bottom: 2px solid #3b82f6;
+    }
+
+    .mode-btn {
+      padding: 10px 20px;
+      border: none;
+      background: transparent;
+      color: #64748b;
+      font-size: 14px;
+      font-weight: 500;
+      cursor: pointer;
+      border-radius: 6px;
+      transition: all 0.2s;
+    }
+    .mode-btn.active {
+      background: white;
+      color: #3b82f6;
+      box-shadow: 0 1px 3px rgba(0,0,0,0.1);
+    }
+
+    .tab-content {
+      display: none;
+      padding: 30px 20px;
+      max-height: 75vh;
+      overflow-y: auto;
+    }
+    .tab-content.active {
+      display: block;
+    }
+
+    .speed-control {
+      margin-bottom: 20px;
+      text-align: center;
+    }
+    .speed-control label {
+      display: block;
+      font-size: 14px;
+      font-weight: 500;
+      margin-bottom: 10px;
+      color: #475569;
+    }
+    .speed-slider {
+      width: 100%;
+      margin: 10px 0;
+      height: 6px;
+      border-radius: 3px;
+      background: #e2e8f0;
+      outline: none;
+      -webkit-appearance: none;
+    }
+    .speed-slider::-webkit-slider-thumb {
+      -webkit-appearance: none;
+      appearance: none;
+      width: 18px;
+      height: 18px;
+      border-radius: 50%;
+      background: #3b82f6;
+      cursor: pointer;
+      border: 2px solid white;
+      box-shadow: 0 1px 3px rgba(0,0,0,0.2);
+    }
+    .speed-slider::-moz-range-thumb {
+      width: 18px;
+      height: 18px;
+      border-radius: 50%;
+      background: #3b82f6;
+      cursor: pointer;
+      border: 2px solid white;
+      box-shadow: 0 1px 3px rgba(0,0,0,0.2);
+    }
+    .speed-value {
+      font-size: 28px;
+      font-weight: 600;
+      color: #3b82f6;
+    }
+
+    .joystick-layout {
+      display: grid;
+      grid-template-columns: 1fr 1fr;
+      gap: 15px;
+      margin-bottom: 20px;
+    }
+
+    .control-grid {
+      display: grid;
+      grid-template-columns: repeat(3, 1fr);
+      gap: 10px;
+    }
+    .btn {
+      padding: 20px;
+      font-size: 24px;
+      border: 1px solid #e2e8f0;
+      border-radius: 8px;
+      cursor: pointer;
+      background: white;
+      color: #3b82f6;
+      transition: all 0.15s;
+      user-select: none;
+      -webkit-user-select: none;
+      -webkit-touch-callout: none;
+      font-weight: 500;
+      box-shadow: 0 1px 2px rgba(0,0,0,0.05);
+    }
+    .btn:active {
+      transform: scale(0.98);
+      background: #eff6ff;
+      border-color: #3b82f6;
+    }
+    .btn.empty {
+      background: transparent;
+      cursor: default;
+      border: none;
+      box-shadow: none;
+    }
+    .btn.stop {
+      background: #ef4444;
+      color: white;
+      border-color: #ef4444;
+      grid-column: 2;
+    }
+    .btn.stop:active {
+      background: #dc2626;
+      border-color: #dc2626;
+    }
+
+    .rotate-buttons {
+      display: grid;
+      grid-template-columns: 1fr 1fr;
+      gap: 10px;
+      height: 100%;
+    }
+
+    .rotate-buttons .btn {
+      font-size: 18px;
+    }
+
+    .emergency-stop {
+      width: 100%;
+      padding: 18px;
+      font-size: 16px;
+      font-weight: 600;
+      background: #ef4444;
+      color: white;
+      border: 1px solid #ef4444;
+      border-radius: 8px;
+      cursor: pointer;
+      margin-top: 20px;
+      box-shadow: 0 1px 3px rgba(239,68,68,0.3);
+      transition: all 0.15s;
+    }
+    .emergency-stop:active {
+      background: #dc2626;
+      border-color: #dc2626;
+      transform: scale(0.98);
+    }
+
+    /* Калибровка - визуальный квадрат */
+    .info-box {
+      background: #f0f9ff;
+      border: 1px solid #bae6fd;
+      padding: 14px;
+      margin-bottom: 20px;
+      border-radius: 8px;
+    }
+    .info-box p {
+      font-size: 13px;
+      color: #0369a1;
+      line-height: 1.6;
+      margin-bottom: 6px;
+    }
+    .info-box p:last-child {
+      margin-bottom: 0;
+    }
+
+    .robot-visual {
+      display: grid;
+      grid-template-columns: 1fr 1fr;
+      gap: 15px;
+      margin-bottom: 24px;
+      padding: 16px;
+      background: #f8fafc;
+      border-radius: 8px;
+      border: 1px solid #e2e8f0;
+    }
+
+    .motor-corner {
+      background: white;
+      border-radius: 8px;
+      padding: 14px;
+      border: 1px solid #e2e8f0;
+      box-shadow: 0 1px 2px rgba(0,0,0,0.05);
+    }
+
+    .corner-header {
+      text-align: center;
+      margin-bottom: 12px;
+      padding-bottom: 10px;
+      border-bottom: 1px solid #e2e8f0;
+    }
+
+    .corner-header h3 {
+      font-size: 13px;
+      color: #475569;
+      margin-bottom: 4px;
+      font-weight: 500;
+    }
+
+    .corner-header .icon {
+      font-size: 24px;
+      margin-bottom: 4px;
+    }
+
+    .test-controls {
+      display: grid;
+      grid-template-columns: repeat(3, 1fr);
+      gap: 6px;
+      margin-bottom: 12px;
+    }
+
+    .test-controls .btn {
+      padding: 10px 6px;
+      font-size: 16px;
+    }
+
+    .btn.forward {
+      background: white;
+      color: #10b981;
+      border-color: #d1fae5;
+    }
+    .btn.forward:active {
+      background: #f0fdf4;
+      border-color: #10b981;
+    }
+    .btn.backward {
+      background: white;
+      color: #f59e0b;
+      border-color: #fed7aa;
+    }
+    .btn.backward:active {
+      background: #fffbeb;
+      border-color: #f59e0b;
+    }
+    .btn.test-stop {
+      background: #ef4444;
+      color: white;
+      border-color: #ef4444;
+    }
+    .btn.test-stop:active {
+      background: #dc2626;
+      border-color: #dc2626;
+    }
+
+    .corner-settings {
+      margin-top: 10px;
+    }
+
+    .setting-item {
+      margin-bottom: 8px;
+    }
+
+    .setting-item label {
+      display: block;
+      font-size: 12px;
+      color: #64748b;
+      margin-bottom: 4px;
+      font-weight: 500;
+    }
+
+    .setting-item select {
+      width: 100%;
+      padding: 8px;
+      border: 1px solid #e2e8f0;
+      border-radius: 6px;
+      font-size: 13px;
+      background: white;
+      color: #475569;
+      cursor: pointer;
+      transition: all 0.15s;
+    }
+
+    .setting-item select:focus {
+      outline: none;
+      border-color: #3b82f6;
+      box-shadow: 0 0 0 3px rgba(59,130,246,0.1);
+    }
+
+    .invert-check {
+      display: flex;
+      align-items: center;
+      justify-content: center;
+      padding: 8px;
+      background: #f8fafc;
+      border-radius: 6px;
+      border: 1px solid #e2e8f0;
+    }
+
+    .invert-check input[type="checkbox"] {
+      width: 16px;
+      height: 16px;
+      margin-right: 8px;
+      cursor: pointer;
+      accent-color: #3b82f6;
+    }
+
+    .invert-check label {
+      font-size: 12px;
+      color: #475569;
+      cursor: pointer;
+      margin: 0;
+      font-weight: 500;
+    }
+
+    .action-buttons {
+      display: grid;
+      grid-template-columns: 2fr 1fr;
+      gap: 10px;
+      margin-top: 20px;
+    }
+
+    .action-buttons .btn {
+      padding: 14px;
+      font-size: 14px;
+    }
+
+    .btn.save {
+      background: #3b82f6;
+      color: white;
+      border-color: #3b82f6;
+    }
+    .btn.save:active {
+      background: #2563eb;
+      border-color: #2563eb;
+    }
+    .btn.reset {
+      background: white;
+      color: #ef4444;
+      border-color: #fecaca;
+    }
+    .btn.reset:active {
+      background: #fef2f2;
+      border-color: #ef4444;
+    }
+
+    @media (max-width: 600px) {
+      .robot-visual {
+        gap: 15px;
+        padding: 15px;
+      }
+      .motor-corner {
+        padding: 12px;
+      }
+      .corner-header .icon {
+        font-size: 24px;
+      }
+      .test-controls .btn {
+        padding: 10px 5px;
+        font-size: 12px;
+      }
+    }
+  </style>
+</head>
+<body>
+  <div class="container">
+    <div class="header">
+      <h1>🤖 Omni Robot Control</h1>
+      <div class="status" id="status">Подключение...</div>
+      <div class="battery" id="battery">🔋 --</div>
+    </div>
+
+    <div class="tabs">
+      <button class="tab active" onclick="switchTab(0)">Управление</button>
+      <button class="tab" onclick="switchTab(1)">Калибровка</button>
+    </div>
+
+    <!-- Вкладка 1: Управление -->
+    <div class="tab-content active" id="tab-control">
+      <!-- Переключатель режимов управления и типа -->
+      <div style="text-align:center; margin-bottom:20px;">
+        <div style="display:inline-flex; background:#f1f5f9; border-radius:8px; padding:4px; margin-bottom:10px;">
+          <button id="modeJoystick" class="mode-btn active" onclick="switchMode('joystick')">🕹️ Джойстик</button>
+          <button id="modeButtons" class="mode-btn" onclick="switchMode('buttons')">🎮 Кнопки</button>
+        </div>
+        <br>
+        <div style="display:inline-flex; background:#e0f2fe; border-radius:8px; padding:4px;">
+          <button id="driveOmni" class="mode-btn active" onclick="switchDriveMode('omni')">🔄 Omni (Strafe)</button>
+          <button id="driveTank" class="mode-btn" onclick="switchDriveMode('tank')">🎯 Tank (Rotation)</button>
+        </div>
+        <div id="gamepadStatus" style="margin-top:8px; color:#64748b; font-size:13px;">🎮 Геймпад: нажмите любую кнопку на нём</div>
+      </div>
+
+      <div class="speed-control">
+        <label>Скорость</label>
+        <input type="range" class="speed-slider" min="0" max="255" value="200" id="speedSlider" oninput="updateSpeed()">
+        <div class="speed-value" id="speedValue">200</div>
+      </div>
+
+      <!-- Режим джойстика -->
+      <div id="joystick-mode" class="control-mode">
+        <div style="text-align:center; margin-bottom:10px; color:#64748b; font-size:13px;">
+          🕹️ Вверх/Вниз: движение • Влево/Вправо: <span id="joystickModeText">стрейф</span>
+        </div>
+        <div style="display:grid; grid-template-columns:1fr 1fr; gap:15px; margin-bottom:20px;">
+          <!-- Джойстик слева -->
+          <div>
+            <h3 style="text-align:center; margin-bottom:10px; color:#475569; font-weight:500; font-size:14px;">Джойстик</h3>
+            <div style="position:relative; width:100%; padding-bottom:100%; background:#f8fafc; border-radius:12px; border:2px solid #e2e8f0;">
+              <canvas id="joystickCanvas" style="position:absolute; width:100%; height:100%; touch-action:none;"></canvas>
+            </div>
+          </div>
+
+          <!-- Кнопки влево/вправо справа -->
+          <div>
+            <h3 style="text-align:center; margin-bottom:10px; color:#475569; font-weight:500; font-size:14px;" id="joystickSideLabel">Стрейф</h3>
+            <div class="rotate-buttons">
+              <button class="btn" ontouchstart="sendCommand('left')" ontouchend="sendCommand('stop')" onmousedown="sendCommand('left')" onmouseup="sendCommand('stop')">⟲</button>
+              <button class="btn" ontouchstart="sendCommand('right')" ontouchend="sendCommand('stop')" onmousedown="sendCommand('right')" onmouseup="sendCommand('stop')">⟳</button>
+            </div>
+          </div>
+        </div>
+      </div>
+
+      <!-- Режим кнопок -->
+      <div id="buttons-mode" class="control-mode" style="display:none;">
+        <div style="text-align:center; margin-bottom:10px; color:#64748b; font-size:13px;">
+          🎮 ⬆️⬇️ движение • ⬅️➡️ <span id="buttonsModeText">разворот</span>
+        </div>
+        <div class="joystick-layout">
+        <!-- Левая половина: направления -->
+        <div>
+          <h3 style="text-align:center; margin-bottom:10px; color:#475569; font-weight:500; font-size:14px;">Движение</h3>
+          <div class="control-grid">
+            <div class="btn empty"></div>
+            <button class="btn" ontouchstart="sendCommand('forward')" ontouchend="sendCommand('stop')" onmousedown="sendCommand('forward')" onmouseup="sendCommand('stop')">⬆️</button>
+            <div class="btn empty"></div>
+
+            <button class="btn" ontouchstart="sendCommand('rotate_left')" ontouchend="sendCommand('stop')" onmousedown="sendCommand('rotate_left')" onmouseup="sendCommand('stop')">⬅️</button>
+            <button class="btn stop" onclick="sendCommand('stop')">⏹️</button>
+            <button class="btn" ontouchstart="sendCommand('rotate_right')" ontouchend="sendCommand('stop')" onmousedown="sendCommand('rotate_right')" onmouseup="sendCommand('stop')">➡️</button>
+
+            <div class="btn empty"></div>
+            <button class="btn" ontouchstart="sendCommand('backward')" ontouchend="sendCommand('stop')" onmousedown="sendCommand('backward')" onmouseup="sendCommand('stop')">⬇️</button>
+            <div class="btn empty"></div>
+          </div>
+        </div>
+
+        <!-- Правая половина: стрейф/разворот -->
+        <div>
+          <h3 style="text-align:center; margin-bottom:10px; color:#475569; font-weight:500; font-size:14px;" id="buttonsSideLabel">Разворот</h3>
+          <div class="rotate-buttons">
+            <button class="btn" ontouchstart="sendCommand('left')" ontouchend="sendCommand('stop')" onmousedown="sendCommand('left')" onmouseup="sendCommand('stop')">⟲</button>
+            <button class="btn" ontouchstart="sendCommand('right')" ontouchend="sendCommand('stop')" onmousedown="sendCommand('right')" onmouseup="sendCommand('stop')">⟳</button>
+          </div>
+        </div>
+      </div>
+      </div>
+
+      <button class="emergency-stop" onclick="sendCommand('estop')">🛑 АВАРИЙНЫЙ СТОП</button>
+    </div>
+
+    <!-- Вкладка 2: Калибровка -->
+    <div class="tab-content" id="tab-calibration">
+      <div class="speed-control">
+        <label>Скорость тестирования</label>
+        <input type="range" class="speed-slider" min="0" max="255" value="200" id="speedSlider2" oninput="updateSpeed2()">
+        <div class="speed-value" id="speedValue2">200</div>
+      </div>
+
+      <div class="info-box">
+        <p><strong>Инструкция:</strong></p>
+        <p>1. Нажми кнопки теста для каждого угла</p>
+        <p>2. Выбери правильный физический мотор из списка</p>
+        <p>3. Поставь галочку "Реверс" если мотор крутится наоборот</p>
+        <p>4. Нажми "Сохранить" когда все настроено</p>
+      </div>
+
+      <div class="robot-visual">
+        <!-- Передний-левый (M2) -->
+        <div class="motor-corner">
+          <div class="corner-header">
+            <div class="icon">↖️</div>
+            <h3>Передний-левый</h3>
+          </div>
+          <div class="test-controls">
+            <button class="btn forward" ontouchstart="sendCommand('test_1_fwd')" ontouchend="sendCommand('test_1_stop')" onmousedown="sendCommand('test_1_fwd')" onmouseup="sendCommand('test_1_stop')">⬆️</button>
+            <button class="btn test-stop" onclick="sendCommand('test_1_stop')">⏹️</button>
+            <button class="btn backward" ontouchstart="sendCommand('test_1_bwd')" ontouchend="sendCommand('test_1_stop')" onmousedown="sendCommand('test_1_bwd')" onmouseup="sendCommand('test_1_stop')">⬇️</button>
+          </div>
+          <div class="corner-settings">
+            <div class="setting-item">
+              <label>Физический мотор:</label>
+              <select id="map1" onchange="updateMapping(1)">
+                <option value="1">Мотор 1 (32,33)</option>
+                <option value="2">Мотор 2 (25,26)</option>
+                <option value="3">Мотор 3 (19,18)</option>
+                <option value="4">Мотор 4 (17,16)</option>
+              </select>
+            </div>
+            <div class="invert-check">
+              <input type="checkbox" id="inv1" onchange="updateInvert(1)">
+              <label for="inv1">Реверс</label>
+            </div>
+          </div>
+        </div>
+
+        <!-- Передний-правый (M1) -->
+        <div class="motor-corner">
+          <div class="corner-header">
+            <div class="icon">↗️</div>
+            <h3>Передний-правый</h3>
+          </div>
+          <div class="test-controls">
+            <button class="btn forward" ontouchstart="sendCommand('test_0_fwd')" ontouchend="sendCommand('test_0_stop')" onmousedown="sendCommand('test_0_fwd')" onmouseup="sendCommand('test_0_stop')">⬆️</button>
+            <button class="btn test-stop" onclick="sendCommand('test_0_stop')">⏹️</button>
+            <button class="btn backward" ontouchstart="sendCommand('test_0_bwd')" ontouchend="sendCommand('test_0_stop')" onmousedown="sendCommand('test_0_bwd')" onmouseup="sendCommand('test_0_stop')">⬇️</button>
+          </div>
+          <div class="corner-settings">
+            <div class="setting-item">
+              <label>Физический мотор:</label>
+              <select id="map0" onchange="updateMapping(0)">
+                <option value="1">Мотор 1 (32,33)</option>
+                <option value="2">Мотор 2 (25,26)</option>
+                <option value="3">Мотор 3 (19,18)</option>
+                <option value="4">Мотор 4 (17,16)</option>
+              </select>
+            </div>
+            <div class="invert-check">
+              <input type="checkbox" id="inv0" onchange="updateInvert(0)">
+              <label for="inv0">Реверс</label>
+            </div>
+          </div>
+        </div>
+
+        <!-- Задний-левый (M3) -->
+        <div class="motor-corner">
+          <div class="corner-header">
+            <div class="icon">↙️</div>
+            <h3>Задний-левый</h3>
+          </div>
+          <div class="test-controls">
+            <button class="btn forward" ontouchstart="sendCommand('test_2_fwd')" ontouchend="sendCommand('test_2_stop')" onmousedown="sendCommand('test_2_fwd')" onmouseup="sendCommand('test_2_stop')">⬆️</button>
+            <button class="btn test-stop" onclick="sendCommand('test_2_stop')">⏹️</button>
+            <button class="btn backward" ontouchstart="sendCommand('test_2_bwd')" ontouchend="sendCommand('test_2_stop')" onmousedown="sendCommand('test_2_bwd')" onmouseup="sendCommand('test_2_stop')">⬇️</button>
+          </div>
+          <div class="corner-settings">
+            <div class="setting-item">
+              <label>Физический мотор:</label>
+              <select id="map2" onchange="updateMapping(2)">
+                <option value="1">Мотор 1 (32,33)</option>
+                <option value="2">Мотор 2 (25,26)</option>
+                <option value="3">Мотор 3 (19,18)</option>
+                <option value="4">Мотор 4 (17,16)</option>
+              </select>
+            </div>
+            <div class="invert-check">
+              <input type="checkbox" id="inv2" onchange="updateInvert(2)">
+              <label for="inv2">Реверс</label>
+            </div>
+          </div>
+        </div>
+
+        <!-- Задний-правый (M4) -->
+        <div class="motor-corner">
+          <div class="corner-header">
+            <div class="icon">↘️</div>
+            <h3>Задний-правый</h3>
+          </div>
+          <div class="test-controls">
+            <button class="btn forward" ontouchstart="sendCommand('test_3_fwd')" ontouchend="sendCommand('test_3_stop')" onmousedown="sendCommand('test_3_fwd')" onmouseup="sendCommand('test_3_stop')">⬆️</button>
+            <button class="btn test-stop" onclick="sendCommand('test_3_stop')">⏹️</button>
+            <button class="btn backward" ontouchstart="sendCommand('test_3_bwd')" ontouchend="sendCommand('test_3_stop')" onmousedown="sendCommand('test_3_bwd')" onmouseup="sendCommand('test_3_stop')">⬇️</button>
+          </div>
+          <div class="corner-settings">
+            <div class="setting-item">
+              <label>Физический мотор:</label>
+              <select id="map3" onchange="updateMapping(3)">
+                <option value="1">Мотор 1 (32,33)</option>
+                <option value="2">Мотор 2 (25,26)</option>
+                <option value="3">Мотор 3 (19,18)</option>
+                <option value="4">Мотор 4 (17,16)</option>
+              </select>
+            </div>
+            <div class="invert-check">
+              <input type="checkbox" id="inv3" onchange="updateInvert(3)">
+              <label for="inv3">Реверс</label>
+            </div>
+          </div>
+        </div>
+      </div>
+
+      <div class="action-buttons">
+        <button class="btn save" onclick="saveSettings()">💾 Сохранить настройки</button>
+        <button class="btn reset" onclick="resetSettings()">🔄 Сброс</button>
+      </div>
+    </div>
+  </div>
+
+  <script>
+    let ws;
+    const statusEl = document.getElementById('status');
+    let currentDriveMode = 'omni';  // 'omni' or 'tank'
+
+    // Сверка часов с роботом (client_clock.h): серия замеров "sync:t1",
+    // лучший по задержке уходит роботу как "clock:смещение:задержка".
+    // Метки по модулю 1000000 мс, как на роботе.
+    const STAMP_MODULO = 1000000;
+    const SYNC_SAMPLES = 8;
+    const SYNC_PERIOD_MS = 10000;
+    let syncBest = null;
+    let syncLeft = 0;
+    let syncTimer = null;
+
+    function clientStamp() {
+      return Math.round(performance.now()) % STAMP_MODULO;
+    }
+
+    function startClockSync() {
+      syncBest = null;
+      syncLeft = SYNC_SAMPLES;
+      sendCommand('sync:' + clientStamp());
+    }
+
+    function onSyncReply(s) {
+      const t4 = clientStamp();
+      const rtt = (t4 - s.t1 + STAMP_MODULO) % STAMP_MODULO;
+      const mid = (s.t1 + rtt / 2) % STAMP_MODULO;
+      const offset = Math.round((s.t2 - mid + STAMP_MODULO) % STAMP_MODULO);
+      if (syncBest === null || rtt < syncBest.rtt) syncBest = {rtt: rtt, offset: offset};
+
+      if (--syncLeft > 0) {
+        setTimeout(function() { sendCommand('sync:' + clientStamp()); }, 50);
+      } else {
+        sendCommand('clock:' + syncBest.offset + ':' + Math.min(syncBest.rtt, 65535));
+      }
+    }
+
+    function initWebSocket() {
+      ws = new WebSocket('ws://' + window.location.hostname + '/ws');
+
+      ws.onopen = function() {
+        statusEl.textContent = '✓ Подключено';
+        statusEl.className = 'status connected';
+        sendCommand('get_config');
+        startClockSync();
+        clearInterval(syncTimer);
+        syncTimer = setInterval(startClockSync, SYNC_PERIOD_MS);
+      };
+
+      ws.onclose = function() {
+        clearInterval(syncTimer);
+        statusEl.textContent = '✗ Отключено';
+        statusEl.className = 'status disconnected';
+        setTimeout(initWebSocket, 2000);
+      };
+
+      ws.onerror = function() {
+        statusEl.textContent = '✗ Ошибка подключения';
+        statusEl.className = 'status disconnected';
+      };
+
+      ws.onmessage = function(event) {
+        try {
+          const data = JSON.parse(event.data);
+          if (data.telemetry) {
+            updateTelemetry(data.telemetry);
+          } else if (data.sync) {
+            onSyncReply(data.sync);
+          } else if (data.mapping && data.invert) {
+            loadConfigToUI(data);
+          } else if (data.status === 'saved' || (data.ack === 'batch' && data.saved)) {
+            alert('💾 Настройки сохранены в память ESP32!');
+          } else if (data.ack === 'batch' && !data.ok) {
+            console.log('Пакет отклонён, команда #' + data.index);
+          }
+        } catch (e) {
+          console.log('Получено сообщение:', event.data);
+        }
+      };
+    }
+
+    function updateTelemetry(t) {
+      const el = document.getElementById('battery');
+      el.textContent = '🔋 ' + (t.battery_mv / 1000).toFixed(2) + ' В • ' + t.soc + '%' + (t.low ? ' • РАЗРЯЖЕНА' : '');
+      el.classList.toggle('low', t.low);
+    }
+
+    function sendCommand(cmd) {
+      if (ws && ws.readyState === WebSocket.OPEN) {
+        ws.send(cmd);
+      }
+    }
+
+    function updateSpeed() {
+      const speed = document.getElementById('speedSlider').value;
+      document.getElementById('speedValue').textContent = speed;
+      document.getElementById('speedSlider2').value = speed;
+      document.getElementById('speedValue2').textContent = speed;
+      sendCommand('speed:' + speed);
+    }
+
+    function updateSpeed2() {
+      const speed = document.getElementById('speedSlider2').value;
+      document.getElementById('speedValue2').textContent = speed;
+      document.getElementById('speedSlider').value = speed;
+      document.getElementById('speedValue').textContent = speed;
+      sendCommand('speed:' + speed);
+    }
+
+    function switchTab(index) {
+      const tabs = document.querySelectorAll('.tab');
+      const contents = document.querySelectorAll('.tab-content');
+
+      tabs.forEach((tab, i) => {
+        tab.classList.toggle('active', i === index);
+      });
+
+      contents.forEach((content, i) => {
+        content.classList.toggle('active', i === index);
+      });
+
+      sendCommand('stop');
+    }
+
+    function loadConfigToUI(config) {
+      for (let i = 0; i < 4; i++) {
+        document.getElementById('map' + i).value = config.mapping[i];
+        document.getElementById('inv' + i).checked = config.invert[i];
+      }
+
+      // Load drive mode
+      if (config.omniMode !== undefined) {
+        currentDriveMode = config.omniMode ? 'omni' : 'tank';
+        updateDriveModeUI();
+      }
+    }
+
+    function updateMapping(pos) {
+      const value = document.getElementById('map' + pos).value;
+      sendCommand('set_map:' + pos + ':' + value);
+    }
+
+    function updateInvert(pos) {
+      const value = document.getElementById('inv' + pos).checked;
+      sendCommand('set_inv:' + pos + ':' + value);
+    }
+
+    function saveSettings() {
+      // Одним пакетом: все настройки, режим вождения и запись в EEPROM
+      const cmds = [];
+      for (let i = 0; i < 4; i++) {
+        cmds.push('set_map:' + i + ':' + document.getElementById('map' + i).value);
+        cmds.push('set_inv:' + i + ':' + document.getElementById('inv' + i).checked);
+      }
+      cmds.push(currentDriveMode === 'omni' ? 'mode_omni' : 'mode_tank');
+      cmds.push('save_config');
+      sendCommand(cmds.join(';'));
+    }
+
+    function resetSettings() {
+      if (confirm('Сбросить все настройки к дефолту?')) {
+        sendCommand('reset_config');
+        alert('🔄 Настройки сброшены! Не забудь сохранить.');
+      }
+    }
+
+    // ========== ПЕРЕКЛЮЧЕНИЕ РЕЖИМА ВОЖДЕНИЯ ==========
+    function switchDriveMode(mode) {
+      currentDriveMode = mode;
+      sendCommand(mode === 'omni' ? 'mode_omni' : 'mode_tank');
+      updateDriveModeUI();
+    }
+
+    function updateDriveModeUI() {
+      const btnOmni = document.getElementById('driveOmni');
+      const btnTank = document.getElementById('driveTank');
+      const joystickModeText = document.getElementById('joystickModeText');
+      const buttonsModeText = document.getElementById('buttonsModeText');
+      const joystickSideLabel = document.getElementById('joystickSideLabel');
+      const buttonsSideLabel = document.getElementById('buttonsSideLabel');
+
+      if (currentDriveMode === 'omni') {
+        btnOmni.classList.add('active');
+        btnTank.classList.remove('active');
+        joystickModeText.textContent = 'стрейф';
+        buttonsModeText.textContent = 'стрейф';
+        joystickSideLabel.textContent = 'Стрейф';
+        buttonsSideLabel.textContent = 'Стрейф';
+      } else {
+        btnOmni.classList.remove('active');
+        btnTank.classList.add('active');
+        joystickModeText.textContent = 'разворот';
+        buttonsModeText.textContent = 'разворот';
+        joystickSideLabel.textContent = 'Разворот';
+        buttonsSideLabel.textContent = 'Разворот';
+      }
+    }
+
+    document.addEventListener('selectstart', function(e) {
+      e.preventDefault();
+    });
+
+    // ========== ДЖОЙСТИК ==========
+    let joystickActive = false;
+    let joystickX = 0;
+    let joystickY = 0;
+
+    function initJoystick() {
+      const canvas = document.getElementById('joystickCanvas');
+      if (!canvas) return;
+
+      const ctx = canvas.getContext('2d');
+      const rect = canvas.getBoundingClientRect();
+      canvas.width = rect.width;
+      canvas.height = rect.height;
+
+      const centerX = canvas.width / 2;
+      const centerY = canvas.height / 2;
+      const maxRadius = Math.min(canvas.width, canvas.height) / 2 - 20;
+
+      function drawJoystick() {
+        ctx.clearRect(0, 0, canvas.width, canvas.height);
+
+        // Внешний круг
+        ctx.beginPath();
+        ctx.arc(centerX, centerY, maxRadius, 0, 2 * Math.PI);
+        ctx.strokeStyle = '#e2e8f0';
+        ctx.lineWidth = 2;
+        ctx.stroke();
+
+        // Центр
+        ctx.beginPath();
+        ctx.arc(centerX, centerY, 5, 0, 2 * Math.PI);
+        ctx.fillStyle = '#cbd5e1';
+        ctx.fill();
+
+        // Стик
+        const stickX = centerX + joystickX * maxRadius / 255;
+        const stickY = centerY + joystickY * maxRadius / 255;
+        ctx.beginPath();
+        ctx.arc(stickX, stickY, 30, 0, 2 * Math.PI);
+        ctx.fillStyle = joystickActive ? '#3b82f6' : '#94a3b8';
+        ctx.fill();
+        ctx.strokeStyle = 'white';
+        ctx.lineWidth = 3;
+        ctx.stroke();
+      }
+
+      function handleMove(clientX, clientY) {
+        const rect = canvas.getBoundingClientRect();
+        const x = clientX - rect.left - centerX;
+        const y = clientY - rect.top - centerY;
+
+        const distance = Math.sqrt(x * x + y * y);
+        const angle = Math.atan2(y, x);
+
+        const clampedDistance = Math.min(distance, maxRadius);
+
+        joystickX = Math.round((clampedDistance * Math.cos(angle) / maxRadius) * 255);
+        joystickY = -Math.round((clampedDistance * Math.sin(angle) / maxRadius) * 255);  // Инвертируем Y
+
+        drawJoystick();
+        // Метка времени: запоздавший кадр робот отбросит
+        sendCommand('at:' + clientStamp() + ';joy:' + joystickX + ':' + joystickY);
+      }
+
+      function handleEnd() {
+        joystickActive = false;
+        joystickX = 0;
+        joystickY = 0;
+        drawJoystick();
+        sendCommand('stop');
+      }
+
+      // Touch events
+      canvas.addEventListener('touchstart', (e) => {
+        e.preventDefault();
+        joystickActive = true;
+        handleMove(e.touches[0].clientX, e.touches[0].clientY);
+      });
+
+      canvas.addEventListener('touchmove', (e) => {
+        e.preventDefault();
+        if (joystickActive) {
+          handleMove(e.touches[0].clientX, e.touches[0].clientY);
+        }
+      });
+
+      canvas.addEventListener('touchend', (e) => {
+        e.preventDefault();
+        handleEnd();
+      });
+
+      // Mouse events
+      canvas.addEventListener('mousedown', (e) => {
+        joystickActive = true;
+        handleMove(e.clientX, e.clientY);
+      });
+
+      canvas.addEventListener('mousemove', (e) => {
+        if (joystickActive) {
+          handleMove(e.clientX, e.clientY);
+        }
+      });
+
+      canvas.addEventListener('mouseup', handleEnd);
+      canvas.addEventListener('mouseleave', handleEnd);
+
+      drawJoystick();
+    }
+
+    // ========== ГЕЙМПАД ==========
+    // Gamepad API опрашивается раз в кадр анимации. Левый стик — перемещение
+    // (vx вправо, vy вперёд), правый стик по X — поворот; все три оси уходят
+    // одной командой "drive:vx:vy:w" и только когда изменились. Режим
+    // omni/tank геймпад не использует: стрейф и поворот — одновременно.
+    const GAMEPAD_DEADZONE = 0.12;         // Доля хода стика, в которой покой
+    const GAMEPAD_MIN_INTERVAL_MS = 20;    // Не чаще 50 Гц, как джойстик на экране
+    let gamepadPolling = false;
+    let gamepadSent = {vx: 0, vy: 0, w: 0};
+    let gamepadSentMs = 0;
+
+    // Радиальная мёртвая зона для стика: внутри 0, снаружи плавно от 0 до 1
+    function gamepadStick(x, y) {
+      const mag = Math.hypot(x, y);
+      if (mag < GAMEPAD_DEADZONE) return [0, 0];
+      const k = Math.min(1, (mag - GAMEPAD_DEADZONE) / (1 - GAMEPAD_DEADZONE)) / mag;
+      return [x * k, y * k];
+    }
+
+    function gamepadAxis(v) {
+      const a = Math.abs(v);
+      if (a < GAMEPAD_DEADZONE) return 0;
+      return Math.sign(v) * Math.min(1, (a - GAMEPAD_DEADZONE) / (1 - GAMEPAD_DEADZONE));
+    }
+
+    function gamepadMoving() {
+      return gamepadSent.vx !== 0 || gamepadSent.vy !== 0 || gamepadSent.w !== 0;
+    }
+
+    function gamepadRelease() {
+      if (gamepadMoving()) sendCommand('stop');
+      gamepadSent = {vx: 0, vy: 0, w: 0};
+    }
+
+    function firstGamepad() {
+      const pads = navigator.getGamepads ? navigator.getGamepads() : [];
+      for (const pad of pads) {
+        if (pad && pad.connected) return pad;
+      }
+      return null;
+    }
+
+    function pollGamepad(now) {
+      const pad = firstGamepad();
+      if (!pad) {
+        gamepadRelease();
+        gamepadPolling = false;
+        return;
+      }
+
+      const [lx, ly] = gamepadStick(pad.axes[0] || 0, pad.axes[1] || 0);
+      const rx = gamepadAxis(pad.axes[2] || 0);
+      // Ось Y стика вниз, поворот стика вправо — по часовой
+      const cur = {vx: Math.round(lx * 255), vy: Math.round(-ly * 255), w: Math.round(-rx * 255)};
+      const changed = cur.vx !== gamepadSent.vx || cur.vy !== gamepadSent.vy || cur.w !== gamepadSent.w;
+
+      if (changed && now - gamepadSentMs >= GAMEPAD_MIN_INTERVAL_MS) {
+        if (cur.vx === 0 && cur.vy === 0 && cur.w === 0) {
+          sendCommand('stop');
+        } else {
+          sendCommand('at:' + clientStamp() + ';drive:' + cur.vx + ':' + cur.vy + ':' + cur.w);
+        }
+        gamepadSent = cur;
+        gamepadSentMs = now;
+      }
+      requestAnimationFrame(pollGamepad);
+    }
+
+    function startGamepadPolling() {
+      if (gamepadPolling) return;
+      gamepadPolling = true;
+      requestAnimationFrame(pollGamepad);
+    }
+
+    window.addEventListener('gamepadconnected', (e) => {
+      document.getElementById('gamepadStatus').textContent =
+        '🎮 ' + e.gamepad.id + ' — левый стик: движение, правый: поворот';
+      startGamepadPolling();
+    });
+
+    window.addEventListener('gamepaddisconnected', () => {
+      document.getElementById('gamepadStatus').textContent = '🎮 Геймпад отключён';
+    });
+
+    // В скрытой вкладке кадры анимации не идут, стики не опрашиваются —
+    // последняя команда осталась бы в силе
+    document.addEventListener('visibilitychange', () => {
+      if (document.hidden) gamepadRelease();
+    });
+
+    // ========== ПЕРЕКЛЮЧЕНИЕ РЕЖИМОВ ==========
+    function switchMode(mode) {
+      const joystickMode = document.getElementById('joystick-mode');
+      const buttonsMode = document.getElementById('buttons-mode');
+      const btnJoystick = document.getElementById('modeJoystick');
+      const btnButtons = document.getElementById('modeButtons');
+
+      if (mode === 'joystick') {
+        joystickMode.style.display = 'block';
+        buttonsMode.style.display = 'none';
+        btnJoystick.classList.add('active');
+        btnButtons.classList.remove('active');
+        setTimeout(initJoystick, 100);
+      } else {
+        joystickMode.style.display = 'none';
+        buttonsMode.style.display = 'block';
+        btnJoystick.classList.remove('active');
+        btnButtons.classList.add('active');
+      }
+    }
+
+    initWebSocket();
+    if (firstGamepad()) startGamepadPolling();
+    setTimeout(() => {
+      initJoystick();
+    }, 500);
+  </script>
+</body>
+</html>
+)rawliteral";
@@ -0,0 +1,98 @@
+#include "ws_assembler.h"
+
+#include <string.h>
+
+WsFrameAssembler::Slot *WsFrameAssembler::find(uint32_t clientId) {
+  for (int i = 0; i < WS_ASSEMBLY_SLOTS; i++) {
+    if (slots[i].used && slots[i].clientId == clientId) return &slots[i];
+  }
+  return nullptr;
+}
+
+WsFrameAssembler::Slot *WsFrameAssembler::acquire(uint32_t clientId) {
+  for (int i = 0; i < WS_ASSEMBLY_SLOTS; i++) {
+    Slot &s = slots[i];
+    if (!s.used) {
+      s = Slot();
+      s.used = true;
+      s.clientId = clientId;
+      s.buf = arena[i];
+      return &s;
+    }
+  }
+  return nullptr;
+}
+
+void WsFrameAssembler::release(uint32_t clientId) {
+  Slot *s = find(clientId);
+  if (s) s->used = false;
+}
+
+WsAssembleResult WsFrameAssembler::finishDiscard(Slot &s, const WsChunk &chunk, size_t len) {
+  bool messageEnd = chunk.final && chunk.index + len >= chunk.frameLen;
+  if (!messageEnd) return WsAssembleResult::Incomplete;
+
+  s.used = false;
+  return s.discardReason;
+}
+
+WsAssembleResult WsFrameAssembler::feed(uint32_t clientId, const WsChunk &chunk,
+                                        const uint8_t *data, size_t len,
+                                        const uint8_t **payload, size_t *payloadLen,
+                                        uint8_t *opcode) {
+  bool frameStart = chunk.index == 0;
+  bool frameEnd = chunk.index + len >= chunk.frameLen;
+  bool messageEnd = frameEnd && chunk.final;
+
+  Slot *s = find(clientId);
+
+  if (s == nullptr) {
+    // Кусок из середины сообщения без начала (например, после NoSlot) — пропускаем
+    if (chunk.frameNum != 0 || !frameStart) return WsAssembleResult::Incomplete;
+
+    // Быстрый путь: сообщение целиком в одном куске, без копирования
+    if (messageEnd && len == chunk.frameLen) {
+      if (len > WS_MAX_MESSAGE) return WsAssembleResult::TooLarge;
+      *payload = data;
+      *payloadLen = len;
+      *opcode = chunk.messageOpcode;
+      return WsAssembleResult::Complete;
+    }
+
+    s = acquire(clientId);
+    if (s == nullptr) return WsAssembleResult::NoSlot;
+    s->opcode = chunk.messageOpcode;
+  } else if (s->discarding) {
+    return finishDiscard(*s, chunk, len);
+  }
+
+  if (frameStart) {
+    if (chunk.frameNum > 0) s->frameStart = s->fill;
+
+    // Длина фрейма известна заранее — лишнее отбрасываем сразу
+    if (s->frameStart + chunk.frameLen > WS_MAX_MESSAGE) {
+      s->discarding = true;
+      s->discardReason = WsAssembleResult::TooLarge;
+      return finishDiscard(*s, chunk, len);
+    }
+  }
+
+  // Куски фрейма должны идти подряд
+  if (s->frameStart + chunk.index != s->fill || chunk.index + len > chunk.frameLen) {
+    s->discarding = true;
+    s->discardReason = WsAssembleResult::Protocol;
+    return finishDiscard(*s, chunk, len);
+  }
+
+  memcpy(s->buf + s->fill, data, len);
+  s->fill += len;
+
+  if (!messageEnd) return WsAssembleResult::Incomplete;
+
+  // Слот освобождается сразу: данные остаются в арене до следующего feed()
+  s->used = false;
+  *payload = s->buf;
+  *payloadLen = s->fill;
+  *opcode = s->opcode;
+  return WsAssembleResult::Complete;
+}
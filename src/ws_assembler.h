@@ -0,0 +1,62 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ==================== СБОРКА ФРАГМЕНТИРОВАННЫХ СООБЩЕНИЙ WEBSOCKET ====================
+// AsyncWebSocket отдаёт данные кусками: сообщение может состоять из
+// нескольких фреймов (фрагментация), а фрейм — из нескольких TCP-пакетов.
+// Если сообщение пришло целиком одним куском, оно отдаётся без копирования.
+// Иначе куски собираются в слот фиксированной арены; сообщения больше
+// WS_MAX_MESSAGE отбрасываются до конца, без выделения памяти.
+
+#define WS_MAX_MESSAGE 2048       // Максимальный размер собранного сообщения
+#define WS_ASSEMBLY_SLOTS 2       // Одновременно собираемых сообщений
+
+// Описание одного куска данных (поля AwsFrameInfo, без зависимости от библиотеки)
+struct WsChunk {
+  uint8_t messageOpcode;  // Тип сообщения (текст/бинарное), одинаков для всех фрагментов
+  uint32_t frameNum;      // Номер фрейма в сообщении (0 = первый)
+  bool final;             // FIN: последний фрейм сообщения
+  uint64_t frameLen;      // Длина полезной нагрузки текущего фрейма
+  uint64_t index;         // Смещение куска внутри фрейма
+};
+
+enum class WsAssembleResult : uint8_t {
+  Incomplete,  // Ждём продолжения
+  Complete,    // payload/payloadLen указывают на целое сообщение
+  TooLarge,    // Сообщение превысило WS_MAX_MESSAGE и отброшено
+  NoSlot,      // Нет свободного слота арены, сообщение отброшено
+  Protocol     // Нарушена последовательность кусков
+};
+
+class WsFrameAssembler {
+public:
+  // payload действителен до следующего вызова feed() (все вызовы идут из задачи AsyncTCP)
+  WsAssembleResult feed(uint32_t clientId, const WsChunk &chunk,
+                        const uint8_t *data, size_t len,
+                        const uint8_t **payload, size_t *payloadLen,
+                        uint8_t *opcode);
+
+  // Освободить слот клиента (при отключении)
+  void release(uint32_t clientId);
+
+private:
+  struct Slot {
+    bool used = false;
+    bool discarding = false;    // Пропускаем остаток слишком большого сообщения
+    WsAssembleResult discardReason = WsAssembleResult::TooLarge;
+    uint32_t clientId = 0;
+    uint8_t opcode = 0;
+    uint32_t fill = 0;          // Собрано байт сообщения
+    uint32_t frameStart = 0;    // Где в сообщении начинается текущий фрейм
+    uint8_t *buf = nullptr;
+  };
+
+  Slot *find(uint32_t clientId);
+  Slot *acquire(uint32_t clientId);
+  static WsAssembleResult finishDiscard(Slot &s, const WsChunk &chunk, size_t len);
+
+  Slot slots[WS_ASSEMBLY_SLOTS];
+  uint8_t arena[WS_ASSEMBLY_SLOTS][WS_MAX_MESSAGE];
+};
@@ -0,0 +1,194 @@
+#include "ws_broadcast.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+
+// ==================== ОБЩИЙ БУФЕР ====================
+
+SharedMessage* SharedMessage::create(const char* data, size_t len, MsgClass cls) {
+  if (len > 0xFFFF) return nullptr;
+
+  void* mem = malloc(sizeof(SharedMessage) + len);
+  if (mem == nullptr) return nullptr;
+
+  SharedMessage* m = new (mem) SharedMessage();
+  m->refs.store(1, std::memory_order_relaxed);
+  m->len = (uint16_t)len;
+  m->cls = cls;
+  memcpy(m->payload, data, len);
+  m->payload[len] = 0;
+  return m;
+}
+
+void SharedMessage::release() {
+  if (refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    if (attached != nullptr) detach(attached);
+    this->~SharedMessage();
+    free(this);
+  }
+}
+
+// ==================== ОЧЕРЕДИ КЛИЕНТОВ ====================
+
+WsBroadcaster::ClientSlot* WsBroadcaster::find(uint32_t id) {
+  for (int i = 0; i < WS_MAX_CLIENTS; i++) {
+    if (clients[i].used && clients[i].st.id == id) return &clients[i];
+  }
+  return nullptr;
+}
+
+bool WsBroadcaster::addClient(uint32_t id) {
+  std::lock_guard<std::mutex> guard(lock);
+  if (find(id)) return true;
+
+  for (int i = 0; i < WS_MAX_CLIENTS; i++) {
+    ClientSlot& c = clients[i];
+    if (!c.used) {
+      c.used = true;
+      c.overflowed = false;
+      c.st = ClientQueueStats();
+      c.st.id = id;
+      c.telemetry = MessageRing<WS_TELEMETRY_DEPTH>();
+      c.reliable = MessageRing<WS_RELIABLE_DEPTH>();
+      return true;
+    }
+  }
+  return false;
+}
+
+void WsBroadcaster::drain(ClientSlot& c) {
+  while (!c.telemetry.empty()) c.telemetry.pop()->release();
+  while (!c.reliable.empty()) c.reliable.pop()->release();
+}
+
+void WsBroadcaster::removeClient(uint32_t id) {
+  std::lock_guard<std::mutex> guard(lock);
+  ClientSlot* c = find(id);
+  if (c == nullptr) return;
+
+  drain(*c);
+  c->used = false;
+}
+
+void WsBroadcaster::enqueue(ClientSlot& c, SharedMessage* m) {
+  if (c.overflowed) return;
+
+  if (m->msgClass() == MsgClass::Telemetry) {
+    // Drop-oldest: клиенту важна только последняя телеметрия
+    if (c.telemetry.full()) {
+      c.telemetry.pop()->release();
+      c.st.dropped++;
+    }
+    m->retain();
+    c.telemetry.push(m);
+  } else {
+    if (c.reliable.full()) {
+      // Гарантию доставки дать нельзя — клиент будет отключен в pump()
+      c.overflowed = true;
+      return;
+    }
+    m->retain();
+    c.reliable.push(m);
+  }
+
+  uint8_t depth = c.telemetry.count + c.reliable.count;
+  if (depth > c.st.peakDepth) c.st.peakDepth = depth;
+}
+
+void WsBroadcaster::broadcast(const char* data, size_t len, MsgClass cls) {
+  SharedMessage* m = SharedMessage::create(data, len, cls);
+  if (m == nullptr) return;
+
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    for (int i = 0; i < WS_MAX_CLIENTS; i++) {
+      if (clients[i].used) enqueue(clients[i], m);
+    }
+  }
+
+  m->release();
+}
+
+void WsBroadcaster::sendTo(uint32_t id, const char* data, size_t len, MsgClass cls) {
+  SharedMessage* m = SharedMessage::create(data, len, cls);
+  if (m == nullptr) return;
+
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    ClientSlot* c = find(id);
+    if (c) enqueue(*c, m);
+  }
+
+  m->release();
+}
+
+void WsBroadcaster::pump(WsSendFn send, WsKickFn kick) {
+  uint32_t toKick[WS_MAX_CLIENTS];
+  int kickCount = 0;
+
+  {
+    std::lock_guard<std::mutex> guard(lock);
+
+    for (int i = 0; i < WS_MAX_CLIENTS; i++) {
+      ClientSlot& c = clients[i];
+      if (!c.used) continue;
+
+      if (c.overflowed) {
+        drain(c);
+        toKick[kickCount++] = c.st.id;
+        continue;
+      }
+
+      // Сначала надёжные сообщения, затем самая свежая телеметрия
+      for (int budget = WS_PUMP_BUDGET; budget > 0; budget--) {
+        MessageRing<WS_RELIABLE_DEPTH>* rq = &c.reliable;
+        MessageRing<WS_TELEMETRY_DEPTH>* tq = &c.telemetry;
+        SharedMessage* m;
+        if (!rq->empty()) m = rq->front();
+        else if (!tq->empty()) m = tq->front();
+        else break;
+
+        if (!send(c.st.id, *m)) {
+          c.st.deferred++;
+          break;
+        }
+
+        if (!rq->empty() && rq->front() == m) rq->pop();
+        else tq->pop();
+        m->release();
+        c.st.sent++;
+      }
+
+      c.st.telemetryDepth = c.telemetry.count;
+      c.st.reliableDepth = c.reliable.count;
+    }
+  }
+
+  // Отключение вне блокировки: close() может сразу вызвать removeClient()
+  for (int i = 0; i < kickCount; i++) {
+    kick(toKick[i]);
+  }
+}
+
+size_t WsBroadcaster::clientCount() {
+  std::lock_guard<std::mutex> guard(lock);
+  size_t n = 0;
+  for (int i = 0; i < WS_MAX_CLIENTS; i++) {
+    if (clients[i].used) n++;
+  }
+  return n;
+}
+
+size_t WsBroadcaster::stats(ClientQueueStats* out, size_t maxCount) {
+  std::lock_guard<std::mutex> guard(lock);
+  size_t n = 0;
+  for (int i = 0; i < WS_MAX_CLIENTS && n < maxCount; i++) {
+    ClientSlot& c = clients[i];
+    if (!c.used) continue;
+    c.st.telemetryDepth = c.telemetry.count;
+    c.st.reliableDepth = c.reliable.count;
+    out[n++] = c.st;
+  }
+  return n;
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include <mutex>
+
+// ==================== РАССЫЛКА WEBSOCKET С УЧЁТОМ ПЕРЕГРУЗКИ ====================
+// Сообщение сериализуется один раз в общий буфер со счётчиком ссылок.
+// У каждого клиента две ограниченные очереди:
+//   - телеметрия: при переполнении выбрасывается самое старое сообщение
+//   - надёжные (подтверждения, конфигурация): не выбрасываются никогда;
+//     если клиент не успевает даже их, он отключается
+// Медленный клиент копит только указатели в своей очереди и не влияет
+// на остальных клиентов и на кучу.
+
+#ifndef WS_MAX_CLIENTS
+#define WS_MAX_CLIENTS 8          // Заменитель робота на ПК поднимает для нагрузочного теста
+#endif
+#define WS_TELEMETRY_DEPTH 4      // Очередь телеметрии на клиента
+#define WS_RELIABLE_DEPTH 16      // Очередь надёжных сообщений на клиента
+#define WS_PUMP_BUDGET 4          // Максимум сообщений клиенту за один проход
+
+enum class MsgClass : uint8_t {
+  Telemetry,  // Можно выбросить, важна только свежесть
+  Reliable    // Должно быть доставлено
+};
+
+// Общий буфер сообщения (один на все очереди)
+class SharedMessage {
+public:
+  static SharedMessage* create(const char* data, size_t len, MsgClass cls);
+
+  void retain() { refs.fetch_add(1, std::memory_order_relaxed); }
+  void release();
+
+  const char* data() const { return payload; }
+  size_t length() const { return len; }
+  MsgClass msgClass() const { return cls; }
+
+  // Буфер транспорта, общий для всех его клиентов (например, буфер
+  // AsyncWebSocket): создаётся при первой отправке, освобождается
+  // вместе с сообщением. Меняется только внутри pump().
+  void* attachment() const { return attached; }
+  void attach(void* buffer, void (*releaseFn)(void*)) {
+    attached = buffer;
+    detach = releaseFn;
+  }
+
+private:
+  SharedMessage() {}
+
+  std::atomic<uint16_t> refs;
+  uint16_t len;
+  MsgClass cls;
+  void* attached = nullptr;
+  void (*detach)(void*) = nullptr;
+  char payload[1];  // Фактический размер выделяется в create()
+};
+
+// Кольцевая очередь указателей фиксированного размера
+template <size_t N>
+struct MessageRing {
+  SharedMessage* items[N];
+  uint8_t head = 0;
+  uint8_t count = 0;
+
+  bool full() const { return count == N; }
+  bool empty() const { return count == 0; }
+  SharedMessage* front() const { return items[head]; }
+  void push(SharedMessage* m) { items[(head + count) % N] = m; count++; }
+  SharedMessage* pop() {
+    SharedMessage* m = items[head];
+    head = (head + 1) % N;
+    count--;
+    return m;
+  }
+};
+
+// Счётчики очереди клиента
+struct ClientQueueStats {
+  uint32_t id;
+  uint8_t telemetryDepth;
+  uint8_t reliableDepth;
+  uint8_t peakDepth;
+  uint32_t sent;
+  uint32_t dropped;     // Выброшенная телеметрия
+  uint32_t deferred;    // Проходы, когда клиент не был готов принять
+};
+
+// Отправка в транспорт: false = клиент сейчас не может принять
+typedef bool (*WsSendFn)(uint32_t clientId, SharedMessage& m);
+// Отключение клиента, переполнившего очередь надёжных сообщений
+typedef void (*WsKickFn)(uint32_t clientId);
+
+class WsBroadcaster {
+public:
+  bool addClient(uint32_t id);
+  void removeClient(uint32_t id);
+
+  // Всем подключенным клиентам
+  void broadcast(const char* data, size_t len, MsgClass cls);
+  // Одному клиенту
+  void sendTo(uint32_t id, const char* data, size_t len, MsgClass cls);
+
+  // Передать накопленное в транспорт (вызывается из loop и после команд)
+  void pump(WsSendFn send, WsKickFn kick);
+
+  size_t clientCount();
+  size_t stats(ClientQueueStats* out, size_t maxCount);
+
+private:
+  struct ClientSlot {
+    bool used = false;
+    bool overflowed = false;
+    ClientQueueStats st;
+    MessageRing<WS_TELEMETRY_DEPTH> telemetry;
+    MessageRing<WS_RELIABLE_DEPTH> reliable;
+  };
+
+  ClientSlot* find(uint32_t id);
+  void enqueue(ClientSlot& c, SharedMessage* m);
+  static void drain(ClientSlot& c);
+
+  ClientSlot clients[WS_MAX_CLIENTS];
+  std::mutex lock;
+};